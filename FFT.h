@@ -16,6 +16,8 @@
 
 // Std Lib includes
 #include <complex>
+#include <memory>
+#include <stdint.h>
 #include <stdlib.h>
 
 namespace cupcake
@@ -24,38 +26,326 @@ namespace cupcake
 namespace veclib
 {
 
+///
+/// The transform used to compute an FFT of a given length.
+///
+enum class FFTAlgorithm
+{
+    radix_2,            // -> IPP's power of 2 FFT. Only valid when FFTSize is a power of 2.
+    dft,                // -> IPP's arbitrary length DFT. Mixed radix for lengths with small
+                        //    prime factors, Bluestein's algorithm otherwise.
+    native,             // -> VecLib's own SIMD radix-4 FFT. Only valid when FFTSize is a power of 2.
+};
+
+///
+/// How make_FFT chooses an FFTAlgorithm.
+///
+enum class FFTPlanning
+{
+    estimate,           // -> Choose from the FFT length alone; no transforms are run.
+    measure,            // -> Time every algorithm valid for the length and keep the fastest.
+};
+
 ///
 /// FFT Configuration
 ///
+/// FFTSpec/DFTSpec are read only once made and may be shared between threads. FFTWorkingBuffer
+/// is scratch memory for the overloads that don't take an FFTScratch, so those may only be
+/// used by one thread at a time.
+///
 struct FFTConfig
 {
     size_t FFTSize;             // -> The theoretical length of the FFT operation.
-    size_t FFTSizeLog2;         // -> Log base 2 of the theoretical length of the FFT operation.
+    size_t FFTSizeLog2;         // -> Log base 2 of the theoretical length of the FFT operation (radix_2 only).
     size_t FFTOutputSize;       // -> The length of the array of complex floats at the output of the FFT.
+    size_t FFTWorkingBufferSize;// -> The number of bytes of scratch memory needed to run the FFT, with either spectrum layout.
+    FFTAlgorithm Algorithm;     // -> Which of FFTSpec, DFTSpec or the native twiddles in FFTSpecBuffer is in use.
     IppsFFTSpec_R_32f* FFTSpec;
+    IppsDFTSpec_R_32f* DFTSpec;
     Ipp8u* FFTSpecBuffer;
     Ipp8u* FFTWorkingBuffer;
 };
+
+///
+/// Scratch memory for running FFTs. Threads running transforms concurrently, even from
+/// the same FFTConfig or FFTPlan, each need their own.
+///
+class FFTScratch
+{
+public:
+
+    FFTScratch();
+
+    explicit FFTScratch( size_t bytes );
+
+    FFTScratch( FFTScratch&& other );
+
+    FFTScratch& operator=( FFTScratch&& other );
+
+    ~FFTScratch();
+
+    FFTScratch( const FFTScratch& ) = delete;
+
+    FFTScratch& operator=( const FFTScratch& ) = delete;
+
+    bool reserve( size_t bytes );
+
+    Ipp8u* data() { return buffer; }
+
+    size_t capacity() const { return buffer_size; }
+
+private:
+
+    Ipp8u* buffer;
+    size_t buffer_size;
+
+};
+
+FFTScratch& thread_FFT_scratch();
     
 static constexpr inline size_t get_output_FFT_size( size_t FFTSize ) { return FFTSize/2 + 1; };
     
-void make_FFT( size_t FFTSize, FFTConfig& config );
+size_t get_fast_FFT_size( size_t minimum_size );
+
+FFTAlgorithm plan_FFT_algorithm( size_t FFTSize, FFTPlanning planning = FFTPlanning::estimate );
+
+void make_FFT( size_t FFTSize, FFTConfig& config, FFTPlanning planning = FFTPlanning::estimate );
+
+void make_FFT( size_t FFTSize, FFTAlgorithm algorithm, FFTConfig& config );
 
 void destroy_FFT( FFTConfig& config );
 
 void FFT_not_in_place( const float* input, std::complex< float >* output, FFTConfig& config );
 
 void IFFT_not_in_place( const std::complex< float >* input, float* output, FFTConfig& config );
+
+void FFT_not_in_place( const float* input, std::complex< float >* output, const FFTConfig& config, FFTScratch& scratch );
+
+void IFFT_not_in_place( const std::complex< float >* input, float* output, const FFTConfig& config, FFTScratch& scratch );
+
+///
+/// Transforms to and from a split complex spectrum: the FFTSize/2 + 1 bins held as an array
+/// of real parts and an array of imaginary parts, rather than interleaved. Spectral kernels
+/// then load whole vectors of either part without shuffles. The native FFT produces and
+/// consumes this layout directly.
+///
+void FFT_not_in_place( const float* input, float* output_real, float* output_imag, FFTConfig& config );
+
+void IFFT_not_in_place( const float* input_real, const float* input_imag, float* output, FFTConfig& config );
+
+void FFT_not_in_place( const float* input, float* output_real, float* output_imag, const FFTConfig& config, FFTScratch& scratch );
+
+void IFFT_not_in_place( const float* input_real, const float* input_imag, float* output, const FFTConfig& config, FFTScratch& scratch );
+
+///
+/// Batched transforms of many frames of the same size.
+///
+/// Frames are described by a stride (elements between consecutive samples of one frame)
+/// and a distance (elements between the first samples of consecutive frames), as in FFTW's
+/// advanced interface. For example, with C interleaved channels of FFTSize samples each,
+/// input_stride = C and input_distance = 1; for frames packed back to back, input_stride = 1
+/// and input_distance = FFTSize. Output strides are counted in complex values.
+///
+void FFT_batch( const float* input, size_t input_stride, size_t input_distance,
+                std::complex< float >* output, size_t output_stride, size_t output_distance,
+                size_t frames, const FFTConfig& config, FFTScratch& scratch );
+
+void IFFT_batch( const std::complex< float >* input, size_t input_stride, size_t input_distance,
+                 float* output, size_t output_stride, size_t output_distance,
+                 size_t frames, const FFTConfig& config, FFTScratch& scratch );
+
+///
+/// Which direction of an FFT plan is normalised.
+///
+enum class FFTScaling
+{
+    inverse_by_n,       // -> Matches make_FFT; the inverse is divided by FFTSize.
+    forward_by_n,       // -> The forward transform is divided by FFTSize.
+    both_by_sqrt_n,     // -> Both directions are divided by sqrt(FFTSize).
+    none,               // -> Neither direction is normalised.
+};
+
+///
+/// Which precisions an FFT plan initialises up front.
+///
+enum class FFTPrecision
+{
+    single,             // -> The double precision specification is built by the first double transform.
+    single_and_double,  // -> Both are built by the constructor, so no transform initialises anything.
+};
+
+///
+/// Immutable FFT specification, shared between plans through the plan cache.
+///
+class FFTSpecification;
+
+///
+/// An FFT of a fixed size.
+///
+/// The specification (twiddles etc.) comes from a process wide cache, so constructing a
+/// plan of a size that has been seen before is cheap. Plans are move-only and release
+/// their reference on destruction.
+///
+/// Transforms are const and thread safe: scratch memory is either supplied by the caller
+/// or taken from the calling thread's thread_FFT_scratch(), so one plan can run on every
+/// core at once.
+///
+/// Besides float, plans transform double samples (on IPP's double precision FFT, whatever
+/// the single precision algorithm) and 16-bit integer samples, converted on the way in.
+/// working_buffer_size() is for single precision and double_working_buffer_size() for
+/// double.
+///
+class FFTPlan
+{
+public:
+
+    explicit FFTPlan( size_t FFTSize, FFTScaling scaling = FFTScaling::inverse_by_n,
+                      FFTPrecision precision = FFTPrecision::single );
+
+    FFTPlan( FFTPlan&& other );
+
+    FFTPlan& operator=( FFTPlan&& other );
+
+    ~FFTPlan();
+
+    FFTPlan( const FFTPlan& ) = delete;
+
+    FFTPlan& operator=( const FFTPlan& ) = delete;
+
+    void forward( const float* input, std::complex< float >* output ) const;
+
+    void inverse( const std::complex< float >* input, float* output ) const;
+
+    void forward( const float* input, std::complex< float >* output, FFTScratch& scratch ) const;
+
+    void inverse( const std::complex< float >* input, float* output, FFTScratch& scratch ) const;
+
+    void forward( const float* input, float* output_real, float* output_imag ) const;
+
+    void inverse( const float* input_real, const float* input_imag, float* output ) const;
+
+    void forward( const float* input, float* output_real, float* output_imag, FFTScratch& scratch ) const;
+
+    void inverse( const float* input_real, const float* input_imag, float* output, FFTScratch& scratch ) const;
+
+    void forward_batch( const float* input, size_t input_stride, size_t input_distance,
+                        std::complex< float >* output, size_t output_stride, size_t output_distance,
+                        size_t frames, FFTScratch& scratch ) const;
+
+    void inverse_batch( const std::complex< float >* input, size_t input_stride, size_t input_distance,
+                        float* output, size_t output_stride, size_t output_distance,
+                        size_t frames, FFTScratch& scratch ) const;
+
+    void forward( const double* input, std::complex< double >* output ) const;
+
+    void inverse( const std::complex< double >* input, double* output ) const;
+
+    void forward( const double* input, std::complex< double >* output, FFTScratch& scratch ) const;
+
+    void inverse( const std::complex< double >* input, double* output, FFTScratch& scratch ) const;
+
+    void forward( const int16_t* input, float gain, std::complex< float >* output ) const;
+
+    void forward( const int16_t* input, float gain, std::complex< float >* output, FFTScratch& scratch ) const;
+
+    size_t size() const;
+
+    size_t output_size() const;
+
+    size_t working_buffer_size() const;
+
+    size_t double_working_buffer_size() const;
+
+private:
+
+    std::shared_ptr< const FFTSpecification > spec;
+
+};
+
+///
+/// FFT plan cache statistics, counted since startup or the last reset_FFT_plan_cache_stats().
+///
+struct FFTPlanCacheStats
+{
+    size_t hits;                // -> Plans created from an existing specification.
+    size_t misses;              // -> Plans that had to initialise a new specification, including any whose
+                                //    thread then lost the race to cache it, or whose initialisation failed
+                                //    and so wasn't cached, so may exceed entries.
+    size_t entries;             // -> Specifications currently held by the cache.
+};
+
+FFTPlanCacheStats get_FFT_plan_cache_stats();
+
+void reset_FFT_plan_cache_stats();
+
+void clear_FFT_plan_cache();
     
+///
+/// Accuracy of the phase computed by phase_spectra and cart_to_polar. Lower accuracy
+/// levels replace the range reduced arctangent with a single polynomial over [0,1].
+///
+enum class SpectralAccuracy
+{
+    full,               // -> IPP, or a range reduced polynomial with the SIMD backend. Max error 3e-7 rad.
+    medium,             // -> Degree 11 minimax polynomial. Max error 2e-6 rad.
+    fast,               // -> Degree 7 minimax polynomial. Max error 1e-4 rad.
+};
+
 ///
 /// Operations on the FFT
 ///
 void spectral_magnitude( const std::complex< float >* input, float* output, size_t length );
     
 void phase_spectra( const std::complex< float >* input, float* output, size_t length );
+
+void phase_spectra( const std::complex< float >* input, float* output, size_t length, SpectralAccuracy accuracy );
     
 void cart_to_polar( const std::complex< float >* input, float* magnitude, float* phase, size_t length );
 
+void cart_to_polar( const std::complex< float >* input, float* magnitude, float* phase, size_t length, SpectralAccuracy accuracy );
+
+void polar_to_cart( const float* magnitude, const float* phase, std::complex< float >* output, size_t length );
+
+void spectral_mult( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* output, size_t length );
+
+void spectral_mult_in_place( const std::complex< float >* input1, std::complex< float >* input2_output, size_t length );
+
+void spectral_mult_accumulate( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* accumulator, size_t length );
+
+void spectral_conj_mult( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* output, size_t length );
+
+void spectral_conj_mult_in_place( const std::complex< float >* input1, std::complex< float >* input2_output, size_t length );
+
+void spectral_conj_mult_accumulate( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* accumulator, size_t length );
+
+void spectral_power( const std::complex< float >* input, float* output, size_t length );
+
+void spectral_power_dB( const std::complex< float >* input, float* output, size_t length, float floor_dB );
+
+///
+/// Operations on a split complex spectrum, see FFT_not_in_place, and conversions between
+/// the split and interleaved layouts.
+///
+void spectral_magnitude( const float* real, const float* imag, float* output, size_t length );
+
+void phase_spectra( const float* real, const float* imag, float* output, size_t length );
+
+void phase_spectra( const float* real, const float* imag, float* output, size_t length, SpectralAccuracy accuracy );
+
+void cart_to_polar( const float* real, const float* imag, float* magnitude, float* phase, size_t length );
+
+void cart_to_polar( const float* real, const float* imag, float* magnitude, float* phase, size_t length, SpectralAccuracy accuracy );
+
+void deinterleave_complex( const std::complex< float >* input, float* real, float* imag, size_t length );
+
+void interleave_complex( const float* real, const float* imag, std::complex< float >* output, size_t length );
+
+void spectral_magnitude( const std::complex< double >* input, double* output, size_t length );
+
+void phase_spectra( const std::complex< double >* input, double* output, size_t length );
+
+void cart_to_polar( const std::complex< double >* input, double* magnitude, double* phase, size_t length );
+
 } // namespace veclib
     
 } // namespace cupcake
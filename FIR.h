@@ -0,0 +1,107 @@
+//
+// Streaming FIR filter, in direct form or by uniformly partitioned FFT convolution.
+//
+
+#ifndef CUPCAKE_VEC_LIB_FIR_H
+#define CUPCAKE_VEC_LIB_FIR_H
+
+// In module includes
+#include "aligned_memory.h"
+#include "FFT.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <complex>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+///
+/// How FIRFilter computes its output.
+///
+enum class FIRMode
+{
+    automatic,          // -> direct for up to FIRFilter::direct_max_taps taps, partitioned above that.
+    direct,             // -> Time domain dot products, vectorised across outputs. No latency; cost grows with the taps.
+    partitioned,        // -> Uniformly partitioned overlap-save with FFTs of twice the block size. Latency of one block.
+};
+
+///
+/// Streaming FIR filter. Accepts input in chunks of any size, producing the same number
+/// of output samples, and keeps its state from one call to the next.
+///
+/// Long filters are split into partitions of block_size taps, each convolved with the input
+/// by an FFT of 2*block_size; input spectra are kept in a delay line so every block costs one
+/// forward and one inverse FFT, whatever the filter length. The output is then delayed by
+/// block_size samples, so block_size sets the trade off between latency and cost per sample.
+/// Short filters are cheaper in direct form, which has no latency.
+///
+/// The taps are fixed at construction, which transforms the partitions and sizes the
+/// delay line and FFT scratch for them. To change filters, construct a new FIRFilter.
+///
+class FIRFilter
+{
+public:
+
+    // The longest filter for which direct form beats partitioned convolution with AVX2 and
+    // 256 sample blocks, see FIRFilter/* in bench/veclib_bench.cpp.
+    static const size_t direct_max_taps = 128;
+
+    FIRFilter( const float* taps, size_t taps_count, size_t block_size, FIRMode mode = FIRMode::automatic );
+
+    void process( const float* input, float* output, size_t length );
+
+    void reset();
+
+    size_t size() const { return taps_length; }
+
+    size_t block_size() const { return block; }
+
+    size_t latency() const { return filter_mode==FIRMode::partitioned ? block : 0; }
+
+    FIRMode mode() const { return filter_mode; }
+
+private:
+
+    void process_direct( const float* input, float* output, size_t length );
+
+    void process_partitioned( const float* input, float* output, size_t length );
+
+    void run_partitioned_block();
+
+    size_t taps_length;
+    size_t block;
+    FIRMode filter_mode;
+
+    // Direct form.
+    AlignedBuffer< float > reversed_taps;
+    AlignedBuffer< float > history;        // -> The last taps - 1 input samples, followed by room for a block.
+
+    // Partitioned.
+    size_t partitions;
+    size_t padded_bins;                     // -> Spectrum length rounded up to a whole number of SIMD vectors.
+    FFTPlan plan;
+    FFTScratch scratch;
+    AlignedBuffer< std::complex< float > > filters;
+    AlignedBuffer< std::complex< float > > swapped_filters;
+    AlignedBuffer< std::complex< float > > delay_line;     // -> Ring of the last partitions input spectra.
+    AlignedBuffer< std::complex< float > > accumulator;
+    AlignedBuffer< float > frame;          // -> The previous and current input blocks, the FFT input.
+    AlignedBuffer< float > convolved;
+    AlignedBuffer< float > pending;        // -> Output of the last full block, emitted as the next one arrives.
+    size_t newest;
+    size_t fill;
+
+};
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_FIR_H
@@ -0,0 +1,97 @@
+//
+// Multi-channel cascades of biquad IIR filters.
+//
+
+#ifndef CUPCAKE_VEC_LIB_IIR_H
+#define CUPCAKE_VEC_LIB_IIR_H
+
+// In module includes
+#include "aligned_memory.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+///
+/// Coefficients of one biquad section, normalised so that a0 = 1:
+///
+///     y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]
+///
+struct BiquadCoefficients
+{
+    float b0;
+    float b1;
+    float b2;
+    float a1;
+    float a2;
+};
+
+///
+/// A cascade of biquad sections run over many channels at once. Samples are interleaved by
+/// channel, so each frame of channels loads as a SIMD vector and every lane filters its own
+/// channel, with its own coefficients, in transposed direct form II. Each block is run two
+/// sections at a time with their coefficients and state held in registers.
+///
+/// Channels are filtered independently, so a single channel gets no benefit from the SIMD
+/// width; the cost per frame is about the same for anything from 1 to the vector width.
+///
+/// Coefficient changes are glitch free: set_coefficients only sets a target, and the next
+/// process() call moves every coefficient linearly to its target over ramp_length frames.
+/// The stability region of a biquad is convex in ( a1, a2 ), so a ramp between two stable
+/// sections passes only through stable ones.
+///
+/// The channel and section counts are fixed at construction, which sizes the coefficient,
+/// ramp and state rows for them; set_coefficients() and reset() only write to those rows.
+///
+class BiquadCascade
+{
+public:
+
+    BiquadCascade( size_t channels, size_t sections, size_t ramp_length = 64 );
+
+    void set_coefficients( size_t section, const BiquadCoefficients& coefficients );
+
+    void set_coefficients( size_t section, size_t channel, const BiquadCoefficients& coefficients );
+
+    void process( const float* input, float* output, size_t frames );
+
+    void reset();
+
+    size_t channels() const { return channel_count; }
+
+    size_t sections() const { return section_count; }
+
+    size_t ramp_length() const { return ramp_frames; }
+
+private:
+
+    void start_ramp();
+
+    size_t channel_count;
+    size_t section_count;
+    size_t ramp_frames;
+    size_t row_length;                      // -> channels rounded up to a multiple of the widest SIMD vector.
+    size_t block_frames;                    // -> Frames per kernel call, keeping each block in L1.
+    AlignedBuffer< float > coefficients;   // -> Coefficients in use, five rows of row_length per section.
+    AlignedBuffer< float > targets;        // -> Coefficients most recently set, in the same layout.
+    AlignedBuffer< float > steps;          // -> Per-frame increments while ramping, in the same layout.
+    AlignedBuffer< float > state;          // -> Filter state, two rows of row_length per section.
+    AlignedBuffer< float > scratch;        // -> A block of the channels after the last whole SIMD vector.
+    size_t ramp_remaining;
+    bool targets_changed;
+
+};
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_IIR_H
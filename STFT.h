@@ -0,0 +1,168 @@
+//
+// Streaming short time Fourier transform and its overlap-add inverse.
+//
+
+#ifndef CUPCAKE_VEC_LIB_STFT_H
+#define CUPCAKE_VEC_LIB_STFT_H
+
+// In module includes
+#include "aligned_memory.h"
+#include "FFT.h"
+#include "window_functions.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <complex>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+///
+/// One analysis frame produced by STFT::process.
+///
+struct STFTFrame
+{
+    const std::complex< float >* spectrum;  // -> FFTSize/2 + 1 bins, laid out as for FFT_not_in_place.
+    const float* magnitude;                 // -> Magnitude of each bin, or NULL if the STFT was made without polar output.
+    const float* phase;                     // -> Phase of each bin, or NULL if the STFT was made without polar output.
+    size_t bins;                            // -> The number of values in spectrum, magnitude and phase.
+    size_t index;                           // -> The number of frames emitted before this one since construction or reset().
+};
+
+///
+/// Streaming STFT. Accepts input in chunks of any size and emits a windowed FFT frame
+/// every hop_size samples.
+///
+/// History is zero filled at the start, so the first frame is emitted after hop_size
+/// samples and no input waits longer than one hop. Frame i covers input samples
+/// [ (i+1)*hop_size - frame_size, (i+1)*hop_size ).
+///
+/// The history, frame and spectrum buffers and the FFT scratch are sized by the
+/// constructor, and the callback's STFTFrame points into them, so it is only valid until
+/// the callback returns.
+///
+class STFT
+{
+public:
+
+    STFT( size_t frame_size, size_t hop_size, bool polar = false );
+
+    STFT( size_t frame_size, size_t hop_size, const float* window, bool polar = false );
+
+    STFT( size_t frame_size, size_t hop_size, const Window& window, bool polar = false );
+
+    template< class Callback >
+    void process( const float* input, size_t length, Callback on_frame );
+
+    void reset();
+
+    size_t frame_size() const { return frame_length; }
+
+    size_t hop_size() const { return hop; }
+
+    size_t bins() const { return plan.output_size(); }
+
+private:
+
+    size_t push( const float* input, size_t length );
+
+    STFTFrame analyse();
+
+    size_t frame_length;
+    size_t hop;
+    bool compute_polar;
+    FFTPlan plan;
+    FFTScratch scratch;
+    Window window;
+    AlignedBuffer< float > history;        // -> Ring buffer of the last frame_size input samples.
+    size_t write_position;
+    size_t samples_until_frame;
+    size_t frames_emitted;
+    AlignedBuffer< float > windowed;
+    AlignedBuffer< std::complex< float > > spectrum;
+    AlignedBuffer< float > magnitude;
+    AlignedBuffer< float > phase;
+
+};
+
+template< class Callback >
+void STFT::process( const float* input, size_t length, Callback on_frame )
+///
+/// Feeds input samples to the STFT, calling on_frame for every frame completed.
+///
+/// @param input
+///  A pointer to the first of length input samples.
+///
+/// @param length
+///  The number of input samples. May be any size, including zero.
+///
+/// @param on_frame
+///  Called as on_frame( const STFTFrame& ) for each frame, in order. The frame's buffers
+///  are only valid until on_frame returns.
+///
+{
+    while( length > 0 )
+    {
+        size_t consumed = push( input, length );
+        input += consumed;
+        length -= consumed;
+        if( samples_until_frame == 0 )
+        {
+            const STFTFrame frame = analyse();
+            on_frame( frame );
+        }
+    }
+}
+
+///
+/// Streaming inverse STFT. Takes one spectrum per hop and produces hop_size output samples,
+/// overlap-adding the windowed inverse FFTs and dividing out the summed squared window so
+/// that ISTFT( STFT( x ) ) reconstructs x, delayed by frame_size - hop_size samples.
+///
+/// Like STFT, all memory is allocated on construction.
+///
+class ISTFT
+{
+public:
+
+    ISTFT( size_t frame_size, size_t hop_size );
+
+    ISTFT( size_t frame_size, size_t hop_size, const float* window );
+
+    ISTFT( size_t frame_size, size_t hop_size, const Window& window );
+
+    void process( const std::complex< float >* spectrum, float* output );
+
+    void reset();
+
+    size_t frame_size() const { return frame_length; }
+
+    size_t hop_size() const { return hop; }
+
+    size_t bins() const { return plan.output_size(); }
+
+private:
+
+    size_t frame_length;
+    size_t hop;
+    FFTPlan plan;
+    FFTScratch scratch;
+    Window window;
+    AlignedBuffer< float > inverse_normalisation;  // -> 1/sum( window^2 ) for each position within a hop.
+    AlignedBuffer< float > frame;
+    AlignedBuffer< float > accumulator;            // -> Ring buffer of partially overlap-added output.
+    size_t read_position;
+
+};
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_STFT_H
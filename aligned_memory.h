@@ -0,0 +1,285 @@
+//
+// Cache line aligned buffers, and an arena for per-frame scratch memory.
+//
+
+#ifndef CUPCAKE_VEC_LIB_ALIGNED_MEMORY_H
+#define CUPCAKE_VEC_LIB_ALIGNED_MEMORY_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+///
+/// Alignment of all memory from AlignedBuffer and Arena, in bytes. One cache line, and the
+/// width of an AVX-512 register.
+///
+const size_t memory_alignment = 64;
+
+void* aligned_allocate( size_t bytes );
+
+void* aligned_allocate( size_t count, size_t element_size );
+
+void aligned_free( void* memory );
+
+///
+/// An owning, fixed alignment array, for use in place of std::vector< T > in signal paths.
+///
+/// T must be trivially copyable, e.g. float or std::complex< float >: elements are moved
+/// with memcpy and new elements are zero filled rather than constructed.
+///
+template< class T >
+class AlignedBuffer
+{
+public:
+
+    typedef T value_type;
+
+    AlignedBuffer() : buffer( NULL ), length( 0 ), reserved( 0 ) {}
+
+    explicit AlignedBuffer( size_t size );
+
+    AlignedBuffer( size_t size, const T& value );
+
+    AlignedBuffer( const AlignedBuffer& other );
+
+    AlignedBuffer( AlignedBuffer&& other );
+
+    AlignedBuffer& operator=( const AlignedBuffer& other );
+
+    AlignedBuffer& operator=( AlignedBuffer&& other );
+
+    ~AlignedBuffer() { aligned_free( buffer ); }
+
+    void resize( size_t size );
+
+    void reserve( size_t size );
+
+    T* data() { return buffer; }
+
+    const T* data() const { return buffer; }
+
+    size_t size() const { return length; }
+
+    size_t capacity() const { return reserved; }
+
+    bool empty() const { return length == 0; }
+
+    T& operator[]( size_t index ) { return buffer[index]; }
+
+    const T& operator[]( size_t index ) const { return buffer[index]; }
+
+    T* begin() { return buffer; }
+
+    T* end() { return buffer + length; }
+
+    const T* begin() const { return buffer; }
+
+    const T* end() const { return buffer + length; }
+
+private:
+
+    T* buffer;
+    size_t length;
+    size_t reserved;                // -> Elements allocated, at least length.
+
+};
+
+template< class T >
+AlignedBuffer< T >::AlignedBuffer( size_t size ) :
+    buffer( NULL ),
+    length( 0 ),
+    reserved( 0 )
+///
+/// Creates a zero filled buffer.
+///
+/// @param size
+///  The number of elements.
+///
+{
+    resize( size );
+}
+
+template< class T >
+AlignedBuffer< T >::AlignedBuffer( size_t size, const T& value ) :
+    buffer( NULL ),
+    length( 0 ),
+    reserved( 0 )
+///
+/// Creates a buffer with every element set to value.
+///
+/// @param size
+///  The number of elements.
+///
+/// @param value
+///  The initial value of each element.
+///
+{
+    resize( size );
+    std::fill( begin(), end(), value );
+}
+
+template< class T >
+AlignedBuffer< T >::AlignedBuffer( const AlignedBuffer& other ) :
+    buffer( NULL ),
+    length( 0 ),
+    reserved( 0 )
+{
+    resize( other.length );
+    if( length > 0 )
+    {
+        memcpy( buffer, other.buffer, length*sizeof( T ) );
+    }
+}
+
+template< class T >
+AlignedBuffer< T >::AlignedBuffer( AlignedBuffer&& other ) :
+    buffer( other.buffer ),
+    length( other.length ),
+    reserved( other.reserved )
+{
+    other.buffer = NULL;
+    other.length = 0;
+    other.reserved = 0;
+}
+
+template< class T >
+AlignedBuffer< T >& AlignedBuffer< T >::operator=( const AlignedBuffer& other )
+{
+    if( this != &other )
+    {
+        resize( other.length );
+        if( length > 0 )
+        {
+            memcpy( buffer, other.buffer, length*sizeof( T ) );
+        }
+    }
+    return *this;
+}
+
+template< class T >
+AlignedBuffer< T >& AlignedBuffer< T >::operator=( AlignedBuffer&& other )
+{
+    std::swap( buffer, other.buffer );
+    std::swap( length, other.length );
+    std::swap( reserved, other.reserved );
+    return *this;
+}
+
+template< class T >
+void AlignedBuffer< T >::reserve( size_t size )
+///
+/// Makes room for at least size elements without changing the contents, so later resizes up
+/// to that size don't allocate. If the memory can't be allocated, the error is reported (see
+/// errors.h) and the buffer and its capacity are left as they were.
+///
+/// @param size
+///  The number of elements to make room for.
+///
+{
+    if( size <= reserved )
+    {
+        return;
+    }
+    T* grown = static_cast< T* >( aligned_allocate( size, sizeof( T ) ) );
+    if( grown == NULL )
+    {
+        return;
+    }
+    if( length > 0 )
+    {
+        memcpy( grown, buffer, length*sizeof( T ) );
+    }
+    aligned_free( buffer );
+    buffer = grown;
+    reserved = size;
+}
+
+template< class T >
+void AlignedBuffer< T >::resize( size_t size )
+///
+/// Changes the number of elements. Existing elements are kept, new ones are zero. Only
+/// allocates when size exceeds capacity(); shrinking keeps the memory for reuse. If the
+/// allocation fails, as for reserve(), the size is left unchanged.
+///
+/// @param size
+///  The new number of elements.
+///
+{
+    reserve( size );
+    if( size > reserved )
+    {
+        return;
+    }
+    if( size > length )
+    {
+        memset( static_cast< void* >( buffer + length ), 0, ( size - length )*sizeof( T ) );
+    }
+    length = size;
+}
+
+///
+/// A bump allocator for scratch memory that lives for one frame or block of processing.
+///
+/// Allocation moves a pointer and reset() releases everything at once, both in constant time.
+/// If a frame needs more than the arena holds, the excess comes from the heap, and the next
+/// reset() replaces the arena with one large enough for that frame; after the first few
+/// frames of a steady processing loop the arena never touches the heap again.
+///
+/// Not thread safe; give each thread its own arena.
+///
+class Arena
+{
+public:
+
+    explicit Arena( size_t bytes = 0 );
+
+    ~Arena();
+
+    template< class T >
+    T* allocate( size_t count ) { return static_cast< T* >( allocate_bytes( count*sizeof( T ) ) ); }
+
+    void* allocate_bytes( size_t bytes );
+
+    void reset();
+
+    size_t capacity() const { return block_size; }
+
+    size_t used() const { return offset + overflow_bytes; }
+
+    size_t peak() const { return peak_bytes; }
+
+private:
+
+    Arena( const Arena& );
+
+    Arena& operator=( const Arena& );
+
+    unsigned char* block;
+    size_t block_size;
+    size_t offset;                          // -> Bytes of block handed out since the last reset.
+    std::vector< void* > overflow;          // -> Heap allocations made because block was full.
+    size_t overflow_bytes;
+    size_t peak_bytes;                      // -> The most used() has reached between resets.
+
+};
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_ALIGNED_MEMORY_H
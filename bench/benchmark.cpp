@@ -0,0 +1,468 @@
+//
+// A minimal benchmark harness in the style of Google Benchmark, for veclib_bench - implementation.
+//
+
+// In Module includes
+#include "benchmark.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <regex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <utility>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace bench
+{
+
+namespace
+{
+
+struct Benchmark
+{
+    std::string name;
+    std::vector< size_t > sizes;
+    Function function;
+};
+
+struct Result
+{
+    std::string name;
+    std::string family;
+    size_t size;
+    size_t iterations;
+    size_t repetitions;
+    double seconds_per_iteration;   // -> Median over the repetitions.
+    double variation;               // -> Standard deviation over mean of the repetitions.
+    double items_per_iteration;
+    double bytes_per_iteration;
+    double flops_per_iteration;
+    std::string label;
+    std::string skipped;
+};
+
+struct Options
+{
+    Options() :
+        filter( ".*" ),
+        min_time( 0.1 ),
+        min_size( 64 ),
+        max_size( size_t( 1 ) << 24 ),
+        repetitions( 1 ),
+        list_only( false )
+    {
+    }
+
+    std::string filter;
+    double min_time;                // -> Seconds each measurement must run for.
+    size_t min_size;
+    size_t max_size;
+    size_t repetitions;
+    std::string json_path;
+    bool list_only;
+};
+
+std::vector< Benchmark >& registry()
+{
+    static std::vector< Benchmark > benchmarks;
+    return benchmarks;
+}
+
+std::vector< std::pair< std::string, std::string > >& context()
+{
+    static std::vector< std::pair< std::string, std::string > > entries;
+    return entries;
+}
+
+Options& options()
+{
+    static Options settings;
+    return settings;
+}
+
+bool parse_option( const char* argument, const char* name, std::string& value )
+///
+/// Matches "--name=value", returning the value.
+///
+{
+    const size_t name_length = strlen( name );
+    if( strncmp( argument, "--", 2 )!=0 || strncmp( argument + 2, name, name_length )!=0 || argument[2 + name_length]!='=' )
+    {
+        return false;
+    }
+    value = argument + 3 + name_length;
+    return true;
+}
+
+void print_usage( const char* program )
+{
+    printf( "Usage: %s [options]\n"
+            "  --filter=<regex>      Only run benchmarks whose name matches, e.g. --filter='^FFT'.\n"
+            "  --min_time=<seconds>  Minimum time per measurement. Default 0.1.\n"
+            "  --min_size=<n>        Skip sizes below n elements. Default 64.\n"
+            "  --max_size=<n>        Skip sizes above n elements. Default 16777216.\n"
+            "  --repetitions=<n>     Measure n times and report the median. Default 1.\n"
+            "  --json=<path>         Also write the results as JSON, for bench/compare.py.\n"
+            "  --list                List the benchmarks without running them.\n"
+            "  --isa=<name>          SIMD backend only: run on one instruction set, e.g. --isa=sse2.\n",
+            program );
+}
+
+std::string json_escape( const std::string& text )
+{
+    std::string escaped;
+    for( size_t i = 0; i < text.size(); ++i )
+    {
+        const char c = text[i];
+        if( c=='"' || c=='\\' )
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string current_date()
+{
+    const time_t now = time( NULL );
+    char text[32];
+    strftime( text, sizeof( text ), "%Y-%m-%dT%H:%M:%S", localtime( &now ) );
+    return text;
+}
+
+Result measure( const Benchmark& benchmark, size_t size )
+///
+/// Runs one benchmark at one size: grows the iteration count until a run lasts min_time,
+/// then repeats that run and keeps the median.
+///
+{
+    const Options& settings = options();
+    Result result;
+    result.name = benchmark.name + "/" + std::to_string( size );
+    result.family = benchmark.name;
+    result.size = size;
+
+    size_t iterations = 1;
+    std::vector< double > times;
+    while( true )
+    {
+        State state( size, iterations );
+        benchmark.function( state );
+        result.items_per_iteration = state.items_per_iteration;
+        result.bytes_per_iteration = state.bytes_per_iteration;
+        result.flops_per_iteration = state.flops_per_iteration;
+        result.label = state.label;
+        result.skipped = state.skipped;
+        if( !state.skipped.empty() )
+        {
+            result.iterations = 0;
+            result.repetitions = 0;
+            result.seconds_per_iteration = 0.0;
+            result.variation = 0.0;
+            return result;
+        }
+        const double seconds = state.seconds();
+        if( seconds >= settings.min_time || iterations >= 1000000000 )
+        {
+            times.push_back( seconds/static_cast< double >( iterations ) );
+            break;
+        }
+        // Aim a little past min_time, growing by at most 100x per step.
+        const double predicted = static_cast< double >( iterations )*settings.min_time*1.4/std::max( seconds, 1e-9 );
+        iterations = static_cast< size_t >( std::min( predicted, static_cast< double >( iterations )*100.0 ) );
+        iterations = std::max< size_t >( iterations, 1 );
+    }
+    while( times.size() < settings.repetitions )
+    {
+        State state( size, iterations );
+        benchmark.function( state );
+        times.push_back( state.seconds()/static_cast< double >( iterations ) );
+    }
+
+    std::vector< double > sorted( times );
+    std::sort( sorted.begin(), sorted.end() );
+    const size_t count = sorted.size();
+    result.seconds_per_iteration = count % 2 ? sorted[count/2] : 0.5*( sorted[count/2 - 1] + sorted[count/2] );
+    double mean = 0.0;
+    for( size_t i = 0; i < count; ++i )
+    {
+        mean += times[i];
+    }
+    mean /= static_cast< double >( count );
+    double variance = 0.0;
+    for( size_t i = 0; i < count; ++i )
+    {
+        variance += ( times[i] - mean )*( times[i] - mean );
+    }
+    result.variation = count > 1 ? std::sqrt( variance/static_cast< double >( count - 1 ) )/mean : 0.0;
+    result.iterations = iterations;
+    result.repetitions = count;
+    return result;
+}
+
+void print_header()
+{
+    printf( "%-48s %12s %12s %10s %10s %10s\n", "Benchmark", "Time (ns)", "Iterations", "ns/elem", "GB/s", "GFLOP/s" );
+    printf( "%s\n", std::string( 107, '-' ).c_str() );
+}
+
+void print_result( const Result& result )
+{
+    if( !result.skipped.empty() )
+    {
+        printf( "%-48s skipped: %s\n", result.name.c_str(), result.skipped.c_str() );
+        return;
+    }
+    const double seconds = result.seconds_per_iteration;
+    printf( "%-48s %12.1f %12zu %10.4f %10.2f %10.2f", result.name.c_str(), seconds*1e9, result.iterations,
+            result.items_per_iteration > 0.0 ? seconds*1e9/result.items_per_iteration : 0.0,
+            result.bytes_per_iteration/seconds*1e-9, result.flops_per_iteration/seconds*1e-9 );
+    if( result.repetitions > 1 )
+    {
+        printf( "  cv %.1f%%", result.variation*100.0 );
+    }
+    if( !result.label.empty() )
+    {
+        printf( "  %s", result.label.c_str() );
+    }
+    printf( "\n" );
+    fflush( stdout );
+}
+
+bool write_json( const std::string& path, const std::vector< Result >& results )
+///
+/// Writes results in a layout close to Google Benchmark's, one benchmark per line so that
+/// runs can be compared with diff as well as bench/compare.py.
+///
+{
+    FILE* file = fopen( path.c_str(), "w" );
+    if( file==NULL )
+    {
+        return false;
+    }
+    fprintf( file, "{\n  \"context\": {\n" );
+    const std::vector< std::pair< std::string, std::string > >& entries = context();
+    for( size_t i = 0; i < entries.size(); ++i )
+    {
+        fprintf( file, "    \"%s\": \"%s\"%s\n", json_escape( entries[i].first ).c_str(), json_escape( entries[i].second ).c_str(),
+                 i + 1 < entries.size() ? "," : "" );
+    }
+    fprintf( file, "  },\n  \"benchmarks\": [\n" );
+    for( size_t i = 0; i < results.size(); ++i )
+    {
+        const Result& result = results[i];
+        const double seconds = result.seconds_per_iteration;
+        fprintf( file, "    {\"name\": \"%s\", \"family\": \"%s\", \"size\": %zu",
+                 json_escape( result.name ).c_str(), json_escape( result.family ).c_str(), result.size );
+        if( !result.skipped.empty() )
+        {
+            fprintf( file, ", \"skipped\": \"%s\"}", json_escape( result.skipped ).c_str() );
+        }
+        else
+        {
+            fprintf( file, ", \"iterations\": %zu, \"repetitions\": %zu, \"real_time_ns\": %.6g, \"ns_per_element\": %.6g"
+                           ", \"gb_per_second\": %.6g, \"gflops\": %.6g, \"cv\": %.4g",
+                     result.iterations, result.repetitions, seconds*1e9,
+                     result.items_per_iteration > 0.0 ? seconds*1e9/result.items_per_iteration : 0.0,
+                     result.bytes_per_iteration/seconds*1e-9, result.flops_per_iteration/seconds*1e-9, result.variation );
+            if( !result.label.empty() )
+            {
+                fprintf( file, ", \"label\": \"%s\"", json_escape( result.label ).c_str() );
+            }
+            fprintf( file, "}" );
+        }
+        fprintf( file, "%s\n", i + 1 < results.size() ? "," : "" );
+    }
+    fprintf( file, "  ]\n}\n" );
+    fclose( file );
+    return true;
+}
+
+} // namespace
+
+State::State( size_t size, size_t iterations ) :
+    items_per_iteration( static_cast< double >( size ) ),
+    bytes_per_iteration( 0.0 ),
+    flops_per_iteration( 0.0 ),
+    problem_size( size ),
+    total_iterations( iterations ),
+    remaining( iterations )
+{
+}
+
+bool State::keep_running()
+///
+/// Returns true once per iteration. The clock starts on the first call and stops on the
+/// last, so setup before the loop isn't timed.
+///
+{
+    if( remaining==total_iterations )
+    {
+        start = Clock::now();
+    }
+    if( remaining==0 )
+    {
+        stop = Clock::now();
+        return false;
+    }
+    --remaining;
+    return true;
+}
+
+double State::seconds() const
+{
+    return std::chrono::duration< double >( stop - start ).count();
+}
+
+void register_benchmark( const std::string& name, const std::vector< size_t >& sizes, Function function )
+{
+    Benchmark benchmark;
+    benchmark.name = name;
+    benchmark.sizes = sizes;
+    benchmark.function = function;
+    registry().push_back( benchmark );
+}
+
+std::vector< size_t > size_range( size_t minimum, size_t maximum )
+{
+    std::vector< size_t > sizes;
+    for( size_t size = minimum; size <= maximum; size *= 4 )
+    {
+        sizes.push_back( size );
+    }
+    return sizes;
+}
+
+size_t max_size()
+{
+    return options().max_size;
+}
+
+void add_context( const std::string& key, const std::string& value )
+{
+    context().push_back( std::make_pair( key, value ) );
+}
+
+int run_benchmarks( int argc, char** argv )
+{
+    Options& settings = options();
+    for( int i = 1; i < argc; ++i )
+    {
+        std::string value;
+        if( parse_option( argv[i], "filter", value ) )
+        {
+            settings.filter = value;
+        }
+        else if( parse_option( argv[i], "min_time", value ) )
+        {
+            settings.min_time = atof( value.c_str() );
+        }
+        else if( parse_option( argv[i], "min_size", value ) )
+        {
+            settings.min_size = static_cast< size_t >( strtoull( value.c_str(), NULL, 10 ) );
+        }
+        else if( parse_option( argv[i], "max_size", value ) )
+        {
+            settings.max_size = static_cast< size_t >( strtoull( value.c_str(), NULL, 10 ) );
+        }
+        else if( parse_option( argv[i], "repetitions", value ) )
+        {
+            settings.repetitions = std::max< size_t >( 1, static_cast< size_t >( strtoull( value.c_str(), NULL, 10 ) ) );
+        }
+        else if( parse_option( argv[i], "json", value ) )
+        {
+            settings.json_path = value;
+        }
+        else if( strcmp( argv[i], "--list" )==0 )
+        {
+            settings.list_only = true;
+        }
+        else
+        {
+            print_usage( argv[0] );
+            return strcmp( argv[i], "--help" )==0 ? 0 : 1;
+        }
+    }
+
+    std::regex filter;
+    try
+    {
+        filter = std::regex( settings.filter );
+    }
+    catch( const std::regex_error& )
+    {
+        fprintf( stderr, "Invalid --filter regular expression: %s\n", settings.filter.c_str() );
+        return 1;
+    }
+
+    add_context( "date", current_date() );
+    add_context( "num_cpus", std::to_string( std::thread::hardware_concurrency() ) );
+#if defined( NDEBUG )
+    add_context( "library_build_type", "release" );
+#else
+    add_context( "library_build_type", "debug" );
+#endif
+#if defined( __VERSION__ )
+    add_context( "compiler", __VERSION__ );
+#endif
+
+    if( !settings.list_only )
+    {
+        for( size_t i = 0; i < context().size(); ++i )
+        {
+            printf( "%s: %s\n", context()[i].first.c_str(), context()[i].second.c_str() );
+        }
+#if !defined( NDEBUG )
+        printf( "***WARNING*** Built without NDEBUG; timings include assertions.\n" );
+#endif
+        print_header();
+    }
+
+    std::vector< Result > results;
+    const std::vector< Benchmark >& benchmarks = registry();
+    for( size_t b = 0; b < benchmarks.size(); ++b )
+    {
+        for( size_t s = 0; s < benchmarks[b].sizes.size(); ++s )
+        {
+            const size_t size = benchmarks[b].sizes[s];
+            const std::string name = benchmarks[b].name + "/" + std::to_string( size );
+            if( size < settings.min_size || size > settings.max_size || !std::regex_search( name, filter ) )
+            {
+                continue;
+            }
+            if( settings.list_only )
+            {
+                printf( "%s\n", name.c_str() );
+                continue;
+            }
+            results.push_back( measure( benchmarks[b], size ) );
+            print_result( results.back() );
+        }
+    }
+
+    if( !settings.json_path.empty() && !write_json( settings.json_path, results ) )
+    {
+        fprintf( stderr, "Could not write %s\n", settings.json_path.c_str() );
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
+
+} // namespace veclib
+
+} // namespace cupcake
@@ -0,0 +1,143 @@
+//
+// A minimal benchmark harness in the style of Google Benchmark, for veclib_bench.
+//
+
+#ifndef CUPCAKE_VEC_LIB_BENCHMARK_H
+#define CUPCAKE_VEC_LIB_BENCHMARK_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <chrono>
+#include <functional>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace bench
+{
+
+///
+/// Passed to each benchmark run. The benchmark sets up its data, then times its body with
+///
+///     while( state.keep_running() ) { ... }
+///
+/// and says how much work one pass of the body does, so that the harness can report
+/// ns/element, GB/s and GFLOP/s.
+///
+class State
+{
+public:
+
+    State( size_t size, size_t iterations );
+
+    bool keep_running();
+
+    size_t size() const { return problem_size; }
+
+    size_t iterations() const { return total_iterations; }
+
+    void set_items_processed( double items ) { items_per_iteration = items; }
+
+    void set_bytes_processed( double bytes ) { bytes_per_iteration = bytes; }
+
+    void set_flops( double flops ) { flops_per_iteration = flops; }
+
+    void set_label( const std::string& text ) { label = text; }
+
+    void skip( const std::string& reason ) { skipped = reason; }
+
+    double seconds() const;
+
+    double items_per_iteration;     // -> Elements per pass of the body, for ns/element. Defaults to size().
+    double bytes_per_iteration;     // -> Bytes read and written per pass, for GB/s.
+    double flops_per_iteration;     // -> Floating point operations per pass, for GFLOP/s.
+    std::string label;
+    std::string skipped;            // -> If not empty, the benchmark didn't run, and why.
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    size_t problem_size;
+    size_t total_iterations;
+    size_t remaining;
+    Clock::time_point start;
+    Clock::time_point stop;
+
+};
+
+typedef std::function< void( State& ) > Function;
+
+///
+/// Registers a benchmark, run once for each of sizes. Results are named "name/size".
+///
+void register_benchmark( const std::string& name, const std::vector< size_t >& sizes, Function function );
+
+///
+/// Powers of 4 from minimum to maximum inclusive.
+///
+std::vector< size_t > size_range( size_t minimum, size_t maximum );
+
+///
+/// Parses the command line, runs every registered benchmark that matches the filter and
+/// reports the results. See --help for the options.
+///
+/// @return
+///  The process exit code.
+///
+int run_benchmarks( int argc, char** argv );
+
+///
+/// The largest size --max_size allows, for benchmarks that size their own data.
+///
+size_t max_size();
+
+///
+/// Adds a key and value to the "context" object of the JSON output.
+///
+void add_context( const std::string& key, const std::string& value );
+
+///
+/// Keeps the compiler from discarding computations whose results are never read.
+///
+template< class T >
+inline void do_not_optimize( const T& value )
+{
+#if defined( _MSC_VER )
+    const volatile void* sink = &value;
+    ( void )sink;
+#else
+    asm volatile( "" : : "r,m"( value ) : "memory" );
+#endif
+}
+
+inline void clobber_memory()
+{
+#if defined( _MSC_VER )
+    _ReadWriteBarrier();
+#else
+    asm volatile( "" : : : "memory" );
+#endif
+}
+
+} // namespace bench
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_BENCHMARK_H
@@ -0,0 +1,64 @@
+#!/usr/bin/env python
+#
+# Compares two veclib_bench --json results and flags benchmarks that got slower.
+#
+# Usage: compare.py baseline.json contender.json [--threshold=0.05]
+#
+# Exits with status 1 if any benchmark's ns/element rose by more than the threshold.
+#
+
+import json
+import sys
+
+
+def load( path ):
+    with open( path ) as f:
+        data = json.load( f )
+    benchmarks = [ b for b in data['benchmarks'] if 'skipped' not in b ]
+    return data.get( 'context', {} ), [ b['name'] for b in benchmarks ], dict( ( b['name'], b ) for b in benchmarks )
+
+
+def main( argv ):
+    threshold = 0.05
+    paths = []
+    for argument in argv[1:]:
+        if argument.startswith( '--threshold=' ):
+            threshold = float( argument.split( '=', 1 )[1] )
+        else:
+            paths.append( argument )
+    if len( paths ) != 2:
+        sys.stderr.write( 'Usage: compare.py baseline.json contender.json [--threshold=0.05]\n' )
+        return 2
+
+    base_context, _, baseline = load( paths[0] )
+    new_context, order, contender = load( paths[1] )
+    for key in sorted( set( base_context ) | set( new_context ) ):
+        if key != 'date' and base_context.get( key ) != new_context.get( key ):
+            print( 'context %s differs: %s -> %s' % ( key, base_context.get( key ), new_context.get( key ) ) )
+
+    regressions = 0
+    print( '%-56s %12s %12s %9s' % ( 'Benchmark', 'Base ns/el', 'New ns/el', 'Change' ) )
+    for name in [ n for n in order if n in baseline ]:
+        old = baseline[name]['ns_per_element']
+        new = contender[name]['ns_per_element']
+        if old <= 0.0:
+            continue
+        change = new/old - 1.0
+        flag = ''
+        if change > threshold:
+            flag = '  REGRESSION'
+            regressions += 1
+        elif change < -threshold:
+            flag = '  improved'
+        print( '%-56s %12.4f %12.4f %+8.1f%%%s' % ( name, old, new, change*100.0, flag ) )
+    for name in sorted( set( baseline ) - set( contender ) ):
+        print( '%-56s only in baseline' % name )
+    for name in sorted( set( contender ) - set( baseline ) ):
+        print( '%-56s only in contender' % name )
+
+    print( '%d regression(s) above %.1f%%' % ( regressions, threshold*100.0 ) )
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit( main( sys.argv ) )
@@ -0,0 +1,1015 @@
+//
+// Benchmarks for every public VecLib function, across sizes from 64 to 16M elements.
+//
+// Run with --help for options. --json=<path> writes results that bench/compare.py can
+// compare against an earlier run to catch regressions.
+//
+
+// In Module includes
+#include "aligned_memory.h"
+#include "benchmark.h"
+#include "FFT.h"
+#include "FIR.h"
+#include "IIR.h"
+#include "instrumentation.h"
+#include "oscillators.h"
+#include "parallel.h"
+#include "rng.h"
+#include "sig_gen.h"
+#include "STFT.h"
+#include "vector_expressions.h"
+#include "vector_functions.h"
+#include "window_functions.h"
+#if defined( VECLIB_BACKEND_SIMD )
+#include "dispatch.h"
+#endif
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cupcake::veclib;
+using namespace cupcake::veclib::bench;
+
+namespace
+{
+
+const size_t smallest = 64;
+const size_t largest = size_t( 1 ) << 24;
+
+///
+/// Random operands in [-2,2), a buffer of ones for in place operations that should leave
+/// their target unchanged, and an output.
+///
+struct Operands
+{
+    explicit Operands( size_t size ) :
+        a( size ),
+        b( size ),
+        ones( size, 1.0f ),
+        out( size )
+    {
+        RandomStream random( 1 );
+        random.uniform( a.data(), size, -2.0f, 2.0f );
+        random.uniform( b.data(), size, -2.0f, 2.0f );
+    }
+
+    AlignedBuffer< float > a;
+    AlignedBuffer< float > b;
+    AlignedBuffer< float > ones;
+    AlignedBuffer< float > out;
+};
+
+typedef void ( *VectorBody )( Operands& operands, size_t length );
+
+void vector_benchmark( const std::string& name, double bytes_per_element, double flops_per_element, VectorBody body,
+                       const std::vector< size_t >& sizes = size_range( smallest, largest ) )
+///
+/// Registers a benchmark of an elementwise operation on float arrays.
+///
+/// @param bytes_per_element
+///  Bytes read plus bytes written per element.
+///
+/// @param flops_per_element
+///  Floating point operations per element.
+///
+{
+    register_benchmark( name, sizes, [=]( State& state )
+    {
+        Operands operands( state.size() );
+        while( state.keep_running() )
+        {
+            body( operands, state.size() );
+            clobber_memory();
+        }
+        state.set_bytes_processed( bytes_per_element*state.size() );
+        state.set_flops( flops_per_element*state.size() );
+    } );
+}
+
+double FFT_flops( size_t size )
+{
+    // The conventional count for a real transform, half that of a complex one.
+    return 2.5*static_cast< double >( size )*std::log2( static_cast< double >( size ) );
+}
+
+double FFT_bytes( size_t size )
+{
+    return static_cast< double >( size*sizeof( float ) + get_output_FFT_size( size )*sizeof( std::complex< float > ) );
+}
+
+std::vector< size_t > thread_counts()
+///
+/// 1, 2, 4, ... up to and including the hardware thread count.
+///
+{
+    const size_t hardware = std::max< size_t >( 1, std::thread::hardware_concurrency() );
+    std::vector< size_t > counts;
+    for( size_t threads = 1; threads < hardware; threads *= 2 )
+    {
+        counts.push_back( threads );
+    }
+    counts.push_back( hardware );
+    return counts;
+}
+
+const char* algorithm_name( FFTAlgorithm algorithm )
+{
+    switch( algorithm )
+    {
+        case FFTAlgorithm::radix_2: return "radix_2";
+        case FFTAlgorithm::dft: return "dft";
+        case FFTAlgorithm::native: return "native";
+    }
+    return "unknown";
+}
+
+const char* sum_accuracy_name( SumAccuracy accuracy )
+{
+    switch( accuracy )
+    {
+        case SumAccuracy::fast: return "fast";
+        case SumAccuracy::pairwise: return "pairwise";
+        case SumAccuracy::compensated: return "compensated";
+    }
+    return "unknown";
+}
+
+const char* accuracy_name( SpectralAccuracy accuracy )
+{
+    switch( accuracy )
+    {
+        case SpectralAccuracy::full: return "full";
+        case SpectralAccuracy::medium: return "medium";
+        case SpectralAccuracy::fast: return "fast";
+    }
+    return "unknown";
+}
+
+void register_vector_functions()
+{
+    vector_benchmark( "vec_mult_const_in_place", 8, 1, []( Operands& o, size_t n ) { vec_mult_const_in_place( o.a.data(), 1.0f, n ); } );
+    vector_benchmark( "vec_mult", 12, 1, []( Operands& o, size_t n ) { vec_mult( o.a.data(), o.b.data(), o.out.data(), n ); } );
+    vector_benchmark( "vec_mult_in_place", 12, 1, []( Operands& o, size_t n ) { vec_mult_in_place( o.ones.data(), o.a.data(), n ); } );
+    vector_benchmark( "vec_add_constant", 8, 1, []( Operands& o, size_t n ) { vec_add_constant( o.a.data(), 0.0f, n ); } );
+    vector_benchmark( "vec_add_in_place", 12, 1, []( Operands& o, size_t n ) { vec_add_in_place( o.a.data(), o.out.data(), n ); } );
+    vector_benchmark( "vec_sub_constant", 8, 1, []( Operands& o, size_t n ) { vec_sub_constant( o.a.data(), 0.0f, n ); } );
+    vector_benchmark( "vec_sub", 12, 1, []( Operands& o, size_t n ) { vec_sub( o.a.data(), o.b.data(), o.out.data(), n ); } );
+    vector_benchmark( "vec_sub_in_place", 12, 1, []( Operands& o, size_t n ) { vec_sub_in_place( o.out.data(), o.a.data(), n ); } );
+    vector_benchmark( "vec_negative_halfwave_rectify", 8, 1, []( Operands& o, size_t n ) { vec_negative_halfwave_rectify( o.a.data(), n ); } );
+    vector_benchmark( "vec_zero_magnitudes_greater_than_abs", 8, 2, []( Operands& o, size_t n ) { vec_zero_magnitudes_greater_than_abs( o.a.data(), 1.5f, n ); } );
+    vector_benchmark( "vec_zero_values_less_than", 8, 1, []( Operands& o, size_t n ) { vec_zero_values_less_than( o.a.data(), -1.5f, n ); } );
+    vector_benchmark( "vec_fractional_part", 8, 2, []( Operands& o, size_t n ) { vec_fractional_part( o.a.data(), o.out.data(), n ); } );
+    vector_benchmark( "vec_zero", 4, 0, []( Operands& o, size_t n ) { vec_zero( o.out.data(), n ); } );
+    vector_benchmark( "vec_copy", 8, 0, []( Operands& o, size_t n ) { vec_copy( o.a.data(), o.out.data(), n ); } );
+    vector_benchmark( "apply_window", 12, 2, []( Operands& o, size_t n ) { apply_window( o.a.data(), o.b.data(), o.out.data(), n, 0.5f ); } );
+
+    // Fused expression templates against the equivalent chain of vector_functions.h calls.
+    vector_benchmark( "expr/mul_add", 16, 2, []( Operands& o, size_t n )
+    {
+        expr::evaluate( o.out.data(), n, expr::view( o.a.data(), n )*expr::view( o.b.data(), n ) + expr::view( o.ones.data(), n ) );
+    } );
+    vector_benchmark( "chained/mul_add", 24, 2, []( Operands& o, size_t n )
+    {
+        vec_mult( o.a.data(), o.b.data(), o.out.data(), n );
+        vec_add_in_place( o.ones.data(), o.out.data(), n );
+    } );
+    vector_benchmark( "expr/abs_diff_scaled", 12, 3, []( Operands& o, size_t n )
+    {
+        expr::evaluate( o.out.data(), n, expr::abs( expr::view( o.a.data(), n ) - expr::view( o.b.data(), n ) )*0.5f );
+    } );
+}
+
+void register_reductions()
+{
+    const SumAccuracy accuracies[] = { SumAccuracy::fast, SumAccuracy::pairwise, SumAccuracy::compensated };
+    for( size_t a = 0; a < 3; ++a )
+    {
+        const SumAccuracy accuracy = accuracies[a];
+        const std::string suffix = std::string( "/" ) + sum_accuracy_name( accuracy );
+        register_benchmark( "vec_sum" + suffix, size_range( smallest, largest ), [=]( State& state )
+        {
+            Operands operands( state.size() );
+            while( state.keep_running() )
+            {
+                do_not_optimize( vec_sum( operands.a.data(), state.size(), accuracy ) );
+            }
+            state.set_bytes_processed( 4.0*state.size() );
+            state.set_flops( 1.0*state.size() );
+        } );
+        register_benchmark( "vec_mean_variance" + suffix, size_range( smallest, largest ), [=]( State& state )
+        {
+            Operands operands( state.size() );
+            float mean = 0.0f;
+            float variance = 0.0f;
+            while( state.keep_running() )
+            {
+                vec_mean_variance( operands.a.data(), state.size(), &mean, &variance, accuracy );
+                do_not_optimize( variance );
+            }
+            state.set_bytes_processed( 4.0*state.size() );
+            state.set_flops( 3.0*state.size() );
+        } );
+    }
+    register_benchmark( "vec_dot", size_range( smallest, largest ), []( State& state )
+    {
+        Operands operands( state.size() );
+        while( state.keep_running() )
+        {
+            do_not_optimize( vec_dot( operands.a.data(), operands.b.data(), state.size() ) );
+        }
+        state.set_bytes_processed( 8.0*state.size() );
+        state.set_flops( 2.0*state.size() );
+    } );
+    register_benchmark( "vec_norm_l2", size_range( smallest, largest ), []( State& state )
+    {
+        Operands operands( state.size() );
+        while( state.keep_running() )
+        {
+            do_not_optimize( vec_norm_l2( operands.a.data(), state.size() ) );
+        }
+        state.set_bytes_processed( 4.0*state.size() );
+        state.set_flops( 2.0*state.size() );
+    } );
+    register_benchmark( "vec_max", size_range( smallest, largest ), []( State& state )
+    {
+        Operands operands( state.size() );
+        size_t index = 0;
+        while( state.keep_running() )
+        {
+            do_not_optimize( vec_max( operands.a.data(), state.size(), &index ) );
+        }
+        state.set_bytes_processed( 4.0*state.size() );
+        state.set_flops( 1.0*state.size() );
+    } );
+    register_benchmark( "vec_weighted_mean", size_range( smallest, largest ), []( State& state )
+    {
+        Operands operands( state.size() );
+        while( state.keep_running() )
+        {
+            do_not_optimize( vec_weighted_mean( operands.a.data(), operands.ones.data(), state.size() ) );
+        }
+        state.set_bytes_processed( 8.0*state.size() );
+        state.set_flops( 3.0*state.size() );
+    } );
+}
+
+void register_sample_types()
+///
+/// The double and int16 overloads, against their float counterparts above.
+///
+{
+    const std::vector< size_t > sizes = size_range( smallest, largest );
+    register_benchmark( "double/vec_mult", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        AlignedBuffer< double > a( n, 1.5 );
+        AlignedBuffer< double > b( n, -0.5 );
+        AlignedBuffer< double > out( n );
+        while( state.keep_running() )
+        {
+            vec_mult( a.data(), b.data(), out.data(), n );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 24.0*n );
+        state.set_flops( 1.0*n );
+    } );
+    register_benchmark( "double/vec_fractional_part", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        AlignedBuffer< double > a( n, 2.75 );
+        AlignedBuffer< double > out( n );
+        while( state.keep_running() )
+        {
+            vec_fractional_part( a.data(), out.data(), n );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 16.0*n );
+        state.set_flops( 2.0*n );
+    } );
+    register_benchmark( "int16/vec_convert_from", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        AlignedBuffer< int16_t > pcm( n, 1234 );
+        AlignedBuffer< float > out( n );
+        while( state.keep_running() )
+        {
+            vec_convert( pcm.data(), out.data(), 1.0f/32768.0f, n );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 6.0*n );
+        state.set_flops( 1.0*n );
+    } );
+    register_benchmark( "int16/vec_convert_to", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        Operands operands( n );
+        AlignedBuffer< int16_t > pcm( n );
+        while( state.keep_running() )
+        {
+            vec_convert( operands.a.data(), pcm.data(), 16384.0f, n );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 6.0*n );
+        state.set_flops( 1.0*n );
+    } );
+    register_benchmark( "int16/vec_mult", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        Operands operands( n );
+        AlignedBuffer< int16_t > pcm( n, 1234 );
+        while( state.keep_running() )
+        {
+            vec_mult( pcm.data(), 1.0f/32768.0f, operands.b.data(), operands.out.data(), n );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 10.0*n );
+        state.set_flops( 2.0*n );
+    } );
+}
+
+void register_parallel()
+///
+/// Scaling curves for parallel.h: each operation at every thread count from 1 to the
+/// hardware thread count, with the size threshold disabled.
+///
+{
+    const std::vector< size_t > counts = thread_counts();
+    for( size_t t = 0; t < counts.size(); ++t )
+    {
+        const size_t threads = counts[t];
+        const std::string suffix = "/threads:" + std::to_string( threads );
+        const std::vector< size_t > sizes = size_range( size_t( 1 ) << 16, largest );
+        struct Parallel
+        {
+            static void run( size_t threads, State& state, double bytes, double flops, VectorBody body )
+            {
+                parallel::set_thread_count( threads );
+                const size_t saved_threshold = parallel::threshold();
+                parallel::set_threshold( 0 );
+                Operands operands( state.size() );
+                while( state.keep_running() )
+                {
+                    body( operands, state.size() );
+                    clobber_memory();
+                }
+                parallel::set_threshold( saved_threshold );
+                parallel::set_thread_count( 0 );
+                state.set_bytes_processed( bytes*state.size() );
+                state.set_flops( flops*state.size() );
+            }
+        };
+        register_benchmark( "parallel/vec_mult" + suffix, sizes, [=]( State& state )
+        {
+            Parallel::run( threads, state, 12, 1, []( Operands& o, size_t n ) { parallel::vec_mult( o.a.data(), o.b.data(), o.out.data(), n ); } );
+        } );
+        register_benchmark( "parallel/vec_add_in_place" + suffix, sizes, [=]( State& state )
+        {
+            Parallel::run( threads, state, 12, 1, []( Operands& o, size_t n ) { parallel::vec_add_in_place( o.a.data(), o.out.data(), n ); } );
+        } );
+        register_benchmark( "parallel/vec_fractional_part" + suffix, sizes, [=]( State& state )
+        {
+            Parallel::run( threads, state, 8, 2, []( Operands& o, size_t n ) { parallel::vec_fractional_part( o.a.data(), o.out.data(), n ); } );
+        } );
+        register_benchmark( "parallel/vec_copy" + suffix, sizes, [=]( State& state )
+        {
+            Parallel::run( threads, state, 8, 0, []( Operands& o, size_t n ) { parallel::vec_copy( o.a.data(), o.out.data(), n ); } );
+        } );
+        register_benchmark( "parallel/vec_sum" + suffix, sizes, [=]( State& state )
+        {
+            Parallel::run( threads, state, 4, 1, []( Operands& o, size_t n ) { o.out[0] = parallel::vec_sum( o.a.data(), n ); } );
+        } );
+    }
+}
+
+void register_spectral()
+{
+    const std::vector< size_t > sizes = size_range( smallest, largest );
+    register_benchmark( "spectral_magnitude", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        AlignedBuffer< std::complex< float > > spectrum( n );
+        RandomStream( 2 ).gaussian( reinterpret_cast< float* >( spectrum.data() ), 2*n );
+        AlignedBuffer< float > magnitude( n );
+        while( state.keep_running() )
+        {
+            spectral_magnitude( spectrum.data(), magnitude.data(), n );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 12.0*n );
+        state.set_flops( 4.0*n );
+    } );
+
+    const SpectralAccuracy accuracies[] = { SpectralAccuracy::full, SpectralAccuracy::medium, SpectralAccuracy::fast };
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const SpectralAccuracy accuracy = accuracies[i];
+        register_benchmark( std::string( "phase_spectra/" ) + accuracy_name( accuracy ), sizes, [=]( State& state )
+        {
+            const size_t n = state.size();
+            AlignedBuffer< std::complex< float > > spectrum( n );
+            RandomStream( 2 ).gaussian( reinterpret_cast< float* >( spectrum.data() ), 2*n );
+            AlignedBuffer< float > phase( n );
+            while( state.keep_running() )
+            {
+                phase_spectra( spectrum.data(), phase.data(), n, accuracy );
+                clobber_memory();
+            }
+            state.set_bytes_processed( 12.0*n );
+        } );
+        register_benchmark( std::string( "cart_to_polar/" ) + accuracy_name( accuracy ), sizes, [=]( State& state )
+        {
+            const size_t n = state.size();
+            AlignedBuffer< std::complex< float > > spectrum( n );
+            RandomStream( 2 ).gaussian( reinterpret_cast< float* >( spectrum.data() ), 2*n );
+            AlignedBuffer< float > magnitude( n );
+            AlignedBuffer< float > phase( n );
+            while( state.keep_running() )
+            {
+                cart_to_polar( spectrum.data(), magnitude.data(), phase.data(), n, accuracy );
+                clobber_memory();
+            }
+            state.set_bytes_processed( 16.0*n );
+        } );
+    }
+
+    register_benchmark( "spectral_power", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        AlignedBuffer< std::complex< float > > spectrum( n );
+        RandomStream( 2 ).gaussian( reinterpret_cast< float* >( spectrum.data() ), 2*n );
+        AlignedBuffer< float > power( n );
+        while( state.keep_running() )
+        {
+            spectral_power( spectrum.data(), power.data(), n );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 12.0*n );
+        state.set_flops( 3.0*n );
+    } );
+    register_benchmark( "spectral_power_dB", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        AlignedBuffer< std::complex< float > > spectrum( n );
+        RandomStream( 2 ).gaussian( reinterpret_cast< float* >( spectrum.data() ), 2*n );
+        AlignedBuffer< float > power( n );
+        while( state.keep_running() )
+        {
+            spectral_power_dB( spectrum.data(), power.data(), n, -120.0f );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 12.0*n );
+    } );
+    register_benchmark( "spectral_mult", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        AlignedBuffer< std::complex< float > > spectrum( n );
+        AlignedBuffer< std::complex< float > > response( n );
+        RandomStream( 2 ).gaussian( reinterpret_cast< float* >( spectrum.data() ), 2*n );
+        RandomStream( 3 ).gaussian( reinterpret_cast< float* >( response.data() ), 2*n );
+        AlignedBuffer< std::complex< float > > product( n );
+        while( state.keep_running() )
+        {
+            spectral_mult( spectrum.data(), response.data(), product.data(), n );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 24.0*n );
+        state.set_flops( 6.0*n );
+    } );
+    register_benchmark( "spectral_conj_mult_accumulate", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        AlignedBuffer< std::complex< float > > spectrum( n );
+        AlignedBuffer< std::complex< float > > other( n );
+        RandomStream( 2 ).gaussian( reinterpret_cast< float* >( spectrum.data() ), 2*n );
+        RandomStream( 3 ).gaussian( reinterpret_cast< float* >( other.data() ), 2*n );
+        AlignedBuffer< std::complex< float > > cross( n, std::complex< float >( 0.0f, 0.0f ) );
+        while( state.keep_running() )
+        {
+            spectral_conj_mult_accumulate( spectrum.data(), other.data(), cross.data(), n );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 32.0*n );
+        state.set_flops( 8.0*n );
+    } );
+    register_benchmark( "polar_to_cart", sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        AlignedBuffer< float > magnitude( n );
+        AlignedBuffer< float > phase( n );
+        RandomStream( 2 ).uniform( magnitude.data(), n );
+        RandomStream( 3 ).uniform( phase.data(), n, -3.14159265f, 3.14159265f );
+        AlignedBuffer< std::complex< float > > spectrum( n );
+        while( state.keep_running() )
+        {
+            polar_to_cart( magnitude.data(), phase.data(), spectrum.data(), n );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 16.0*n );
+    } );
+}
+
+void register_FFT()
+{
+    const FFTAlgorithm algorithms[] = { FFTAlgorithm::radix_2, FFTAlgorithm::dft, FFTAlgorithm::native };
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const FFTAlgorithm algorithm = algorithms[i];
+        for( int inverse = 0; inverse < 2; ++inverse )
+        {
+            const std::string name = std::string( inverse ? "IFFT_not_in_place/" : "FFT_not_in_place/" ) + algorithm_name( algorithm );
+            register_benchmark( name, size_range( smallest, largest ), [=]( State& state )
+            {
+                const size_t n = state.size();
+                FFTConfig config;
+                make_FFT( n, algorithm, config );
+                FFTScratch scratch( config.FFTWorkingBufferSize );
+                AlignedBuffer< float > signal( n );
+                RandomStream( 3 ).uniform( signal.data(), n, -1.0f, 1.0f );
+                AlignedBuffer< std::complex< float > > spectrum( config.FFTOutputSize );
+                FFT_not_in_place( signal.data(), spectrum.data(), config, scratch );
+                while( state.keep_running() )
+                {
+                    if( inverse )
+                    {
+                        IFFT_not_in_place( spectrum.data(), signal.data(), config, scratch );
+                    }
+                    else
+                    {
+                        FFT_not_in_place( signal.data(), spectrum.data(), config, scratch );
+                    }
+                    clobber_memory();
+                }
+                destroy_FFT( config );
+                state.set_bytes_processed( FFT_bytes( n ) );
+                state.set_flops( FFT_flops( n ) );
+            } );
+        }
+    }
+
+    // A forward FFT followed by the magnitude, with the spectrum interleaved or split.
+    for( int split = 0; split < 2; ++split )
+    {
+        register_benchmark( std::string( "FFT_magnitude/" ) + ( split ? "split" : "interleaved" ), size_range( smallest, largest ), [=]( State& state )
+        {
+            const size_t n = state.size();
+            FFTPlan plan( n );
+            FFTScratch scratch( plan.working_buffer_size() );
+            AlignedBuffer< float > signal( n );
+            RandomStream( 3 ).uniform( signal.data(), n, -1.0f, 1.0f );
+            AlignedBuffer< std::complex< float > > spectrum( plan.output_size() );
+            AlignedBuffer< float > real( plan.output_size() );
+            AlignedBuffer< float > imag( plan.output_size() );
+            AlignedBuffer< float > magnitude( plan.output_size() );
+            while( state.keep_running() )
+            {
+                if( split )
+                {
+                    plan.forward( signal.data(), real.data(), imag.data(), scratch );
+                    spectral_magnitude( real.data(), imag.data(), magnitude.data(), plan.output_size() );
+                }
+                else
+                {
+                    plan.forward( signal.data(), spectrum.data(), scratch );
+                    spectral_magnitude( spectrum.data(), magnitude.data(), plan.output_size() );
+                }
+                clobber_memory();
+            }
+            state.set_bytes_processed( FFT_bytes( n ) );
+            state.set_flops( FFT_flops( n ) );
+        } );
+    }
+
+    // Lengths with a factor of 3, which only the DFT handles.
+    std::vector< size_t > mixed_sizes = size_range( smallest, largest );
+    for( size_t i = 0; i < mixed_sizes.size(); ++i )
+    {
+        mixed_sizes[i] = mixed_sizes[i]/4*3;
+    }
+    register_benchmark( "FFT_not_in_place/dft_mixed_radix", mixed_sizes, []( State& state )
+    {
+        const size_t n = state.size();
+        FFTConfig config;
+        make_FFT( n, FFTAlgorithm::dft, config );
+        FFTScratch scratch( config.FFTWorkingBufferSize );
+        AlignedBuffer< float > signal( n );
+        RandomStream( 3 ).uniform( signal.data(), n, -1.0f, 1.0f );
+        AlignedBuffer< std::complex< float > > spectrum( config.FFTOutputSize );
+        while( state.keep_running() )
+        {
+            FFT_not_in_place( signal.data(), spectrum.data(), config, scratch );
+            clobber_memory();
+        }
+        destroy_FFT( config );
+        state.set_bytes_processed( FFT_bytes( n ) );
+        state.set_flops( FFT_flops( n ) );
+    } );
+
+    register_benchmark( "FFTPlan/forward", size_range( smallest, largest ), []( State& state )
+    {
+        const size_t n = state.size();
+        FFTPlan plan( n );
+        AlignedBuffer< float > signal( n );
+        RandomStream( 3 ).uniform( signal.data(), n, -1.0f, 1.0f );
+        AlignedBuffer< std::complex< float > > spectrum( plan.output_size() );
+        while( state.keep_running() )
+        {
+            plan.forward( signal.data(), spectrum.data() );
+            clobber_memory();
+        }
+        state.set_bytes_processed( FFT_bytes( n ) );
+        state.set_flops( FFT_flops( n ) );
+    } );
+
+    // Many frames through one plan, as an STFT over a whole file would.
+    register_benchmark( "FFTPlan/forward_batch_64", size_range( 256, 16384 ), []( State& state )
+    {
+        const size_t n = state.size();
+        const size_t frames = 64;
+        FFTPlan plan( n );
+        FFTScratch scratch( plan.working_buffer_size() );
+        AlignedBuffer< float > signal( n*frames );
+        RandomStream( 3 ).uniform( signal.data(), signal.size(), -1.0f, 1.0f );
+        AlignedBuffer< std::complex< float > > spectra( plan.output_size()*frames );
+        while( state.keep_running() )
+        {
+            plan.forward_batch( signal.data(), 1, n, spectra.data(), 1, plan.output_size(), frames, scratch );
+            clobber_memory();
+        }
+        state.set_items_processed( static_cast< double >( n*frames ) );
+        state.set_bytes_processed( FFT_bytes( n )*frames );
+        state.set_flops( FFT_flops( n )*frames );
+    } );
+
+    // The same frames through 64 separate calls, the baseline forward_batch_64 must beat.
+    register_benchmark( "FFTPlan/forward_loop_64", size_range( 256, 16384 ), []( State& state )
+    {
+        const size_t n = state.size();
+        const size_t frames = 64;
+        FFTPlan plan( n );
+        FFTScratch scratch( plan.working_buffer_size() );
+        AlignedBuffer< float > signal( n*frames );
+        RandomStream( 3 ).uniform( signal.data(), signal.size(), -1.0f, 1.0f );
+        AlignedBuffer< std::complex< float > > spectra( plan.output_size()*frames );
+        while( state.keep_running() )
+        {
+            for( size_t frame = 0; frame < frames; ++frame )
+            {
+                plan.forward( signal.data() + frame*n, spectra.data() + frame*plan.output_size(), scratch );
+            }
+            clobber_memory();
+        }
+        state.set_items_processed( static_cast< double >( n*frames ) );
+        state.set_bytes_processed( FFT_bytes( n )*frames );
+        state.set_flops( FFT_flops( n )*frames );
+    } );
+
+    // Aggregate throughput of one shared plan driven from several threads at once.
+    const std::vector< size_t > counts = thread_counts();
+    for( size_t t = 0; t < counts.size(); ++t )
+    {
+        const size_t threads = counts[t];
+        register_benchmark( "FFTPlan/forward_shared/threads:" + std::to_string( threads ), size_range( 256, 65536 ), [=]( State& state )
+        {
+            const size_t n = state.size();
+            const FFTPlan plan( n );
+            std::vector< AlignedBuffer< float > > signals( threads, AlignedBuffer< float >( n ) );
+            std::vector< AlignedBuffer< std::complex< float > > > spectra( threads, AlignedBuffer< std::complex< float > >( plan.output_size() ) );
+            const size_t per_thread = 64;
+            while( state.keep_running() )
+            {
+                std::vector< std::thread > workers;
+                for( size_t w = 0; w < threads; ++w )
+                {
+                    workers.push_back( std::thread( [&, w]()
+                    {
+                        for( size_t k = 0; k < per_thread; ++k )
+                        {
+                            plan.forward( signals[w].data(), spectra[w].data() );
+                        }
+                    } ) );
+                }
+                for( size_t w = 0; w < threads; ++w )
+                {
+                    workers[w].join();
+                }
+            }
+            const double transforms = static_cast< double >( threads*per_thread );
+            state.set_items_processed( transforms*n );
+            state.set_bytes_processed( transforms*FFT_bytes( n ) );
+            state.set_flops( transforms*FFT_flops( n ) );
+        } );
+    }
+
+    register_benchmark( "FFTPlan/construct_cached", size_range( smallest, 65536 ), []( State& state )
+    {
+        FFTPlan warm( state.size() );
+        while( state.keep_running() )
+        {
+            FFTPlan plan( state.size() );
+            do_not_optimize( plan );
+        }
+        state.set_items_processed( 1 );
+    } );
+}
+
+void register_STFT()
+{
+    const std::vector< size_t > sizes = size_range( 256, 16384 );
+    register_benchmark( "STFT/process_hop_quarter", sizes, []( State& state )
+    {
+        const size_t frame = state.size();
+        const size_t samples = 16*frame;
+        STFT analysis( frame, frame/4, true );
+        AlignedBuffer< float > input( samples );
+        RandomStream( 4 ).uniform( input.data(), samples, -1.0f, 1.0f );
+        float sink = 0.0f;
+        while( state.keep_running() )
+        {
+            analysis.process( input.data(), samples, [&]( const STFTFrame& f ) { sink += f.magnitude[1]; } );
+        }
+        do_not_optimize( sink );
+        state.set_items_processed( static_cast< double >( samples ) );
+        state.set_label( "items are input samples" );
+    } );
+    register_benchmark( "ISTFT/process_hop_quarter", sizes, []( State& state )
+    {
+        const size_t frame = state.size();
+        ISTFT synthesis( frame, frame/4 );
+        AlignedBuffer< std::complex< float > > spectrum( synthesis.bins() );
+        RandomStream( 4 ).gaussian( reinterpret_cast< float* >( spectrum.data() ), 2*spectrum.size() );
+        AlignedBuffer< float > output( frame/4 );
+        while( state.keep_running() )
+        {
+            synthesis.process( spectrum.data(), output.data() );
+            clobber_memory();
+        }
+        state.set_items_processed( static_cast< double >( frame/4 ) );
+        state.set_label( "items are output samples" );
+    } );
+}
+
+void register_FIR()
+{
+    // Sizes are filter lengths, to show where partitioned convolution overtakes direct form.
+    const size_t block = 256;
+    const FIRMode modes[] = { FIRMode::direct, FIRMode::partitioned };
+    for( FIRMode mode : modes )
+    {
+        const std::string name = mode==FIRMode::direct ? "FIRFilter/direct" : "FIRFilter/partitioned";
+        register_benchmark( name, size_range( 4, mode==FIRMode::direct ? 4096 : 65536 ), [=]( State& state )
+        {
+            const size_t samples = 16*block;
+            AlignedBuffer< float > taps( state.size() );
+            RandomStream( 5 ).gaussian( taps.data(), taps.size() );
+            FIRFilter filter( taps.data(), taps.size(), block, mode );
+            AlignedBuffer< float > input( samples );
+            RandomStream( 4 ).uniform( input.data(), samples, -1.0f, 1.0f );
+            AlignedBuffer< float > output( samples );
+            while( state.keep_running() )
+            {
+                filter.process( input.data(), output.data(), samples );
+                clobber_memory();
+            }
+            state.set_items_processed( static_cast< double >( samples ) );
+            state.set_label( "items are input samples, block 256" );
+        } );
+    }
+}
+
+void register_IIR()
+{
+    // Four lowpass sections per channel, at 1 to 64 interleaved channels. Sizes are frames.
+    const size_t channel_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+    for( size_t channels : channel_counts )
+    {
+        register_benchmark( "BiquadCascade/channels:" + std::to_string( channels ), size_range( 256, 4096 ), [=]( State& state )
+        {
+            const size_t samples = state.size()*channels;
+            const BiquadCoefficients lowpass = { 0.0675f, 0.135f, 0.0675f, -1.143f, 0.413f };
+            BiquadCascade cascade( channels, 4, 0 );
+            for( size_t s = 0; s < cascade.sections(); ++s )
+            {
+                cascade.set_coefficients( s, lowpass );
+            }
+            AlignedBuffer< float > input( samples );
+            RandomStream( 4 ).uniform( input.data(), samples, -1.0f, 1.0f );
+            AlignedBuffer< float > output( samples );
+            while( state.keep_running() )
+            {
+                cascade.process( input.data(), output.data(), state.size() );
+                clobber_memory();
+            }
+            state.set_items_processed( static_cast< double >( samples ) );
+            state.set_flops( 4*9.0*samples );
+            state.set_label( "items are samples over all channels" );
+        } );
+    }
+}
+
+void register_windows()
+{
+    const std::vector< size_t > sizes = size_range( smallest, 65536 );
+    register_benchmark( "Window/construct_cached", sizes, []( State& state )
+    {
+        Window warm( WindowType::hann, state.size() );
+        while( state.keep_running() )
+        {
+            Window window( WindowType::hann, state.size() );
+            do_not_optimize( window );
+        }
+        state.set_items_processed( 1 );
+    } );
+    register_benchmark( "Window/construct_uncached_kaiser", sizes, []( State& state )
+    {
+        while( state.keep_running() )
+        {
+            clear_window_cache();
+            Window window( WindowType::kaiser, state.size() );
+            do_not_optimize( window );
+        }
+    } );
+    register_benchmark( "apply_window/Window", size_range( smallest, largest ), []( State& state )
+    {
+        Window window( WindowType::hann, state.size() );
+        Operands operands( state.size() );
+        while( state.keep_running() )
+        {
+            apply_window( operands.a.data(), window, operands.out.data() );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 12.0*state.size() );
+        state.set_flops( 1.0*state.size() );
+    } );
+}
+
+void register_generators()
+{
+    const std::vector< size_t > sizes = size_range( smallest, largest );
+    register_benchmark( "RandomStream/uniform", sizes, []( State& state )
+    {
+        RandomStream random( 5 );
+        AlignedBuffer< float > output( state.size() );
+        while( state.keep_running() )
+        {
+            random.uniform( output.data(), state.size(), -1.0f, 1.0f );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 4.0*state.size() );
+    } );
+    register_benchmark( "RandomStream/gaussian", sizes, []( State& state )
+    {
+        RandomStream random( 5 );
+        AlignedBuffer< float > output( state.size() );
+        while( state.keep_running() )
+        {
+            random.gaussian( output.data(), state.size() );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 4.0*state.size() );
+    } );
+    register_benchmark( "SineOscillator/process", sizes, []( State& state )
+    {
+        SineOscillator oscillator( 0.01f );
+        AlignedBuffer< float > output( state.size() );
+        while( state.keep_running() )
+        {
+            oscillator.process( output.data(), state.size() );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 4.0*state.size() );
+    } );
+    register_benchmark( "ChirpOscillator/process", sizes, []( State& state )
+    {
+        ChirpOscillator chirp( 0.001f, 0.4f, state.size() );
+        AlignedBuffer< float > output( state.size() );
+        while( state.keep_running() )
+        {
+            chirp.restart();
+            chirp.process( output.data(), state.size() );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 4.0*state.size() );
+    } );
+    register_benchmark( "NoiseSource/process", sizes, []( State& state )
+    {
+        NoiseSource noise( 0.5f, 6 );
+        AlignedBuffer< float > output( state.size() );
+        while( state.keep_running() )
+        {
+            noise.process( output.data(), state.size() );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 4.0*state.size() );
+    } );
+    register_benchmark( "fill_vector_sine", sizes, []( State& state )
+    {
+        AlignedBuffer< float > output( state.size() );
+        while( state.keep_running() )
+        {
+            fill_vector_sine( output.data(), state.size(), 0.01f, 0.0f, 1.0f );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 4.0*state.size() );
+    } );
+    register_benchmark( "fill_vector_chirp", sizes, []( State& state )
+    {
+        AlignedBuffer< float > output( state.size() );
+        while( state.keep_running() )
+        {
+            fill_vector_chirp( output.data(), state.size(), 0.001f, 0.4f, 0.0f, 1.0f );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 4.0*state.size() );
+    } );
+    register_benchmark( "hamming", sizes, []( State& state )
+    {
+        AlignedBuffer< float > output( state.size() );
+        while( state.keep_running() )
+        {
+            hamming( output.data(), state.size() );
+            clobber_memory();
+        }
+        state.set_bytes_processed( 4.0*state.size() );
+    } );
+    register_benchmark( "make_random_number", size_range( smallest, 65536 ), []( State& state )
+    {
+        float sum = 0.0f;
+        while( state.keep_running() )
+        {
+            for( size_t i = 0; i < state.size(); ++i )
+            {
+                sum += make_random_number( -1.0f, 1.0f );
+            }
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+    // --isa=<name> is handled here, as it must take effect before anything runs.
+    std::vector< char* > arguments;
+    for( int i = 0; i < argc; ++i )
+    {
+        if( strncmp( argv[i], "--isa=", 6 )==0 )
+        {
+#if defined( VECLIB_BACKEND_SIMD )
+            const ISA candidates[] = { ISA::scalar, ISA::sse2, ISA::avx2, ISA::avx512, ISA::neon };
+            bool found = false;
+            for( size_t c = 0; c < 5; ++c )
+            {
+                if( strcmp( argv[i] + 6, isa_name( candidates[c] ) )==0 )
+                {
+                    found = force_isa( candidates[c] );
+                }
+            }
+            if( !found )
+            {
+                fprintf( stderr, "Unknown or unsupported instruction set: %s\n", argv[i] + 6 );
+                return 1;
+            }
+#else
+            fprintf( stderr, "--isa only applies to the SIMD backend.\n" );
+            return 1;
+#endif
+            continue;
+        }
+        arguments.push_back( argv[i] );
+    }
+
+#if defined( VECLIB_BACKEND_SIMD )
+    add_context( "backend", "simd" );
+    add_context( "isa", isa_name( active_isa() ) );
+#else
+    add_context( "backend", "ipp" );
+#endif
+    add_context( "parallel_threads", std::to_string( parallel::thread_count() ) );
+    add_context( "instrumentation", instrumentation_enabled() ? "on" : "off" );
+
+    register_vector_functions();
+    register_reductions();
+    register_sample_types();
+    register_parallel();
+    register_spectral();
+    register_FFT();
+    register_STFT();
+    register_FIR();
+    register_IIR();
+    register_windows();
+    register_generators();
+
+    return run_benchmarks( static_cast< int >( arguments.size() ), arguments.data() );
+}
@@ -0,0 +1,35 @@
+  {
+
+    'includes':
+    [
+      '../VecLib.gypi',
+    ],
+
+    'targets':
+    [
+      {
+        # Benchmarks for every public function. Build with NDEBUG for meaningful timings, e.g.
+        #   gyp bench/veclib_bench.gyp --depth=. -Dveclib_backend=simd
+        'target_name': 'veclib_bench',
+        'type': 'executable',
+        'defines':
+        [
+          'NDEBUG',
+        ],
+        'cflags':
+        [
+          '-O3',
+        ],
+        'xcode_settings':
+        {
+          'GCC_OPTIMIZATION_LEVEL': '3',
+        },
+        'sources':
+        [
+          'benchmark.h',
+          'benchmark.cpp',
+          'veclib_bench.cpp',
+        ],
+      },
+    ],
+  }
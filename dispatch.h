@@ -0,0 +1,52 @@
+//
+// Runtime selection of the instruction set used by the SIMD backend.
+//
+
+#ifndef CUPCAKE_VEC_LIB_DISPATCH_H
+#define CUPCAKE_VEC_LIB_DISPATCH_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+// None.
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+///
+/// Instruction sets that the SIMD backend has kernels for.
+///
+/// On first use the fastest one supported by the host is selected, unless the
+/// VECLIB_ISA environment variable names another, e.g. VECLIB_ISA=sse2.
+///
+enum class ISA
+{
+    scalar,
+    sse2,
+    avx2,
+    avx512,
+    neon,
+};
+
+ISA best_supported_isa();
+
+ISA active_isa();
+
+bool force_isa( ISA isa );
+
+bool isa_supported( ISA isa );
+
+const char* isa_name( ISA isa );
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_DISPATCH_H
@@ -0,0 +1,67 @@
+//
+// Error reporting for VecLib's entry points.
+//
+
+#ifndef CUPCAKE_VEC_LIB_ERRORS_H
+#define CUPCAKE_VEC_LIB_ERRORS_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stddef.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+//
+// VecLib functions do not throw or return status codes. When a call fails, e.g. IPP rejects
+// its arguments or an allocation fails, the error is recorded as the calling thread's last
+// error and passed to the error handler, if one is set. With no handler, debug builds stop
+// on an assert as they always have, and release builds only record the error.
+//
+// Successful calls pay one predictable branch per IPP call for the check; reporting is kept
+// out of line.
+//
+
+enum class ErrorCode
+{
+    none,
+    ipp_error,                  // -> IPP returned a failing status, see Error::status.
+    allocation_failed,          // -> An allocation of FFT specifications or scratch memory failed.
+    invalid_argument,           // -> An argument outside the documented range.
+};
+
+struct Error
+{
+    ErrorCode code;
+    int status;                 // -> The IppStatus for ipp_error, otherwise 0.
+    const char* function;       // -> The VecLib function that failed.
+    const char* message;        // -> A static description of the error, never NULL.
+};
+
+///
+/// Called on the failing thread, before the failing function returns. May throw, in which
+/// case the exception propagates out of that function; output buffers are then undefined.
+///
+typedef void ( *ErrorHandler )( const Error& error, void* context );
+
+void set_error_handler( ErrorHandler handler, void* context = NULL );
+
+ErrorHandler get_error_handler();
+
+Error last_error();
+
+void clear_last_error();
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_ERRORS_H
@@ -0,0 +1,71 @@
+//
+// Opt-in call counters and timing for VecLib's entry points.
+//
+
+#ifndef CUPCAKE_VEC_LIB_INSTRUMENTATION_H
+#define CUPCAKE_VEC_LIB_INSTRUMENTATION_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+//
+// Instrumentation is compiled in when VecLib is built with VECLIB_INSTRUMENT defined (the
+// 'veclib_instrument' GYP variable). Otherwise every entry point is free of it, and
+// snapshots are empty.
+//
+// Each call to an instrumented function adds one to its call count, its length to the
+// element count and the time stamp counter ticks it took to its cycle count. Counts are
+// kept per thread without atomic read-modify-writes, so the cost is two time stamp reads
+// and a few stores per call. Functions that call other instrumented functions, e.g. the
+// parallel.h operations, are counted at the innermost call only.
+//
+
+///
+/// Totals for one function since the last reset_instrumentation().
+///
+struct FunctionCounters
+{
+    const char* name;
+    uint64_t calls;
+    uint64_t elements;          // -> Sum of the lengths passed, e.g. FFT sizes times frames for FFTs.
+    uint64_t cycles;            // -> Time stamp counter ticks: rdtsc on x86, cntvct_el0 on ARM64, nanoseconds elsewhere.
+    double seconds;             // -> cycles converted with cycles_per_second.
+};
+
+struct InstrumentationSnapshot
+{
+    std::vector< FunctionCounters > functions;      // -> Functions called at least once, in a fixed order.
+    double cycles_per_second;                       // -> Time stamp counter frequency, measured against the system clock.
+    double elapsed_seconds;                         // -> Wall time since the last reset, for comparing against the total.
+};
+
+bool instrumentation_enabled();
+
+InstrumentationSnapshot get_instrumentation_snapshot();
+
+void reset_instrumentation();
+
+std::string format_instrumentation_text( const InstrumentationSnapshot& snapshot );
+
+std::string format_instrumentation_json( const InstrumentationSnapshot& snapshot );
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_INSTRUMENTATION_H
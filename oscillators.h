@@ -0,0 +1,124 @@
+//
+// Streaming signal generators that continue seamlessly from one block to the next.
+//
+
+#ifndef CUPCAKE_VEC_LIB_OSCILLATORS_H
+#define CUPCAKE_VEC_LIB_OSCILLATORS_H
+
+// In module includes
+#include "rng.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+///
+/// A sinusoid, mag*cos( phase ), generated one block at a time.
+///
+/// Phase is kept in double precision between calls, so consecutive blocks join without a
+/// discontinuity however long the oscillator runs. Frequency changes apply from the next
+/// sample generated; to change frequency at sample k of a block, process k samples, change
+/// the frequency, then process the rest. Nothing allocates, so all methods are safe to call
+/// from a real-time audio callback.
+///
+class SineOscillator
+{
+public:
+
+    explicit SineOscillator( float frequency, float phase = 0.0f, float magnitude = 1.0f );
+
+    void process( float* output, size_t length );
+
+    void set_frequency( float frequency );
+
+    void ramp_frequency( float frequency, size_t samples );
+
+    void set_phase( float phase );
+
+    void set_magnitude( float magnitude ) { amplitude = magnitude; }
+
+    float frequency() const { return static_cast< float >( current_frequency ); }
+
+    float phase() const;
+
+    float magnitude() const { return amplitude; }
+
+private:
+
+    double cycles;                  // -> Phase of the next sample, in cycles, kept in [-0.5,0.5).
+    double current_frequency;       // -> Frequency of the next sample, in cycles per sample.
+    double chirp_rate;              // -> Frequency change per sample while ramping.
+    double ramp_target;             // -> Frequency at the end of the current ramp.
+    size_t ramp_remaining;          // -> Samples left in the current ramp.
+    float amplitude;
+
+};
+
+///
+/// A linear chirp from start_freq to end_freq over a given number of samples, generated one
+/// block at a time. Once the sweep is complete the oscillator holds end_freq.
+///
+class ChirpOscillator
+{
+public:
+
+    ChirpOscillator( float start_freq, float end_freq, size_t sweep_samples, float phase = 0.0f, float magnitude = 1.0f );
+
+    void process( float* output, size_t length ) { oscillator.process( output, length ); }
+
+    void restart();
+
+    float frequency() const { return oscillator.frequency(); }
+
+    float phase() const { return oscillator.phase(); }
+
+private:
+
+    SineOscillator oscillator;
+    float start_frequency;
+    float end_frequency;
+    size_t sweep_length;
+    float start_phase;
+
+};
+
+///
+/// Uniform white noise in [-magnitude,magnitude), generated one block at a time.
+///
+/// The same seed always gives the same sequence, however it is split into blocks.
+///
+class NoiseSource
+{
+public:
+
+    explicit NoiseSource( float magnitude = 1.0f, uint64_t seed = 0 );
+
+    void process( float* output, size_t length ) { generator.uniform( output, length, -amplitude, amplitude ); }
+
+    void seed( uint64_t seed ) { generator = RandomStream( seed ); }
+
+    void set_magnitude( float magnitude ) { amplitude = magnitude; }
+
+    float magnitude() const { return amplitude; }
+
+private:
+
+    RandomStream generator;
+    float amplitude;
+
+};
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_OSCILLATORS_H
@@ -0,0 +1,136 @@
+//
+// Multi-threaded versions of the vector_functions.h operations, for very long arrays.
+//
+
+#ifndef CUPCAKE_VEC_LIB_PARALLEL_H
+#define CUPCAKE_VEC_LIB_PARALLEL_H
+
+// In module includes
+#include "vector_functions.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace parallel
+{
+
+//
+// Work is split into chunks of chunk_size() elements, sized to stay in cache, and run on a
+// persistent pool of threads shared by the whole process. Each thread starts on its own
+// contiguous share of the chunks and steals from the others when it runs out, so uneven
+// progress between cores doesn't leave any idle. The calling thread takes part as well.
+//
+// Arrays shorter than threshold() are processed on the calling thread alone, as are calls
+// made from inside a pool thread, or while another thread is already using the pool.
+//
+// Results of the elementwise operations are identical to the single threaded functions in
+// vector_functions.h. The reductions reduce each chunk separately and combine the chunk
+// results in order, so their results depend on chunk_size() but never on the thread count.
+//
+
+void set_thread_count( size_t threads );
+
+size_t thread_count();
+
+void set_threshold( size_t length );
+
+size_t threshold();
+
+void set_chunk_size( size_t length );
+
+size_t chunk_size();
+
+typedef void ( *ChunkFunction )( void* context, size_t begin, size_t end );
+
+void for_each_chunk( size_t length, ChunkFunction function, void* context );
+
+template< class Body >
+void for_each_chunk( size_t length, Body& body )
+///
+/// Calls body( begin, end ) for consecutive chunks covering [0,length), from as many threads
+/// as are available. Chunks may run in any order and concurrently with each other.
+///
+/// @param length
+///  The number of elements to process.
+///
+/// @param body
+///  A callable taking ( size_t begin, size_t end ). Must be safe to call concurrently on
+///  disjoint ranges.
+///
+{
+    struct Trampoline
+    {
+        static void call( void* context, size_t begin, size_t end ) { ( *static_cast< Body* >( context ) )( begin, end ); }
+    };
+    for_each_chunk( length, &Trampoline::call, static_cast< void* >( &body ) );
+}
+
+///
+/// Elementwise vector operations, as in vector_functions.h.
+///
+void vec_mult_const_in_place( float* input1, float multiplier, size_t length );
+
+void vec_mult( const float* input1, const float* input2, float* output, size_t length );
+
+void vec_mult_in_place( const float* input1, float* input2, size_t length );
+
+void vec_add_constant( float* input1, float constant, size_t length );
+
+void vec_add_in_place( const float* input1, float* input2_output, size_t length );
+
+void vec_sub_constant( float* input1, float constant, size_t length );
+
+void vec_sub( const float* input1, const float* input2, float* output, size_t length );
+
+void vec_sub_in_place( float* input1, const float* input2, size_t length );
+
+void vec_negative_halfwave_rectify( float* input, size_t length );
+
+void vec_zero_magnitudes_greater_than_abs( float* input, float threshold, size_t length );
+
+void vec_zero_values_less_than( float* input, float threshold, size_t length );
+
+void vec_fractional_part( const float* input, float* output, size_t length );
+
+///
+/// Vector intialization functions, as in vector_functions.h.
+///
+void vec_zero( float* vec, size_t length );
+
+void vec_copy( const float* vec_source, float* vec_dest, size_t length );
+
+///
+/// Reductions, as in vector_functions.h.
+///
+float vec_sum( const float* input, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+float vec_dot( const float* input1, const float* input2, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+float vec_norm_l1( const float* input, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+float vec_norm_l2( const float* input, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+float vec_min( const float* input, size_t length, size_t* index = NULL );
+
+float vec_max( const float* input, size_t length, size_t* index = NULL );
+
+void vec_mean_variance( const float* input, size_t length, float* mean, float* variance, SumAccuracy accuracy = SumAccuracy::fast );
+
+float vec_weighted_mean( const float* values, const float* weights, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+} // namespace parallel
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_PARALLEL_H
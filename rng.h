@@ -0,0 +1,69 @@
+//
+// Reproducible, thread-safe generation of buffers of random numbers.
+//
+
+#ifndef CUPCAKE_VEC_LIB_RNG_H
+#define CUPCAKE_VEC_LIB_RNG_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+///
+/// A stream of random numbers from a counter-based generator (Philox4x32-10).
+///
+/// Every sample is a function only of ( seed, stream, position ), so there is no hidden shared
+/// state: streams are cheap to create, any number of them can be used concurrently, and one
+/// stream can be read from any position with seek(). Different stream numbers give
+/// statistically independent sequences of 2^64 samples each.
+///
+/// To get results that do not depend on the number of threads, split the work into fixed
+/// jobs rather than per-thread shares, and give each job its own stream number. Alternatively
+/// split one long stream: a thread that handles samples [begin,end) seeks to begin before
+/// filling, and the output is identical to filling the whole range from one thread.
+///
+/// A single RandomStream object is not safe to use from several threads at once.
+///
+class RandomStream
+{
+public:
+
+    explicit RandomStream( uint64_t seed = 0, uint64_t stream = 0 );
+
+    void uniform( float* output, size_t length, float minimum = 0.0f, float maximum = 1.0f );
+
+    void gaussian( float* output, size_t length, float mean = 0.0f, float deviation = 1.0f );
+
+    void seek( uint64_t sample ) { position = sample; }
+
+    uint64_t tell() const { return position; }
+
+    uint64_t seed() const { return key; }
+
+    uint64_t stream() const { return stream_number; }
+
+private:
+
+    uint64_t key;                   // -> The seed, used as the Philox key.
+    uint64_t stream_number;
+    uint64_t position;              // -> Index of the next sample to generate.
+
+};
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_RNG_H
@@ -29,10 +29,16 @@ void seed_rand();
 float make_random_number( float minVal, float maxVal );
     
 void fill_vector_sine( std::vector<float>& output, float frequency, float phase, float mag );
+
+void fill_vector_sine( float* output, size_t length, float frequency, float phase, float mag );
     
 void fill_vector_chirp( std::vector< float >& output, float start_freq, float end_freq, float start_phase, float mag );
+
+void fill_vector_chirp( float* output, size_t length, float start_freq, float end_freq, float start_phase, float mag );
     
 void hamming( std::vector<float>& window_output );
+
+void hamming( float* window_output, size_t length );
     
 void linspace( float start, float finish, std::vector<float>& output );
 
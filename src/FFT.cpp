@@ -7,13 +7,33 @@
 
 // In Module includes
 #include "FFT.h"
+#include "error_reporting.h"
+#include "instrumentation_probe.h"
+#if defined( VECLIB_BACKEND_SIMD )
+#include "simd/kernel_table.h"
+#else
+#include "simd/fft_kernels.h"
+#include "simd/native_isa.h"
+#include "simd/spectral_kernels.h"
+#include "simd/vector_kernels.h"
+#endif
 
 // Thirdparty includes
 #include "ipp/ippcore.h"
 #include "ipp/ippvm.h"
 
 // Std Lib includes
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits.h>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace cupcake
 {
@@ -21,75 +41,569 @@ namespace cupcake
 namespace veclib
 {
 
-void make_FFT( size_t FFTSize, FFTConfig& config )
+namespace
+{
+
+bool is_power_of_2( size_t size )
+{
+    return size && !( size & ( size - 1 ) );
+}
+
+size_t align_up( size_t bytes )
+{
+    const size_t alignment = 64;
+    return ( bytes + alignment - 1 ) & ~( alignment - 1 );
+}
+
+size_t split_staging_size( const FFTConfig& config )
 ///
-/// Function for initialising an FFT object to be later used as an FFT configuration.
+/// The bytes at the end of the working buffer of IPP's transforms in which the split layout
+/// overloads stage an interleaved spectrum. None for the native FFT, which reads and writes
+/// split arrays directly.
 ///
-/// @param FFTSize
-///  The length of the FFT output - this must be a power of 2.
+{
+    return config.Algorithm==FFTAlgorithm::native ? 0 : config.FFTOutputSize*sizeof( std::complex< float > );
+}
+
+size_t native_FFT_table_size( size_t FFTSize )
 ///
-/// @param FFTConfig
-///  An uninitialised FFTConfig object that will be filled out by this function.
+/// The number of floats in the native FFT's twiddle table. See src/simd/fft_kernels.h.
+///
+{
+    const size_t M = FFTSize/2;
+    size_t size = 2 + 2*( M + 1 );
+    for( size_t n = M; n >= 4; n /= 4 )
+    {
+        size += 6*( n/4 );
+    }
+    return size;
+}
+
+void init_native_FFT_table( size_t FFTSize, int scaling_flag, float* table )
+///
+/// Fills the native FFT's scale factors and twiddles, computed in double precision.
+///
+{
+    const double pi = 3.14159265358979323846;
+    const double N = static_cast< double >( FFTSize );
+    const size_t M = FFTSize/2;
+
+    double forward_scale = 1.0;
+    double inverse_scale = 1.0;
+    if( scaling_flag==IPP_FFT_DIV_FWD_BY_N )
+    {
+        forward_scale = 1.0/N;
+    }
+    else if( scaling_flag==IPP_FFT_DIV_INV_BY_N )
+    {
+        inverse_scale = 1.0/N;
+    }
+    else if( scaling_flag==IPP_FFT_DIV_BY_SQRTN )
+    {
+        forward_scale = 1.0/std::sqrt( N );
+        inverse_scale = forward_scale;
+    }
+    table[0] = static_cast< float >( 0.5*forward_scale );
+    table[1] = static_cast< float >( inverse_scale );
+
+    float* w_re = table + 2;
+    float* w_im = w_re + M + 1;
+    for( size_t k = 0; k <= M; ++k )
+    {
+        w_re[k] = static_cast< float >( std::cos( 2.0*pi*k/N ) );
+        w_im[k] = static_cast< float >( -std::sin( 2.0*pi*k/N ) );
+    }
+
+    float* stage = w_im + M + 1;
+    for( size_t n = M; n >= 4; n /= 4 )
+    {
+        const size_t m = n/4;
+        for( size_t p = 0; p < m; ++p )
+        {
+            for( size_t k = 1; k <= 3; ++k )
+            {
+                const double angle = 2.0*pi*static_cast< double >( k*p )/static_cast< double >( n );
+                stage[( 2*k - 2 )*m + p] = static_cast< float >( std::cos( angle ) );
+                stage[( 2*k - 1 )*m + p] = static_cast< float >( -std::sin( angle ) );
+            }
+        }
+        stage += 6*m;
+    }
+}
+
+void init_FFT_spec( size_t FFTSize, FFTAlgorithm algorithm, int scaling_flag, FFTConfig& config )
+///
+/// Fills out an FFTConfig for the given algorithm, except for the working buffer which is
+/// left NULL with its required size in FFTWorkingBufferSize.
 ///
 {
-    // Set FFT sizes (Find what power of 2 is greater or equal to FFTSize for order.)
+    assert( FFTSize>0 ); // FFTSize must be positive.
+    assert( algorithm!=FFTAlgorithm::radix_2 || is_power_of_2( FFTSize ) ); // Radix 2 FFTSize must be a power of 2.
+    assert( algorithm!=FFTAlgorithm::native || ( is_power_of_2( FFTSize ) && FFTSize>=2 ) ); // Native FFTSize must be a power of 2, at least 2.
+
     config.FFTSize = FFTSize;
     config.FFTSizeLog2 = 0;
-    config.FFTOutputSize = FFTSize/2 + 1;
+    config.FFTOutputSize = get_output_FFT_size( FFTSize );
+    config.Algorithm = algorithm;
+    config.FFTSpec = NULL;
+    config.DFTSpec = NULL;
+    config.FFTWorkingBuffer = NULL;
     while( FFTSize >>= 1 )
     {
         ++config.FFTSizeLog2;
-        assert( ( ( FFTSize & 1 )==0 ) || FFTSize==1 ); // FFTSize must be a power of 2.
     }
-    
-    // Set the FFTSpec to Null.
+
+    if( algorithm==FFTAlgorithm::native )
+    {
+        const size_t table_size = native_FFT_table_size( config.FFTSize );
+        config.FFTSpecBuffer = ippsMalloc_8u( static_cast< int >( table_size*sizeof( float ) ) );
+        config.FFTWorkingBufferSize = 0;
+        if( VECLIB_UNLIKELY( config.FFTSpecBuffer==NULL ) )
+        {
+            report_error( ErrorCode::allocation_failed, 0, "make_FFT", "Failed to allocate FFT twiddle table." );
+            return;
+        }
+        init_native_FFT_table( config.FFTSize, scaling_flag, reinterpret_cast< float* >( config.FFTSpecBuffer ) );
+        config.FFTWorkingBufferSize = 2*config.FFTSize*sizeof( float );
+        return;
+    }
+
+    // Get memory size allocations for this type of transform.
+    int spec_buffer_size;
+    int init_buffer_size;
+    int working_buffer_size;
+    IppStatus err;
+    if( algorithm==FFTAlgorithm::radix_2 )
+    {
+        err = ippsFFTGetSize_R_32f( static_cast< int >( config.FFTSizeLog2 ),
+                                    scaling_flag,
+                                    ippAlgHintNone,
+                                    &spec_buffer_size,
+                                    &init_buffer_size,
+                                    &working_buffer_size );
+    }
+    else
+    {
+        err = ippsDFTGetSize_R_32f( static_cast< int >( config.FFTSize ),
+                                    scaling_flag,
+                                    ippAlgHintNone,
+                                    &spec_buffer_size,
+                                    &init_buffer_size,
+                                    &working_buffer_size );
+    }
+
+    config.FFTSpecBuffer = NULL;
+    config.FFTWorkingBufferSize = 0;
+    if( !check_ipp_status( err, "make_FFT" ) )
+    {
+        return;
+    }
+
+    Ipp8u* init_buffer = init_buffer_size ? ippsMalloc_8u( init_buffer_size ) : NULL;
+    config.FFTSpecBuffer = spec_buffer_size ? ippsMalloc_8u( spec_buffer_size ) : NULL;
+    if( VECLIB_UNLIKELY( ( init_buffer_size && init_buffer==NULL ) || ( spec_buffer_size && config.FFTSpecBuffer==NULL ) ) )
+    {
+        ippsFree( init_buffer );
+        ippsFree( config.FFTSpecBuffer );
+        config.FFTSpecBuffer = NULL;
+        report_error( ErrorCode::allocation_failed, 0, "make_FFT", "Failed to allocate FFT specification." );
+        return;
+    }
+    // IPP only transforms to and from interleaved spectra, so the working buffer is followed by
+    // room to stage one for the split layout overloads.
+    config.FFTWorkingBufferSize = align_up( static_cast< size_t >( working_buffer_size ) ) + split_staging_size( config );
+
+    // Initialise the specification structures. The DFT specification is the spec buffer itself.
+    if( algorithm==FFTAlgorithm::radix_2 )
+    {
+        err = ippsFFTInit_R_32f( &(config.FFTSpec),
+                                 static_cast< int >( config.FFTSizeLog2 ),
+                                 scaling_flag,
+                                 ippAlgHintNone,
+                                 config.FFTSpecBuffer,
+                                 init_buffer );
+    }
+    else
+    {
+        config.DFTSpec = reinterpret_cast< IppsDFTSpec_R_32f* >( config.FFTSpecBuffer );
+        err = ippsDFTInit_R_32f( static_cast< int >( config.FFTSize ),
+                                 scaling_flag,
+                                 ippAlgHintNone,
+                                 config.DFTSpec,
+                                 init_buffer );
+    }
+
+    // Free memory used for initialisation
+    ippsFree( init_buffer );
+
+    if( !check_ipp_status( err, "make_FFT" ) )
+    {
+        ippsFree( config.FFTSpecBuffer );
+        config.FFTSpecBuffer = NULL;
+        config.FFTSpec = NULL;
+        config.DFTSpec = NULL;
+    }
+}
+
+bool FFT_spec_built( const FFTConfig& config )
+///
+/// Returns whether init_FFT_spec succeeded in building the config's specification.
+///
+{
+    switch( config.Algorithm )
+    {
+        case FFTAlgorithm::native:
+            return config.FFTSpecBuffer!=NULL;
+        case FFTAlgorithm::dft:
+            return config.DFTSpec!=NULL;
+        case FFTAlgorithm::radix_2:
+        default:
+            return config.FFTSpec!=NULL;
+    }
+}
+
+bool has_FFT_spec( const FFTConfig& config, const char* function_name )
+///
+/// Reports allocation_failed, and returns false, if make_FFT failed to build the config's
+/// specification, e.g. the native FFT's twiddle table.
+///
+{
+    if( VECLIB_UNLIKELY( !FFT_spec_built( config ) ) )
+    {
+        report_error( ErrorCode::allocation_failed, 0, function_name, "FFT specification was not built." );
+        return false;
+    }
+    return true;
+}
+
+bool has_working_buffer( const FFTConfig& config, const char* function_name )
+///
+/// Reports allocation_failed, and returns false, if make_FFT failed to allocate the config's
+/// working buffer.
+///
+{
+    if( VECLIB_UNLIKELY( config.FFTWorkingBufferSize && config.FFTWorkingBuffer==NULL ) )
+    {
+        report_error( ErrorCode::allocation_failed, 0, function_name, "FFT working buffer was not allocated." );
+        return false;
+    }
+    return true;
+}
+
+IppStatus forward_transform( const FFTConfig& config, const float* input, std::complex< float >* output, Ipp8u* working_buffer )
+{
+    if( config.Algorithm==FFTAlgorithm::native )
+    {
+        const float* table = reinterpret_cast< const float* >( config.FFTSpecBuffer );
+        float* working_floats = reinterpret_cast< float* >( working_buffer );
+#if defined( VECLIB_BACKEND_SIMD )
+        simd::kernels().real_FFT_forward( config.FFTSize, table, input, reinterpret_cast< float* >( output ), working_floats );
+#else
+        simd::real_FFT_forward< simd::NativeISA >( config.FFTSize, table, input, reinterpret_cast< float* >( output ), working_floats );
+#endif
+        return ippStsNoErr;
+    }
+    if( config.Algorithm==FFTAlgorithm::dft )
+    {
+        return ippsDFTFwd_RToCCS_32f( input, reinterpret_cast< Ipp32f* >( output ), config.DFTSpec, working_buffer );
+    }
+    return ippsFFTFwd_RToCCS_32f( input, reinterpret_cast< Ipp32f* >( output ), config.FFTSpec, working_buffer );
+}
+
+IppStatus inverse_transform( const FFTConfig& config, const std::complex< float >* input, float* output, Ipp8u* working_buffer )
+{
+    if( config.Algorithm==FFTAlgorithm::native )
+    {
+        const float* table = reinterpret_cast< const float* >( config.FFTSpecBuffer );
+        float* working_floats = reinterpret_cast< float* >( working_buffer );
+#if defined( VECLIB_BACKEND_SIMD )
+        simd::kernels().real_FFT_inverse( config.FFTSize, table, reinterpret_cast< const float* >( input ), output, working_floats );
+#else
+        simd::real_FFT_inverse< simd::NativeISA >( config.FFTSize, table, reinterpret_cast< const float* >( input ), output, working_floats );
+#endif
+        return ippStsNoErr;
+    }
+    if( config.Algorithm==FFTAlgorithm::dft )
+    {
+        return ippsDFTInv_CCSToR_32f( reinterpret_cast< const Ipp32f* >( input ), output, config.DFTSpec, working_buffer );
+    }
+    return ippsFFTInv_CCSToR_32f( reinterpret_cast< const Ipp32f* >( input ), output, config.FFTSpec, working_buffer );
+}
+
+///
+/// A double precision FFT specification. Always IPP's radix 2 FFT or DFT; the native FFT is
+/// single precision only.
+///
+struct DoubleFFTConfig
+{
+    size_t FFTSize;
+    size_t FFTWorkingBufferSize;
+    FFTAlgorithm Algorithm;
+    IppsFFTSpec_R_64f* FFTSpec;
+    IppsDFTSpec_R_64f* DFTSpec;
+    Ipp8u* FFTSpecBuffer;
+};
+
+void init_double_FFT_spec( size_t FFTSize, int scaling_flag, DoubleFFTConfig& config )
+///
+/// Fills out a DoubleFFTConfig, as init_FFT_spec does for single precision.
+///
+{
+    config.FFTSize = FFTSize;
+    config.FFTWorkingBufferSize = 0;
+    config.Algorithm = is_power_of_2( FFTSize ) ? FFTAlgorithm::radix_2 : FFTAlgorithm::dft;
     config.FFTSpec = NULL;
-    
-    // Get memory size allocations for this type of FFT.
-    int FFT_specification_buffer_size;
-    int FFT_init_buffer_size;
-    int FFT_working_buffer_size;
-    
-    IppStatus err = ippsFFTGetSize_R_32f( static_cast< int >( config.FFTSizeLog2 ),
-                                          IPP_FFT_DIV_INV_BY_N,
-                                          ippAlgHintNone,
-                                          &FFT_specification_buffer_size,
-                                          &FFT_init_buffer_size,
-                                          &FFT_working_buffer_size );
-    
-    assert( err==ippStsNoErr ); // Error getting FFT structure sizes.
-    
-    // Allocate memories
-    Ipp8u* init_buffer;
-    if( FFT_init_buffer_size )
-        init_buffer = ippsMalloc_8u( FFT_init_buffer_size );
+    config.DFTSpec = NULL;
+    config.FFTSpecBuffer = NULL;
+    int order = 0;
+    while( ( size_t( 1 ) << order ) < FFTSize )
+    {
+        ++order;
+    }
+
+    int spec_buffer_size;
+    int init_buffer_size;
+    int working_buffer_size;
+    IppStatus err;
+    if( config.Algorithm==FFTAlgorithm::radix_2 )
+    {
+        err = ippsFFTGetSize_R_64f( order, scaling_flag, ippAlgHintNone,
+                                    &spec_buffer_size, &init_buffer_size, &working_buffer_size );
+    }
     else
-        init_buffer = NULL;
-    
-    if( FFT_specification_buffer_size )
-        config.FFTSpecBuffer = ippsMalloc_8u( FFT_specification_buffer_size );
+    {
+        err = ippsDFTGetSize_R_64f( static_cast< int >( FFTSize ), scaling_flag, ippAlgHintNone,
+                                    &spec_buffer_size, &init_buffer_size, &working_buffer_size );
+    }
+    if( !check_ipp_status( err, "FFTPlan" ) )
+    {
+        return;
+    }
+
+    Ipp8u* init_buffer = init_buffer_size ? ippsMalloc_8u( init_buffer_size ) : NULL;
+    config.FFTSpecBuffer = spec_buffer_size ? ippsMalloc_8u( spec_buffer_size ) : NULL;
+    if( VECLIB_UNLIKELY( ( init_buffer_size && init_buffer==NULL ) || ( spec_buffer_size && config.FFTSpecBuffer==NULL ) ) )
+    {
+        ippsFree( init_buffer );
+        ippsFree( config.FFTSpecBuffer );
+        config.FFTSpecBuffer = NULL;
+        report_error( ErrorCode::allocation_failed, 0, "FFTPlan", "Failed to allocate FFT specification." );
+        return;
+    }
+    config.FFTWorkingBufferSize = static_cast< size_t >( working_buffer_size );
+
+    if( config.Algorithm==FFTAlgorithm::radix_2 )
+    {
+        err = ippsFFTInit_R_64f( &(config.FFTSpec), order, scaling_flag, ippAlgHintNone, config.FFTSpecBuffer, init_buffer );
+    }
     else
+    {
+        config.DFTSpec = reinterpret_cast< IppsDFTSpec_R_64f* >( config.FFTSpecBuffer );
+        err = ippsDFTInit_R_64f( static_cast< int >( FFTSize ), scaling_flag, ippAlgHintNone, config.DFTSpec, init_buffer );
+    }
+
+    ippsFree( init_buffer );
+
+    if( !check_ipp_status( err, "FFTPlan" ) )
+    {
+        ippsFree( config.FFTSpecBuffer );
         config.FFTSpecBuffer = NULL;
-    
-    if( FFT_working_buffer_size )
-        config.FFTWorkingBuffer = ippsMalloc_8u( FFT_working_buffer_size );
+        config.FFTSpec = NULL;
+        config.DFTSpec = NULL;
+    }
+}
+
+IppStatus forward_transform( const DoubleFFTConfig& config, const double* input, std::complex< double >* output, Ipp8u* working_buffer )
+{
+    if( config.Algorithm==FFTAlgorithm::dft )
+    {
+        return ippsDFTFwd_RToCCS_64f( input, reinterpret_cast< Ipp64f* >( output ), config.DFTSpec, working_buffer );
+    }
+    return ippsFFTFwd_RToCCS_64f( input, reinterpret_cast< Ipp64f* >( output ), config.FFTSpec, working_buffer );
+}
+
+IppStatus inverse_transform( const DoubleFFTConfig& config, const std::complex< double >* input, double* output, Ipp8u* working_buffer )
+{
+    if( config.Algorithm==FFTAlgorithm::dft )
+    {
+        return ippsDFTInv_CCSToR_64f( reinterpret_cast< const Ipp64f* >( input ), output, config.DFTSpec, working_buffer );
+    }
+    return ippsFFTInv_CCSToR_64f( reinterpret_cast< const Ipp64f* >( input ), output, config.FFTSpec, working_buffer );
+}
+
+bool has_FFT_spec( const DoubleFFTConfig& config, const char* function_name )
+///
+/// As has_FFT_spec above, for a double precision specification.
+///
+{
+    const bool built = config.Algorithm==FFTAlgorithm::dft ? config.DFTSpec!=NULL : config.FFTSpec!=NULL;
+    if( VECLIB_UNLIKELY( !built ) )
+    {
+        report_error( ErrorCode::allocation_failed, 0, function_name, "FFT specification was not built." );
+        return false;
+    }
+    return true;
+}
+
+double time_FFT_algorithm( size_t FFTSize, FFTAlgorithm algorithm )
+///
+/// Returns the fastest of several timed forward and inverse transform pairs, in seconds.
+///
+{
+    FFTConfig config;
+    init_FFT_spec( FFTSize, algorithm, IPP_FFT_DIV_INV_BY_N, config );
+    if( !FFT_spec_built( config ) )
+    {
+        return std::numeric_limits< double >::max();
+    }
+    FFTScratch scratch( config.FFTWorkingBufferSize );
+    std::vector< float > signal( FFTSize, 0.0f );
+    std::vector< std::complex< float > > spectrum( config.FFTOutputSize );
+
+    // Repeat small transforms so each trial is long enough to time.
+    const size_t repeats = std::max< size_t >( 1, 65536/FFTSize );
+    const int trials = 5;
+    double fastest = std::numeric_limits< double >::max();
+    for( int trial = 0; trial < trials; ++trial )
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( size_t repeat = 0; repeat < repeats; ++repeat )
+        {
+            forward_transform( config, signal.data(), spectrum.data(), scratch.data() );
+            inverse_transform( config, spectrum.data(), signal.data(), scratch.data() );
+        }
+        const std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+        fastest = std::min( fastest, elapsed.count() );
+    }
+
+    ippsFree( config.FFTSpecBuffer );
+    return fastest;
+}
+
+} // namespace
+
+size_t get_fast_FFT_size( size_t minimum_size )
+///
+/// Finds the smallest FFT length, no shorter than a given length, whose only prime factors
+/// are 2, 3 and 5. These lengths run on mixed radix kernels, so zero padding a frame to
+/// this length is usually much cheaper than padding to the next power of 2,
+/// e.g. 3000 is already fast whereas the next power of 2 is 4096.
+///
+/// @param minimum_size
+///  The length of the signal to be transformed.
+///
+/// @return
+///  A length of at least minimum_size that transforms efficiently.
+///
+{
+    for( size_t size = std::max< size_t >( minimum_size, 1 ); ; ++size )
+    {
+        size_t remainder = size;
+        while( remainder % 2==0 ) remainder /= 2;
+        while( remainder % 3==0 ) remainder /= 3;
+        while( remainder % 5==0 ) remainder /= 5;
+        if( remainder==1 )
+        {
+            return size;
+        }
+    }
+}
+
+FFTAlgorithm plan_FFT_algorithm( size_t FFTSize, FFTPlanning planning )
+///
+/// Chooses the transform to use for an FFT of a given length.
+///
+/// When estimating, power of 2 lengths use IPP's FFT with the IPP backend and the native
+/// FFT with the SIMD backend, and all other lengths use IPP's DFT.
+///
+/// @param FFTSize
+///  The length of the FFT. Any positive length is supported.
+///
+/// @param planning
+///  Whether to choose from the length alone, or by timing each algorithm that supports it.
+///  Measuring takes a few transforms' worth of time, so is best done once at startup.
+///
+/// @return
+///  The algorithm to pass through to make_FFT.
+///
+{
+    if( !is_power_of_2( FFTSize ) )
+    {
+        return FFTAlgorithm::dft;
+    }
+    if( FFTSize < 2 )
+    {
+        return FFTAlgorithm::radix_2;
+    }
+    if( planning==FFTPlanning::estimate )
+    {
+#if defined( VECLIB_BACKEND_SIMD )
+        return FFTAlgorithm::native;
+#else
+        return FFTAlgorithm::radix_2;
+#endif
+    }
+
+    const FFTAlgorithm candidates[] = { FFTAlgorithm::radix_2, FFTAlgorithm::dft, FFTAlgorithm::native };
+    FFTAlgorithm fastest = candidates[0];
+    double fastest_time = std::numeric_limits< double >::max();
+    for( FFTAlgorithm candidate : candidates )
+    {
+        const double time = time_FFT_algorithm( FFTSize, candidate );
+        if( time < fastest_time )
+        {
+            fastest = candidate;
+            fastest_time = time;
+        }
+    }
+    return fastest;
+}
+
+void make_FFT( size_t FFTSize, FFTConfig& config, FFTPlanning planning )
+///
+/// Function for initialising an FFT object to be later used as an FFT configuration.
+///
+/// @param FFTSize
+///  The length of the FFT output. Any positive length is supported, though lengths from
+///  get_fast_FFT_size() are the most efficient.
+///
+/// @param FFTConfig
+///  An uninitialised FFTConfig object that will be filled out by this function.
+///
+/// @param planning
+///  How the FFT algorithm is chosen, see plan_FFT_algorithm().
+///
+{
+    make_FFT( FFTSize, plan_FFT_algorithm( FFTSize, planning ), config );
+}
+
+void make_FFT( size_t FFTSize, FFTAlgorithm algorithm, FFTConfig& config )
+///
+/// Initialises an FFT configuration that uses a given algorithm, e.g. to compare the
+/// native FFT against IPP.
+///
+/// @param FFTSize
+///  The length of the FFT output. Must be a power of 2 for FFTAlgorithm::radix_2 and
+///  FFTAlgorithm::native.
+///
+/// @param algorithm
+///  The transform to use.
+///
+/// @param FFTConfig
+///  An uninitialised FFTConfig object that will be filled out by this function.
+///
+{
+    init_FFT_spec( FFTSize, algorithm, IPP_FFT_DIV_INV_BY_N, config );
+
+    if( config.FFTWorkingBufferSize )
+        config.FFTWorkingBuffer = ippsMalloc_8u( static_cast< int >( config.FFTWorkingBufferSize ) );
     else
         config.FFTWorkingBuffer = NULL;
-    
-    // Initialise the FFT specification structures.
-    err = ippsFFTInit_R_32f( &(config.FFTSpec),
-                            static_cast< int >( config.FFTSizeLog2 ),
-                            IPP_FFT_DIV_INV_BY_N,
-                            ippAlgHintNone,
-                            config.FFTSpecBuffer,
-                            init_buffer );
-    
-    // Free memory used for initialisation
-    ippsFree( init_buffer );
-    
-    // Check for errors
-    assert( err==ippStsNoErr ); // Error initialising FFT specification.
-    
+
+    if( VECLIB_UNLIKELY( config.FFTWorkingBufferSize && config.FFTWorkingBuffer==NULL ) )
+    {
+        report_error( ErrorCode::allocation_failed, 0, "make_FFT", "Failed to allocate FFT working buffer." );
+    }
 }
 
 void destroy_FFT( FFTConfig& config )
@@ -101,11 +615,15 @@ void destroy_FFT( FFTConfig& config )
 ///
 {
     
-    /// @todo [matthew.mccallum 05.25.17] We may need to free the config.FFTSpec memory here
-    ///                                   although the function to do this seems to have
-    ///                                   disappeared somewhere between IPP 6.1.1 and IPP 8.2...
+    // Since IPP 7 ippsFFTInit_R_32f builds the specification inside FFTSpecBuffer (which is
+    // why ippsFFTFree_R_32f was removed), so freeing the buffer releases the spec too.
+    // The same holds for DFTSpec and the native FFT's twiddle table.
     ippsFree( config.FFTSpecBuffer );
     ippsFree( config.FFTWorkingBuffer );
+    config.FFTSpec = NULL;
+    config.DFTSpec = NULL;
+    config.FFTSpecBuffer = NULL;
+    config.FFTWorkingBuffer = NULL;
     
 }
 
@@ -114,8 +632,8 @@ void FFT_not_in_place( const float* input, std::complex< float >* output, FFTCon
 /// Performs an FFT from an input vector to an output. The length of the input FFT is
 /// assumed equal to the length of the FFT output (specified in FFTConfig), and so any
 /// zero padding on the input must be performed before this function call.
-/// The output vector will be of length config.FFTSize/2 + 1, where the first and last
-/// values of the output array are real values corresponding to DC and Nyquist respectively.
+/// The output vector will be of length config.FFTSize/2 + 1, where the first value is the
+/// real DC value and, for even FFTSize, the last is the real Nyquist value.
 /// This operation cannot be formed in place.
 ///
 /// @param input
@@ -129,20 +647,26 @@ void FFT_not_in_place( const float* input, std::complex< float >* output, FFTCon
 ///  for the FFT operation.
 ///
 {
+    VECLIB_PROBE( FFT_not_in_place, config.FFTSize );
+    
+    if( !has_FFT_spec( config, "FFT_not_in_place" ) || !has_working_buffer( config, "FFT_not_in_place" ) )
+    {
+        return;
+    }
     
-    IppStatus err = ippsFFTFwd_RToCCS_32f( input, reinterpret_cast< Ipp32f* >( output ), config.FFTSpec, config.FFTWorkingBuffer );
+    IppStatus err = forward_transform( config, input, output, config.FFTWorkingBuffer );
     
-    assert( err==ippStsNoErr ); // Error in forward FFT operation
+    check_ipp_status( err, "FFT_not_in_place" );
 
 }
 
 void IFFT_not_in_place( const std::complex< float >* input, float* output, FFTConfig& config )
 ///
 /// Perform the inverse FFT operation on a contiguous set of complex values. The length of this FFT
-/// is specified in config and should be twice the (complex) length of the input minus 2. It is expected
+/// is specified in config and the input should have config.FFTSize/2 + 1 complex values. It is expected
 /// that there will be the correct number of elements in input.
 /// The output should be of the FFTSize length specified in config.
-/// The first and last values in the input should be purely real and correspond to DC and Nyquist respectively.
+/// The first value in the input should be purely real (DC), as should the last for even FFTSize (Nyquist).
 ///
 /// @param input
 ///  A pointer to the first element in a contiguous input signal vector.
@@ -155,87 +679,1957 @@ void IFFT_not_in_place( const std::complex< float >* input, float* output, FFTCo
 ///  for the IFFT operation.
 ///
 {
+    VECLIB_PROBE( IFFT_not_in_place, config.FFTSize );
     
-    IppStatus err = ippsFFTInv_CCSToR_32f( reinterpret_cast< const Ipp32f* >( input ), output, config.FFTSpec, config.FFTWorkingBuffer );
+    if( !has_FFT_spec( config, "IFFT_not_in_place" ) || !has_working_buffer( config, "IFFT_not_in_place" ) )
+    {
+        return;
+    }
     
-    assert( err==ippStsNoErr ); // Error in inverse FFT operation.
+    IppStatus err = inverse_transform( config, input, output, config.FFTWorkingBuffer );
     
-}
+    check_ipp_status( err, "IFFT_not_in_place" );
     
-void spectral_magnitude( const std::complex< float >* input, float* output, size_t length )
+}
+
+void FFT_not_in_place( const float* input, std::complex< float >* output, const FFTConfig& config, FFTScratch& scratch )
 ///
-/// Computes the magnitude of all complex values in a given vector.
+/// As FFT_not_in_place above, but using caller supplied scratch memory instead of the
+/// config's working buffer. Any number of threads may use the same config at once, as long
+/// as each has its own scratch, e.g. thread_FFT_scratch().
 ///
 /// @param input
-///  A pointer to the first element of the complex vector to get the magnitude of.
+///  A pointer to the first element in a contiguous input signal vector.
 ///
-/// @param ouput
-///  A pointer to a vector of half the memory size of input (same number of elements),
-///  in which to place the magnitude of each value in input.
+/// @param output
+///  The pointer to the first element in a contiguous output signal vector.
 ///
-/// @param length
-///  The number of elements in input and output.
+/// @param config
+///  The FFT configuration specifying the FFT length.
+///
+/// @param scratch
+///  Working memory for this call. Grown to config.FFTWorkingBufferSize if it is smaller.
 ///
 {
+    VECLIB_PROBE( FFT_not_in_place, config.FFTSize );
+    
+    if( !has_FFT_spec( config, "FFT_not_in_place" ) || !scratch.reserve( config.FFTWorkingBufferSize ) )
+    {
+        return;
+    }
     
-    IppStatus err =  ippsMagnitude_32fc( reinterpret_cast< const Ipp32fc* >( input ),
-                                         static_cast< Ipp32f* >( output ),
-                                         static_cast< int >( length ) );
+    IppStatus err = forward_transform( config, input, output, scratch.data() );
     
-    assert( err==ippStsNoErr ); // Error calculating magnitude
+    check_ipp_status( err, "FFT_not_in_place" );
     
 }
-    
-void phase_spectra( const std::complex< float >* input, float* output, size_t length )
+
+void IFFT_not_in_place( const std::complex< float >* input, float* output, const FFTConfig& config, FFTScratch& scratch )
 ///
-/// Get the argument of all complex values in the input vector. These values will
-/// be in the range (-pi,pi].
+/// As IFFT_not_in_place above, but using caller supplied scratch memory instead of the
+/// config's working buffer. Any number of threads may use the same config at once, as long
+/// as each has its own scratch, e.g. thread_FFT_scratch().
 ///
 /// @param input
-///  A pointer to the first complex valued element to get the argument of.
+///  A pointer to the first element in a contiguous input signal vector.
 ///
 /// @param output
-///  A pointer to the first element in the output (half the size of the input vector).
+///  The pointer to the first element in a contiguous output signal vector.
 ///
-/// @param length
-///  The number of elements in input and output.
+/// @param config
+///  The IFFT configuration specifying the IFFT length.
+///
+/// @param scratch
+///  Working memory for this call. Grown to config.FFTWorkingBufferSize if it is smaller.
 ///
 {
+    VECLIB_PROBE( IFFT_not_in_place, config.FFTSize );
+    
+    if( !has_FFT_spec( config, "IFFT_not_in_place" ) || !scratch.reserve( config.FFTWorkingBufferSize ) )
+    {
+        return;
+    }
     
-    IppStatus err = ippsPhase_32fc( reinterpret_cast< const Ipp32fc* >( input ),
-                                    static_cast< Ipp32f* >( output ),
-                                    static_cast< int >( length ) );
+    IppStatus err = inverse_transform( config, input, output, scratch.data() );
     
-    assert( err==ippStsNoErr ); // Error calculating phase
+    check_ipp_status( err, "IFFT_not_in_place" );
     
 }
-    
-void cart_to_polar( const std::complex< float >* input, float* magnitude, float* phase, size_t length )
+
+namespace
+{
+
+void forward_FFT_batch( const FFTConfig& config,
+                        const float* input, size_t input_stride, size_t input_distance,
+                        std::complex< float >* output, size_t output_stride, size_t output_distance,
+                        size_t frames, FFTScratch& scratch )
 ///
-/// Get the magnitude and arguments of all elements in the input vector.
+/// Runs a forward FFT over a batch of frames. Strided frames are gathered into, and
+/// scattered out of, contiguous staging buffers that share the scratch allocation with the
+/// IPP working buffer, so the whole batch needs at most one allocation.
+///
+{
+    const size_t FFTSize = config.FFTSize;
+    const size_t output_size = config.FFTOutputSize;
+    const size_t staging_in_offset = align_up( config.FFTWorkingBufferSize );
+    const size_t staging_out_offset = staging_in_offset + align_up( FFTSize*sizeof( float ) );
+    if( !has_FFT_spec( config, "FFT_batch" ) || !scratch.reserve( staging_out_offset + output_size*sizeof( std::complex< float > ) ) )
+    {
+        return;
+    }
+
+    Ipp8u* working_buffer = scratch.data();
+    float* staging_in = reinterpret_cast< float* >( scratch.data() + staging_in_offset );
+    std::complex< float >* staging_out = reinterpret_cast< std::complex< float >* >( scratch.data() + staging_out_offset );
+
+    IppStatus status = ippStsNoErr;
+    for( size_t frame = 0; frame < frames; ++frame )
+    {
+        const float* frame_in = input + frame*input_distance;
+        std::complex< float >* frame_out = output + frame*output_distance;
+
+        const float* src = frame_in;
+        if( input_stride != 1 )
+        {
+            for( size_t n = 0; n < FFTSize; ++n )
+            {
+                staging_in[n] = frame_in[n*input_stride];
+            }
+            src = staging_in;
+        }
+        std::complex< float >* dst = ( output_stride == 1 ) ? frame_out : staging_out;
+
+        IppStatus err = forward_transform( config, src, dst, working_buffer );
+        status = ( status<ippStsNoErr ) ? status : err;
+
+        if( output_stride != 1 )
+        {
+            for( size_t k = 0; k < output_size; ++k )
+            {
+                frame_out[k*output_stride] = staging_out[k];
+            }
+        }
+    }
+
+    check_ipp_status( status, "FFT_batch" );
+}
+
+void inverse_FFT_batch( const FFTConfig& config,
+                        const std::complex< float >* input, size_t input_stride, size_t input_distance,
+                        float* output, size_t output_stride, size_t output_distance,
+                        size_t frames, FFTScratch& scratch )
+///
+/// Runs an inverse FFT over a batch of frames. See forward_FFT_batch.
+///
+{
+    const size_t FFTSize = config.FFTSize;
+    const size_t output_size = config.FFTOutputSize;
+    const size_t staging_in_offset = align_up( config.FFTWorkingBufferSize );
+    const size_t staging_out_offset = staging_in_offset + align_up( output_size*sizeof( std::complex< float > ) );
+    if( !has_FFT_spec( config, "IFFT_batch" ) || !scratch.reserve( staging_out_offset + FFTSize*sizeof( float ) ) )
+    {
+        return;
+    }
+
+    Ipp8u* working_buffer = scratch.data();
+    std::complex< float >* staging_in = reinterpret_cast< std::complex< float >* >( scratch.data() + staging_in_offset );
+    float* staging_out = reinterpret_cast< float* >( scratch.data() + staging_out_offset );
+
+    IppStatus status = ippStsNoErr;
+    for( size_t frame = 0; frame < frames; ++frame )
+    {
+        const std::complex< float >* frame_in = input + frame*input_distance;
+        float* frame_out = output + frame*output_distance;
+
+        const std::complex< float >* src = frame_in;
+        if( input_stride != 1 )
+        {
+            for( size_t k = 0; k < output_size; ++k )
+            {
+                staging_in[k] = frame_in[k*input_stride];
+            }
+            src = staging_in;
+        }
+        float* dst = ( output_stride == 1 ) ? frame_out : staging_out;
+
+        IppStatus err = inverse_transform( config, src, dst, working_buffer );
+        status = ( status<ippStsNoErr ) ? status : err;
+
+        if( output_stride != 1 )
+        {
+            for( size_t n = 0; n < FFTSize; ++n )
+            {
+                frame_out[n*output_stride] = staging_out[n];
+            }
+        }
+    }
+
+    check_ipp_status( status, "IFFT_batch" );
+}
+
+IppStatus deinterleave_spectrum( const std::complex< float >* input, float* real, float* imag, size_t length )
+{
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().deinterleave_complex( input, real, imag, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsCplxToReal_32fc( reinterpret_cast< const Ipp32fc* >( input + offset ),
+                                             static_cast< Ipp32f* >( real + offset ),
+                                             static_cast< Ipp32f* >( imag + offset ),
+                                             ipp_chunk_length( length, offset ) );
+        if( err != ippStsNoErr )
+        {
+            return err;
+        }
+    }
+#endif
+    return ippStsNoErr;
+}
+
+IppStatus interleave_spectrum( const float* real, const float* imag, std::complex< float >* output, size_t length )
+{
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().interleave_complex( real, imag, output, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsRealToCplx_32f( static_cast< const Ipp32f* >( real + offset ),
+                                            static_cast< const Ipp32f* >( imag + offset ),
+                                            reinterpret_cast< Ipp32fc* >( output + offset ),
+                                            ipp_chunk_length( length, offset ) );
+        if( err != ippStsNoErr )
+        {
+            return err;
+        }
+    }
+#endif
+    return ippStsNoErr;
+}
+
+IppStatus forward_transform_split( const FFTConfig& config, const float* input, float* output_real, float* output_imag, Ipp8u* scratch )
+///
+/// Runs a forward FFT into split arrays, with scratch of at least config.FFTWorkingBufferSize bytes.
+///
+{
+    if( config.Algorithm==FFTAlgorithm::native )
+    {
+        const float* table = reinterpret_cast< const float* >( config.FFTSpecBuffer );
+        float* working_floats = reinterpret_cast< float* >( scratch );
+#if defined( VECLIB_BACKEND_SIMD )
+        simd::kernels().real_FFT_forward_split( config.FFTSize, table, input, output_real, output_imag, working_floats );
+#else
+        simd::real_FFT_forward_split< simd::NativeISA >( config.FFTSize, table, input, output_real, output_imag, working_floats );
+#endif
+        return ippStsNoErr;
+    }
+
+    // The staging buffer is still in cache when it is split.
+    std::complex< float >* staging = reinterpret_cast< std::complex< float >* >( scratch + config.FFTWorkingBufferSize - split_staging_size( config ) );
+    IppStatus err = forward_transform( config, input, staging, scratch );
+    if( err != ippStsNoErr )
+    {
+        return err;
+    }
+    return deinterleave_spectrum( staging, output_real, output_imag, config.FFTOutputSize );
+}
+
+IppStatus inverse_transform_split( const FFTConfig& config, const float* input_real, const float* input_imag, float* output, Ipp8u* scratch )
+///
+/// Runs an inverse FFT from split arrays, with scratch of at least config.FFTWorkingBufferSize bytes.
+///
+{
+    if( config.Algorithm==FFTAlgorithm::native )
+    {
+        const float* table = reinterpret_cast< const float* >( config.FFTSpecBuffer );
+        float* working_floats = reinterpret_cast< float* >( scratch );
+#if defined( VECLIB_BACKEND_SIMD )
+        simd::kernels().real_FFT_inverse_split( config.FFTSize, table, input_real, input_imag, output, working_floats );
+#else
+        simd::real_FFT_inverse_split< simd::NativeISA >( config.FFTSize, table, input_real, input_imag, output, working_floats );
+#endif
+        return ippStsNoErr;
+    }
+
+    std::complex< float >* staging = reinterpret_cast< std::complex< float >* >( scratch + config.FFTWorkingBufferSize - split_staging_size( config ) );
+    IppStatus err = interleave_spectrum( input_real, input_imag, staging, config.FFTOutputSize );
+    if( err != ippStsNoErr )
+    {
+        return err;
+    }
+    return inverse_transform( config, staging, output, scratch );
+}
+
+} // namespace
+
+void FFT_batch( const float* input, size_t input_stride, size_t input_distance,
+                std::complex< float >* output, size_t output_stride, size_t output_distance,
+                size_t frames, const FFTConfig& config, FFTScratch& scratch )
+///
+/// Performs forward FFTs of a batch of equally sized frames with one call. Each frame is
+/// still transformed on its own, so packed frames run no faster than calling
+/// FFT_not_in_place per frame with the same scratch; the batch gathers strided frames, e.g.
+/// interleaved channels, without a copy loop in the caller.
 ///
 /// @param input
-///  A pointer to the first element in a vector of complex elements of which to get the magnitude
-///  and phase of each.
+///  A pointer to the first sample of the first frame.
 ///
-/// @param magnitude
-///  A pointer to the location of the output vector for the magnitude of each element in input.
+/// @param input_stride
+///  The number of floats between consecutive samples of a frame. 1 for contiguous frames,
+///  the channel count for interleaved channels.
 ///
-/// @param phase
-///  A pointer to the location of the output vector for the phase of each element in input.
+/// @param input_distance
+///  The number of floats between the first samples of consecutive frames.
 ///
-/// @param length
-///  The number of elements in input, magnitude and phase.
+/// @param output
+///  A pointer to the first output value of the first frame. Each frame produces
+///  config.FFTOutputSize complex values, laid out as for FFT_not_in_place.
+///
+/// @param output_stride
+///  The number of complex values between consecutive outputs of a frame.
+///
+/// @param output_distance
+///  The number of complex values between the first outputs of consecutive frames.
+///
+/// @param frames
+///  The number of frames to transform.
+///
+/// @param config
+///  The FFT configuration specifying the FFT length.
+///
+/// @param scratch
+///  Working memory for this call, not in use by any other thread.
 ///
 {
+    VECLIB_PROBE( FFT_batch, config.FFTSize*frames );
+    forward_FFT_batch( config,
+                       input, input_stride, input_distance,
+                       output, output_stride, output_distance,
+                       frames, scratch );
+}
 
-    IppStatus err = ippsCartToPolar_32fc( reinterpret_cast< const Ipp32fc* >( input ),
-                                          static_cast< Ipp32f* >( magnitude ),
-                                          static_cast< Ipp32f* >( phase ),
-                                          static_cast< int >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error converting coordinates
+void IFFT_batch( const std::complex< float >* input, size_t input_stride, size_t input_distance,
+                 float* output, size_t output_stride, size_t output_distance,
+                 size_t frames, const FFTConfig& config, FFTScratch& scratch )
+///
+/// Performs inverse FFTs of a batch of equally sized frames with one call.
+///
+/// @param input
+///  A pointer to the first complex value of the first frame. Each frame has
+///  config.FFTOutputSize values, laid out as for IFFT_not_in_place.
+///
+/// @param input_stride
+///  The number of complex values between consecutive values of a frame.
+///
+/// @param input_distance
+///  The number of complex values between the first values of consecutive frames.
+///
+/// @param output
+///  A pointer to the first sample of the first output frame.
+///
+/// @param output_stride
+///  The number of floats between consecutive samples of an output frame.
+///
+/// @param output_distance
+///  The number of floats between the first samples of consecutive output frames.
+///
+/// @param frames
+///  The number of frames to transform.
+///
+/// @param config
+///  The IFFT configuration specifying the IFFT length.
+///
+/// @param scratch
+///  Working memory for this call, not in use by any other thread.
+///
+{
+    VECLIB_PROBE( IFFT_batch, config.FFTSize*frames );
+    inverse_FFT_batch( config,
+                       input, input_stride, input_distance,
+                       output, output_stride, output_distance,
+                       frames, scratch );
+}
+
+void FFT_not_in_place( const float* input, float* output_real, float* output_imag, FFTConfig& config )
+///
+/// As FFT_not_in_place above, with the spectrum split into separate arrays of real and
+/// imaginary parts.
+///
+/// @param input
+///  A pointer to the first element in a contiguous input signal vector.
+///
+/// @param output_real
+///  A pointer to config.FFTSize/2 + 1 floats for the real part of each bin.
+///
+/// @param output_imag
+///  A pointer to config.FFTSize/2 + 1 floats for the imaginary part of each bin.
+///
+/// @param config
+///  The FFT configuration specifying the FFT length.
+///
+{
+    VECLIB_PROBE( FFT_not_in_place, config.FFTSize );
+
+    if( !has_FFT_spec( config, "FFT_not_in_place" ) || !has_working_buffer( config, "FFT_not_in_place" ) )
+    {
+        return;
+    }
+
+    IppStatus err = forward_transform_split( config, input, output_real, output_imag, config.FFTWorkingBuffer );
+
+    check_ipp_status( err, "FFT_not_in_place" );
+}
+
+void IFFT_not_in_place( const float* input_real, const float* input_imag, float* output, FFTConfig& config )
+///
+/// As IFFT_not_in_place above, from a spectrum split into separate arrays of real and
+/// imaginary parts.
+///
+/// @param input_real
+///  A pointer to config.FFTSize/2 + 1 floats, the real part of each bin.
+///
+/// @param input_imag
+///  A pointer to config.FFTSize/2 + 1 floats, the imaginary part of each bin. Those of DC
+///  and, for even FFTSize, Nyquist should be zero.
+///
+/// @param output
+///  The pointer to the first element in a contiguous output signal vector.
+///
+/// @param config
+///  The IFFT configuration specifying the IFFT length.
+///
+{
+    VECLIB_PROBE( IFFT_not_in_place, config.FFTSize );
+
+    if( !has_FFT_spec( config, "IFFT_not_in_place" ) || !has_working_buffer( config, "IFFT_not_in_place" ) )
+    {
+        return;
+    }
+
+    IppStatus err = inverse_transform_split( config, input_real, input_imag, output, config.FFTWorkingBuffer );
+
+    check_ipp_status( err, "IFFT_not_in_place" );
+}
+
+void FFT_not_in_place( const float* input, float* output_real, float* output_imag, const FFTConfig& config, FFTScratch& scratch )
+///
+/// As FFT_not_in_place above, with the spectrum split into separate arrays of real and
+/// imaginary parts, so that later spectral processing needs no shuffles. The native FFT
+/// writes the split arrays directly; IPP's transforms write the interleaved spectrum to
+/// scratch, which is then split while still in cache.
+///
+/// @param input
+///  A pointer to the first element in a contiguous input signal vector.
+///
+/// @param output_real
+///  A pointer to config.FFTSize/2 + 1 floats for the real part of each bin.
+///
+/// @param output_imag
+///  A pointer to config.FFTSize/2 + 1 floats for the imaginary part of each bin.
+///
+/// @param config
+///  The FFT configuration specifying the FFT length.
+///
+/// @param scratch
+///  Working memory for this call. Grown to config.FFTWorkingBufferSize if it is smaller.
+///
+{
+    VECLIB_PROBE( FFT_not_in_place, config.FFTSize );
+
+    if( !has_FFT_spec( config, "FFT_not_in_place" ) || !scratch.reserve( config.FFTWorkingBufferSize ) )
+    {
+        return;
+    }
+
+    IppStatus err = forward_transform_split( config, input, output_real, output_imag, scratch.data() );
+
+    check_ipp_status( err, "FFT_not_in_place" );
+}
+
+void IFFT_not_in_place( const float* input_real, const float* input_imag, float* output, const FFTConfig& config, FFTScratch& scratch )
+///
+/// As IFFT_not_in_place above, from a spectrum split into separate arrays of real and
+/// imaginary parts.
+///
+/// @param input_real
+///  A pointer to config.FFTSize/2 + 1 floats, the real part of each bin.
+///
+/// @param input_imag
+///  A pointer to config.FFTSize/2 + 1 floats, the imaginary part of each bin.
+///
+/// @param output
+///  The pointer to the first element in a contiguous output signal vector.
+///
+/// @param config
+///  The IFFT configuration specifying the IFFT length.
+///
+/// @param scratch
+///  Working memory for this call. Grown to config.FFTWorkingBufferSize if it is smaller.
+///
+{
+    VECLIB_PROBE( IFFT_not_in_place, config.FFTSize );
+
+    if( !has_FFT_spec( config, "IFFT_not_in_place" ) || !scratch.reserve( config.FFTWorkingBufferSize ) )
+    {
+        return;
+    }
+
+    IppStatus err = inverse_transform_split( config, input_real, input_imag, output, scratch.data() );
+
+    check_ipp_status( err, "IFFT_not_in_place" );
+}
+
+FFTScratch::FFTScratch() :
+    buffer( NULL ),
+    buffer_size( 0 )
+{
+}
+
+FFTScratch::FFTScratch( size_t bytes ) :
+    buffer( NULL ),
+    buffer_size( 0 )
+///
+/// Creates scratch memory of at least the given size.
+///
+/// @param bytes
+///  The number of bytes to allocate up front, e.g. FFTPlan::working_buffer_size().
+///
+{
+    reserve( bytes );
+}
+
+FFTScratch::FFTScratch( FFTScratch&& other ) :
+    buffer( other.buffer ),
+    buffer_size( other.buffer_size )
+{
+    other.buffer = NULL;
+    other.buffer_size = 0;
+}
+
+FFTScratch& FFTScratch::operator=( FFTScratch&& other )
+{
+    if( this != &other )
+    {
+        ippsFree( buffer );
+        buffer = other.buffer;
+        buffer_size = other.buffer_size;
+        other.buffer = NULL;
+        other.buffer_size = 0;
+    }
+    return *this;
+}
+
+FFTScratch::~FFTScratch()
+{
+    ippsFree( buffer );
+}
+
+bool FFTScratch::reserve( size_t bytes )
+///
+/// Grows the scratch memory to at least the given size. Contents are not preserved.
+/// Does nothing if it is already large enough, so after the first call for the largest
+/// FFT in use this never allocates.
+///
+/// @param bytes
+///  The minimum number of bytes required.
+///
+/// @return
+///  False if the allocation failed, in which case the scratch is left empty and the error
+///  is reported.
+///
+{
+    if( bytes <= buffer_size )
+    {
+        return true;
+    }
+    ippsFree( buffer );
+    buffer = bytes<=static_cast< size_t >( INT_MAX ) ? ippsMalloc_8u( static_cast< int >( bytes ) ) : NULL;
+    if( VECLIB_UNLIKELY( buffer==NULL ) )
+    {
+        buffer_size = 0;
+        report_error( ErrorCode::allocation_failed, 0, "FFTScratch::reserve", "Failed to allocate FFT scratch memory." );
+        return false;
+    }
+    buffer_size = bytes;
+    return true;
+}
+
+FFTScratch& thread_FFT_scratch()
+///
+/// Returns scratch memory private to the calling thread. It grows to the largest FFT the
+/// thread has run and is freed when the thread exits.
+///
+{
+    static thread_local FFTScratch scratch;
+    return scratch;
+}
     
+class FFTSpecification
+///
+/// An initialised FFT specification and the sizes needed to run it. Never
+/// modified after construction, so one instance can be shared by any number of plans and
+/// threads. config.FFTWorkingBuffer is always NULL; transforms use an FFTScratch.
+///
+/// The double precision specification is only built when a plan asks for it, so single
+/// precision users don't pay for it.
+///
+{
+public:
+
+    FFTSpecification( size_t FFTSize, FFTScaling scaling );
+
+    ~FFTSpecification();
+
+    const DoubleFFTConfig& double_config() const;
+
+    FFTConfig config;
+
+private:
+
+    int scaling_flag;
+    mutable std::once_flag double_once;
+    mutable DoubleFFTConfig double_spec;
+
+    FFTSpecification( const FFTSpecification& );
+
+    FFTSpecification& operator=( const FFTSpecification& );
+
+};
+
+namespace
+{
+
+int ipp_scaling_flag( FFTScaling scaling )
+{
+    switch( scaling )
+    {
+        case FFTScaling::forward_by_n:
+            return IPP_FFT_DIV_FWD_BY_N;
+        case FFTScaling::both_by_sqrt_n:
+            return IPP_FFT_DIV_BY_SQRTN;
+        case FFTScaling::none:
+            return IPP_FFT_NODIV_BY_ANY;
+        case FFTScaling::inverse_by_n:
+        default:
+            return IPP_FFT_DIV_INV_BY_N;
+    }
+}
+
+///
+/// Process wide cache of FFT specifications, keyed by size and scaling.
+///
+/// Specifications are kept until clear_FFT_plan_cache() is called; plans hold their own
+/// reference, so clearing never invalidates a live plan.
+///
+struct FFTPlanCache
+{
+    typedef std::pair< size_t, FFTScaling > Key;
+
+    FFTPlanCache() : hits( 0 ), misses( 0 ) {}
+
+    std::mutex lock;
+    std::map< Key, std::shared_ptr< const FFTSpecification > > specs;
+    std::atomic< size_t > hits;
+    std::atomic< size_t > misses;
+};
+
+FFTPlanCache& plan_cache()
+{
+    static FFTPlanCache cache;
+    return cache;
+}
+
+std::shared_ptr< const FFTSpecification > acquire_FFT_spec( size_t FFTSize, FFTScaling scaling )
+///
+/// Returns the cached specification for an FFT, creating it on first use.
+///
+{
+    FFTPlanCache& cache = plan_cache();
+    const FFTPlanCache::Key key( FFTSize, scaling );
+    {
+        std::lock_guard< std::mutex > guard( cache.lock );
+        auto found = cache.specs.find( key );
+        if( found != cache.specs.end() )
+        {
+            ++cache.hits;
+            return found->second;
+        }
+    }
+
+    // Initialise outside the lock so that a miss doesn't stall lookups of other sizes.
+    // If another thread beat us to it, keep theirs and drop ours; we still paid for the
+    // initialisation, so it counts as a miss either way.
+    std::shared_ptr< const FFTSpecification > spec = std::make_shared< FFTSpecification >( FFTSize, scaling );
+    ++cache.misses;
+
+    // A specification that failed to build (the error is already reported) goes only to this
+    // plan, so that the next plan of this size tries again.
+    if( !FFT_spec_built( spec->config ) )
+    {
+        return spec;
+    }
+    std::lock_guard< std::mutex > guard( cache.lock );
+    return cache.specs.insert( std::make_pair( key, spec ) ).first->second;
+}
+
+} // namespace
+
+FFTSpecification::FFTSpecification( size_t FFTSize, FFTScaling scaling )
+///
+/// Initialises the FFT specification for whichever algorithm plan_FFT_algorithm()
+/// estimates to be fastest.
+///
+/// @param FFTSize
+///  The length of the FFT. Any positive length is supported.
+///
+/// @param scaling
+///  Which direction of the transform is normalised.
+///
+{
+    scaling_flag = ipp_scaling_flag( scaling );
+    double_spec.FFTSpecBuffer = NULL;
+    init_FFT_spec( FFTSize, plan_FFT_algorithm( FFTSize ), scaling_flag, config );
+}
+
+FFTSpecification::~FFTSpecification()
+{
+    // The specifications live inside their FFTSpecBuffers.
+    ippsFree( config.FFTSpecBuffer );
+    ippsFree( double_spec.FFTSpecBuffer );
+}
+
+const DoubleFFTConfig& FFTSpecification::double_config() const
+///
+/// Returns the double precision specification, building it on first use.
+///
+{
+    std::call_once( double_once, [this]() { init_double_FFT_spec( config.FFTSize, scaling_flag, double_spec ); } );
+    return double_spec;
+}
+
+FFTPlan::FFTPlan( size_t FFTSize, FFTScaling scaling, FFTPrecision precision ) :
+    spec( acquire_FFT_spec( FFTSize, scaling ) )
+///
+/// Creates a plan for a real FFT of a given size.
+///
+/// @param FFTSize
+///  The length of the FFT. Any positive length is supported.
+///
+/// @param scaling
+///  Which direction of the transform is normalised. The default matches make_FFT.
+///
+/// @param precision
+///  Whether to also build the double precision specification now, rather than in the
+///  first double transform, e.g. before running double transforms from an audio callback.
+///
+{
+    if( precision==FFTPrecision::single_and_double )
+    {
+        spec->double_config();
+    }
+}
+
+FFTPlan::FFTPlan( FFTPlan&& other ) :
+    spec( std::move( other.spec ) )
+{
+}
+
+FFTPlan& FFTPlan::operator=( FFTPlan&& other )
+{
+    spec = std::move( other.spec );
+    return *this;
+}
+
+FFTPlan::~FFTPlan()
+{
+}
+
+void FFTPlan::forward( const float* input, std::complex< float >* output ) const
+///
+/// Performs the forward FFT, with the same layout as FFT_not_in_place, using the calling
+/// thread's scratch memory.
+///
+/// @param input
+///  A pointer to size() real samples.
+///
+/// @param output
+///  A pointer to output_size() complex values; DC and Nyquist are purely real.
+///
+{
+    forward( input, output, thread_FFT_scratch() );
+}
+
+void FFTPlan::inverse( const std::complex< float >* input, float* output ) const
+///
+/// Performs the inverse FFT, with the same layout as IFFT_not_in_place, using the calling
+/// thread's scratch memory.
+///
+/// @param input
+///  A pointer to output_size() complex values; DC and Nyquist must be purely real.
+///
+/// @param output
+///  A pointer to size() real samples.
+///
+{
+    inverse( input, output, thread_FFT_scratch() );
+}
+
+void FFTPlan::forward( const float* input, std::complex< float >* output, FFTScratch& scratch ) const
+///
+/// Performs the forward FFT using caller supplied scratch memory.
+///
+/// @param input
+///  A pointer to size() real samples.
+///
+/// @param output
+///  A pointer to output_size() complex values; DC and Nyquist are purely real.
+///
+/// @param scratch
+///  Working memory for this call, not in use by any other thread.
+///
+{
+    assert( spec ); // Plan has been moved from.
+
+    VECLIB_PROBE( FFTPlan_forward, spec->config.FFTSize );
+
+    if( !has_FFT_spec( spec->config, "FFTPlan::forward" ) || !scratch.reserve( spec->config.FFTWorkingBufferSize ) )
+    {
+        return;
+    }
+
+    IppStatus err = forward_transform( spec->config, input, output, scratch.data() );
+
+    check_ipp_status( err, "FFTPlan::forward" );
+}
+
+void FFTPlan::inverse( const std::complex< float >* input, float* output, FFTScratch& scratch ) const
+///
+/// Performs the inverse FFT using caller supplied scratch memory.
+///
+/// @param input
+///  A pointer to output_size() complex values; DC and Nyquist must be purely real.
+///
+/// @param output
+///  A pointer to size() real samples.
+///
+/// @param scratch
+///  Working memory for this call, not in use by any other thread.
+///
+{
+    assert( spec ); // Plan has been moved from.
+
+    VECLIB_PROBE( FFTPlan_inverse, spec->config.FFTSize );
+
+    if( !has_FFT_spec( spec->config, "FFTPlan::inverse" ) || !scratch.reserve( spec->config.FFTWorkingBufferSize ) )
+    {
+        return;
+    }
+
+    IppStatus err = inverse_transform( spec->config, input, output, scratch.data() );
+
+    check_ipp_status( err, "FFTPlan::inverse" );
+}
+
+void FFTPlan::forward_batch( const float* input, size_t input_stride, size_t input_distance,
+                             std::complex< float >* output, size_t output_stride, size_t output_distance,
+                             size_t frames, FFTScratch& scratch ) const
+///
+/// Performs forward FFTs of a batch of frames. See FFT_batch for the meaning of the arguments.
+///
+{
+    assert( spec ); // Plan has been moved from.
+
+    VECLIB_PROBE( FFTPlan_forward_batch, spec->config.FFTSize*frames );
+
+    forward_FFT_batch( spec->config,
+                       input, input_stride, input_distance,
+                       output, output_stride, output_distance,
+                       frames, scratch );
+}
+
+void FFTPlan::inverse_batch( const std::complex< float >* input, size_t input_stride, size_t input_distance,
+                             float* output, size_t output_stride, size_t output_distance,
+                             size_t frames, FFTScratch& scratch ) const
+///
+/// Performs inverse FFTs of a batch of frames. See IFFT_batch for the meaning of the arguments.
+///
+{
+    assert( spec ); // Plan has been moved from.
+
+    VECLIB_PROBE( FFTPlan_inverse_batch, spec->config.FFTSize*frames );
+
+    inverse_FFT_batch( spec->config,
+                       input, input_stride, input_distance,
+                       output, output_stride, output_distance,
+                       frames, scratch );
+}
+
+void FFTPlan::forward( const double* input, std::complex< double >* output ) const
+///
+/// Performs the forward FFT in double precision, using the calling thread's scratch memory.
+///
+/// @param input
+///  A pointer to size() real samples.
+///
+/// @param output
+///  A pointer to output_size() complex values; DC and Nyquist are purely real.
+///
+{
+    forward( input, output, thread_FFT_scratch() );
+}
+
+void FFTPlan::inverse( const std::complex< double >* input, double* output ) const
+///
+/// Performs the inverse FFT in double precision, using the calling thread's scratch memory.
+///
+/// @param input
+///  A pointer to output_size() complex values; DC and Nyquist must be purely real.
+///
+/// @param output
+///  A pointer to size() real samples.
+///
+{
+    inverse( input, output, thread_FFT_scratch() );
+}
+
+void FFTPlan::forward( const double* input, std::complex< double >* output, FFTScratch& scratch ) const
+///
+/// Performs the forward FFT in double precision using caller supplied scratch memory. The
+/// first double precision transform of each size initialises its specification, unless
+/// the plan was constructed with FFTPrecision::single_and_double.
+///
+/// @param input
+///  A pointer to size() real samples.
+///
+/// @param output
+///  A pointer to output_size() complex values; DC and Nyquist are purely real.
+///
+/// @param scratch
+///  Working memory for this call, not in use by any other thread.
+///
+{
+    assert( spec ); // Plan has been moved from.
+
+    VECLIB_PROBE( FFTPlan_forward, spec->config.FFTSize );
+
+    const DoubleFFTConfig& config = spec->double_config();
+    if( !has_FFT_spec( config, "FFTPlan::forward" ) || !scratch.reserve( config.FFTWorkingBufferSize ) )
+    {
+        return;
+    }
+
+    IppStatus err = forward_transform( config, input, output, scratch.data() );
+
+    check_ipp_status( err, "FFTPlan::forward" );
+}
+
+void FFTPlan::inverse( const std::complex< double >* input, double* output, FFTScratch& scratch ) const
+///
+/// Performs the inverse FFT in double precision using caller supplied scratch memory.
+///
+/// @param input
+///  A pointer to output_size() complex values; DC and Nyquist must be purely real.
+///
+/// @param output
+///  A pointer to size() real samples.
+///
+/// @param scratch
+///  Working memory for this call, not in use by any other thread.
+///
+{
+    assert( spec ); // Plan has been moved from.
+
+    VECLIB_PROBE( FFTPlan_inverse, spec->config.FFTSize );
+
+    const DoubleFFTConfig& config = spec->double_config();
+    if( !has_FFT_spec( config, "FFTPlan::inverse" ) || !scratch.reserve( config.FFTWorkingBufferSize ) )
+    {
+        return;
+    }
+
+    IppStatus err = inverse_transform( config, input, output, scratch.data() );
+
+    check_ipp_status( err, "FFTPlan::inverse" );
+}
+
+void FFTPlan::forward( const int16_t* input, float gain, std::complex< float >* output ) const
+///
+/// Performs the forward FFT of 16-bit integer samples, using the calling thread's scratch
+/// memory.
+///
+/// @param input
+///  A pointer to size() 16-bit samples.
+///
+/// @param gain
+///  Each sample is multiplied by this, e.g. 1.0f/32768.0f for full scale at 1.0.
+///
+/// @param output
+///  A pointer to output_size() complex values; DC and Nyquist are purely real.
+///
+{
+    forward( input, gain, output, thread_FFT_scratch() );
+}
+
+void FFTPlan::forward( const int16_t* input, float gain, std::complex< float >* output, FFTScratch& scratch ) const
+///
+/// Performs the forward FFT of 16-bit integer samples using caller supplied scratch memory.
+/// The samples are converted into the scratch memory, which stays in cache for the
+/// transform, rather than into a caller buffer in a separate pass.
+///
+/// @param input
+///  A pointer to size() 16-bit samples.
+///
+/// @param gain
+///  Each sample is multiplied by this, e.g. 1.0f/32768.0f for full scale at 1.0.
+///
+/// @param output
+///  A pointer to output_size() complex values; DC and Nyquist are purely real.
+///
+/// @param scratch
+///  Working memory for this call, not in use by any other thread.
+///
+{
+    assert( spec ); // Plan has been moved from.
+
+    VECLIB_PROBE( FFTPlan_forward, spec->config.FFTSize );
+
+    const FFTConfig& config = spec->config;
+    const size_t staging_offset = align_up( config.FFTWorkingBufferSize );
+    if( !has_FFT_spec( config, "FFTPlan::forward" ) || !scratch.reserve( staging_offset + config.FFTSize*sizeof( float ) ) )
+    {
+        return;
+    }
+    float* staging = reinterpret_cast< float* >( scratch.data() + staging_offset );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().vec_convert_from_s16( input, staging, gain, config.FFTSize );
+#else
+    simd::map_from_s16< simd::NativeISA >( input, staging, config.FFTSize, simd::MulConst< simd::NativeISA >( gain ) );
+#endif
+
+    IppStatus err = forward_transform( config, staging, output, scratch.data() );
+
+    check_ipp_status( err, "FFTPlan::forward" );
+}
+
+void FFTPlan::forward( const float* input, float* output_real, float* output_imag ) const
+///
+/// Performs the forward FFT into split real and imaginary arrays, using the calling
+/// thread's scratch memory.
+///
+/// @param input
+///  A pointer to size() real samples.
+///
+/// @param output_real
+///  A pointer to output_size() floats for the real part of each bin.
+///
+/// @param output_imag
+///  A pointer to output_size() floats for the imaginary part of each bin.
+///
+{
+    forward( input, output_real, output_imag, thread_FFT_scratch() );
+}
+
+void FFTPlan::inverse( const float* input_real, const float* input_imag, float* output ) const
+///
+/// Performs the inverse FFT from split real and imaginary arrays, using the calling
+/// thread's scratch memory.
+///
+/// @param input_real
+///  A pointer to output_size() floats, the real part of each bin.
+///
+/// @param input_imag
+///  A pointer to output_size() floats, the imaginary part of each bin.
+///
+/// @param output
+///  A pointer to size() real samples.
+///
+{
+    inverse( input_real, input_imag, output, thread_FFT_scratch() );
+}
+
+void FFTPlan::forward( const float* input, float* output_real, float* output_imag, FFTScratch& scratch ) const
+///
+/// Performs the forward FFT into split real and imaginary arrays using caller supplied
+/// scratch memory. See FFT_not_in_place.
+///
+/// @param input
+///  A pointer to size() real samples.
+///
+/// @param output_real
+///  A pointer to output_size() floats for the real part of each bin.
+///
+/// @param output_imag
+///  A pointer to output_size() floats for the imaginary part of each bin.
+///
+/// @param scratch
+///  Working memory for this call, not in use by any other thread.
+///
+{
+    assert( spec ); // Plan has been moved from.
+
+    VECLIB_PROBE( FFTPlan_forward, spec->config.FFTSize );
+
+    if( !has_FFT_spec( spec->config, "FFTPlan::forward" ) || !scratch.reserve( spec->config.FFTWorkingBufferSize ) )
+    {
+        return;
+    }
+
+    IppStatus err = forward_transform_split( spec->config, input, output_real, output_imag, scratch.data() );
+
+    check_ipp_status( err, "FFTPlan::forward" );
+}
+
+void FFTPlan::inverse( const float* input_real, const float* input_imag, float* output, FFTScratch& scratch ) const
+///
+/// Performs the inverse FFT from split real and imaginary arrays using caller supplied
+/// scratch memory.
+///
+/// @param input_real
+///  A pointer to output_size() floats, the real part of each bin.
+///
+/// @param input_imag
+///  A pointer to output_size() floats, the imaginary part of each bin.
+///
+/// @param output
+///  A pointer to size() real samples.
+///
+/// @param scratch
+///  Working memory for this call, not in use by any other thread.
+///
+{
+    assert( spec ); // Plan has been moved from.
+
+    VECLIB_PROBE( FFTPlan_inverse, spec->config.FFTSize );
+
+    if( !has_FFT_spec( spec->config, "FFTPlan::inverse" ) || !scratch.reserve( spec->config.FFTWorkingBufferSize ) )
+    {
+        return;
+    }
+
+    IppStatus err = inverse_transform_split( spec->config, input_real, input_imag, output, scratch.data() );
+
+    check_ipp_status( err, "FFTPlan::inverse" );
+}
+
+size_t FFTPlan::size() const
+{
+    return spec->config.FFTSize;
+}
+
+size_t FFTPlan::output_size() const
+{
+    return spec->config.FFTOutputSize;
+}
+
+size_t FFTPlan::working_buffer_size() const
+{
+    return spec->config.FFTWorkingBufferSize;
+}
+
+size_t FFTPlan::double_working_buffer_size() const
+///
+/// Returns the scratch memory, in bytes, needed by the double precision transforms. Builds
+/// the double precision specification if the plan hasn't already.
+///
+{
+    return spec->double_config().FFTWorkingBufferSize;
+}
+
+FFTPlanCacheStats get_FFT_plan_cache_stats()
+///
+/// Returns the plan cache hit and miss counts, e.g. to measure plan creation overhead at startup.
+///
+{
+    FFTPlanCache& cache = plan_cache();
+    FFTPlanCacheStats stats;
+    stats.hits = cache.hits.load();
+    stats.misses = cache.misses.load();
+    std::lock_guard< std::mutex > guard( cache.lock );
+    stats.entries = cache.specs.size();
+    return stats;
+}
+
+void reset_FFT_plan_cache_stats()
+///
+/// Zeroes the plan cache hit and miss counts.
+///
+{
+    plan_cache().hits = 0;
+    plan_cache().misses = 0;
+}
+
+void clear_FFT_plan_cache()
+///
+/// Releases the cache's references to all FFT specifications. Specifications still used
+/// by a live FFTPlan are freed when the last such plan is destroyed.
+///
+{
+    FFTPlanCache& cache = plan_cache();
+    std::lock_guard< std::mutex > guard( cache.lock );
+    cache.specs.clear();
+}
+    
+void spectral_magnitude( const std::complex< float >* input, float* output, size_t length )
+///
+/// Computes the magnitude of all complex values in a given vector.
+///
+/// @param input
+///  A pointer to the first element of the complex vector to get the magnitude of.
+///
+/// @param ouput
+///  A pointer to a vector of half the memory size of input (same number of elements),
+///  in which to place the magnitude of each value in input.
+///
+/// @param length
+///  The number of elements in input and output.
+///
+{
+    VECLIB_PROBE( spectral_magnitude, length );
+    
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_magnitude( input, output, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMagnitude_32fc( reinterpret_cast< const Ipp32fc* >( input + offset ),
+                                            static_cast< Ipp32f* >( output + offset ),
+                                            ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "spectral_magnitude" ) )
+        {
+            return;
+        }
+    }
+#endif
+    
+}
+    
+void phase_spectra( const std::complex< float >* input, float* output, size_t length )
+///
+/// Get the argument of all complex values in the input vector. These values will
+/// be in the range (-pi,pi].
+///
+/// @param input
+///  A pointer to the first complex valued element to get the argument of.
+///
+/// @param output
+///  A pointer to the first element in the output (half the size of the input vector).
+///
+/// @param length
+///  The number of elements in input and output.
+///
+{
+    
+    phase_spectra( input, output, length, SpectralAccuracy::full );
+    
+}
+
+void phase_spectra( const std::complex< float >* input, float* output, size_t length, SpectralAccuracy accuracy )
+///
+/// As phase_spectra above, at a given accuracy. See SpectralAccuracy for the maximum
+/// error at each level.
+///
+/// @param input
+///  A pointer to the first complex valued element to get the argument of.
+///
+/// @param output
+///  A pointer to the first element in the output (half the size of the input vector).
+///
+/// @param length
+///  The number of elements in input and output.
+///
+/// @param accuracy
+///  The accuracy of the result. Lower levels are faster.
+///
+{
+    VECLIB_PROBE( phase_spectra, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().phase_spectra( input, output, length, accuracy );
+#else
+    const float* floats = reinterpret_cast< const float* >( input );
+    switch( accuracy )
+    {
+        case SpectralAccuracy::medium:
+            simd::phase_spectra< simd::NativeISA, simd::MediumAtan2< simd::NativeISA > >( floats, output, length );
+            break;
+        case SpectralAccuracy::fast:
+            simd::phase_spectra< simd::NativeISA, simd::FastAtan2< simd::NativeISA > >( floats, output, length );
+            break;
+        case SpectralAccuracy::full:
+        default:
+        {
+            for( size_t offset = 0; offset < length; offset += max_ipp_length )
+            {
+                IppStatus err = ippsPhase_32fc( reinterpret_cast< const Ipp32fc* >( input + offset ),
+                                                static_cast< Ipp32f* >( output + offset ),
+                                                ipp_chunk_length( length, offset ) );
+                if( !check_ipp_status( err, "phase_spectra" ) )
+                {
+                    break;
+                }
+            }
+            break;
+        }
+    }
+#endif
+
+}
+    
+void cart_to_polar( const std::complex< float >* input, float* magnitude, float* phase, size_t length )
+///
+/// Get the magnitude and arguments of all elements in the input vector.
+///
+/// @param input
+///  A pointer to the first element in a vector of complex elements of which to get the magnitude
+///  and phase of each.
+///
+/// @param magnitude
+///  A pointer to the location of the output vector for the magnitude of each element in input.
+///
+/// @param phase
+///  A pointer to the location of the output vector for the phase of each element in input.
+///
+/// @param length
+///  The number of elements in input, magnitude and phase.
+///
+{
+
+    cart_to_polar( input, magnitude, phase, length, SpectralAccuracy::full );
+    
+}
+
+void cart_to_polar( const std::complex< float >* input, float* magnitude, float* phase, size_t length, SpectralAccuracy accuracy )
+///
+/// As cart_to_polar above, with the phase at a given accuracy. The magnitude is always
+/// computed with a hardware square root.
+///
+/// @param input
+///  A pointer to the first element in a vector of complex elements of which to get the magnitude
+///  and phase of each.
+///
+/// @param magnitude
+///  A pointer to the location of the output vector for the magnitude of each element in input.
+///
+/// @param phase
+///  A pointer to the location of the output vector for the phase of each element in input.
+///
+/// @param length
+///  The number of elements in input, magnitude and phase.
+///
+/// @param accuracy
+///  The accuracy of the phase. Lower levels are faster.
+///
+{
+    VECLIB_PROBE( cart_to_polar, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().cart_to_polar( input, magnitude, phase, length, accuracy );
+#else
+    const float* floats = reinterpret_cast< const float* >( input );
+    switch( accuracy )
+    {
+        case SpectralAccuracy::medium:
+            simd::cart_to_polar< simd::NativeISA, simd::MediumAtan2< simd::NativeISA > >( floats, magnitude, phase, length );
+            break;
+        case SpectralAccuracy::fast:
+            simd::cart_to_polar< simd::NativeISA, simd::FastAtan2< simd::NativeISA > >( floats, magnitude, phase, length );
+            break;
+        case SpectralAccuracy::full:
+        default:
+        {
+            for( size_t offset = 0; offset < length; offset += max_ipp_length )
+            {
+                IppStatus err = ippsCartToPolar_32fc( reinterpret_cast< const Ipp32fc* >( input + offset ),
+                                                      static_cast< Ipp32f* >( magnitude + offset ),
+                                                      static_cast< Ipp32f* >( phase + offset ),
+                                                      ipp_chunk_length( length, offset ) );
+                if( !check_ipp_status( err, "cart_to_polar" ) )
+                {
+                    break;
+                }
+            }
+            break;
+        }
+    }
+#endif
+
+}
+
+void spectral_magnitude( const float* real, const float* imag, float* output, size_t length )
+///
+/// As spectral_magnitude above, for complex values held as separate arrays of real and
+/// imaginary parts.
+///
+/// @param real
+///  A pointer to the real part of each complex value.
+///
+/// @param imag
+///  A pointer to the imaginary part of each complex value.
+///
+/// @param output
+///  A pointer to the location of the output vector for the magnitude of each value.
+///
+/// @param length
+///  The number of elements in real, imag and output.
+///
+{
+    VECLIB_PROBE( spectral_magnitude, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_magnitude_split( real, imag, output, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMagnitude_32f( static_cast< const Ipp32f* >( real + offset ),
+                                           static_cast< const Ipp32f* >( imag + offset ),
+                                           static_cast< Ipp32f* >( output + offset ),
+                                           ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "spectral_magnitude" ) )
+        {
+            return;
+        }
+    }
+#endif
+
+}
+
+void phase_spectra( const float* real, const float* imag, float* output, size_t length )
+///
+/// As phase_spectra above, for complex values held as separate arrays of real and
+/// imaginary parts.
+///
+{
+    phase_spectra( real, imag, output, length, SpectralAccuracy::full );
+}
+
+void phase_spectra( const float* real, const float* imag, float* output, size_t length, SpectralAccuracy accuracy )
+///
+/// As phase_spectra above, at a given accuracy, for complex values held as separate arrays
+/// of real and imaginary parts.
+///
+/// @param real
+///  A pointer to the real part of each complex value.
+///
+/// @param imag
+///  A pointer to the imaginary part of each complex value.
+///
+/// @param output
+///  A pointer to the location of the output vector for the argument of each value.
+///
+/// @param length
+///  The number of elements in real, imag and output.
+///
+/// @param accuracy
+///  The accuracy of the phase. Lower levels are faster.
+///
+{
+    VECLIB_PROBE( phase_spectra, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().phase_spectra_split( real, imag, output, length, accuracy );
+#else
+    switch( accuracy )
+    {
+        case SpectralAccuracy::medium:
+            simd::phase_spectra_split< simd::NativeISA, simd::MediumAtan2< simd::NativeISA > >( real, imag, output, length );
+            break;
+        case SpectralAccuracy::fast:
+            simd::phase_spectra_split< simd::NativeISA, simd::FastAtan2< simd::NativeISA > >( real, imag, output, length );
+            break;
+        case SpectralAccuracy::full:
+        default:
+        {
+            for( size_t offset = 0; offset < length; offset += max_ipp_length )
+            {
+                IppStatus err = ippsPhase_32f( static_cast< const Ipp32f* >( real + offset ),
+                                               static_cast< const Ipp32f* >( imag + offset ),
+                                               static_cast< Ipp32f* >( output + offset ),
+                                               ipp_chunk_length( length, offset ) );
+                if( !check_ipp_status( err, "phase_spectra" ) )
+                {
+                    break;
+                }
+            }
+            break;
+        }
+    }
+#endif
+
+}
+
+void cart_to_polar( const float* real, const float* imag, float* magnitude, float* phase, size_t length )
+///
+/// As cart_to_polar above, for complex values held as separate arrays of real and
+/// imaginary parts.
+///
+{
+    cart_to_polar( real, imag, magnitude, phase, length, SpectralAccuracy::full );
+}
+
+void cart_to_polar( const float* real, const float* imag, float* magnitude, float* phase, size_t length, SpectralAccuracy accuracy )
+///
+/// As cart_to_polar above, at a given accuracy, for complex values held as separate arrays
+/// of real and imaginary parts.
+///
+/// @param real
+///  A pointer to the real part of each complex value.
+///
+/// @param imag
+///  A pointer to the imaginary part of each complex value.
+///
+/// @param magnitude
+///  A pointer to the location of the output vector for the magnitude of each value.
+///
+/// @param phase
+///  A pointer to the location of the output vector for the phase of each value.
+///
+/// @param length
+///  The number of elements in real, imag, magnitude and phase.
+///
+/// @param accuracy
+///  The accuracy of the phase. Lower levels are faster.
+///
+{
+    VECLIB_PROBE( cart_to_polar, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().cart_to_polar_split( real, imag, magnitude, phase, length, accuracy );
+#else
+    switch( accuracy )
+    {
+        case SpectralAccuracy::medium:
+            simd::cart_to_polar_split< simd::NativeISA, simd::MediumAtan2< simd::NativeISA > >( real, imag, magnitude, phase, length );
+            break;
+        case SpectralAccuracy::fast:
+            simd::cart_to_polar_split< simd::NativeISA, simd::FastAtan2< simd::NativeISA > >( real, imag, magnitude, phase, length );
+            break;
+        case SpectralAccuracy::full:
+        default:
+        {
+            for( size_t offset = 0; offset < length; offset += max_ipp_length )
+            {
+                IppStatus err = ippsCartToPolar_32f( static_cast< const Ipp32f* >( real + offset ),
+                                                     static_cast< const Ipp32f* >( imag + offset ),
+                                                     static_cast< Ipp32f* >( magnitude + offset ),
+                                                     static_cast< Ipp32f* >( phase + offset ),
+                                                     ipp_chunk_length( length, offset ) );
+                if( !check_ipp_status( err, "cart_to_polar" ) )
+                {
+                    break;
+                }
+            }
+            break;
+        }
+    }
+#endif
+
+}
+
+void deinterleave_complex( const std::complex< float >* input, float* real, float* imag, size_t length )
+///
+/// Splits complex values into separate arrays of real and imaginary parts, to pass a
+/// spectrum from the interleaved layout to the split one.
+///
+/// @param input
+///  A pointer to the complex values.
+///
+/// @param real
+///  A pointer to the location of the output vector for the real parts.
+///
+/// @param imag
+///  A pointer to the location of the output vector for the imaginary parts.
+///
+/// @param length
+///  The number of elements in input, real and imag.
+///
+{
+    VECLIB_PROBE( deinterleave_complex, length );
+
+    IppStatus err = deinterleave_spectrum( input, real, imag, length );
+
+    check_ipp_status( err, "deinterleave_complex" );
+}
+
+void interleave_complex( const float* real, const float* imag, std::complex< float >* output, size_t length )
+///
+/// Merges separate arrays of real and imaginary parts into complex values, to pass a
+/// spectrum from the split layout to the interleaved one.
+///
+/// @param real
+///  A pointer to the real parts.
+///
+/// @param imag
+///  A pointer to the imaginary parts.
+///
+/// @param output
+///  A pointer to the location of the output vector of complex values.
+///
+/// @param length
+///  The number of elements in real, imag and output.
+///
+{
+    VECLIB_PROBE( interleave_complex, length );
+
+    IppStatus err = interleave_spectrum( real, imag, output, length );
+
+    check_ipp_status( err, "interleave_complex" );
+}
+
+void polar_to_cart( const float* magnitude, const float* phase, std::complex< float >* output, size_t length )
+///
+/// Forms complex values from their magnitudes and arguments, the inverse of cart_to_polar,
+/// e.g. to resynthesise a modified magnitude spectrum with its original phase.
+///
+/// @param magnitude
+///  A pointer to the magnitude of each output value.
+///
+/// @param phase
+///  A pointer to the argument of each output value, in radians. Need not be wrapped to
+///  (-pi,pi].
+///
+/// @param output
+///  A pointer to the location of the output vector of complex values.
+///
+/// @param length
+///  The number of elements in magnitude, phase and output.
+///
+{
+    VECLIB_PROBE( polar_to_cart, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().polar_to_cart( magnitude, phase, output, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsPolarToCart_32fc( static_cast< const Ipp32f* >( magnitude + offset ),
+                                              static_cast< const Ipp32f* >( phase + offset ),
+                                              reinterpret_cast< Ipp32fc* >( output + offset ),
+                                              ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "polar_to_cart" ) )
+        {
+            return;
+        }
+    }
+#endif
+
+}
+
+void spectral_mult( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* output, size_t length )
+///
+/// Multiplies two complex vectors element by element, e.g. to apply a filter's frequency
+/// response to a spectrum.
+///
+/// @param input1
+///  A pointer to the first complex vector to be multiplied.
+///
+/// @param input2
+///  A pointer to the second complex vector to be multiplied.
+///
+/// @param output
+///  A pointer to the location of the output vector for the products. May be equal to input1
+///  or input2.
+///
+/// @param length
+///  The number of elements in input1, input2 and output.
+///
+{
+    VECLIB_PROBE( spectral_mult, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_mult( input1, input2, output, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMul_32fc( reinterpret_cast< const Ipp32fc* >( input1 + offset ),
+                                      reinterpret_cast< const Ipp32fc* >( input2 + offset ),
+                                      reinterpret_cast< Ipp32fc* >( output + offset ),
+                                      ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "spectral_mult" ) )
+        {
+            return;
+        }
+    }
+#endif
+
+}
+
+void spectral_mult_in_place( const std::complex< float >* input1, std::complex< float >* input2_output, size_t length )
+///
+/// Multiplies one complex vector by another element by element, in place.
+///
+/// @param input1
+///  A pointer to the complex vector to multiply by.
+///
+/// @param input2_output
+///  A pointer to the complex vector to be multiplied, which is overwritten with the products.
+///
+/// @param length
+///  The number of elements in input1 and input2_output.
+///
+{
+    VECLIB_PROBE( spectral_mult_in_place, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_mult( input1, input2_output, input2_output, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMul_32fc_I( reinterpret_cast< const Ipp32fc* >( input1 + offset ),
+                                        reinterpret_cast< Ipp32fc* >( input2_output + offset ),
+                                        ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "spectral_mult_in_place" ) )
+        {
+            return;
+        }
+    }
+#endif
+
+}
+
+void spectral_mult_accumulate( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* accumulator, size_t length )
+///
+/// Multiplies two complex vectors element by element and adds the products to a third, in
+/// a single pass.
+///
+/// @param input1
+///  A pointer to the first complex vector to be multiplied.
+///
+/// @param input2
+///  A pointer to the second complex vector to be multiplied.
+///
+/// @param accumulator
+///  A pointer to the complex vector to which the products are added.
+///
+/// @param length
+///  The number of elements in input1, input2 and accumulator.
+///
+{
+    VECLIB_PROBE( spectral_mult_accumulate, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_mult_accumulate( input1, input2, accumulator, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsAddProduct_32fc( reinterpret_cast< const Ipp32fc* >( input1 + offset ),
+                                             reinterpret_cast< const Ipp32fc* >( input2 + offset ),
+                                             reinterpret_cast< Ipp32fc* >( accumulator + offset ),
+                                             ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "spectral_mult_accumulate" ) )
+        {
+            return;
+        }
+    }
+#endif
+
+}
+
+void spectral_conj_mult( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* output, size_t length )
+///
+/// Multiplies the complex conjugate of one vector by another, element by element, i.e.
+/// conj( input1 )*input2, as in a cross spectrum or a correlation.
+///
+/// @param input1
+///  A pointer to the complex vector to be conjugated.
+///
+/// @param input2
+///  A pointer to the complex vector to multiply by.
+///
+/// @param output
+///  A pointer to the location of the output vector for the products. May be equal to input1
+///  or input2.
+///
+/// @param length
+///  The number of elements in input1, input2 and output.
+///
+{
+    VECLIB_PROBE( spectral_conj_mult, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_conj_mult( input1, input2, output, length );
+#else
+    simd::map_complex_binary< simd::NativeISA, simd::ConjugateMul< simd::NativeISA >, false >( reinterpret_cast< const float* >( input1 ),
+                                                                                              reinterpret_cast< const float* >( input2 ),
+                                                                                              reinterpret_cast< float* >( output ), length );
+#endif
+
+}
+
+void spectral_conj_mult_in_place( const std::complex< float >* input1, std::complex< float >* input2_output, size_t length )
+///
+/// As spectral_conj_mult, overwriting input2_output with conj( input1 )*input2_output.
+///
+{
+    VECLIB_PROBE( spectral_conj_mult_in_place, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_conj_mult( input1, input2_output, input2_output, length );
+#else
+    simd::map_complex_binary< simd::NativeISA, simd::ConjugateMul< simd::NativeISA >, false >( reinterpret_cast< const float* >( input1 ),
+                                                                                              reinterpret_cast< const float* >( input2_output ),
+                                                                                              reinterpret_cast< float* >( input2_output ), length );
+#endif
+
+}
+
+void spectral_conj_mult_accumulate( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* accumulator, size_t length )
+///
+/// As spectral_conj_mult, adding conj( input1 )*input2 to accumulator in a single pass, e.g.
+/// to average a cross spectrum over frames.
+///
+{
+    VECLIB_PROBE( spectral_conj_mult_accumulate, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_conj_mult_accumulate( input1, input2, accumulator, length );
+#else
+    simd::map_complex_binary< simd::NativeISA, simd::ConjugateMul< simd::NativeISA >, true >( reinterpret_cast< const float* >( input1 ),
+                                                                                             reinterpret_cast< const float* >( input2 ),
+                                                                                             reinterpret_cast< float* >( accumulator ), length );
+#endif
+
+}
+
+void spectral_power( const std::complex< float >* input, float* output, size_t length )
+///
+/// Computes the squared magnitude of all complex values in a given vector, without the
+/// square root taken by spectral_magnitude.
+///
+/// @param input
+///  A pointer to the first element of the complex vector to get the power of.
+///
+/// @param output
+///  A pointer to a vector of the same number of elements as input, in which to place the
+///  power of each value in input.
+///
+/// @param length
+///  The number of elements in input and output.
+///
+{
+    VECLIB_PROBE( spectral_power, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_power( input, output, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsPowerSpectr_32fc( reinterpret_cast< const Ipp32fc* >( input + offset ),
+                                              static_cast< Ipp32f* >( output + offset ),
+                                              ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "spectral_power" ) )
+        {
+            return;
+        }
+    }
+#endif
+
+}
+
+void spectral_power_dB( const std::complex< float >* input, float* output, size_t length, float floor_dB )
+///
+/// Computes the power of all complex values in a given vector in decibels,
+/// 10*log10( |x|^2 ), in a single pass. Powers below the floor are raised to it, so that
+/// silent bins give floor_dB rather than -inf.
+///
+/// @param input
+///  A pointer to the first element of the complex vector to get the power of.
+///
+/// @param output
+///  A pointer to a vector of the same number of elements as input, in which to place the
+///  power of each value in input, in dB.
+///
+/// @param length
+///  The number of elements in input and output.
+///
+/// @param floor_dB
+///  The lowest power to output, in dB, e.g. -120. Limited to the range of normal floats,
+///  about -376 dB to 385 dB.
+///
+{
+    VECLIB_PROBE( spectral_power_dB, length );
+
+    const float floor_power = std::min( std::max( std::pow( 10.0f, floor_dB/10.0f ), std::numeric_limits< float >::min() ),
+                                        std::numeric_limits< float >::max() );
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_power_dB( input, output, length, floor_power );
+#else
+    simd::spectral_power_dB< simd::NativeISA >( reinterpret_cast< const float* >( input ), output, length, floor_power );
+#endif
+
+}
+
+void spectral_magnitude( const std::complex< double >* input, double* output, size_t length )
+///
+/// As spectral_magnitude above, in double precision.
+///
+{
+    VECLIB_PROBE( spectral_magnitude, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().spectral_magnitude_double( input, output, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMagnitude_64fc( reinterpret_cast< const Ipp64fc* >( input + offset ),
+                                            static_cast< Ipp64f* >( output + offset ),
+                                            ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "spectral_magnitude" ) )
+        {
+            return;
+        }
+    }
+#endif
+
+}
+
+void phase_spectra( const std::complex< double >* input, double* output, size_t length )
+///
+/// As phase_spectra above, in double precision.
+///
+{
+    VECLIB_PROBE( phase_spectra, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().phase_spectra_double( input, output, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsPhase_64fc( reinterpret_cast< const Ipp64fc* >( input + offset ),
+                                        static_cast< Ipp64f* >( output + offset ),
+                                        ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "phase_spectra" ) )
+        {
+            return;
+        }
+    }
+#endif
+
+}
+
+void cart_to_polar( const std::complex< double >* input, double* magnitude, double* phase, size_t length )
+///
+/// As cart_to_polar above, in double precision.
+///
+{
+    VECLIB_PROBE( cart_to_polar, length );
+
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().cart_to_polar_double( input, magnitude, phase, length );
+#else
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsCartToPolar_64fc( reinterpret_cast< const Ipp64fc* >( input + offset ),
+                                              static_cast< Ipp64f* >( magnitude + offset ),
+                                              static_cast< Ipp64f* >( phase + offset ),
+                                              ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "cart_to_polar" ) )
+        {
+            return;
+        }
+    }
+#endif
+
 }
 
 } // namespace veclib
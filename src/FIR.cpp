@@ -0,0 +1,237 @@
+//
+// Streaming FIR filter, in direct form or by uniformly partitioned FFT convolution - implementation.
+//
+
+// In Module includes
+#include "FIR.h"
+#include "instrumentation_probe.h"
+#include "vector_functions.h"
+#if defined( VECLIB_BACKEND_SIMD )
+#include "simd/kernel_table.h"
+#else
+#include "simd/convolution_kernels.h"
+#include "simd/native_isa.h"
+#endif
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace
+{
+
+// Spectra are padded to a multiple of the widest SIMD vector so that the layout does not
+// depend on the instruction set chosen at runtime and the kernels need no tail.
+const size_t bin_alignment = 16;
+
+FIRMode select_mode( size_t taps_count, FIRMode mode )
+{
+    if( mode==FIRMode::automatic )
+    {
+        return taps_count <= FIRFilter::direct_max_taps ? FIRMode::direct : FIRMode::partitioned;
+    }
+    return mode;
+}
+
+void fir_direct( const float* history, const float* reversed_taps, float* output, size_t length, size_t taps )
+{
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().fir_direct( history, reversed_taps, output, length, taps );
+#else
+    simd::fir_direct< simd::NativeISA >( history, reversed_taps, output, length, taps );
+#endif
+}
+
+void convolve_partitions( const std::complex< float >* delay_line, const std::complex< float >* filters,
+                          const std::complex< float >* swapped_filters, std::complex< float >* output,
+                          size_t bins, size_t partitions, size_t newest )
+{
+    const float* delay_floats = reinterpret_cast< const float* >( delay_line );
+    const float* filter_floats = reinterpret_cast< const float* >( filters );
+    const float* swapped_floats = reinterpret_cast< const float* >( swapped_filters );
+    float* output_floats = reinterpret_cast< float* >( output );
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().convolve_partitions( delay_floats, filter_floats, swapped_floats, output_floats, bins, partitions, newest );
+#else
+    simd::convolve_partitions< simd::NativeISA >( delay_floats, filter_floats, swapped_floats, output_floats, bins, partitions, newest );
+#endif
+}
+
+} // namespace
+
+const size_t FIRFilter::direct_max_taps;
+
+FIRFilter::FIRFilter( const float* taps, size_t taps_count, size_t block_size, FIRMode mode ) :
+    taps_length( taps_count ),
+    block( block_size ),
+    filter_mode( select_mode( taps_count, mode ) ),
+    reversed_taps( filter_mode==FIRMode::direct ? taps_count : 0 ),
+    history( filter_mode==FIRMode::direct ? taps_count - 1 + block_size : 0, 0.0f ),
+    partitions( filter_mode==FIRMode::partitioned ? ( taps_count + block_size - 1 )/block_size : 0 ),
+    padded_bins( ( get_output_FFT_size( 2*block_size ) + bin_alignment - 1 )/bin_alignment*bin_alignment ),
+    // Direct form has no use for the FFT, so takes the smallest plan rather than one of 2*block_size.
+    plan( filter_mode==FIRMode::partitioned ? 2*block_size : 2 ),
+    scratch( plan.working_buffer_size() ),
+    filters( partitions*padded_bins, std::complex< float >( 0.0f, 0.0f ) ),
+    swapped_filters( partitions*padded_bins, std::complex< float >( 0.0f, 0.0f ) ),
+    delay_line( partitions*padded_bins, std::complex< float >( 0.0f, 0.0f ) ),
+    accumulator( partitions > 0 ? padded_bins : 0 ),
+    frame( partitions > 0 ? 2*block_size : 0, 0.0f ),
+    convolved( partitions > 0 ? 2*block_size : 0 ),
+    pending( partitions > 0 ? block_size : 0, 0.0f ),
+    newest( 0 ),
+    fill( 0 )
+///
+/// Creates a streaming FIR filter.
+///
+/// @param taps
+///  A pointer to the filter's impulse response, of taps_count coefficients, which are copied.
+///
+/// @param taps_count
+///  The number of filter coefficients. Must be non-zero.
+///
+/// @param block_size
+///  In partitioned mode, the partition length and the latency in samples; the FFTs are of
+///  2*block_size, so it is best chosen such that 2*block_size is a fast size, see
+///  get_fast_FFT_size(). In direct mode, the most samples filtered per kernel call.
+///
+/// @param mode
+///  Direct form, partitioned convolution, or automatic selection by taps_count.
+///
+{
+    assert( taps_count > 0 ); // Filter must have at least one tap.
+    assert( block_size > 0 ); // Blocks must be non-empty.
+
+    if( filter_mode==FIRMode::direct )
+    {
+        std::reverse_copy( taps, taps + taps_count, reversed_taps.data() );
+        return;
+    }
+
+    // Transform each zero padded partition of the taps, unscaled, as the inverse divides by 2*block_size.
+    for( size_t p = 0; p < partitions; ++p )
+    {
+        const size_t count = std::min( block_size, taps_count - p*block_size );
+        vec_zero( frame.data(), frame.size() );
+        vec_copy( taps + p*block_size, frame.data(), count );
+        std::complex< float >* spectrum = filters.data() + p*padded_bins;
+        plan.forward( frame.data(), spectrum, scratch );
+        std::complex< float >* swapped = swapped_filters.data() + p*padded_bins;
+        for( size_t k = 0; k < plan.output_size(); ++k )
+        {
+            swapped[k] = std::complex< float >( spectrum[k].imag(), spectrum[k].real() );
+        }
+    }
+    vec_zero( frame.data(), frame.size() );
+}
+
+void FIRFilter::process( const float* input, float* output, size_t length )
+///
+/// Filters the next length samples of the input stream.
+///
+/// @param input
+///  A pointer to length input samples.
+///
+/// @param output
+///  A pointer to length floats to be filled with filtered samples, latency() samples behind
+///  the input. May be equal to input.
+///
+/// @param length
+///  The number of samples. May be any size, including zero.
+///
+{
+    VECLIB_PROBE( FIRFilter_process, length );
+    if( filter_mode==FIRMode::direct )
+    {
+        process_direct( input, output, length );
+    }
+    else
+    {
+        process_partitioned( input, output, length );
+    }
+}
+
+void FIRFilter::reset()
+///
+/// Returns the filter to its initial state, as if it had only ever been given zeros.
+///
+{
+    vec_zero( history.data(), history.size() );
+    vec_zero( reinterpret_cast< float* >( delay_line.data() ), 2*delay_line.size() );
+    vec_zero( frame.data(), frame.size() );
+    vec_zero( pending.data(), pending.size() );
+    newest = 0;
+    fill = 0;
+}
+
+void FIRFilter::process_direct( const float* input, float* output, size_t length )
+///
+/// Filters input in steps of at most one block, appending each step to the history and
+/// then sliding the last taps - 1 samples back to the front.
+///
+{
+    const size_t kept = taps_length - 1;
+    while( length > 0 )
+    {
+        const size_t count = std::min( length, block );
+        vec_copy( input, history.data() + kept, count );
+        fir_direct( history.data(), reversed_taps.data(), output, count, taps_length );
+        memmove( history.data(), history.data() + count, kept*sizeof( float ) );
+        input += count;
+        output += count;
+        length -= count;
+    }
+}
+
+void FIRFilter::process_partitioned( const float* input, float* output, size_t length )
+///
+/// Collects input into the current block while emitting the previous block's output, and
+/// convolves each block as it fills.
+///
+{
+    while( length > 0 )
+    {
+        const size_t count = std::min( length, block - fill );
+        vec_copy( input, frame.data() + block + fill, count );
+        vec_copy( pending.data() + fill, output, count );
+        fill += count;
+        input += count;
+        output += count;
+        length -= count;
+        if( fill==block )
+        {
+            run_partitioned_block();
+        }
+    }
+}
+
+void FIRFilter::run_partitioned_block()
+///
+/// Overlap-save over the previous and current blocks: transforms them into the delay line,
+/// sums the products with every filter partition and keeps the last half of the inverse,
+/// which is free of circular wrap around.
+///
+{
+    newest = newest + 1 < partitions ? newest + 1 : 0;
+    plan.forward( frame.data(), delay_line.data() + newest*padded_bins, scratch );
+    convolve_partitions( delay_line.data(), filters.data(), swapped_filters.data(), accumulator.data(),
+                         padded_bins, partitions, newest );
+    plan.inverse( accumulator.data(), convolved.data(), scratch );
+    vec_copy( convolved.data() + block, pending.data(), block );
+    vec_copy( frame.data() + block, frame.data(), block );
+    fill = 0;
+}
+
+} // namespace veclib
+
+} // namespace cupcake
@@ -0,0 +1,214 @@
+//
+// Multi-channel cascades of biquad IIR filters - implementation.
+//
+
+// In Module includes
+#include "IIR.h"
+#include "instrumentation_probe.h"
+#include "vector_functions.h"
+#if defined( VECLIB_BACKEND_SIMD )
+#include "simd/kernel_table.h"
+#else
+#include "simd/biquad_kernels.h"
+#include "simd/native_isa.h"
+#endif
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <assert.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace
+{
+
+// Rows, and the scratch for each frame's leftover channels, are padded to the widest SIMD
+// vector, so that whole vectors can be loaded for the last, partial, vector of channels.
+const size_t lane_alignment = 16;
+
+// Samples per kernel call, so that a block stays in L1 between passes over its sections.
+const size_t block_samples = 4096;
+
+void biquad_cascade( const float* input, float* output, size_t frames, size_t channels, size_t sections,
+                     size_t row_length, float* coefficients, const float* steps, float* state, float* scratch )
+{
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().biquad_cascade( input, output, frames, channels, sections, row_length, coefficients, steps, state, scratch );
+#else
+    if( steps != NULL )
+    {
+        simd::biquad_cascade< simd::NativeISA, true >( input, output, frames, channels, sections, row_length, coefficients, steps, state, scratch );
+    }
+    else
+    {
+        simd::biquad_cascade< simd::NativeISA, false >( input, output, frames, channels, sections, row_length, coefficients, steps, state, scratch );
+    }
+#endif
+}
+
+} // namespace
+
+BiquadCascade::BiquadCascade( size_t channels, size_t sections, size_t ramp_length ) :
+    channel_count( channels ),
+    section_count( sections ),
+    ramp_frames( ramp_length ),
+    row_length( ( channels + lane_alignment - 1 )/lane_alignment*lane_alignment ),
+    block_frames( std::max< size_t >( 1, block_samples/std::max< size_t >( 1, channels ) ) ),
+    coefficients( 5*sections*row_length, 0.0f ),
+    targets( 5*sections*row_length, 0.0f ),
+    steps( 5*sections*row_length, 0.0f ),
+    state( 2*sections*row_length, 0.0f ),
+    scratch( block_frames*lane_alignment ),
+    ramp_remaining( 0 ),
+    targets_changed( false )
+///
+/// Creates a cascade in which every section passes its input through unchanged.
+///
+/// @param channels
+///  The number of interleaved channels. Must be non-zero.
+///
+/// @param sections
+///  The number of biquads each channel passes through. Must be non-zero.
+///
+/// @param ramp_length
+///  The number of frames over which coefficient changes are spread. Zero to apply them at
+///  the start of the next process() call.
+///
+{
+    assert( channels > 0 ); // Cascade must have at least one channel.
+    assert( sections > 0 ); // Cascade must have at least one section.
+
+    const BiquadCoefficients identity = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    for( size_t s = 0; s < sections; ++s )
+    {
+        set_coefficients( s, identity );
+    }
+    vec_copy( targets.data(), coefficients.data(), coefficients.size() );
+    targets_changed = false;
+}
+
+void BiquadCascade::set_coefficients( size_t section, const BiquadCoefficients& coefficients_ )
+///
+/// Sets one section's target coefficients for every channel.
+///
+/// @param section
+///  The index of the section, from 0 at the input.
+///
+/// @param coefficients_
+///  The new coefficients, reached ramp_length() frames into the next process() call.
+///
+{
+    for( size_t c = 0; c < channel_count; ++c )
+    {
+        set_coefficients( section, c, coefficients_ );
+    }
+}
+
+void BiquadCascade::set_coefficients( size_t section, size_t channel, const BiquadCoefficients& coefficients_ )
+///
+/// Sets one section's target coefficients for a single channel.
+///
+/// @param section
+///  The index of the section, from 0 at the input.
+///
+/// @param channel
+///  The index of the channel within each frame.
+///
+/// @param coefficients_
+///  The new coefficients, reached ramp_length() frames into the next process() call.
+///
+{
+    assert( section < section_count ); // Section out of range.
+    assert( channel < channel_count ); // Channel out of range.
+
+    float* target = targets.data() + 5*section*row_length + channel;
+    target[0] = coefficients_.b0;
+    target[row_length] = coefficients_.b1;
+    target[2*row_length] = coefficients_.b2;
+    target[3*row_length] = coefficients_.a1;
+    target[4*row_length] = coefficients_.a2;
+    targets_changed = true;
+}
+
+void BiquadCascade::process( const float* input, float* output, size_t frames )
+///
+/// Filters the next frames of every channel.
+///
+/// @param input
+///  A pointer to frames*channels() samples, interleaved by channel.
+///
+/// @param output
+///  A pointer to frames*channels() floats to be filled with filtered samples, in the same
+///  layout. May be equal to input.
+///
+/// @param frames
+///  The number of samples per channel. May be any size, including zero.
+///
+{
+    VECLIB_PROBE( BiquadCascade_process, frames*channel_count );
+    if( targets_changed )
+    {
+        start_ramp();
+    }
+
+    while( frames > 0 )
+    {
+        size_t count = std::min( frames, block_frames );
+        if( ramp_remaining > 0 )
+        {
+            count = std::min( count, ramp_remaining );
+        }
+        biquad_cascade( input, output, count, channel_count, section_count, row_length,
+                        coefficients.data(), ramp_remaining > 0 ? steps.data() : NULL, state.data(), scratch.data() );
+        if( ramp_remaining > 0 )
+        {
+            ramp_remaining -= count;
+            if( ramp_remaining == 0 )
+            {
+                // Land exactly on the targets, free of the rounding in the accumulated steps.
+                vec_copy( targets.data(), coefficients.data(), coefficients.size() );
+            }
+        }
+        input += count*channel_count;
+        output += count*channel_count;
+        frames -= count;
+    }
+}
+
+void BiquadCascade::reset()
+///
+/// Clears the filter state, as if every channel had only ever been given zeros. Coefficients,
+/// and any ramp in progress, are kept.
+///
+{
+    vec_zero( state.data(), state.size() );
+}
+
+void BiquadCascade::start_ramp()
+///
+/// Starts moving every coefficient from its current value to its target, restarting the
+/// ramp from wherever an unfinished one had got to.
+///
+{
+    targets_changed = false;
+    if( ramp_frames == 0 )
+    {
+        vec_copy( targets.data(), coefficients.data(), coefficients.size() );
+        ramp_remaining = 0;
+        return;
+    }
+    vec_sub( targets.data(), coefficients.data(), steps.data(), steps.size() );
+    vec_mult_const_in_place( steps.data(), 1.0f/static_cast< float >( ramp_frames ), steps.size() );
+    ramp_remaining = ramp_frames;
+}
+
+} // namespace veclib
+
+} // namespace cupcake
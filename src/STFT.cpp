@@ -0,0 +1,264 @@
+//
+// Streaming short time Fourier transform and its overlap-add inverse - implementation.
+//
+
+// In Module includes
+#include "STFT.h"
+#include "vector_functions.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <assert.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+STFT::STFT( size_t frame_size, size_t hop_size, bool polar ) :
+    STFT( frame_size, hop_size, NULL, polar )
+///
+/// Creates a streaming STFT with a periodic Hamming window.
+///
+/// @param frame_size
+///  The length of each analysis frame and FFT. Any length is supported, see get_fast_FFT_size().
+///
+/// @param hop_size
+///  The number of input samples between the starts of consecutive frames. At most frame_size.
+///
+/// @param polar
+///  If true, each frame also carries the magnitude and phase of its spectrum.
+///
+{
+}
+
+STFT::STFT( size_t frame_size, size_t hop_size, const float* window_, bool polar ) :
+    STFT( frame_size, hop_size, window_ ? Window( window_, frame_size ) : Window( WindowType::hamming, frame_size ), polar )
+///
+/// Creates a streaming STFT with a given analysis window.
+///
+/// @param frame_size
+///  The length of each analysis frame and FFT. Any length is supported, see get_fast_FFT_size().
+///
+/// @param hop_size
+///  The number of input samples between the starts of consecutive frames. At most frame_size.
+///
+/// @param window_
+///  A pointer to frame_size window coefficients, which are copied. NULL for a periodic Hamming window.
+///
+/// @param polar
+///  If true, each frame also carries the magnitude and phase of its spectrum.
+///
+{
+}
+
+STFT::STFT( size_t frame_size, size_t hop_size, const Window& window_, bool polar ) :
+    frame_length( frame_size ),
+    hop( hop_size ),
+    compute_polar( polar ),
+    plan( frame_size ),
+    scratch( plan.working_buffer_size() ),
+    window( window_ ),
+    history( frame_size, 0.0f ),
+    write_position( 0 ),
+    samples_until_frame( hop_size ),
+    frames_emitted( 0 ),
+    windowed( frame_size ),
+    spectrum( plan.output_size() ),
+    magnitude( polar ? plan.output_size() : 0 ),
+    phase( polar ? plan.output_size() : 0 )
+///
+/// Creates a streaming STFT with an analysis window from window_functions.h.
+///
+/// @param frame_size
+///  The length of each analysis frame and FFT. Any length is supported, see get_fast_FFT_size().
+///
+/// @param hop_size
+///  The number of input samples between the starts of consecutive frames. At most frame_size.
+///
+/// @param window_
+///  The analysis window, of frame_size coefficients. Shared, not copied.
+///
+/// @param polar
+///  If true, each frame also carries the magnitude and phase of its spectrum.
+///
+{
+    assert( hop_size > 0 && hop_size <= frame_size ); // Hop must be non-zero and no longer than a frame.
+    assert( window.size()==frame_size ); // Window must be the same length as a frame.
+}
+
+void STFT::reset()
+///
+/// Returns the STFT to its initial state, discarding any buffered input.
+///
+{
+    vec_zero( history.data(), frame_length );
+    write_position = 0;
+    samples_until_frame = hop;
+    frames_emitted = 0;
+}
+
+size_t STFT::push( const float* input, size_t length )
+///
+/// Copies input into the history ring buffer, stopping early if a frame becomes due.
+///
+/// @return
+///  The number of samples consumed.
+///
+{
+    const size_t count = std::min( length, samples_until_frame );
+    const size_t first = std::min( count, frame_length - write_position );
+    vec_copy( input, history.data() + write_position, first );
+    vec_copy( input + first, history.data(), count - first );
+    write_position = ( write_position + count ) % frame_length;
+    samples_until_frame -= count;
+    return count;
+}
+
+STFTFrame STFT::analyse()
+///
+/// Windows and transforms the most recent frame_size samples.
+///
+{
+    // The oldest sample sits at write_position; window the ring in its two contiguous pieces.
+    const size_t first = frame_length - write_position;
+    apply_window( history.data() + write_position, window.data(), windowed.data(), first );
+    apply_window( history.data(), window.data() + first, windowed.data() + first, write_position );
+
+    plan.forward( windowed.data(), spectrum.data(), scratch );
+
+    STFTFrame frame;
+    frame.spectrum = spectrum.data();
+    frame.magnitude = NULL;
+    frame.phase = NULL;
+    frame.bins = spectrum.size();
+    frame.index = frames_emitted;
+    if( compute_polar )
+    {
+        cart_to_polar( spectrum.data(), magnitude.data(), phase.data(), spectrum.size() );
+        frame.magnitude = magnitude.data();
+        frame.phase = phase.data();
+    }
+
+    samples_until_frame = hop;
+    ++frames_emitted;
+    return frame;
+}
+
+ISTFT::ISTFT( size_t frame_size, size_t hop_size ) :
+    ISTFT( frame_size, hop_size, NULL )
+///
+/// Creates a streaming inverse STFT with a periodic Hamming window, matching STFT's default.
+///
+/// @param frame_size
+///  The length of each frame and inverse FFT. Any length is supported, see get_fast_FFT_size().
+///
+/// @param hop_size
+///  The number of output samples produced per frame. At most frame_size.
+///
+{
+}
+
+ISTFT::ISTFT( size_t frame_size, size_t hop_size, const float* window_ ) :
+    ISTFT( frame_size, hop_size, window_ ? Window( window_, frame_size ) : Window( WindowType::hamming, frame_size ) )
+///
+/// Creates a streaming inverse STFT with a given window, used for synthesis and assumed to
+/// have been used for analysis.
+///
+/// @param frame_size
+///  The length of each frame and inverse FFT. Any length is supported, see get_fast_FFT_size().
+///
+/// @param hop_size
+///  The number of output samples produced per frame. At most frame_size.
+///
+/// @param window_
+///  A pointer to frame_size window coefficients, which are copied. NULL for a periodic Hamming window.
+///
+{
+}
+
+ISTFT::ISTFT( size_t frame_size, size_t hop_size, const Window& window_ ) :
+    frame_length( frame_size ),
+    hop( hop_size ),
+    plan( frame_size ),
+    scratch( plan.working_buffer_size() ),
+    window( window_ ),
+    inverse_normalisation( hop_size, 0.0f ),
+    frame( frame_size ),
+    accumulator( frame_size, 0.0f ),
+    read_position( 0 )
+///
+/// Creates a streaming inverse STFT with a window from window_functions.h, used for
+/// synthesis and assumed to have been used for analysis.
+///
+/// @param frame_size
+///  The length of each frame and inverse FFT. Any length is supported, see get_fast_FFT_size().
+///
+/// @param hop_size
+///  The number of output samples produced per frame. At most frame_size.
+///
+/// @param window_
+///  The synthesis window, of frame_size coefficients. Shared, not copied.
+///
+{
+    assert( hop_size > 0 && hop_size <= frame_size ); // Hop must be non-zero and no longer than a frame.
+    assert( window.size()==frame_size ); // Window must be the same length as a frame.
+
+    // Each output sample is the sum of frame_size/hop_size windowed frames, at offsets that
+    // are equal modulo the hop, weighted by analysis x synthesis window.
+    for( size_t n = 0; n < frame_size; ++n )
+    {
+        inverse_normalisation[ n % hop_size ] += window[n]*window[n];
+    }
+    for( size_t n = 0; n < hop_size; ++n )
+    {
+        assert( inverse_normalisation[n] > 0.0f ); // Window does not overlap-add to a usable gain.
+        inverse_normalisation[n] = 1.0f/inverse_normalisation[n];
+    }
+}
+
+void ISTFT::process( const std::complex< float >* spectrum, float* output )
+///
+/// Inverse transforms one frame, overlap-adds it and emits the next hop of output.
+///
+/// @param spectrum
+///  A pointer to frame_size/2 + 1 bins, laid out as for IFFT_not_in_place.
+///
+/// @param output
+///  A pointer to hop_size floats to be filled with finished output samples.
+///
+{
+    plan.inverse( spectrum, frame.data(), scratch );
+    apply_window( frame.data(), window, frame.data() );
+
+    // Accumulate the frame into the ring, starting at the oldest unfinished sample.
+    const size_t first = frame_length - read_position;
+    vec_add_in_place( frame.data(), accumulator.data() + read_position, first );
+    vec_add_in_place( frame.data() + first, accumulator.data(), read_position );
+
+    // The first hop of the ring has now received every frame that overlaps it.
+    const size_t ready = std::min( hop, first );
+    vec_mult( accumulator.data() + read_position, inverse_normalisation.data(), output, ready );
+    vec_mult( accumulator.data(), inverse_normalisation.data() + ready, output + ready, hop - ready );
+    vec_zero( accumulator.data() + read_position, ready );
+    vec_zero( accumulator.data(), hop - ready );
+
+    read_position = ( read_position + hop ) % frame_length;
+}
+
+void ISTFT::reset()
+///
+/// Returns the ISTFT to its initial state, discarding any partially overlap-added output.
+///
+{
+    vec_zero( accumulator.data(), frame_length );
+    read_position = 0;
+}
+
+} // namespace veclib
+
+} // namespace cupcake
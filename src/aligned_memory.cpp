@@ -0,0 +1,191 @@
+//
+// Cache line aligned buffers, and an arena for per-frame scratch memory - implementation.
+//
+
+// In Module includes
+#include "aligned_memory.h"
+#include "error_reporting.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <limits>
+#include <stdlib.h>
+#if defined( _MSC_VER )
+#include <malloc.h>
+#endif
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace
+{
+
+size_t round_up( size_t bytes )
+{
+    return ( bytes + memory_alignment - 1 ) & ~( memory_alignment - 1 );
+}
+
+} // namespace
+
+void* aligned_allocate( size_t bytes )
+///
+/// Allocates memory aligned to memory_alignment bytes.
+///
+/// @param bytes
+///  The number of bytes. 0 returns NULL.
+///
+/// @return
+///  The memory, to be released with aligned_free(), or NULL if it can't be allocated, which
+///  is reported as ErrorCode::allocation_failed.
+///
+{
+    if( bytes == 0 )
+    {
+        return NULL;
+    }
+#if defined( _MSC_VER )
+    void* memory = _aligned_malloc( bytes, memory_alignment );
+#else
+    void* memory = NULL;
+    if( posix_memalign( &memory, memory_alignment, bytes ) != 0 )
+    {
+        memory = NULL;
+    }
+#endif
+    if( VECLIB_UNLIKELY( memory == NULL ) )
+    {
+        report_error( ErrorCode::allocation_failed, 0, "aligned_allocate", "Failed to allocate aligned memory." );
+    }
+    return memory;
+}
+
+void* aligned_allocate( size_t count, size_t element_size )
+///
+/// Allocates an array aligned to memory_alignment bytes, rejecting sizes that overflow.
+///
+/// @param count
+///  The number of elements. 0 returns NULL.
+///
+/// @param element_size
+///  The size of each element in bytes.
+///
+/// @return
+///  The memory, to be released with aligned_free(), or NULL if count*element_size bytes
+///  can't be allocated, which is reported as ErrorCode::allocation_failed.
+///
+{
+    if( VECLIB_UNLIKELY( element_size > 0 && count > std::numeric_limits< size_t >::max()/element_size ) )
+    {
+        report_error( ErrorCode::allocation_failed, 0, "aligned_allocate", "Allocation size overflows size_t." );
+        return NULL;
+    }
+    return aligned_allocate( count*element_size );
+}
+
+void aligned_free( void* memory )
+///
+/// Releases memory from aligned_allocate(). NULL is ignored.
+///
+{
+#if defined( _MSC_VER )
+    _aligned_free( memory );
+#else
+    free( memory );
+#endif
+}
+
+Arena::Arena( size_t bytes ) :
+    block( static_cast< unsigned char* >( aligned_allocate( round_up( bytes ) ) ) ),
+    block_size( block ? round_up( bytes ) : 0 ),
+    offset( 0 ),
+    overflow_bytes( 0 ),
+    peak_bytes( 0 )
+///
+/// Creates an arena.
+///
+/// @param bytes
+///  The initial capacity. The arena grows to fit the largest frame, so this only needs
+///  to be right to avoid allocating during the first few frames.
+///
+{
+}
+
+Arena::~Arena()
+{
+    for( size_t i = 0; i < overflow.size(); ++i )
+    {
+        aligned_free( overflow[i] );
+    }
+    aligned_free( block );
+}
+
+void* Arena::allocate_bytes( size_t bytes )
+///
+/// Returns memory aligned to memory_alignment bytes, valid until the next reset(), or NULL
+/// if the arena is full and the heap allocation fails.
+///
+/// @param bytes
+///  The number of bytes.
+///
+{
+    const size_t rounded = round_up( std::max< size_t >( bytes, 1 ) );
+    void* memory;
+    if( offset + rounded <= block_size )
+    {
+        memory = block + offset;
+        offset += rounded;
+    }
+    else
+    {
+        // Keep the vector's own storage from allocating on the common path.
+        if( overflow.capacity() == 0 )
+        {
+            overflow.reserve( 8 );
+        }
+        memory = aligned_allocate( rounded );
+        if( VECLIB_UNLIKELY( memory == NULL ) )
+        {
+            return NULL;
+        }
+        overflow.push_back( memory );
+        overflow_bytes += rounded;
+    }
+    peak_bytes = std::max( peak_bytes, used() );
+    return memory;
+}
+
+void Arena::reset()
+///
+/// Releases everything allocated since the last reset. If the arena overflowed, it is
+/// replaced with one big enough for the largest frame seen.
+///
+{
+    if( !overflow.empty() )
+    {
+        for( size_t i = 0; i < overflow.size(); ++i )
+        {
+            aligned_free( overflow[i] );
+        }
+        overflow.clear();
+        overflow_bytes = 0;
+        // If the larger block can't be allocated (the error is reported), keep the old one.
+        unsigned char* grown = static_cast< unsigned char* >( aligned_allocate( round_up( peak_bytes ) ) );
+        if( grown != NULL )
+        {
+            aligned_free( block );
+            block = grown;
+            block_size = round_up( peak_bytes );
+        }
+    }
+    offset = 0;
+}
+
+} // namespace veclib
+
+} // namespace cupcake
@@ -0,0 +1,296 @@
+//
+// Runtime selection of the instruction set used by the SIMD backend - implementation.
+//
+
+// In Module includes
+#include "dispatch.h"
+#include "simd/kernel_table.h"
+
+// Thirdparty includes
+#if defined( _MSC_VER )
+#include <intrin.h>
+#elif defined( __x86_64__ ) || defined( __i386__ )
+#include <cpuid.h>
+#endif
+
+// Std Lib includes
+#include <stdlib.h>
+#include <string.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+#define VECLIB_DISPATCH_X86 1
+#endif
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+std::atomic< const KernelTable* > active_kernel_table( NULL );
+
+} // namespace simd
+
+namespace
+{
+
+#if defined( VECLIB_DISPATCH_X86 )
+
+struct CPUFeatures
+{
+    bool sse2;
+    bool avx2;
+    bool avx512;
+};
+
+void cpuid( unsigned int leaf, unsigned int subleaf, unsigned int regs[4] )
+{
+#if defined( _MSC_VER )
+    int out[4];
+    __cpuidex( out, static_cast< int >( leaf ), static_cast< int >( subleaf ) );
+    for( int i = 0; i < 4; ++i )
+    {
+        regs[i] = static_cast< unsigned int >( out[i] );
+    }
+#else
+    if( !__get_cpuid_count( leaf, subleaf, &regs[0], &regs[1], &regs[2], &regs[3] ) )
+    {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    }
+#endif
+}
+
+unsigned long long xgetbv()
+///
+/// Reads XCR0, which says which register files the OS saves on a context switch.
+///
+{
+#if defined( _MSC_VER )
+    return _xgetbv( 0 );
+#else
+    unsigned int eax, edx;
+    __asm__ __volatile__( "xgetbv" : "=a"( eax ), "=d"( edx ) : "c"( 0 ) );
+    return ( static_cast< unsigned long long >( edx ) << 32 ) | eax;
+#endif
+}
+
+CPUFeatures detect_cpu_features()
+///
+/// Queries cpuid for the instruction sets we have kernels for. AVX registers are only
+/// usable if the OS has enabled them in XCR0 as well as the CPU supporting them.
+///
+{
+    CPUFeatures features = { false, false, false };
+
+    unsigned int regs[4];
+    cpuid( 0, 0, regs );
+    const unsigned int max_leaf = regs[0];
+    if( max_leaf < 1 )
+    {
+        return features;
+    }
+
+    cpuid( 1, 0, regs );
+    features.sse2 = ( regs[3] & ( 1u << 26 ) ) != 0;
+    const bool fma = ( regs[2] & ( 1u << 12 ) ) != 0;
+    const bool osxsave = ( regs[2] & ( 1u << 27 ) ) != 0;
+    const bool avx = ( regs[2] & ( 1u << 28 ) ) != 0;
+    if( !osxsave || !avx || max_leaf < 7 )
+    {
+        return features;
+    }
+
+    const unsigned long long xcr0 = xgetbv();
+    const bool os_ymm = ( xcr0 & 0x6 ) == 0x6;
+    const bool os_zmm = ( xcr0 & 0xe6 ) == 0xe6;
+
+    cpuid( 7, 0, regs );
+    features.avx2 = os_ymm && fma && ( regs[1] & ( 1u << 5 ) ) != 0;
+    features.avx512 = os_zmm && ( regs[1] & ( 1u << 16 ) ) != 0;
+    return features;
+}
+
+const CPUFeatures& cpu_features()
+{
+    static const CPUFeatures features = detect_cpu_features();
+    return features;
+}
+
+#endif // VECLIB_DISPATCH_X86
+
+const simd::KernelTable* kernel_table_for( ISA isa )
+///
+/// Returns the table for isa, or NULL if it is not built for this architecture.
+///
+{
+    switch( isa )
+    {
+        case ISA::scalar:
+            return &simd::scalar_kernel_table();
+#if defined( VECLIB_DISPATCH_X86 )
+        case ISA::sse2:
+            return &simd::sse2_kernel_table();
+        case ISA::avx2:
+            return &simd::avx2_kernel_table();
+        case ISA::avx512:
+            return &simd::avx512_kernel_table();
+#endif
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+        case ISA::neon:
+            return &simd::neon_kernel_table();
+#endif
+        default:
+            return NULL;
+    }
+}
+
+bool parse_isa( const char* name, ISA& isa )
+{
+    static const ISA all[] = { ISA::scalar, ISA::sse2, ISA::avx2, ISA::avx512, ISA::neon };
+    for( size_t i = 0; i < sizeof( all )/sizeof( all[0] ); ++i )
+    {
+        if( strcmp( name, isa_name( all[i] ) ) == 0 )
+        {
+            isa = all[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+ISA best_supported_isa()
+///
+/// Returns the fastest instruction set that both the host and this build support.
+///
+{
+#if defined( VECLIB_DISPATCH_X86 )
+    if( cpu_features().avx512 )
+        return ISA::avx512;
+    if( cpu_features().avx2 )
+        return ISA::avx2;
+    if( cpu_features().sse2 )
+        return ISA::sse2;
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+    return ISA::neon;
+#endif
+    return ISA::scalar;
+}
+
+bool isa_supported( ISA isa )
+///
+/// Returns true if kernels for isa are built in, and the host can run them.
+///
+/// @param isa
+///  The instruction set to query.
+///
+{
+    if( kernel_table_for( isa ) == NULL )
+    {
+        return false;
+    }
+#if defined( VECLIB_DISPATCH_X86 )
+    switch( isa )
+    {
+        case ISA::sse2:
+            return cpu_features().sse2;
+        case ISA::avx2:
+            return cpu_features().avx2;
+        case ISA::avx512:
+            return cpu_features().avx512;
+        default:
+            break;
+    }
+#endif
+    return true;
+}
+
+ISA active_isa()
+///
+/// Returns the instruction set that veclib calls are currently dispatched to.
+///
+{
+    return simd::kernels().isa;
+}
+
+bool force_isa( ISA isa )
+///
+/// Routes all subsequent veclib calls to the kernels for a specific instruction set.
+/// Intended for benchmarking and reproducing ISA specific bugs. Takes precedence over
+/// the VECLIB_ISA environment variable.
+///
+/// Calls already in flight on other threads finish on the table they started with.
+///
+/// @param isa
+///  The instruction set to use.
+///
+/// @return
+///  True on success, false if isa is not supported, in which case nothing changes.
+///
+{
+    if( !isa_supported( isa ) )
+    {
+        return false;
+    }
+    simd::active_kernel_table.store( kernel_table_for( isa ), std::memory_order_relaxed );
+    return true;
+}
+
+const char* isa_name( ISA isa )
+///
+/// Returns the lower case name of an instruction set, as accepted by VECLIB_ISA.
+///
+{
+    switch( isa )
+    {
+        case ISA::scalar:
+            return "scalar";
+        case ISA::sse2:
+            return "sse2";
+        case ISA::avx2:
+            return "avx2";
+        case ISA::avx512:
+            return "avx512";
+        case ISA::neon:
+            return "neon";
+    }
+    return "unknown";
+}
+
+namespace simd
+{
+
+const KernelTable& resolve_kernel_table()
+///
+/// Picks the kernel table on the first veclib call. Racing threads all arrive at the
+/// same answer, so there is no need for a lock.
+///
+{
+    ISA isa = best_supported_isa();
+
+    const char* requested = getenv( "VECLIB_ISA" );
+    ISA override_isa;
+    if( requested != NULL && parse_isa( requested, override_isa ) && isa_supported( override_isa ) )
+    {
+        isa = override_isa;
+    }
+
+    const KernelTable* table = kernel_table_for( isa );
+    const KernelTable* expected = NULL;
+    // Don't clobber a force_isa() that happened while we were working this out.
+    if( !active_kernel_table.compare_exchange_strong( expected, table, std::memory_order_relaxed ) )
+    {
+        return *expected;
+    }
+    return *table;
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
@@ -0,0 +1,69 @@
+//
+// Checks used inside VecLib's entry points to report errors. See errors.h.
+//
+
+#ifndef CUPCAKE_VEC_LIB_ERROR_REPORTING_H
+#define CUPCAKE_VEC_LIB_ERROR_REPORTING_H
+
+// In module includes
+#include "errors.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stddef.h>
+
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define VECLIB_UNLIKELY( condition ) __builtin_expect( !!( condition ), 0 )
+#define VECLIB_COLD __attribute__(( cold, noinline ))
+#elif defined( _MSC_VER )
+#define VECLIB_UNLIKELY( condition ) ( condition )
+#define VECLIB_COLD __declspec( noinline )
+#else
+#define VECLIB_UNLIKELY( condition ) ( condition )
+#define VECLIB_COLD
+#endif
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+///
+/// The most elements passed to a single IPP call. IPP lengths are int, so longer vectors are
+/// processed in chunks of this many elements.
+///
+const size_t max_ipp_length = size_t( 1 ) << 30;
+
+VECLIB_COLD void report_error( ErrorCode code, int status, const char* function, const char* message );
+
+inline int ipp_chunk_length( size_t length, size_t offset )
+///
+/// Returns the number of elements, from offset, for the next IPP call over a vector of length.
+///
+{
+    const size_t remaining = length - offset;
+    return static_cast< int >( remaining<max_ipp_length ? remaining : max_ipp_length );
+}
+
+inline bool check_ipp_status( int status, const char* function )
+///
+/// Reports status if it is an IPP error; warnings (positive statuses) are ignored. Returns
+/// true if the call succeeded.
+///
+{
+    if( VECLIB_UNLIKELY( status<0 ) )
+    {
+        report_error( ErrorCode::ipp_error, status, function, "IPP returned an error status." );
+        return false;
+    }
+    return true;
+}
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_ERROR_REPORTING_H
@@ -0,0 +1,116 @@
+//
+// Error reporting for VecLib's entry points - implementation.
+//
+
+// In Module includes
+#include "errors.h"
+#include "error_reporting.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <assert.h>
+#include <atomic>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace
+{
+
+struct HandlerSlot
+{
+    ErrorHandler handler;
+    void* context;
+};
+
+//
+// The handler and its context are swapped as a pair, so a handler is never called with
+// another handler's context.
+//
+std::atomic< HandlerSlot* > installed_handler( NULL );
+
+thread_local Error thread_last_error = { ErrorCode::none, 0, "", "No error." };
+
+} // namespace
+
+void set_error_handler( ErrorHandler handler, void* context )
+///
+/// Sets the function called whenever a VecLib function fails, on any thread. Pass NULL to
+/// remove it. Intended to be set once at start up; previous handlers are not freed, so
+/// that a handler may be replaced while other threads are reporting.
+///
+/// @param handler
+///  The function to call, or NULL.
+///
+/// @param context
+///  Passed to handler unchanged.
+///
+{
+    HandlerSlot* slot = NULL;
+    if( handler )
+    {
+        slot = new HandlerSlot;
+        slot->handler = handler;
+        slot->context = context;
+    }
+    installed_handler.store( slot, std::memory_order_release );
+}
+
+ErrorHandler get_error_handler()
+///
+/// Returns the function set by set_error_handler, or NULL.
+///
+{
+    const HandlerSlot* slot = installed_handler.load( std::memory_order_acquire );
+    return slot ? slot->handler : NULL;
+}
+
+Error last_error()
+///
+/// Returns the most recent error on the calling thread since the last clear_last_error(),
+/// or an Error with code ErrorCode::none. Errors are sticky; successful calls do not clear
+/// them.
+///
+{
+    return thread_last_error;
+}
+
+void clear_last_error()
+///
+/// Resets the calling thread's last error to ErrorCode::none.
+///
+{
+    thread_last_error.code = ErrorCode::none;
+    thread_last_error.status = 0;
+    thread_last_error.function = "";
+    thread_last_error.message = "No error.";
+}
+
+void report_error( ErrorCode code, int status, const char* function, const char* message )
+///
+/// Records an error as the calling thread's last error and passes it to the error handler.
+/// Without a handler, asserts in debug builds.
+///
+{
+    thread_last_error.code = code;
+    thread_last_error.status = status;
+    thread_last_error.function = function;
+    thread_last_error.message = message;
+
+    const HandlerSlot* slot = installed_handler.load( std::memory_order_acquire );
+    if( slot )
+    {
+        slot->handler( thread_last_error, slot->context );
+        return;
+    }
+    assert( code==ErrorCode::none ); // VecLib error, see last_error() or install a handler with set_error_handler().
+}
+
+} // namespace veclib
+
+} // namespace cupcake
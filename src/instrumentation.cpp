@@ -0,0 +1,331 @@
+//
+// Opt-in call counters and timing for VecLib's entry points - implementation.
+//
+
+// In Module includes
+#include "instrumentation.h"
+#include "instrumentation_probe.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+#if defined( VECLIB_INSTRUMENT )
+
+namespace instrument
+{
+
+namespace
+{
+
+const char* const function_names[function_count] =
+{
+    "vec_mult_const_in_place",
+    "vec_mult",
+    "vec_mult_in_place",
+    "vec_add_constant",
+    "vec_add_in_place",
+    "vec_sub_constant",
+    "vec_sub",
+    "vec_sub_in_place",
+    "vec_negative_halfwave_rectify",
+    "vec_zero_magnitudes_greater_than_abs",
+    "vec_zero_values_less_than",
+    "vec_fractional_part",
+    "vec_zero",
+    "vec_copy",
+    "vec_convert",
+    "vec_sum",
+    "vec_dot",
+    "vec_norm_l1",
+    "vec_norm_l2",
+    "vec_min",
+    "vec_max",
+    "vec_mean_variance",
+    "vec_weighted_mean",
+    "apply_window",
+    "spectral_magnitude",
+    "phase_spectra",
+    "cart_to_polar",
+    "polar_to_cart",
+    "spectral_mult",
+    "spectral_mult_in_place",
+    "spectral_mult_accumulate",
+    "spectral_conj_mult",
+    "spectral_conj_mult_in_place",
+    "spectral_conj_mult_accumulate",
+    "spectral_power",
+    "spectral_power_dB",
+    "deinterleave_complex",
+    "interleave_complex",
+    "FFT_not_in_place",
+    "IFFT_not_in_place",
+    "FFT_batch",
+    "IFFT_batch",
+    "FFTPlan::forward",
+    "FFTPlan::inverse",
+    "FFTPlan::forward_batch",
+    "FFTPlan::inverse_batch",
+    "RandomStream::uniform",
+    "RandomStream::gaussian",
+    "FIRFilter::process",
+    "BiquadCascade::process",
+};
+
+typedef std::chrono::steady_clock Clock;
+
+struct Totals
+{
+    uint64_t calls[function_count];
+    uint64_t elements[function_count];
+    uint64_t cycles[function_count];
+};
+
+///
+/// Every thread's counters, plus the totals of threads that have exited. Never destroyed,
+/// so that threads exiting during static destruction can still report in.
+///
+struct Registry
+{
+    Registry() :
+        origin_cycles( read_cycle_counter() ),
+        origin_time( Clock::now() ),
+        reset_time( origin_time )
+    {
+        memset( &retired, 0, sizeof( retired ) );
+        memset( &baseline, 0, sizeof( baseline ) );
+    }
+
+    std::mutex lock;
+    std::vector< ThreadCounters* > live;
+    Totals retired;
+    Totals baseline;                    // -> Totals at the last reset, subtracted from snapshots.
+    uint64_t origin_cycles;             // -> Counter and clock at first use, to measure the counter's rate.
+    Clock::time_point origin_time;
+    Clock::time_point reset_time;
+};
+
+Registry& registry()
+{
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+struct ThreadSlot
+{
+    ThreadSlot()
+    {
+        for( size_t i = 0; i < function_count; ++i )
+        {
+            counters.calls[i].store( 0, std::memory_order_relaxed );
+            counters.elements[i].store( 0, std::memory_order_relaxed );
+            counters.cycles[i].store( 0, std::memory_order_relaxed );
+        }
+        Registry& shared = registry();
+        std::lock_guard< std::mutex > guard( shared.lock );
+        shared.live.push_back( &counters );
+    }
+
+    ~ThreadSlot()
+    {
+        Registry& shared = registry();
+        std::lock_guard< std::mutex > guard( shared.lock );
+        for( size_t i = 0; i < function_count; ++i )
+        {
+            shared.retired.calls[i] += counters.calls[i].load( std::memory_order_relaxed );
+            shared.retired.elements[i] += counters.elements[i].load( std::memory_order_relaxed );
+            shared.retired.cycles[i] += counters.cycles[i].load( std::memory_order_relaxed );
+        }
+        for( size_t i = 0; i < shared.live.size(); ++i )
+        {
+            if( shared.live[i]==&counters )
+            {
+                shared.live[i] = shared.live.back();
+                shared.live.pop_back();
+                break;
+            }
+        }
+    }
+
+    ThreadCounters counters;
+};
+
+void sum_counters( Registry& shared, Totals& totals )
+///
+/// Adds up every thread's counters. Must be called with shared.lock held.
+///
+{
+    totals = shared.retired;
+    for( size_t t = 0; t < shared.live.size(); ++t )
+    {
+        for( size_t i = 0; i < function_count; ++i )
+        {
+            totals.calls[i] += shared.live[t]->calls[i].load( std::memory_order_relaxed );
+            totals.elements[i] += shared.live[t]->elements[i].load( std::memory_order_relaxed );
+            totals.cycles[i] += shared.live[t]->cycles[i].load( std::memory_order_relaxed );
+        }
+    }
+}
+
+} // namespace
+
+ThreadCounters& thread_counters()
+{
+    thread_local ThreadSlot slot;
+    return slot.counters;
+}
+
+} // namespace instrument
+
+#endif // VECLIB_INSTRUMENT
+
+bool instrumentation_enabled()
+///
+/// Returns true if VecLib was built with VECLIB_INSTRUMENT.
+///
+{
+#if defined( VECLIB_INSTRUMENT )
+    return true;
+#else
+    return false;
+#endif
+}
+
+InstrumentationSnapshot get_instrumentation_snapshot()
+///
+/// Returns the counters of every function called since the last reset, summed over all
+/// threads, including threads that have since exited. Safe to call while other threads
+/// are using VecLib; calls in progress are not included.
+///
+{
+    InstrumentationSnapshot snapshot;
+    snapshot.cycles_per_second = 0.0;
+    snapshot.elapsed_seconds = 0.0;
+#if defined( VECLIB_INSTRUMENT )
+    using namespace instrument;
+    Registry& shared = registry();
+
+    // The counter's rate is measured over at least 10 ms since first use.
+    const Clock::time_point earliest = shared.origin_time + std::chrono::milliseconds( 10 );
+    if( Clock::now() < earliest )
+    {
+        std::this_thread::sleep_until( earliest );
+    }
+    const uint64_t now_cycles = read_cycle_counter();
+    const Clock::time_point now = Clock::now();
+    snapshot.cycles_per_second = static_cast< double >( now_cycles - shared.origin_cycles )/
+                                 std::chrono::duration< double >( now - shared.origin_time ).count();
+
+    Totals totals;
+    {
+        std::lock_guard< std::mutex > guard( shared.lock );
+        sum_counters( shared, totals );
+        snapshot.elapsed_seconds = std::chrono::duration< double >( now - shared.reset_time ).count();
+        for( size_t i = 0; i < function_count; ++i )
+        {
+            totals.calls[i] -= shared.baseline.calls[i];
+            totals.elements[i] -= shared.baseline.elements[i];
+            totals.cycles[i] -= shared.baseline.cycles[i];
+        }
+    }
+
+    for( size_t i = 0; i < function_count; ++i )
+    {
+        if( totals.calls[i]==0 )
+        {
+            continue;
+        }
+        FunctionCounters counters;
+        counters.name = function_names[i];
+        counters.calls = totals.calls[i];
+        counters.elements = totals.elements[i];
+        counters.cycles = totals.cycles[i];
+        counters.seconds = static_cast< double >( totals.cycles[i] )/snapshot.cycles_per_second;
+        snapshot.functions.push_back( counters );
+    }
+#endif
+    return snapshot;
+}
+
+void reset_instrumentation()
+///
+/// Zeroes every function's counters, for all threads.
+///
+{
+#if defined( VECLIB_INSTRUMENT )
+    using namespace instrument;
+    Registry& shared = registry();
+    std::lock_guard< std::mutex > guard( shared.lock );
+    sum_counters( shared, shared.baseline );
+    shared.reset_time = Clock::now();
+#endif
+}
+
+std::string format_instrumentation_text( const InstrumentationSnapshot& snapshot )
+///
+/// Formats a snapshot as a table, one function per line, for logs.
+///
+{
+    if( !instrumentation_enabled() )
+    {
+        return "VecLib instrumentation is not compiled in; build with VECLIB_INSTRUMENT.\n";
+    }
+    double total_seconds = 0.0;
+    for( size_t i = 0; i < snapshot.functions.size(); ++i )
+    {
+        total_seconds += snapshot.functions[i].seconds;
+    }
+    char line[256];
+    snprintf( line, sizeof( line ), "VecLib: %.6f s in calls over %.3f s elapsed (counter at %.3f GHz)\n",
+              total_seconds, snapshot.elapsed_seconds, snapshot.cycles_per_second*1e-9 );
+    std::string text( line );
+    snprintf( line, sizeof( line ), "%-40s %12s %14s %12s %12s %12s\n", "Function", "Calls", "Elements", "Time (ms)", "ns/call", "cycles/elem" );
+    text += line;
+    for( size_t i = 0; i < snapshot.functions.size(); ++i )
+    {
+        const FunctionCounters& f = snapshot.functions[i];
+        snprintf( line, sizeof( line ), "%-40s %12llu %14llu %12.3f %12.1f %12.3f\n", f.name,
+                  static_cast< unsigned long long >( f.calls ), static_cast< unsigned long long >( f.elements ),
+                  f.seconds*1e3, f.seconds*1e9/static_cast< double >( f.calls ),
+                  f.elements ? static_cast< double >( f.cycles )/static_cast< double >( f.elements ) : 0.0 );
+        text += line;
+    }
+    return text;
+}
+
+std::string format_instrumentation_json( const InstrumentationSnapshot& snapshot )
+///
+/// Formats a snapshot as a JSON object, for metrics pipelines.
+///
+{
+    char buffer[256];
+    snprintf( buffer, sizeof( buffer ), "{\"enabled\": %s, \"cycles_per_second\": %.6g, \"elapsed_seconds\": %.6g, \"functions\": [",
+              instrumentation_enabled() ? "true" : "false", snapshot.cycles_per_second, snapshot.elapsed_seconds );
+    std::string json( buffer );
+    for( size_t i = 0; i < snapshot.functions.size(); ++i )
+    {
+        const FunctionCounters& f = snapshot.functions[i];
+        snprintf( buffer, sizeof( buffer ), "%s{\"name\": \"%s\", \"calls\": %llu, \"elements\": %llu, \"cycles\": %llu, \"seconds\": %.6g}",
+                  i ? ", " : "", f.name, static_cast< unsigned long long >( f.calls ), static_cast< unsigned long long >( f.elements ),
+                  static_cast< unsigned long long >( f.cycles ), f.seconds );
+        json += buffer;
+    }
+    json += "]}";
+    return json;
+}
+
+} // namespace veclib
+
+} // namespace cupcake
@@ -0,0 +1,179 @@
+//
+// The probes placed in VecLib's entry points. See instrumentation.h.
+//
+
+#ifndef CUPCAKE_VEC_LIB_INSTRUMENTATION_PROBE_H
+#define CUPCAKE_VEC_LIB_INSTRUMENTATION_PROBE_H
+
+//
+// VECLIB_PROBE( function, elements ) times the rest of the enclosing scope and counts it
+// against function, one of the InstrumentedFunction names. Without VECLIB_INSTRUMENT it
+// expands to nothing and elements is not evaluated.
+//
+
+#if defined( VECLIB_INSTRUMENT )
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <atomic>
+#include <stdint.h>
+#include <stdlib.h>
+#if defined( _MSC_VER )
+#include <intrin.h>
+#elif defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace instrument
+{
+
+enum class InstrumentedFunction
+{
+    vec_mult_const_in_place,
+    vec_mult,
+    vec_mult_in_place,
+    vec_add_constant,
+    vec_add_in_place,
+    vec_sub_constant,
+    vec_sub,
+    vec_sub_in_place,
+    vec_negative_halfwave_rectify,
+    vec_zero_magnitudes_greater_than_abs,
+    vec_zero_values_less_than,
+    vec_fractional_part,
+    vec_zero,
+    vec_copy,
+    vec_convert,
+    vec_sum,
+    vec_dot,
+    vec_norm_l1,
+    vec_norm_l2,
+    vec_min,
+    vec_max,
+    vec_mean_variance,
+    vec_weighted_mean,
+    apply_window,
+    spectral_magnitude,
+    phase_spectra,
+    cart_to_polar,
+    polar_to_cart,
+    spectral_mult,
+    spectral_mult_in_place,
+    spectral_mult_accumulate,
+    spectral_conj_mult,
+    spectral_conj_mult_in_place,
+    spectral_conj_mult_accumulate,
+    spectral_power,
+    spectral_power_dB,
+    deinterleave_complex,
+    interleave_complex,
+    FFT_not_in_place,
+    IFFT_not_in_place,
+    FFT_batch,
+    IFFT_batch,
+    FFTPlan_forward,
+    FFTPlan_inverse,
+    FFTPlan_forward_batch,
+    FFTPlan_inverse_batch,
+    RandomStream_uniform,
+    RandomStream_gaussian,
+    FIRFilter_process,
+    BiquadCascade_process,
+    count,
+};
+
+const size_t function_count = static_cast< size_t >( InstrumentedFunction::count );
+
+///
+/// One thread's counters. Only the owning thread writes them, with plain loads and stores
+/// on atomics so that snapshots taken from other threads may read them at any time.
+///
+struct ThreadCounters
+{
+    std::atomic< uint64_t > calls[function_count];
+    std::atomic< uint64_t > elements[function_count];
+    std::atomic< uint64_t > cycles[function_count];
+};
+
+ThreadCounters& thread_counters();
+
+inline uint64_t read_cycle_counter()
+{
+#if defined( _MSC_VER ) || defined( __x86_64__ ) || defined( __i386__ )
+    return __rdtsc();
+#elif defined( __aarch64__ )
+    uint64_t ticks;
+    asm volatile( "mrs %0, cntvct_el0" : "=r"( ticks ) );
+    return ticks;
+#else
+    return static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now().time_since_epoch() ).count() );
+#endif
+}
+
+inline void add( std::atomic< uint64_t >& counter, uint64_t value )
+{
+    counter.store( counter.load( std::memory_order_relaxed ) + value, std::memory_order_relaxed );
+}
+
+class Probe
+{
+public:
+
+    Probe( InstrumentedFunction function, size_t elements ) :
+        index( static_cast< size_t >( function ) ),
+        length( elements ),
+        start( read_cycle_counter() )
+    {
+    }
+
+    ~Probe()
+    {
+        const uint64_t elapsed = read_cycle_counter() - start;
+        ThreadCounters& counters = thread_counters();
+        add( counters.calls[index], 1 );
+        add( counters.elements[index], length );
+        add( counters.cycles[index], elapsed );
+    }
+
+private:
+
+    size_t index;
+    uint64_t length;
+    uint64_t start;
+
+    Probe( const Probe& );
+
+    Probe& operator=( const Probe& );
+
+};
+
+} // namespace instrument
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#define VECLIB_PROBE( function, elements ) \
+    const ::cupcake::veclib::instrument::Probe veclib_probe( ::cupcake::veclib::instrument::InstrumentedFunction::function, ( elements ) )
+
+#else
+
+#define VECLIB_PROBE( function, elements )
+
+#endif // VECLIB_INSTRUMENT
+
+#endif // CUPCAKE_VEC_LIB_INSTRUMENTATION_PROBE_H
@@ -0,0 +1,218 @@
+//
+// Streaming signal generators that continue seamlessly from one block to the next - implementation.
+//
+
+// In Module includes
+#include "oscillators.h"
+#if defined( VECLIB_BACKEND_SIMD )
+#include "simd/kernel_table.h"
+#else
+#include "simd/native_isa.h"
+#include "simd/oscillator_kernels.h"
+#endif
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace
+{
+
+const double two_pi = 6.283185307179586476925;
+
+double wrap( double cycles )
+{
+    return cycles - std::floor( cycles + 0.5 );
+}
+
+void render_cosine( float* output, size_t length, double start_cycles, double start_frequency,
+                    double chirp_rate, float magnitude )
+{
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().cosine_oscillator( output, length, start_cycles, start_frequency, chirp_rate, magnitude, 0.0f );
+#else
+    simd::cosine_oscillator< simd::NativeISA >( output, length, start_cycles, start_frequency, chirp_rate, magnitude, 0.0f );
+#endif
+}
+
+} // namespace
+
+SineOscillator::SineOscillator( float frequency, float phase, float magnitude ) :
+    cycles( 0.0 ),
+    current_frequency( frequency ),
+    chirp_rate( 0.0 ),
+    ramp_target( frequency ),
+    ramp_remaining( 0 ),
+    amplitude( magnitude )
+///
+/// Creates an oscillator.
+///
+/// @param frequency
+///  The frequency in cycles per sample.
+///
+/// @param phase
+///  The phase of the first sample in radians.
+///
+/// @param magnitude
+///  The amplitude of the sinusoid.
+///
+{
+    set_phase( phase );
+}
+
+void SineOscillator::process( float* output, size_t length )
+///
+/// Generates the next block of samples.
+///
+/// @param output
+///  A pointer to length floats to fill.
+///
+/// @param length
+///  The number of samples to generate. May be any size, including zero.
+///
+{
+    while( length > 0 )
+    {
+        // Ramps are rendered as a chirp up to their final sample, then as a steady tone.
+        const size_t segment = ( ramp_remaining > 0 ) ? std::min( length, ramp_remaining ) : length;
+        const double rate = ( ramp_remaining > 0 ) ? chirp_rate : 0.0;
+        render_cosine( output, segment, cycles, current_frequency, rate, amplitude );
+
+        const double samples = static_cast< double >( segment );
+        cycles = wrap( cycles + samples*( current_frequency + 0.5*rate*samples ) );
+        current_frequency += rate*samples;
+        if( ramp_remaining > 0 )
+        {
+            ramp_remaining -= segment;
+            if( ramp_remaining == 0 )
+            {
+                current_frequency = ramp_target;
+            }
+        }
+
+        output += segment;
+        length -= segment;
+    }
+}
+
+void SineOscillator::set_frequency( float frequency )
+///
+/// Changes frequency from the next sample, cancelling any ramp in progress. Phase carries
+/// on from where it was, so there is no discontinuity.
+///
+/// @param frequency
+///  The new frequency in cycles per sample.
+///
+{
+    current_frequency = frequency;
+    ramp_target = frequency;
+    ramp_remaining = 0;
+}
+
+void SineOscillator::ramp_frequency( float frequency, size_t samples )
+///
+/// Glides the frequency linearly from its current value, starting at the next sample and
+/// reaching the target at the sample after next samples. Replaces any ramp in progress.
+///
+/// @param frequency
+///  The target frequency in cycles per sample.
+///
+/// @param samples
+///  The length of the glide. 0 changes frequency immediately, as set_frequency.
+///
+{
+    if( samples == 0 )
+    {
+        set_frequency( frequency );
+        return;
+    }
+    ramp_target = frequency;
+    ramp_remaining = samples;
+    chirp_rate = ( ramp_target - current_frequency )/static_cast< double >( samples );
+}
+
+void SineOscillator::set_phase( float phase )
+///
+/// Sets the phase of the next sample.
+///
+/// @param phase
+///  The phase in radians.
+///
+{
+    cycles = wrap( phase/two_pi );
+}
+
+float SineOscillator::phase() const
+///
+/// Returns the phase of the next sample, in radians in [-pi,pi).
+///
+{
+    return static_cast< float >( cycles*two_pi );
+}
+
+ChirpOscillator::ChirpOscillator( float start_freq, float end_freq, size_t sweep_samples, float phase, float magnitude ) :
+    oscillator( start_freq, phase, magnitude ),
+    start_frequency( start_freq ),
+    end_frequency( end_freq ),
+    sweep_length( sweep_samples ),
+    start_phase( phase )
+///
+/// Creates a chirp.
+///
+/// @param start_freq
+///  The frequency of the first sample, in cycles per sample.
+///
+/// @param end_freq
+///  The frequency in cycles per sample reached after sweep_samples samples, and held thereafter.
+///
+/// @param sweep_samples
+///  The length of the sweep.
+///
+/// @param phase
+///  The phase of the first sample in radians.
+///
+/// @param magnitude
+///  The amplitude of the chirp.
+///
+{
+    oscillator.ramp_frequency( end_frequency, sweep_length );
+}
+
+void ChirpOscillator::restart()
+///
+/// Starts the sweep again from the first sample.
+///
+{
+    oscillator.set_frequency( start_frequency );
+    oscillator.set_phase( start_phase );
+    oscillator.ramp_frequency( end_frequency, sweep_length );
+}
+
+NoiseSource::NoiseSource( float magnitude, uint64_t seed_value ) :
+    generator( seed_value ),
+    amplitude( magnitude )
+///
+/// Creates a noise source.
+///
+/// @param magnitude
+///  The peak amplitude of the noise.
+///
+/// @param seed_value
+///  Seed for the generator. Sources with the same seed produce the same noise.
+///
+{
+}
+
+} // namespace veclib
+
+} // namespace cupcake
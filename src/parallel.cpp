@@ -0,0 +1,722 @@
+//
+// Multi-threaded versions of the vector_functions.h operations, for very long arrays - implementation.
+//
+
+// In Module includes
+#include "parallel.h"
+#include "aligned_memory.h"
+#include "vector_functions.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace parallel
+{
+
+namespace
+{
+
+const size_t default_threshold = 1 << 18;
+const size_t default_chunk_size = 1 << 14;
+
+std::atomic< size_t > parallel_threshold( default_threshold );
+std::atomic< size_t > parallel_chunk_size( default_chunk_size );
+
+thread_local bool in_pool_thread = false;
+
+///
+/// One participant's share of a job: a range of chunk indices packed into a single word,
+/// begin in the low half and end in the high half, so that the owner taking from the front
+/// and thieves taking from the back can both update it with one compare and swap.
+///
+struct alignas( 64 ) ChunkRange
+{
+    std::atomic< uint64_t > range;
+};
+
+///
+/// Operator new only honours alignas( 64 ) from C++17, so ranges are placed in aligned memory.
+///
+struct FreeChunkRanges
+{
+    void operator()( ChunkRange* ranges ) const { aligned_free( ranges ); }
+};
+
+ChunkRange* allocate_chunk_ranges( size_t count )
+{
+    ChunkRange* ranges = static_cast< ChunkRange* >( aligned_allocate( count*sizeof( ChunkRange ) ) );
+    for( size_t i = 0; i < count; ++i )
+    {
+        new ( ranges + i ) ChunkRange();
+    }
+    return ranges;
+}
+
+inline uint64_t pack( uint64_t begin, uint64_t end ) { return begin | ( end << 32 ); }
+
+inline uint64_t range_begin( uint64_t range ) { return range & 0xFFFFFFFFu; }
+
+inline uint64_t range_end( uint64_t range ) { return range >> 32; }
+
+///
+/// A call to for_each_chunk in progress.
+///
+struct Job
+{
+    ChunkFunction function;
+    void* context;
+    size_t length;
+    size_t chunk;
+    ChunkRange* ranges;
+    size_t participants;
+};
+
+bool pop_chunk( ChunkRange& own, uint64_t& index )
+///
+/// Takes the first chunk of a participant's own range.
+///
+{
+    uint64_t range = own.range.load();
+    while( range_begin( range ) < range_end( range ) )
+    {
+        if( own.range.compare_exchange_weak( range, pack( range_begin( range ) + 1, range_end( range ) ) ) )
+        {
+            index = range_begin( range );
+            return true;
+        }
+    }
+    return false;
+}
+
+bool steal_chunks( const Job& job, size_t thief )
+///
+/// Moves the back half of another participant's remaining range into the thief's own,
+/// which must be empty. Returns false once every range is empty.
+///
+{
+    for( size_t offset = 1; offset < job.participants; ++offset )
+    {
+        ChunkRange& victim = job.ranges[ ( thief + offset ) % job.participants ];
+        uint64_t range = victim.range.load();
+        while( range_begin( range ) < range_end( range ) )
+        {
+            const uint64_t begin = range_begin( range );
+            const uint64_t end = range_end( range );
+            const uint64_t middle = begin + ( end - begin )/2;
+            if( victim.range.compare_exchange_weak( range, pack( begin, middle ) ) )
+            {
+                job.ranges[thief].range.store( pack( middle, end ) );
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void participate( const Job& job, size_t participant )
+///
+/// Runs chunks from a participant's own range, then steals until no work is left anywhere.
+///
+{
+    do
+    {
+        uint64_t index;
+        while( pop_chunk( job.ranges[participant], index ) )
+        {
+            const size_t begin = static_cast< size_t >( index )*job.chunk;
+            job.function( job.context, begin, std::min( begin + job.chunk, job.length ) );
+        }
+    }
+    while( steal_chunks( job, participant ) );
+}
+
+size_t default_thread_count()
+///
+/// The VECLIB_THREADS environment variable if set, otherwise one thread per hardware thread.
+///
+{
+    const char* requested = getenv( "VECLIB_THREADS" );
+    if( requested != NULL && atoi( requested ) > 0 )
+    {
+        return static_cast< size_t >( atoi( requested ) );
+    }
+    return std::max( 1u, std::thread::hardware_concurrency() );
+}
+
+///
+/// The process wide thread pool. Holds thread_count() - 1 worker threads; the thread that
+/// submits a job is the last participant.
+///
+class ThreadPool
+{
+public:
+
+    explicit ThreadPool( size_t threads );
+
+    ~ThreadPool();
+
+    bool try_run( Job& job );
+
+    size_t size() const { return workers.size() + 1; }
+
+    std::mutex submit_lock;                 // -> Held for the duration of a job, and while resizing.
+
+private:
+
+    void worker_loop( size_t participant );
+
+    std::vector< std::thread > workers;
+    std::unique_ptr< ChunkRange, FreeChunkRanges > ranges;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    uint64_t generation;                    // -> Incremented for each job.
+    size_t busy_workers;                    // -> Workers yet to finish the current job.
+    Job* current_job;
+    bool stopping;
+
+    ThreadPool( const ThreadPool& );
+
+    ThreadPool& operator=( const ThreadPool& );
+
+};
+
+ThreadPool::ThreadPool( size_t threads ) :
+    ranges( allocate_chunk_ranges( std::max< size_t >( threads, 1 ) ) ),
+    generation( 0 ),
+    busy_workers( 0 ),
+    current_job( NULL ),
+    stopping( false )
+{
+    for( size_t participant = 0; participant + 1 < threads; ++participant )
+    {
+        workers.push_back( std::thread( &ThreadPool::worker_loop, this, participant ) );
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard< std::mutex > guard( lock );
+        stopping = true;
+    }
+    wake.notify_all();
+    for( size_t i = 0; i < workers.size(); ++i )
+    {
+        workers[i].join();
+    }
+}
+
+void ThreadPool::worker_loop( size_t participant )
+{
+    in_pool_thread = true;
+    uint64_t seen = 0;
+    std::unique_lock< std::mutex > guard( lock );
+    while( true )
+    {
+        wake.wait( guard, [&]{ return stopping || generation != seen; } );
+        if( stopping )
+        {
+            return;
+        }
+        seen = generation;
+        Job* job = current_job;
+
+        guard.unlock();
+        participate( *job, participant );
+        guard.lock();
+
+        if( --busy_workers == 0 )
+        {
+            finished.notify_one();
+        }
+    }
+}
+
+bool ThreadPool::try_run( Job& job )
+///
+/// Runs a job across the pool, returning when every chunk is done. Returns false without
+/// running anything if another thread is using the pool.
+///
+{
+    std::unique_lock< std::mutex > submitting( submit_lock, std::try_to_lock );
+    if( !submitting.owns_lock() )
+    {
+        return false;
+    }
+
+    // Deal the chunks out evenly; stealing evens out whatever imbalance remains.
+    const size_t participants = size();
+    const size_t chunks = ( job.length + job.chunk - 1 )/job.chunk;
+    for( size_t i = 0; i < participants; ++i )
+    {
+        ranges.get()[i].range.store( pack( chunks*i/participants, chunks*( i + 1 )/participants ) );
+    }
+    job.ranges = ranges.get();
+    job.participants = participants;
+
+    {
+        std::lock_guard< std::mutex > guard( lock );
+        current_job = &job;
+        busy_workers = workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+
+    in_pool_thread = true;
+    participate( job, participants - 1 );
+    in_pool_thread = false;
+
+    std::unique_lock< std::mutex > guard( lock );
+    finished.wait( guard, [&]{ return busy_workers == 0; } );
+    current_job = NULL;
+    return true;
+}
+
+std::mutex pool_lock;                       // -> Guards creation and replacement of the pool.
+std::shared_ptr< ThreadPool > current_pool;
+size_t requested_threads = 0;               // -> 0 until set_thread_count() is called.
+
+std::shared_ptr< ThreadPool > get_pool()
+///
+/// Returns the pool, starting its threads on first use.
+///
+{
+    std::lock_guard< std::mutex > guard( pool_lock );
+    if( !current_pool )
+    {
+        current_pool = std::make_shared< ThreadPool >( requested_threads > 0 ? requested_threads : default_thread_count() );
+    }
+    return current_pool;
+}
+
+} // namespace
+
+void set_thread_count( size_t threads )
+///
+/// Sets the number of threads used by parallel operations, including the calling thread.
+/// The pool is rebuilt on the next parallel call. Operations already running finish on the
+/// old pool.
+///
+/// @param threads
+///  The thread count. 1 runs everything on the calling thread; 0 restores the default of
+///  one per hardware thread, or the VECLIB_THREADS environment variable if set.
+///
+{
+    std::lock_guard< std::mutex > guard( pool_lock );
+    requested_threads = threads;
+    current_pool.reset();
+}
+
+size_t thread_count()
+///
+/// Returns the number of threads used by parallel operations, including the calling thread.
+///
+{
+    std::lock_guard< std::mutex > guard( pool_lock );
+    if( current_pool )
+    {
+        return current_pool->size();
+    }
+    return requested_threads > 0 ? requested_threads : default_thread_count();
+}
+
+void set_threshold( size_t length )
+///
+/// Sets the array length below which operations run on the calling thread alone, because
+/// waking the pool would cost more than it saves. The default is 262144 elements.
+///
+/// @param length
+///  The threshold, in elements.
+///
+{
+    parallel_threshold = length;
+}
+
+size_t threshold()
+///
+/// Returns the array length below which operations run on the calling thread alone.
+///
+{
+    return parallel_threshold;
+}
+
+void set_chunk_size( size_t length )
+///
+/// Sets the number of elements in each unit of work. The default, 16384 floats, keeps the
+/// operands of a two input operation within a typical 256 kB L2 cache.
+///
+/// @param length
+///  The chunk size, in elements. Must be non-zero.
+///
+{
+    assert( length > 0 ); // Chunks must contain at least one element.
+    parallel_chunk_size = length;
+}
+
+size_t chunk_size()
+///
+/// Returns the number of elements in each unit of work.
+///
+{
+    return parallel_chunk_size;
+}
+
+namespace
+{
+
+size_t job_chunk( size_t length )
+///
+/// The chunk size for a job over length elements: chunk_size(), widened if the chunks would
+/// not otherwise fit in a packed range, which only happens with a tiny chunk size.
+///
+{
+    return std::max< size_t >( parallel_chunk_size, ( length >> 31 ) + 1 );
+}
+
+void run_job( size_t length, size_t chunk, ChunkFunction function, void* context )
+///
+/// As for_each_chunk, with a given chunk size from job_chunk().
+///
+{
+    if( length == 0 )
+    {
+        return;
+    }
+
+    Job job;
+    job.function = function;
+    job.context = context;
+    job.length = length;
+    job.chunk = chunk;
+    job.ranges = NULL;
+    job.participants = 0;
+
+    if( length >= parallel_threshold && !in_pool_thread )
+    {
+        std::shared_ptr< ThreadPool > pool = get_pool();
+        if( pool->size() > 1 && pool->try_run( job ) )
+        {
+            return;
+        }
+    }
+    function( context, 0, length );
+}
+
+} // namespace
+
+void for_each_chunk( size_t length, ChunkFunction function, void* context )
+///
+/// Calls function( context, begin, end ) for consecutive chunks covering [0,length), from as
+/// many threads as are available. Chunks may run in any order and concurrently.
+///
+/// @param length
+///  The number of elements to process.
+///
+/// @param function
+///  Processes the elements [begin,end). Must be safe to call concurrently on disjoint ranges.
+///
+/// @param context
+///  Passed through to function.
+///
+{
+    run_job( length, job_chunk( length ), function, context );
+}
+
+namespace
+{
+
+//
+// Each parallel operation runs the single threaded function on every chunk.
+//
+
+template< class Body >
+void run( size_t length, Body body )
+{
+    for_each_chunk( length, body );
+}
+
+//
+// Each parallel reduction reduces every chunk with the single threaded function, then
+// combines the chunk results in order. Chunks don't depend on the thread count, so neither
+// does the result.
+//
+
+template< class Result, class Reduce >
+void reduce_chunks( size_t length, std::vector< Result >& partials, Reduce reduce )
+///
+/// Sets partials[k] to reduce( begin, end ) for the k'th chunk of [0,length).
+///
+{
+    const size_t chunk = job_chunk( length );
+    partials.resize( ( length + chunk - 1 )/chunk );
+    struct Body
+    {
+        static void call( void* context, size_t begin, size_t end )
+        {
+            Body& body = *static_cast< Body* >( context );
+            // Ranges start on a chunk boundary, and cover every chunk when run on one thread.
+            for( size_t first = begin; first < end; first += body.chunk )
+            {
+                ( *body.partials )[first/body.chunk] = body.reduce( first, std::min( first + body.chunk, end ) );
+            }
+        }
+
+        size_t chunk;
+        std::vector< Result >* partials;
+        Reduce reduce;
+    };
+    Body body = { chunk, &partials, reduce };
+    run_job( length, chunk, &Body::call, &body );
+}
+
+struct Extreme
+{
+    float value;
+    size_t index;
+};
+
+struct Moments
+{
+    size_t count;
+    float mean;
+    float variance;
+};
+
+struct WeightedSums
+{
+    float weighted;
+    float weight;
+};
+
+} // namespace
+
+void vec_mult_const_in_place( float* input1, float multiplier, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_mult_const_in_place( input1 + begin, multiplier, end - begin ); } );
+}
+
+void vec_mult( const float* input1, const float* input2, float* output, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_mult( input1 + begin, input2 + begin, output + begin, end - begin ); } );
+}
+
+void vec_mult_in_place( const float* input1, float* input2, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_mult_in_place( input1 + begin, input2 + begin, end - begin ); } );
+}
+
+void vec_add_constant( float* input1, float constant, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_add_constant( input1 + begin, constant, end - begin ); } );
+}
+
+void vec_add_in_place( const float* input1, float* input2_output, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_add_in_place( input1 + begin, input2_output + begin, end - begin ); } );
+}
+
+void vec_sub_constant( float* input1, float constant, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_sub_constant( input1 + begin, constant, end - begin ); } );
+}
+
+void vec_sub( const float* input1, const float* input2, float* output, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_sub( input1 + begin, input2 + begin, output + begin, end - begin ); } );
+}
+
+void vec_sub_in_place( float* input1, const float* input2, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_sub_in_place( input1 + begin, input2 + begin, end - begin ); } );
+}
+
+void vec_negative_halfwave_rectify( float* input, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_negative_halfwave_rectify( input + begin, end - begin ); } );
+}
+
+void vec_zero_magnitudes_greater_than_abs( float* input, float threshold, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_zero_magnitudes_greater_than_abs( input + begin, threshold, end - begin ); } );
+}
+
+void vec_zero_values_less_than( float* input, float threshold, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_zero_values_less_than( input + begin, threshold, end - begin ); } );
+}
+
+void vec_fractional_part( const float* input, float* output, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_fractional_part( input + begin, output + begin, end - begin ); } );
+}
+
+void vec_zero( float* vec, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_zero( vec + begin, end - begin ); } );
+}
+
+void vec_copy( const float* vec_source, float* vec_dest, size_t length )
+{
+    run( length, [=]( size_t begin, size_t end ){ veclib::vec_copy( vec_source + begin, vec_dest + begin, end - begin ); } );
+}
+
+float vec_sum( const float* input, size_t length, SumAccuracy accuracy )
+{
+    std::vector< float > partials;
+    reduce_chunks( length, partials, [=]( size_t begin, size_t end ){ return veclib::vec_sum( input + begin, end - begin, accuracy ); } );
+    return veclib::vec_sum( partials.data(), partials.size(), accuracy );
+}
+
+float vec_dot( const float* input1, const float* input2, size_t length, SumAccuracy accuracy )
+{
+    std::vector< float > partials;
+    reduce_chunks( length, partials, [=]( size_t begin, size_t end ){ return veclib::vec_dot( input1 + begin, input2 + begin, end - begin, accuracy ); } );
+    return veclib::vec_sum( partials.data(), partials.size(), accuracy );
+}
+
+float vec_norm_l1( const float* input, size_t length, SumAccuracy accuracy )
+{
+    std::vector< float > partials;
+    reduce_chunks( length, partials, [=]( size_t begin, size_t end ){ return veclib::vec_norm_l1( input + begin, end - begin, accuracy ); } );
+    return veclib::vec_sum( partials.data(), partials.size(), accuracy );
+}
+
+float vec_norm_l2( const float* input, size_t length, SumAccuracy accuracy )
+{
+    std::vector< float > partials;
+    reduce_chunks( length, partials, [=]( size_t begin, size_t end ){ return veclib::vec_dot( input + begin, input + begin, end - begin, accuracy ); } );
+    return std::sqrt( veclib::vec_sum( partials.data(), partials.size(), accuracy ) );
+}
+
+float vec_min( const float* input, size_t length, size_t* index )
+{
+    if( length == 0 )
+    {
+        return veclib::vec_min( input, length, index );
+    }
+    std::vector< Extreme > partials;
+    reduce_chunks( length, partials, [=]( size_t begin, size_t end )
+    {
+        Extreme extreme;
+        extreme.value = veclib::vec_min( input + begin, end - begin, &extreme.index );
+        extreme.index += begin;
+        return extreme;
+    } );
+    Extreme best = partials[0];
+    for( size_t k = 1; k < partials.size(); ++k )
+    {
+        best = ( partials[k].value < best.value ) ? partials[k] : best;
+    }
+    if( index )
+    {
+        *index = best.index;
+    }
+    return best.value;
+}
+
+float vec_max( const float* input, size_t length, size_t* index )
+{
+    if( length == 0 )
+    {
+        return veclib::vec_max( input, length, index );
+    }
+    std::vector< Extreme > partials;
+    reduce_chunks( length, partials, [=]( size_t begin, size_t end )
+    {
+        Extreme extreme;
+        extreme.value = veclib::vec_max( input + begin, end - begin, &extreme.index );
+        extreme.index += begin;
+        return extreme;
+    } );
+    Extreme best = partials[0];
+    for( size_t k = 1; k < partials.size(); ++k )
+    {
+        best = ( partials[k].value > best.value ) ? partials[k] : best;
+    }
+    if( index )
+    {
+        *index = best.index;
+    }
+    return best.value;
+}
+
+void vec_mean_variance( const float* input, size_t length, float* mean, float* variance, SumAccuracy accuracy )
+{
+    if( length == 0 )
+    {
+        veclib::vec_mean_variance( input, length, mean, variance, accuracy );
+        return;
+    }
+    std::vector< Moments > partials;
+    reduce_chunks( length, partials, [=]( size_t begin, size_t end )
+    {
+        Moments moments;
+        moments.count = end - begin;
+        veclib::vec_mean_variance( input + begin, end - begin, &moments.mean, &moments.variance, accuracy );
+        return moments;
+    } );
+
+    // Chan et al.'s pairwise update, adding one chunk at a time, in double precision.
+    double count = 0.0;
+    double combined_mean = 0.0;
+    double squares = 0.0;
+    for( size_t k = 0; k < partials.size(); ++k )
+    {
+        const double chunk_count = static_cast< double >( partials[k].count );
+        const double delta = partials[k].mean - combined_mean;
+        const double total = count + chunk_count;
+        combined_mean += delta*chunk_count/total;
+        squares += partials[k].variance*chunk_count + delta*delta*count*chunk_count/total;
+        count = total;
+    }
+    *mean = static_cast< float >( combined_mean );
+    *variance = static_cast< float >( squares/count );
+}
+
+float vec_weighted_mean( const float* values, const float* weights, size_t length, SumAccuracy accuracy )
+{
+    std::vector< WeightedSums > partials;
+    reduce_chunks( length, partials, [=]( size_t begin, size_t end )
+    {
+        // The second pass over weights reads them from cache.
+        WeightedSums sums;
+        sums.weighted = veclib::vec_dot( values + begin, weights + begin, end - begin, accuracy );
+        sums.weight = veclib::vec_sum( weights + begin, end - begin, accuracy );
+        return sums;
+    } );
+    std::vector< float > weighted( partials.size() );
+    std::vector< float > weight( partials.size() );
+    for( size_t k = 0; k < partials.size(); ++k )
+    {
+        weighted[k] = partials[k].weighted;
+        weight[k] = partials[k].weight;
+    }
+    const float total_weight = veclib::vec_sum( weight.data(), weight.size(), accuracy );
+    return ( total_weight != 0.0f ) ? veclib::vec_sum( weighted.data(), weighted.size(), accuracy )/total_weight : 0.0f;
+}
+
+} // namespace parallel
+
+} // namespace veclib
+
+} // namespace cupcake
@@ -0,0 +1,100 @@
+//
+// Reproducible, thread-safe generation of buffers of random numbers - implementation.
+//
+
+// In Module includes
+#include "rng.h"
+#include "instrumentation_probe.h"
+#if defined( VECLIB_BACKEND_SIMD )
+#include "simd/kernel_table.h"
+#else
+#include "simd/native_isa.h"
+#include "simd/random_kernels.h"
+#endif
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <assert.h>
+#include <stdint.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+RandomStream::RandomStream( uint64_t seed, uint64_t stream ) :
+    key( seed ),
+    stream_number( stream ),
+    position( 0 )
+///
+/// Creates a stream positioned at its first sample.
+///
+/// @param seed
+///  Seed for the generator. The same seed and stream always give the same sequence.
+///
+/// @param stream
+///  Selects one of 2^64 independent sequences for the seed, e.g. a job or thread index.
+///
+{
+}
+
+void RandomStream::uniform( float* output, size_t length, float minimum, float maximum )
+///
+/// Fills a buffer with samples uniformly distributed in [minimum,maximum), and advances
+/// the stream by length samples.
+///
+/// @param output
+///  A pointer to length floats to fill.
+///
+/// @param length
+///  The number of samples to generate.
+///
+/// @param minimum
+///  The lower limit of the range.
+///
+/// @param maximum
+///  The upper limit of the range.
+///
+{
+    VECLIB_PROBE( RandomStream_uniform, length );
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().random_uniform( key, stream_number, position, output, length, minimum, maximum );
+#else
+    simd::random_uniform< simd::NativeISA >( key, stream_number, position, output, length, minimum, maximum );
+#endif
+    position += length;
+}
+
+void RandomStream::gaussian( float* output, size_t length, float mean, float deviation )
+///
+/// Fills a buffer with normally distributed samples, and advances the stream by length samples.
+///
+/// @param output
+///  A pointer to length floats to fill.
+///
+/// @param length
+///  The number of samples to generate.
+///
+/// @param mean
+///  The mean of the distribution.
+///
+/// @param deviation
+///  The standard deviation of the distribution.
+///
+{
+    VECLIB_PROBE( RandomStream_gaussian, length );
+    assert( deviation >= 0.0f ); // Standard deviation must be non-negative.
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().random_gaussian( key, stream_number, position, output, length, mean, deviation );
+#else
+    simd::random_gaussian< simd::NativeISA >( key, stream_number, position, output, length, mean, deviation );
+#endif
+    position += length;
+}
+
+} // namespace veclib
+
+} // namespace cupcake
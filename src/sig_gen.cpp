@@ -7,15 +7,24 @@
 
 // In Module includes
 #include "sig_gen.h"
+#include "rng.h"
+#if defined( VECLIB_BACKEND_SIMD )
+#include "simd/kernel_table.h"
+#else
+#include "simd/native_isa.h"
+#include "simd/oscillator_kernels.h"
+#endif
 
 // Thirdparty includes
 // None.
 
 // Std Lib includes
 #include <algorithm>
+#include <atomic>
 #include <ctime>
 #include <math.h>
 #include <assert.h>
+#include <stdint.h>
 
 namespace cupcake
 {
@@ -23,12 +32,25 @@ namespace cupcake
 namespace veclib
 {
 
+namespace
+{
+
+std::atomic< uint64_t > random_seed( 0 );          // -> Seed shared by every thread's make_random_number stream.
+std::atomic< uint64_t > random_generation( 0 );    // -> Incremented by seed_rand, so threads know to reseed.
+std::atomic< uint64_t > random_thread_count( 0 );  // -> Hands out a distinct stream number to each thread.
+
+} // namespace
+
 void seed_rand()
 ///
-/// Helper function to seed the random variable maker.
+/// Helper function to seed the random variable maker, from the current time.
+///
+/// Safe to call from any thread. Each thread draws from its own stream of the seeded
+/// generator, so make_random_number never contends on shared state.
 ///
 {
-    srand( static_cast< unsigned int >( std::time( 0 ) ) );
+    random_seed.store( static_cast< uint64_t >( std::time( 0 ) ), std::memory_order_relaxed );
+    random_generation.fetch_add( 1, std::memory_order_release );
 }
 
 float make_random_number( float minVal, float maxVal )
@@ -36,6 +58,9 @@ float make_random_number( float minVal, float maxVal )
 /// Returns a random float type number greater than or equal to minVal and
 /// less than or equal to maxVal.
 ///
+/// Thread-safe. For buffers of random numbers, or sequences that must be reproducible, use
+/// RandomStream (rng.h) instead.
+///
 /// @param minVal
 ///  The lower limit on the output range of the random number generator.
 ///
@@ -47,9 +72,46 @@ float make_random_number( float minVal, float maxVal )
 ///
 {
     assert( maxVal > minVal ); // Only generates numbers in a positive range.
-    return ( static_cast< float >( rand() )/RAND_MAX*( maxVal - minVal ) + minVal );
+
+    // Uniform values in [0,1) are generated a block at a time and handed out one per call.
+    const size_t block_size = 64;
+    static thread_local RandomStream stream;
+    static thread_local float block[ block_size ];
+    static thread_local size_t next = block_size;
+    static thread_local uint64_t generation = UINT64_MAX;
+    const uint64_t current = random_generation.load( std::memory_order_acquire );
+    if( generation != current )
+    {
+        stream = RandomStream( random_seed.load( std::memory_order_relaxed ), random_thread_count.fetch_add( 1 ) );
+        generation = current;
+        next = block_size;
+    }
+    if( next == block_size )
+    {
+        stream.uniform( block, block_size );
+        next = 0;
+    }
+    return block[ next++ ]*( maxVal - minVal ) + minVal;
+}
+
+namespace
+{
+
+void render_cosine( float* output, size_t length, double start_cycles, double start_frequency,
+                    double chirp_rate, float magnitude, float offset )
+///
+/// Fills output with offset + magnitude*cos( 2 pi ( start_cycles + start_frequency*n + chirp_rate*n^2/2 ) ).
+///
+{
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().cosine_oscillator( output, length, start_cycles, start_frequency, chirp_rate, magnitude, offset );
+#else
+    simd::cosine_oscillator< simd::NativeISA >( output, length, start_cycles, start_frequency, chirp_rate, magnitude, offset );
+#endif
 }
 
+} // namespace
+
 void fill_vector_sine( std::vector< float >& output, float frequency, float phase, float mag )
 ///
 /// Fills a vector with a sinusoid of the appropriate frequency, phase, and amplitude.
@@ -67,12 +129,33 @@ void fill_vector_sine( std::vector< float >& output, float frequency, float phas
 ///  The magnitude of the sinusoid.
 ///
 {
-    size_t n = 0;
-    std::generate( output.begin(), output.end(), [&n, frequency, phase, mag]{
-        float result = mag*cos( 2.0*M_PI*frequency*static_cast< float >( n ) + phase );
-        ++n;
-        return result;
-    });
+    fill_vector_sine( output.data(), output.size(), frequency, phase, mag );
+}
+
+void fill_vector_sine( float* output, size_t length, float frequency, float phase, float mag )
+///
+/// Fills a buffer with a sinusoid, mag*cos( 2 pi frequency n + phase ).
+///
+/// The phase is tracked in double precision, so the signal stays in phase with the ideal
+/// sinusoid to within about 1e-6 rad however long it is.
+///
+/// @param output
+///  A pointer to the first of length floats to be filled with a sinusoid.
+///
+/// @param length
+///  The number of samples to generate.
+///
+/// @param frequency
+///  The frequency of the sinusoid in cycles per sample.
+///
+/// @param phase
+///  The phase of the sinusoid in radians.
+///
+/// @param mag
+///  The magnitude of the sinusoid.
+///
+{
+    render_cosine( output, length, phase/( 2.0*M_PI ), frequency, 0.0, mag, 0.0f );
 }
     
 void fill_vector_chirp( std::vector< float >& output, float start_freq, float end_freq, float start_phase, float mag )
@@ -98,14 +181,35 @@ void fill_vector_chirp( std::vector< float >& output, float start_freq, float en
 ///  The magnitude of the chirp signal at all samples.
 ///
 {
-    float freq_per_sample = ( end_freq - start_freq )/static_cast< float >( output.size() );
-    size_t n = 0;
-    std::generate( output.begin(), output.end(), [&n, start_freq, freq_per_sample, start_phase, mag]{
-        float samp = static_cast< float >( n );
-        float result = mag*cos( 2.0*M_PI*( start_freq + samp*freq_per_sample )*samp + start_phase );
-        ++n;
-        return result;
-    });
+    fill_vector_chirp( output.data(), output.size(), start_freq, end_freq, start_phase, mag );
+}
+
+void fill_vector_chirp( float* output, size_t length, float start_freq, float end_freq, float start_phase, float mag )
+///
+/// Fills a buffer with a linear chirp, as for the std::vector overload above. The phase is
+/// tracked in double precision, so it remains accurate for very long chirps.
+///
+/// @param output
+///  A pointer to the first of length floats to be filled with the linear chirp signal.
+///
+/// @param length
+///  The number of samples to generate.
+///
+/// @param start_freq
+///  The frequency in cycles per sample at output index 0.
+///
+/// @param end_freq
+///  The frequency in cycles per sample at output index length-1.
+///
+/// @param start_phase
+///  The phase of the first sample in radians.
+///
+/// @param mag
+///  The magnitude of the chirp signal at all samples.
+///
+{
+    const double chirp_rate = ( length > 1 ) ? ( static_cast< double >( end_freq ) - start_freq )/static_cast< double >( length - 1 ) : 0.0;
+    render_cosine( output, length, start_phase/( 2.0*M_PI ), start_freq, chirp_rate, mag, 0.0f );
 }
     
 void hamming( std::vector< float >& window_output )
@@ -118,16 +222,25 @@ void hamming( std::vector< float >& window_output )
 ///  The vector to be filled with a Hamming window.
 ///
 {
-    size_t n = 0;
-    float N = static_cast< float >( window_output.size() );
-    std::generate( window_output.begin(), window_output.end(),
-        [&n, N]
-        {
-            float result = 0.54 - 0.46*cos( 2.0*M_PI*static_cast< float >( n )/N );
-            ++n;
-            return result;
-        }
-    );
+    hamming( window_output.data(), window_output.size() );
+}
+
+void hamming( float* window_output, size_t length )
+///
+/// Fills a buffer with a periodic Hamming window, as for the std::vector overload above.
+///
+/// @param window_output
+///  A pointer to the first of length floats to be filled with a Hamming window.
+///
+/// @param length
+///  The length of the window.
+///
+{
+    if( length==0 )
+    {
+        return;
+    }
+    render_cosine( window_output, length, 0.0, 1.0/static_cast< double >( length ), 0.0, -0.46f, 0.54f );
 }
     
 void linspace( float start, float finish, std::vector< float >& output )
@@ -0,0 +1,259 @@
+//
+// SIMD kernels for cascades of biquad filters, one channel per lane.
+//
+
+#ifndef CUPCAKE_VEC_LIB_BIQUAD_KERNELS_H
+#define CUPCAKE_VEC_LIB_BIQUAD_KERNELS_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+//
+// As with vector_kernels.h, everything here is a template on the ISA traits, V.
+//
+// Samples are interleaved by channel, so one frame of consecutive channels loads as a
+// vector and each lane runs an independent filter. Sections are transposed direct form II,
+//
+//     y = b0*x + s1,    s1 = b1*x - a1*y + s2,    s2 = b2*x - a2*y,
+//
+// and their coefficients and state are stored as rows of row_length floats, one per
+// coefficient or state variable, indexed by channel: five coefficient rows per section, in
+// the order b0, b1, b2, a1, a2, and two state rows per section, s1 then s2.
+//
+
+template< class V >
+struct BiquadSection
+///
+/// One section's coefficients and state for a vector of channels, held in registers for the
+/// length of a block. The feedback coefficients are kept negated so every update is an fmadd.
+///
+{
+    typedef typename V::vf vf;
+
+    inline void load( const float* coefficients, const float* state, size_t row_length )
+    {
+        b0 = V::loadu( coefficients );
+        b1 = V::loadu( coefficients + row_length );
+        b2 = V::loadu( coefficients + 2*row_length );
+        minus_a1 = V::sub( V::zero(), V::loadu( coefficients + 3*row_length ) );
+        minus_a2 = V::sub( V::zero(), V::loadu( coefficients + 4*row_length ) );
+        s1 = V::loadu( state );
+        s2 = V::loadu( state + row_length );
+    }
+
+    inline void load_steps( const float* steps, size_t row_length )
+    {
+        step_b0 = V::loadu( steps );
+        step_b1 = V::loadu( steps + row_length );
+        step_b2 = V::loadu( steps + 2*row_length );
+        step_minus_a1 = V::sub( V::zero(), V::loadu( steps + 3*row_length ) );
+        step_minus_a2 = V::sub( V::zero(), V::loadu( steps + 4*row_length ) );
+    }
+
+    inline void advance()
+    {
+        b0 = V::add( b0, step_b0 );
+        b1 = V::add( b1, step_b1 );
+        b2 = V::add( b2, step_b2 );
+        minus_a1 = V::add( minus_a1, step_minus_a1 );
+        minus_a2 = V::add( minus_a2, step_minus_a2 );
+    }
+
+    inline vf process( vf x )
+    {
+        vf y = V::fmadd( b0, x, s1 );
+        s1 = V::fmadd( minus_a1, y, V::fmadd( b1, x, s2 ) );
+        s2 = V::fmadd( minus_a2, y, V::mul( b2, x ) );
+        return y;
+    }
+
+    inline void save_state( float* state, size_t row_length ) const
+    {
+        V::storeu( state, s1 );
+        V::storeu( state + row_length, s2 );
+    }
+
+    inline void save_coefficients( float* coefficients, size_t row_length ) const
+    {
+        V::storeu( coefficients, b0 );
+        V::storeu( coefficients + row_length, b1 );
+        V::storeu( coefficients + 2*row_length, b2 );
+        V::storeu( coefficients + 3*row_length, V::sub( V::zero(), minus_a1 ) );
+        V::storeu( coefficients + 4*row_length, V::sub( V::zero(), minus_a2 ) );
+    }
+
+    vf b0, b1, b2, minus_a1, minus_a2;
+    vf s1, s2;
+    vf step_b0, step_b1, step_b2, step_minus_a1, step_minus_a2;
+};
+
+template< class V, size_t Count, bool Ramp >
+inline void biquad_sections( const float* input, float* output, size_t frames, size_t channels,
+                             size_t row_length, float* coefficients, const float* steps, float* state )
+///
+/// Runs Count consecutive sections over a block for one vector of channels. Count is at
+/// most two, so that the coefficients and state stay in registers; the second section of
+/// one frame can then overlap the first section of the next. With Ramp, every coefficient
+/// moves by its step before each frame and the final values are written back.
+///
+{
+    BiquadSection< V > section[ Count ];
+    for( size_t i = 0; i < Count; ++i )
+    {
+        section[i].load( coefficients + 5*i*row_length, state + 2*i*row_length, row_length );
+        if( Ramp )
+        {
+            section[i].load_steps( steps + 5*i*row_length, row_length );
+        }
+    }
+
+    for( size_t n = 0; n < frames; ++n )
+    {
+        typename V::vf x = V::loadu( input + n*channels );
+        for( size_t i = 0; i < Count; ++i )
+        {
+            if( Ramp )
+            {
+                section[i].advance();
+            }
+            x = section[i].process( x );
+        }
+        V::storeu( output + n*channels, x );
+    }
+
+    for( size_t i = 0; i < Count; ++i )
+    {
+        section[i].save_state( state + 2*i*row_length, row_length );
+        if( Ramp )
+        {
+            section[i].save_coefficients( coefficients + 5*i*row_length, row_length );
+        }
+    }
+}
+
+template< class V, bool Ramp >
+inline void biquad_channels( const float* input, float* output, size_t frames, size_t channels,
+                             size_t sections, size_t row_length, float* coefficients, const float* steps, float* state )
+///
+/// Runs every section over a block for one vector of channels, two sections per pass. The
+/// first pass reads input and later passes work in place on output.
+///
+{
+    const float* source = input;
+    for( size_t s = 0; s < sections; s += 2 )
+    {
+        float* section_coefficients = coefficients + 5*s*row_length;
+        const float* section_steps = Ramp ? steps + 5*s*row_length : NULL;
+        float* section_state = state + 2*s*row_length;
+        if( s + 1 < sections )
+        {
+            biquad_sections< V, 2, Ramp >( source, output, frames, channels, row_length,
+                                          section_coefficients, section_steps, section_state );
+        }
+        else
+        {
+            biquad_sections< V, 1, Ramp >( source, output, frames, channels, row_length,
+                                          section_coefficients, section_steps, section_state );
+        }
+        source = output;
+    }
+}
+
+template< class V, bool Ramp >
+inline void biquad_cascade( const float* input, float* output, size_t frames, size_t channels, size_t sections,
+                            size_t row_length, float* coefficients, const float* steps, float* state, float* scratch )
+///
+/// Filters a block of interleaved frames through a cascade of biquads, with each channel's
+/// coefficients and state in its own lane.
+///
+/// Channels left over after the last whole vector are copied into scratch, zero padded to
+/// a vector per frame, filtered there and copied back. Loading them straight from the frames
+/// through a small buffer would stall every load on store forwarding.
+///
+/// @param input
+///  A pointer to frames*channels samples, interleaved by channel.
+///
+/// @param output
+///  A pointer to frames*channels floats in which to place the filtered samples. May be equal
+///  to input.
+///
+/// @param frames
+///  The number of samples per channel.
+///
+/// @param channels
+///  The number of interleaved channels.
+///
+/// @param sections
+///  The number of biquads in the cascade. Must be non-zero.
+///
+/// @param row_length
+///  The length of each coefficient and state row. At least channels rounded up to a whole
+///  number of vectors.
+///
+/// @param coefficients
+///  A pointer to 5*sections rows of coefficients, laid out as above. Updated with the
+///  ramped values when Ramp is set.
+///
+/// @param steps
+///  With Ramp, a pointer to 5*sections rows of per-frame coefficient increments. Unused
+///  otherwise.
+///
+/// @param state
+///  A pointer to 2*sections rows of filter state, laid out as above, updated in place.
+///
+/// @param scratch
+///  A pointer to frames*V::width floats of working memory.
+///
+{
+    const size_t W = V::width;
+    size_t c = 0;
+    for( ; c + W <= channels; c += W )
+    {
+        biquad_channels< V, Ramp >( input + c, output + c, frames, channels, sections, row_length,
+                                    coefficients + c, Ramp ? steps + c : NULL, state + c );
+    }
+    if( c < channels )
+    {
+        const size_t count = channels - c;
+        for( size_t n = 0; n < frames; ++n )
+        {
+            V::storeu( scratch + n*W, V::zero() );
+            for( size_t j = 0; j < count; ++j )
+            {
+                scratch[ n*W + j ] = input[ n*channels + c + j ];
+            }
+        }
+        biquad_channels< V, Ramp >( scratch, scratch, frames, W, sections, row_length,
+                                    coefficients + c, Ramp ? steps + c : NULL, state + c );
+        for( size_t n = 0; n < frames; ++n )
+        {
+            for( size_t j = 0; j < count; ++j )
+            {
+                output[ n*channels + c + j ] = scratch[ n*W + j ];
+            }
+        }
+    }
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_BIQUAD_KERNELS_H
@@ -0,0 +1,174 @@
+//
+// SIMD kernels for FIR filtering, in direct form and by partitioned fast convolution.
+//
+
+#ifndef CUPCAKE_VEC_LIB_CONVOLUTION_KERNELS_H
+#define CUPCAKE_VEC_LIB_CONVOLUTION_KERNELS_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+//
+// As with vector_kernels.h, everything here is a template on the ISA traits, V.
+//
+
+template< class V >
+inline void fir_direct( const float* history, const float* reversed_taps, float* output, size_t length, size_t taps )
+///
+/// Direct form FIR filter, vectorised across outputs. Each tap is broadcast once and
+/// multiplied into four vectors of consecutive outputs, so the taps are read once per
+/// 4*V::width outputs and every load is a plain unaligned load of the history.
+///
+/// @param history
+///  A pointer to taps - 1 + length input samples: the taps - 1 samples preceding the
+///  block, oldest first, followed by the block itself.
+///
+/// @param reversed_taps
+///  A pointer to the taps coefficients, last first.
+///
+/// @param output
+///  A pointer to length floats in which to place the filtered block.
+///
+/// @param length
+///  The number of output samples.
+///
+/// @param taps
+///  The number of filter coefficients.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    size_t n = 0;
+    for( ; n + 4*W <= length; n += 4*W )
+    {
+        vf acc0 = V::zero();
+        vf acc1 = V::zero();
+        vf acc2 = V::zero();
+        vf acc3 = V::zero();
+        const float* x = history + n;
+        for( size_t k = 0; k < taps; ++k )
+        {
+            vf tap = V::set1( reversed_taps[k] );
+            acc0 = V::fmadd( tap, V::loadu( x + k ), acc0 );
+            acc1 = V::fmadd( tap, V::loadu( x + k + W ), acc1 );
+            acc2 = V::fmadd( tap, V::loadu( x + k + 2*W ), acc2 );
+            acc3 = V::fmadd( tap, V::loadu( x + k + 3*W ), acc3 );
+        }
+        V::storeu( output + n, acc0 );
+        V::storeu( output + n + W, acc1 );
+        V::storeu( output + n + 2*W, acc2 );
+        V::storeu( output + n + 3*W, acc3 );
+    }
+    for( ; n + W <= length; n += W )
+    {
+        vf acc = V::zero();
+        const float* x = history + n;
+        for( size_t k = 0; k < taps; ++k )
+        {
+            acc = V::fmadd( V::set1( reversed_taps[k] ), V::loadu( x + k ), acc );
+        }
+        V::storeu( output + n, acc );
+    }
+    for( ; n < length; ++n )
+    {
+        float acc = 0.0f;
+        const float* x = history + n;
+        for( size_t k = 0; k < taps; ++k )
+        {
+            acc += reversed_taps[k]*x[k];
+        }
+        output[n] = acc;
+    }
+}
+
+template< class V >
+inline void convolve_partitions( const float* delay_line, const float* filters, const float* swapped_filters,
+                                 float* output, size_t bins, size_t partitions, size_t newest )
+///
+/// Frequency domain multiply-accumulate for uniformly partitioned convolution:
+///
+///     output[k] = sum over p of delay_line[( newest - p ) mod partitions][k]*filters[p][k]
+///
+/// Spectra are interleaved complex values, each one bins long and stored back to back.
+/// Rather than splitting real and imaginary parts on every load, each lane accumulates
+/// x*h and x*swap( h ), where swap( h ) exchanges the real and imaginary parts of h and is
+/// precomputed with the filters. The real part of the product is the difference of the even
+/// and odd lanes of the first sum and the imaginary part the sum of the lanes of the second,
+/// so the only shuffles are one deinterleave per output vector, after all the partitions.
+/// Bins are the outer loop so that the accumulators stay in registers across partitions.
+///
+/// @param delay_line
+///  A pointer to partitions input spectra, a ring with the most recent at index newest.
+///
+/// @param filters
+///  A pointer to partitions filter spectra, the first applying to the most recent input.
+///
+/// @param swapped_filters
+///  As filters, with the real and imaginary parts of each value exchanged.
+///
+/// @param output
+///  A pointer to bins complex values in which to place the sum.
+///
+/// @param bins
+///  The number of complex values in each spectrum. Must be a multiple of V::width.
+///
+/// @param partitions
+///  The number of spectra in delay_line, filters and swapped_filters.
+///
+/// @param newest
+///  The index of the most recent spectrum in delay_line.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    const size_t stride = 2*bins;
+    for( size_t i = 0; i < stride; i += 2*W )
+    {
+        vf direct_lo = V::zero();
+        vf direct_hi = V::zero();
+        vf crossed_lo = V::zero();
+        vf crossed_hi = V::zero();
+        for( size_t p = 0; p < partitions; ++p )
+        {
+            const size_t slot = p <= newest ? newest - p : newest + partitions - p;
+            const float* x = delay_line + slot*stride + i;
+            const size_t offset = p*stride + i;
+            vf x_lo = V::loadu( x );
+            vf x_hi = V::loadu( x + W );
+            direct_lo = V::fmadd( x_lo, V::loadu( filters + offset ), direct_lo );
+            direct_hi = V::fmadd( x_hi, V::loadu( filters + offset + W ), direct_hi );
+            crossed_lo = V::fmadd( x_lo, V::loadu( swapped_filters + offset ), crossed_lo );
+            crossed_hi = V::fmadd( x_hi, V::loadu( swapped_filters + offset + W ), crossed_hi );
+        }
+        vf re_re, im_im, re_im, im_re;
+        V::deinterleave( direct_lo, direct_hi, re_re, im_im );
+        V::deinterleave( crossed_lo, crossed_hi, re_im, im_re );
+        vf lo, hi;
+        V::interleave( V::sub( re_re, im_im ), V::add( re_im, im_re ), lo, hi );
+        V::storeu( output + i, lo );
+        V::storeu( output + i + W, hi );
+    }
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_CONVOLUTION_KERNELS_H
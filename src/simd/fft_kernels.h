@@ -0,0 +1,518 @@
+//
+// Native power of 2 real FFT kernels, producing the same CCS layout as IPP, or the same
+// bins split into real and imaginary arrays.
+//
+
+#ifndef CUPCAKE_VEC_LIB_FFT_KERNELS_H
+#define CUPCAKE_VEC_LIB_FFT_KERNELS_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+//
+// A real FFT of length N is computed as a complex FFT of length M = N/2 on the even
+// (real part) and odd (imaginary part) samples, followed by a split step that separates
+// the two spectra. The complex FFT is a Stockham autosort radix-4 decimation in frequency,
+// with one radix-2 pass at the end when log2( M ) is odd, so no bit reversal is needed.
+// Data is held split into real and imaginary arrays so that every butterfly is plain
+// vector arithmetic.
+//
+// Passes are vectorised along their contiguous inner index, whose length grows by 4 each
+// pass. The first passes, where that is shorter than a vector, run one float at a time.
+//
+// Twiddles are built in double precision by FFT.cpp, laid out as floats:
+//
+//  [0]                 Forward scale, including the split step's factor of 1/2.
+//  [1]                 Inverse scale.
+//  [2, M + 3)          cos( 2 pi k/N ) for k in [0, M], the split step twiddles.
+//  [M + 3, 2M + 4)     -sin( 2 pi k/N ) for k in [0, M].
+//  [2M + 4, ...)       For each radix-4 pass of length n = M, M/4, ... >= 4, six arrays of
+//                      n/4 values: the real and imaginary parts of W_n^p, W_n^2p, W_n^3p.
+//
+// The working buffer holds 2N floats.
+//
+// The split step reads and writes the real spectrum through InterleavedSpectrum or
+// SplitSpectrum, so a split layout spectrum costs no shuffles at all.
+//
+
+template< class V >
+struct ScalarLane
+///
+/// Single float stand-in for the ISA traits, for work too short to fill a vector.
+/// A template on V only so that each ISA's copy gets its own symbols, as for the kernels.
+///
+{
+    typedef float vf;
+
+    static const size_t width = 1;
+
+    static inline vf set1( float value ) { return value; }
+    static inline vf loadu( const float* ptr ) { return *ptr; }
+    static inline void storeu( float* ptr, vf value ) { *ptr = value; }
+
+    static inline vf add( vf a, vf b ) { return a + b; }
+    static inline vf sub( vf a, vf b ) { return a - b; }
+    static inline vf mul( vf a, vf b ) { return a*b; }
+    static inline vf fmadd( vf a, vf b, vf c ) { return a*b + c; }
+
+    static inline vf reverse( vf a ) { return a; }
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd ) { even = lo; odd = hi; }
+    static inline void interleave( vf even, vf odd, vf& lo, vf& hi ) { lo = even; hi = odd; }
+};
+
+template< class U >
+inline void complex_mul( typename U::vf a_re, typename U::vf a_im, typename U::vf b_re, typename U::vf b_im,
+                         typename U::vf& re, typename U::vf& im )
+{
+    re = U::sub( U::mul( a_re, b_re ), U::mul( a_im, b_im ) );
+    im = U::fmadd( a_re, b_im, U::mul( a_im, b_re ) );
+}
+
+template< class V, class U >
+void radix4_pass( size_t n, size_t s, const float* twiddles,
+                  const float* x_re, const float* x_im, float* y_re, float* y_im )
+///
+/// One radix-4 pass over sub-transforms of length n, each interleaved s ways.
+/// U is V, or ScalarLane< V > when s is less than a vector wide.
+///
+{
+    typedef typename U::vf vf;
+
+    const size_t m = n/4;
+    for( size_t p = 0; p < m; ++p )
+    {
+        const vf w1_re = U::set1( twiddles[p] );
+        const vf w1_im = U::set1( twiddles[m + p] );
+        const vf w2_re = U::set1( twiddles[2*m + p] );
+        const vf w2_im = U::set1( twiddles[3*m + p] );
+        const vf w3_re = U::set1( twiddles[4*m + p] );
+        const vf w3_im = U::set1( twiddles[5*m + p] );
+
+        const size_t in = s*p;
+        const size_t out = 4*s*p;
+        for( size_t q = 0; q < s; q += U::width )
+        {
+            const vf a_re = U::loadu( x_re + in + q );
+            const vf a_im = U::loadu( x_im + in + q );
+            const vf b_re = U::loadu( x_re + in + s*m + q );
+            const vf b_im = U::loadu( x_im + in + s*m + q );
+            const vf c_re = U::loadu( x_re + in + 2*s*m + q );
+            const vf c_im = U::loadu( x_im + in + 2*s*m + q );
+            const vf d_re = U::loadu( x_re + in + 3*s*m + q );
+            const vf d_im = U::loadu( x_im + in + 3*s*m + q );
+
+            const vf apc_re = U::add( a_re, c_re );
+            const vf apc_im = U::add( a_im, c_im );
+            const vf amc_re = U::sub( a_re, c_re );
+            const vf amc_im = U::sub( a_im, c_im );
+            const vf bpd_re = U::add( b_re, d_re );
+            const vf bpd_im = U::add( b_im, d_im );
+            const vf bmd_re = U::sub( b_re, d_re );
+            const vf bmd_im = U::sub( b_im, d_im );
+
+            U::storeu( y_re + out + q, U::add( apc_re, bpd_re ) );
+            U::storeu( y_im + out + q, U::add( apc_im, bpd_im ) );
+
+            // ( a - c ) -/+ i( b - d ), rotated by the first and third twiddles.
+            vf re, im;
+            complex_mul< U >( U::add( amc_re, bmd_im ), U::sub( amc_im, bmd_re ), w1_re, w1_im, re, im );
+            U::storeu( y_re + out + s + q, re );
+            U::storeu( y_im + out + s + q, im );
+
+            complex_mul< U >( U::sub( apc_re, bpd_re ), U::sub( apc_im, bpd_im ), w2_re, w2_im, re, im );
+            U::storeu( y_re + out + 2*s + q, re );
+            U::storeu( y_im + out + 2*s + q, im );
+
+            complex_mul< U >( U::sub( amc_re, bmd_im ), U::add( amc_im, bmd_re ), w3_re, w3_im, re, im );
+            U::storeu( y_re + out + 3*s + q, re );
+            U::storeu( y_im + out + 3*s + q, im );
+        }
+    }
+}
+
+template< class V, class U >
+void radix2_pass( size_t s, const float* x_re, const float* x_im, float* y_re, float* y_im )
+///
+/// The final radix-2 pass for when log2( M ) is odd. All twiddles are 1.
+///
+{
+    typedef typename U::vf vf;
+
+    for( size_t q = 0; q < s; q += U::width )
+    {
+        const vf a_re = U::loadu( x_re + q );
+        const vf a_im = U::loadu( x_im + q );
+        const vf b_re = U::loadu( x_re + s + q );
+        const vf b_im = U::loadu( x_im + s + q );
+        U::storeu( y_re + q, U::add( a_re, b_re ) );
+        U::storeu( y_im + q, U::add( a_im, b_im ) );
+        U::storeu( y_re + s + q, U::sub( a_re, b_re ) );
+        U::storeu( y_im + s + q, U::sub( a_im, b_im ) );
+    }
+}
+
+template< class V >
+void complex_FFT( size_t M, const float* twiddles, float* a_re, float* a_im, float* b_re, float* b_im,
+                  float*& out_re, float*& out_im )
+///
+/// Forward complex FFT of length M from a, using b as the other half of the ping-pong.
+/// Sets out_re/out_im to whichever of the two holds the result.
+///
+{
+    float* x_re = a_re;
+    float* x_im = a_im;
+    float* y_re = b_re;
+    float* y_im = b_im;
+    float* swap;
+
+    size_t s = 1;
+    for( size_t n = M; n >= 4; n /= 4 )
+    {
+        if( s >= V::width )
+        {
+            radix4_pass< V, V >( n, s, twiddles, x_re, x_im, y_re, y_im );
+        }
+        else
+        {
+            radix4_pass< V, ScalarLane< V > >( n, s, twiddles, x_re, x_im, y_re, y_im );
+        }
+        twiddles += 6*( n/4 );
+        s *= 4;
+        swap = x_re; x_re = y_re; y_re = swap;
+        swap = x_im; x_im = y_im; y_im = swap;
+    }
+    if( M/s == 2 )
+    {
+        if( s >= V::width )
+        {
+            radix2_pass< V, V >( s, x_re, x_im, y_re, y_im );
+        }
+        else
+        {
+            radix2_pass< V, ScalarLane< V > >( s, x_re, x_im, y_re, y_im );
+        }
+        swap = x_re; x_re = y_re; y_re = swap;
+        swap = x_im; x_im = y_im; y_im = swap;
+    }
+
+    out_re = x_re;
+    out_im = x_im;
+}
+
+template< class V, class U >
+void split_even_odd( size_t M, const float* input, float* z_re, float* z_im )
+{
+    for( size_t n = 0; n < M; n += U::width )
+    {
+        typename U::vf even, odd;
+        U::deinterleave( U::loadu( input + 2*n ), U::loadu( input + 2*n + U::width ), even, odd );
+        U::storeu( z_re + n, even );
+        U::storeu( z_im + n, odd );
+    }
+}
+
+template< class V, class U >
+void merge_even_odd( size_t M, const float* z_re, const float* z_im, float* output )
+{
+    for( size_t n = 0; n < M; n += U::width )
+    {
+        typename U::vf lo, hi;
+        U::interleave( U::loadu( z_re + n ), U::loadu( z_im + n ), lo, hi );
+        U::storeu( output + 2*n, lo );
+        U::storeu( output + 2*n + U::width, hi );
+    }
+}
+
+template< class V, class T >
+struct InterleavedSpectrum
+///
+/// Bins of a spectrum as interleaved ( re, im ) pairs, the CCS layout. T is float, or
+/// const float for a spectrum that is only read. A template on V for the same reason as
+/// ScalarLane.
+///
+{
+    explicit InterleavedSpectrum( T* data_ ) : data( data_ ) {}
+
+    template< class U >
+    inline void load( size_t k, typename U::vf& re, typename U::vf& im ) const
+    {
+        U::deinterleave( U::loadu( data + 2*k ), U::loadu( data + 2*k + U::width ), re, im );
+    }
+
+    template< class U >
+    inline void store( size_t k, typename U::vf re, typename U::vf im ) const
+    {
+        typename U::vf lo, hi;
+        U::interleave( re, im, lo, hi );
+        U::storeu( data + 2*k, lo );
+        U::storeu( data + 2*k + U::width, hi );
+    }
+
+    inline float real( size_t k ) const { return data[ 2*k ]; }
+
+    inline void set( size_t k, float re, float im ) const
+    {
+        data[ 2*k ] = re;
+        data[ 2*k + 1 ] = im;
+    }
+
+    T* data;
+};
+
+template< class V, class T >
+struct SplitSpectrum
+///
+/// Bins of a spectrum as separate arrays of real and imaginary parts, which load and store
+/// without any shuffles. A template on V for the same reason as ScalarLane.
+///
+{
+    SplitSpectrum( T* real_, T* imag_ ) : re( real_ ), im( imag_ ) {}
+
+    template< class U >
+    inline void load( size_t k, typename U::vf& re_out, typename U::vf& im_out ) const
+    {
+        re_out = U::loadu( re + k );
+        im_out = U::loadu( im + k );
+    }
+
+    template< class U >
+    inline void store( size_t k, typename U::vf re_in, typename U::vf im_in ) const
+    {
+        U::storeu( re + k, re_in );
+        U::storeu( im + k, im_in );
+    }
+
+    inline float real( size_t k ) const { return re[k]; }
+
+    inline void set( size_t k, float re_in, float im_in ) const
+    {
+        re[k] = re_in;
+        im[k] = im_in;
+    }
+
+    T* re;
+    T* im;
+};
+
+template< class V, class U, class Spectrum >
+void split_forward( size_t M, float scale, const float* w_re, const float* w_im,
+                    const float* z_re, const float* z_im, const Spectrum& output )
+///
+/// Forms bins k and M - k of the real spectrum from bins k and M - k of the half length
+/// complex spectrum, for k in [1, M/2]. Each step handles a vector of k from the front
+/// and the mirrored vector from the back, so U must be no wider than M/2.
+///
+{
+    typedef typename U::vf vf;
+
+    const vf half_scale = U::set1( scale );
+    for( size_t k = 1; k <= M/2; k += U::width )
+    {
+        const size_t j = M - k - ( U::width - 1 );
+
+        const vf a_re = U::loadu( z_re + k );
+        const vf a_im = U::loadu( z_im + k );
+        const vf b_re = U::reverse( U::loadu( z_re + j ) );
+        const vf b_im = U::reverse( U::loadu( z_im + j ) );
+
+        // Even and odd sample spectra: E = ( Z[k] + Z*[M-k] )/2, O = -i( Z[k] - Z*[M-k] )/2.
+        const vf e_re = U::mul( half_scale, U::add( a_re, b_re ) );
+        const vf e_im = U::mul( half_scale, U::sub( a_im, b_im ) );
+        const vf o_re = U::mul( half_scale, U::add( a_im, b_im ) );
+        const vf o_im = U::mul( half_scale, U::sub( b_re, a_re ) );
+
+        vf t_re, t_im;
+        complex_mul< U >( o_re, o_im, U::loadu( w_re + k ), U::loadu( w_im + k ), t_re, t_im );
+
+        // X[k] = E + W^k O and X[M-k] = ( E - W^k O )*.
+        output.template store< U >( k, U::add( e_re, t_re ), U::add( e_im, t_im ) );
+        output.template store< U >( j, U::reverse( U::sub( e_re, t_re ) ), U::reverse( U::sub( t_im, e_im ) ) );
+    }
+}
+
+template< class V, class U, class Spectrum >
+void split_inverse( size_t M, float scale, const float* w_re, const float* w_im,
+                    const Spectrum& input, float* z_re, float* z_im )
+///
+/// The inverse of split_forward: forms bins k and M - k of the half length complex
+/// spectrum from the real spectrum, for k in [1, M/2].
+///
+{
+    typedef typename U::vf vf;
+
+    const vf inverse_scale = U::set1( scale );
+    for( size_t k = 1; k <= M/2; k += U::width )
+    {
+        const size_t j = M - k - ( U::width - 1 );
+
+        vf a_re, a_im, b_re, b_im;
+        input.template load< U >( k, a_re, a_im );
+        input.template load< U >( j, b_re, b_im );
+        b_re = U::reverse( b_re );
+        b_im = U::reverse( b_im );
+
+        // E = X[k] + X*[M-k] and O = ( X[k] - X*[M-k] )W^-k.
+        const vf e_re = U::mul( inverse_scale, U::add( a_re, b_re ) );
+        const vf e_im = U::mul( inverse_scale, U::sub( a_im, b_im ) );
+        const vf d_re = U::mul( inverse_scale, U::sub( a_re, b_re ) );
+        const vf d_im = U::mul( inverse_scale, U::add( a_im, b_im ) );
+        const vf w_k_re = U::loadu( w_re + k );
+        const vf w_k_im = U::loadu( w_im + k );
+        const vf o_re = U::fmadd( d_re, w_k_re, U::mul( d_im, w_k_im ) );
+        const vf o_im = U::sub( U::mul( d_im, w_k_re ), U::mul( d_re, w_k_im ) );
+
+        // Z[k] = E + iO and Z[M-k] = E* + iO*.
+        U::storeu( z_re + k, U::sub( e_re, o_im ) );
+        U::storeu( z_im + k, U::add( e_im, o_re ) );
+        U::storeu( z_re + j, U::reverse( U::add( e_re, o_im ) ) );
+        U::storeu( z_im + j, U::reverse( U::sub( o_re, e_im ) ) );
+    }
+}
+
+template< class V, class Spectrum >
+void real_FFT_forward_to( size_t FFTSize, const float* table, const float* input, const Spectrum& output, float* working_buffer )
+///
+/// Forward real FFT of a power of 2 length of at least 2, from FFTSize floats to the
+/// FFTSize/2 + 1 bins of output, an InterleavedSpectrum or a SplitSpectrum.
+///
+{
+    const size_t M = FFTSize/2;
+    const float* w_re = table + 2;
+    const float* w_im = w_re + M + 1;
+    float* a_re = working_buffer;
+    float* a_im = a_re + M;
+    float* b_re = a_im + M;
+    float* b_im = b_re + M;
+
+    if( M >= V::width )
+    {
+        split_even_odd< V, V >( M, input, a_re, a_im );
+    }
+    else
+    {
+        split_even_odd< V, ScalarLane< V > >( M, input, a_re, a_im );
+    }
+
+    float* z_re;
+    float* z_im;
+    complex_FFT< V >( M, w_im + M + 1, a_re, a_im, b_re, b_im, z_re, z_im );
+
+    // DC and Nyquist are the sum and difference of the even and odd sample sums.
+    const float scale = 2.0f*table[0];
+    output.set( 0, scale*( z_re[0] + z_im[0] ), 0.0f );
+    output.set( M, scale*( z_re[0] - z_im[0] ), 0.0f );
+
+    if( M >= 2*V::width )
+    {
+        split_forward< V, V >( M, table[0], w_re, w_im, z_re, z_im, output );
+    }
+    else
+    {
+        split_forward< V, ScalarLane< V > >( M, table[0], w_re, w_im, z_re, z_im, output );
+    }
+}
+
+template< class V, class Spectrum >
+void real_FFT_inverse_from( size_t FFTSize, const float* table, const Spectrum& input, float* output, float* working_buffer )
+///
+/// Inverse real FFT of a power of 2 length of at least 2, from the FFTSize/2 + 1 bins of
+/// input, an InterleavedSpectrum or a SplitSpectrum, to FFTSize floats. The imaginary parts
+/// of DC and Nyquist are ignored.
+///
+{
+    const size_t M = FFTSize/2;
+    const float* w_re = table + 2;
+    const float* w_im = w_re + M + 1;
+    float* a_re = working_buffer;
+    float* a_im = a_re + M;
+    float* b_re = a_im + M;
+    float* b_im = b_re + M;
+
+    a_re[0] = table[1]*( input.real( 0 ) + input.real( M ) );
+    a_im[0] = table[1]*( input.real( 0 ) - input.real( M ) );
+
+    if( M >= 2*V::width )
+    {
+        split_inverse< V, V >( M, table[1], w_re, w_im, input, a_re, a_im );
+    }
+    else
+    {
+        split_inverse< V, ScalarLane< V > >( M, table[1], w_re, w_im, input, a_re, a_im );
+    }
+
+    // The inverse FFT is the forward FFT with real and imaginary parts swapped on the way
+    // in and out, which for split arrays is just a matter of which pointer is which.
+    float* z_re;
+    float* z_im;
+    complex_FFT< V >( M, w_im + M + 1, a_im, a_re, b_im, b_re, z_im, z_re );
+
+    if( M >= V::width )
+    {
+        merge_even_odd< V, V >( M, z_re, z_im, output );
+    }
+    else
+    {
+        merge_even_odd< V, ScalarLane< V > >( M, z_re, z_im, output );
+    }
+}
+
+template< class V >
+void real_FFT_forward( size_t FFTSize, const float* table, const float* input, float* output, float* working_buffer )
+///
+/// Forward real FFT to FFTSize/2 + 1 interleaved complex values in CCS layout.
+///
+{
+    real_FFT_forward_to< V >( FFTSize, table, input, InterleavedSpectrum< V, float >( output ), working_buffer );
+}
+
+template< class V >
+void real_FFT_inverse( size_t FFTSize, const float* table, const float* input, float* output, float* working_buffer )
+///
+/// Inverse real FFT from FFTSize/2 + 1 interleaved complex values in CCS layout.
+///
+{
+    real_FFT_inverse_from< V >( FFTSize, table, InterleavedSpectrum< V, const float >( input ), output, working_buffer );
+}
+
+template< class V >
+void real_FFT_forward_split( size_t FFTSize, const float* table, const float* input, float* output_real,
+                             float* output_imag, float* working_buffer )
+///
+/// Forward real FFT to FFTSize/2 + 1 bins held as separate real and imaginary arrays.
+///
+{
+    real_FFT_forward_to< V >( FFTSize, table, input, SplitSpectrum< V, float >( output_real, output_imag ), working_buffer );
+}
+
+template< class V >
+void real_FFT_inverse_split( size_t FFTSize, const float* table, const float* input_real, const float* input_imag,
+                             float* output, float* working_buffer )
+///
+/// Inverse real FFT from FFTSize/2 + 1 bins held as separate real and imaginary arrays.
+///
+{
+    real_FFT_inverse_from< V >( FFTSize, table, SplitSpectrum< V, const float >( input_real, input_imag ), output, working_buffer );
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_FFT_KERNELS_H
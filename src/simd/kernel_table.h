@@ -0,0 +1,175 @@
+//
+// Function pointer table through which the SIMD backend reaches its kernels.
+//
+
+#ifndef CUPCAKE_VEC_LIB_KERNEL_TABLE_H
+#define CUPCAKE_VEC_LIB_KERNEL_TABLE_H
+
+// In module includes
+#include "FFT.h"
+#include "dispatch.h"
+#include "vector_functions.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <atomic>
+#include <complex>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+///
+/// One entry per dispatched veclib function, each with the same signature as the
+/// public function it implements, plus the native FFT, FIR, IIR, oscillator and random number
+/// kernels used by FFT.cpp, FIR.cpp, IIR.cpp, sig_gen.cpp and rng.cpp.
+///
+struct KernelTable
+{
+    ISA isa;
+
+    void ( *vec_mult_const_in_place )( float*, float, size_t );
+    void ( *vec_mult )( const float*, const float*, float*, size_t );
+    void ( *vec_mult_in_place )( const float*, float*, size_t );
+    void ( *vec_add_constant )( float*, float, size_t );
+    void ( *vec_add_in_place )( const float*, float*, size_t );
+    void ( *vec_sub_constant )( float*, float, size_t );
+    void ( *vec_sub )( const float*, const float*, float*, size_t );
+    void ( *vec_sub_in_place )( float*, const float*, size_t );
+    void ( *vec_negative_halfwave_rectify )( float*, size_t );
+    void ( *vec_zero_magnitudes_greater_than_abs )( float*, float, size_t );
+    void ( *vec_zero_values_less_than )( float*, float, size_t );
+    void ( *vec_fractional_part )( const float*, float*, size_t );
+    void ( *vec_zero )( float*, size_t );
+
+    // Double precision versions of the above, run on V::Double.
+    void ( *vec_mult_const_in_place_double )( double*, double, size_t );
+    void ( *vec_mult_double )( const double*, const double*, double*, size_t );
+    void ( *vec_mult_in_place_double )( const double*, double*, size_t );
+    void ( *vec_add_constant_double )( double*, double, size_t );
+    void ( *vec_add_in_place_double )( const double*, double*, size_t );
+    void ( *vec_sub_constant_double )( double*, double, size_t );
+    void ( *vec_sub_double )( const double*, const double*, double*, size_t );
+    void ( *vec_sub_in_place_double )( double*, const double*, size_t );
+    void ( *vec_negative_halfwave_rectify_double )( double*, size_t );
+    void ( *vec_zero_magnitudes_greater_than_abs_double )( double*, double, size_t );
+    void ( *vec_zero_values_less_than_double )( double*, double, size_t );
+    void ( *vec_fractional_part_double )( const double*, double*, size_t );
+    void ( *vec_zero_double )( double*, size_t );
+
+    // 16-bit integer conversions and fused convert-and-process operations. See vector_functions.h.
+    void ( *vec_convert_from_s16 )( const int16_t*, float*, float, size_t );
+    void ( *vec_convert_to_s16 )( const float*, int16_t*, float, size_t );
+    void ( *vec_mult_s16 )( const int16_t*, float, const float*, float*, size_t );
+    void ( *vec_add_in_place_s16 )( const int16_t*, float, float*, size_t );
+
+    // Reductions, in single then double precision. Length is at least 1 for min, max and mean_variance.
+    float ( *vec_sum )( const float*, size_t, SumAccuracy );
+    float ( *vec_dot )( const float*, const float*, size_t, SumAccuracy );
+    float ( *vec_norm_l1 )( const float*, size_t, SumAccuracy );
+    float ( *vec_norm_l2 )( const float*, size_t, SumAccuracy );
+    float ( *vec_min )( const float*, size_t, size_t* );
+    float ( *vec_max )( const float*, size_t, size_t* );
+    void ( *vec_mean_variance )( const float*, size_t, float*, float*, SumAccuracy );
+    float ( *vec_weighted_mean )( const float*, const float*, size_t, SumAccuracy );
+    double ( *vec_sum_double )( const double*, size_t, SumAccuracy );
+    double ( *vec_dot_double )( const double*, const double*, size_t, SumAccuracy );
+    double ( *vec_norm_l1_double )( const double*, size_t, SumAccuracy );
+    double ( *vec_norm_l2_double )( const double*, size_t, SumAccuracy );
+    double ( *vec_min_double )( const double*, size_t, size_t* );
+    double ( *vec_max_double )( const double*, size_t, size_t* );
+    void ( *vec_mean_variance_double )( const double*, size_t, double*, double*, SumAccuracy );
+    double ( *vec_weighted_mean_double )( const double*, const double*, size_t, SumAccuracy );
+
+    // Input, window, output, length, gain. See window_functions.h.
+    void ( *apply_window )( const float*, const float*, float*, size_t, float );
+
+    void ( *spectral_magnitude )( const std::complex< float >*, float*, size_t );
+    void ( *phase_spectra )( const std::complex< float >*, float*, size_t, SpectralAccuracy );
+    void ( *cart_to_polar )( const std::complex< float >*, float*, float*, size_t, SpectralAccuracy );
+    void ( *spectral_mult )( const std::complex< float >*, const std::complex< float >*, std::complex< float >*, size_t );
+    void ( *spectral_mult_accumulate )( const std::complex< float >*, const std::complex< float >*, std::complex< float >*, size_t );
+    void ( *spectral_conj_mult )( const std::complex< float >*, const std::complex< float >*, std::complex< float >*, size_t );
+    void ( *spectral_conj_mult_accumulate )( const std::complex< float >*, const std::complex< float >*, std::complex< float >*, size_t );
+    void ( *spectral_power )( const std::complex< float >*, float*, size_t );
+    void ( *spectral_power_dB )( const std::complex< float >*, float*, size_t, float );   // -> Takes the floor as a power, not in dB.
+    void ( *polar_to_cart )( const float*, const float*, std::complex< float >*, size_t );
+    void ( *spectral_magnitude_split )( const float*, const float*, float*, size_t );
+    void ( *phase_spectra_split )( const float*, const float*, float*, size_t, SpectralAccuracy );
+    void ( *cart_to_polar_split )( const float*, const float*, float*, float*, size_t, SpectralAccuracy );
+    void ( *deinterleave_complex )( const std::complex< float >*, float*, float*, size_t );
+    void ( *interleave_complex )( const float*, const float*, std::complex< float >*, size_t );
+    // Double precision spectral_magnitude, phase_spectra and cart_to_polar, run on V::Double at full accuracy.
+    void ( *spectral_magnitude_double )( const std::complex< double >*, double*, size_t );
+    void ( *phase_spectra_double )( const std::complex< double >*, double*, size_t );
+    void ( *cart_to_polar_double )( const std::complex< double >*, double*, double*, size_t );
+
+    // FIR filtering: history, reversed taps, output, length, taps; then delay line, filters,
+    // swapped filters, output, bins, partitions, newest. See convolution_kernels.h.
+    void ( *fir_direct )( const float*, const float*, float*, size_t, size_t );
+    void ( *convolve_partitions )( const float*, const float*, const float*, float*, size_t, size_t, size_t );
+
+    // IIR filtering: input, output, frames, channels, sections, row length, coefficients,
+    // coefficient steps or NULL when not ramping, state, scratch. See biquad_kernels.h.
+    void ( *biquad_cascade )( const float*, float*, size_t, size_t, size_t, size_t, float*, const float*, float*, float* );
+
+    // Native FFT: FFTSize, twiddle table, input, output, working buffer, with the spectrum
+    // either interleaved or as real and imaginary arrays. See fft_kernels.h.
+    void ( *real_FFT_forward )( size_t, const float*, const float*, float*, float* );
+    void ( *real_FFT_inverse )( size_t, const float*, const float*, float*, float* );
+    void ( *real_FFT_forward_split )( size_t, const float*, const float*, float*, float*, float* );
+    void ( *real_FFT_inverse_split )( size_t, const float*, const float*, const float*, float*, float* );
+
+    // Signal generation: output, length, start cycles, start frequency, chirp rate, magnitude, offset.
+    // See oscillator_kernels.h.
+    void ( *cosine_oscillator )( float*, size_t, double, double, double, float, float );
+
+    // Random numbers: seed, stream, first sample, output, length, then minimum and maximum or
+    // mean and deviation. See random_kernels.h.
+    void ( *random_uniform )( uint64_t, uint64_t, uint64_t, float*, size_t, float, float );
+    void ( *random_gaussian )( uint64_t, uint64_t, uint64_t, float*, size_t, float, float );
+};
+
+///
+/// Tables for each instruction set. Only those for the target architecture are defined.
+///
+const KernelTable& scalar_kernel_table();
+const KernelTable& sse2_kernel_table();
+const KernelTable& avx2_kernel_table();
+const KernelTable& avx512_kernel_table();
+const KernelTable& neon_kernel_table();
+
+extern std::atomic< const KernelTable* > active_kernel_table;
+
+const KernelTable& resolve_kernel_table();
+
+inline const KernelTable& kernels()
+///
+/// Returns the table for the active instruction set, detecting it on the first call.
+///
+{
+    // Tables are constant-initialised statics, so a relaxed load always sees a complete table.
+    const KernelTable* table = active_kernel_table.load( std::memory_order_relaxed );
+    if( table == NULL )
+    {
+        return resolve_kernel_table();
+    }
+    return *table;
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_KERNEL_TABLE_H
@@ -0,0 +1,601 @@
+//
+// Builds a KernelTable from the kernel templates for a given ISA.
+//
+// Include this only from a kernels_<isa>.cpp file, after that file has set the
+// compiler's target for the instruction set.
+//
+
+#ifndef CUPCAKE_VEC_LIB_KERNEL_TABLE_IMPL_H
+#define CUPCAKE_VEC_LIB_KERNEL_TABLE_IMPL_H
+
+// In module includes
+#include "biquad_kernels.h"
+#include "convolution_kernels.h"
+#include "fft_kernels.h"
+#include "kernel_table.h"
+#include "oscillator_kernels.h"
+#include "random_kernels.h"
+#include "reduction_kernels.h"
+#include "spectral_kernels.h"
+#include "vector_kernels.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <complex>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+template< class V >
+struct Kernels
+{
+    typedef typename V::Double D;
+
+    static void vec_mult_const_in_place( float* input1, float multiplier, size_t length )
+    {
+        map_unary< V >( input1, input1, length, MulConst< V >( multiplier ) );
+    }
+
+    static void vec_mult( const float* input1, const float* input2, float* output, size_t length )
+    {
+        map_binary< V >( input1, input2, output, length, Mul< V >() );
+    }
+
+    static void vec_mult_in_place( const float* input1, float* input2, size_t length )
+    {
+        map_binary< V >( input1, input2, input2, length, Mul< V >() );
+    }
+
+    static void vec_add_constant( float* input1, float constant, size_t length )
+    {
+        map_unary< V >( input1, input1, length, AddConst< V >( constant ) );
+    }
+
+    static void vec_add_in_place( const float* input1, float* input2_output, size_t length )
+    {
+        map_binary< V >( input1, input2_output, input2_output, length, Add< V >() );
+    }
+
+    static void vec_sub_constant( float* input, float constant, size_t length )
+    {
+        map_unary< V >( input, input, length, AddConst< V >( -constant ) );
+    }
+
+    static void vec_sub( const float* input1, const float* input2, float* output, size_t length )
+    {
+        map_binary< V >( input1, input2, output, length, Sub< V >() );
+    }
+
+    static void vec_sub_in_place( float* input1, const float* input2, size_t length )
+    {
+        map_binary< V >( input1, input2, input1, length, Sub< V >() );
+    }
+
+    static void vec_negative_halfwave_rectify( float* input, size_t length )
+    {
+        map_unary< V >( input, input, length, MinConst< V >( 0.0f ) );
+    }
+
+    static void vec_zero_magnitudes_greater_than_abs( float* input, float threshold, size_t length )
+    {
+        map_unary< V >( input, input, length, ZeroAbsGreaterThan< V >( threshold ) );
+    }
+
+    static void vec_zero_values_less_than( float* input, float threshold, size_t length )
+    {
+        map_unary< V >( input, input, length, ZeroLessThan< V >( threshold ) );
+    }
+
+    static void vec_fractional_part( const float* input, float* output, size_t length )
+    {
+        map_unary< V >( input, output, length, FractionalPart< V >() );
+    }
+
+    static void vec_zero( float* vec, size_t length )
+    {
+        fill< V >( vec, 0.0f, length );
+    }
+
+    static void vec_mult_const_in_place_double( double* input1, double multiplier, size_t length )
+    {
+        map_unary< D >( input1, input1, length, MulConst< D >( multiplier ) );
+    }
+
+    static void vec_mult_double( const double* input1, const double* input2, double* output, size_t length )
+    {
+        map_binary< D >( input1, input2, output, length, Mul< D >() );
+    }
+
+    static void vec_mult_in_place_double( const double* input1, double* input2, size_t length )
+    {
+        map_binary< D >( input1, input2, input2, length, Mul< D >() );
+    }
+
+    static void vec_add_constant_double( double* input1, double constant, size_t length )
+    {
+        map_unary< D >( input1, input1, length, AddConst< D >( constant ) );
+    }
+
+    static void vec_add_in_place_double( const double* input1, double* input2_output, size_t length )
+    {
+        map_binary< D >( input1, input2_output, input2_output, length, Add< D >() );
+    }
+
+    static void vec_sub_constant_double( double* input, double constant, size_t length )
+    {
+        map_unary< D >( input, input, length, AddConst< D >( -constant ) );
+    }
+
+    static void vec_sub_double( const double* input1, const double* input2, double* output, size_t length )
+    {
+        map_binary< D >( input1, input2, output, length, Sub< D >() );
+    }
+
+    static void vec_sub_in_place_double( double* input1, const double* input2, size_t length )
+    {
+        map_binary< D >( input1, input2, input1, length, Sub< D >() );
+    }
+
+    static void vec_negative_halfwave_rectify_double( double* input, size_t length )
+    {
+        map_unary< D >( input, input, length, MinConst< D >( 0.0 ) );
+    }
+
+    static void vec_zero_magnitudes_greater_than_abs_double( double* input, double threshold, size_t length )
+    {
+        map_unary< D >( input, input, length, ZeroAbsGreaterThan< D >( threshold ) );
+    }
+
+    static void vec_zero_values_less_than_double( double* input, double threshold, size_t length )
+    {
+        map_unary< D >( input, input, length, ZeroLessThan< D >( threshold ) );
+    }
+
+    static void vec_fractional_part_double( const double* input, double* output, size_t length )
+    {
+        map_unary< D >( input, output, length, FractionalPart< D >() );
+    }
+
+    static void vec_zero_double( double* vec, size_t length )
+    {
+        fill< D >( vec, 0.0, length );
+    }
+
+    static void vec_convert_from_s16( const int16_t* input, float* output, float scale, size_t length )
+    {
+        map_from_s16< V >( input, output, length, MulConst< V >( scale ) );
+    }
+
+    static void vec_convert_to_s16( const float* input, int16_t* output, float scale, size_t length )
+    {
+        convert_to_s16< V >( input, output, scale, length );
+    }
+
+    static void vec_mult_s16( const int16_t* input1, float scale, const float* input2, float* output, size_t length )
+    {
+        map_binary_s16< V >( input1, input2, output, length, MulScaled< V >( scale ) );
+    }
+
+    static void vec_add_in_place_s16( const int16_t* input1, float scale, float* input2_output, size_t length )
+    {
+        map_binary_s16< V >( input1, input2_output, input2_output, length, AddScaled< V >( scale ) );
+    }
+
+    static float vec_sum( const float* input, size_t length, SumAccuracy accuracy )
+    {
+        return simd::sum< V >( input, length, accuracy );
+    }
+
+    static float vec_dot( const float* input1, const float* input2, size_t length, SumAccuracy accuracy )
+    {
+        return simd::dot< V >( input1, input2, length, accuracy );
+    }
+
+    static float vec_norm_l1( const float* input, size_t length, SumAccuracy accuracy )
+    {
+        return simd::norm_l1< V >( input, length, accuracy );
+    }
+
+    static float vec_norm_l2( const float* input, size_t length, SumAccuracy accuracy )
+    {
+        return simd::norm_l2< V >( input, length, accuracy );
+    }
+
+    static float vec_min( const float* input, size_t length, size_t* index )
+    {
+        float value;
+        const size_t found = find_extreme< V, Smallest< V > >( input, length, &value );
+        if( index )
+        {
+            *index = found;
+        }
+        return value;
+    }
+
+    static float vec_max( const float* input, size_t length, size_t* index )
+    {
+        float value;
+        const size_t found = find_extreme< V, Largest< V > >( input, length, &value );
+        if( index )
+        {
+            *index = found;
+        }
+        return value;
+    }
+
+    static void vec_mean_variance( const float* input, size_t length, float* mean, float* variance, SumAccuracy accuracy )
+    {
+        simd::mean_variance< V >( input, length, mean, variance, accuracy );
+    }
+
+    static float vec_weighted_mean( const float* values, const float* weights, size_t length, SumAccuracy accuracy )
+    {
+        return simd::weighted_mean< V >( values, weights, length, accuracy );
+    }
+
+    static double vec_sum_double( const double* input, size_t length, SumAccuracy accuracy )
+    {
+        return simd::sum< D >( input, length, accuracy );
+    }
+
+    static double vec_dot_double( const double* input1, const double* input2, size_t length, SumAccuracy accuracy )
+    {
+        return simd::dot< D >( input1, input2, length, accuracy );
+    }
+
+    static double vec_norm_l1_double( const double* input, size_t length, SumAccuracy accuracy )
+    {
+        return simd::norm_l1< D >( input, length, accuracy );
+    }
+
+    static double vec_norm_l2_double( const double* input, size_t length, SumAccuracy accuracy )
+    {
+        return simd::norm_l2< D >( input, length, accuracy );
+    }
+
+    static double vec_min_double( const double* input, size_t length, size_t* index )
+    {
+        double value;
+        const size_t found = find_extreme< D, Smallest< D > >( input, length, &value );
+        if( index )
+        {
+            *index = found;
+        }
+        return value;
+    }
+
+    static double vec_max_double( const double* input, size_t length, size_t* index )
+    {
+        double value;
+        const size_t found = find_extreme< D, Largest< D > >( input, length, &value );
+        if( index )
+        {
+            *index = found;
+        }
+        return value;
+    }
+
+    static void vec_mean_variance_double( const double* input, size_t length, double* mean, double* variance, SumAccuracy accuracy )
+    {
+        simd::mean_variance< D >( input, length, mean, variance, accuracy );
+    }
+
+    static double vec_weighted_mean_double( const double* values, const double* weights, size_t length, SumAccuracy accuracy )
+    {
+        return simd::weighted_mean< D >( values, weights, length, accuracy );
+    }
+
+    static void apply_window( const float* input, const float* window, float* output, size_t length, float gain )
+    {
+        map_binary< V >( input, window, output, length, MulScaled< V >( gain ) );
+    }
+
+    static void spectral_magnitude( const std::complex< float >* input, float* output, size_t length )
+    {
+        simd::spectral_magnitude< V >( reinterpret_cast< const float* >( input ), output, length );
+    }
+
+    static void phase_spectra( const std::complex< float >* input, float* output, size_t length, SpectralAccuracy accuracy )
+    {
+        const float* floats = reinterpret_cast< const float* >( input );
+        switch( accuracy )
+        {
+            case SpectralAccuracy::medium:
+                simd::phase_spectra< V, MediumAtan2< V > >( floats, output, length );
+                break;
+            case SpectralAccuracy::fast:
+                simd::phase_spectra< V, FastAtan2< V > >( floats, output, length );
+                break;
+            case SpectralAccuracy::full:
+            default:
+                simd::phase_spectra< V, FullAtan2< V > >( floats, output, length );
+                break;
+        }
+    }
+
+    static void cart_to_polar( const std::complex< float >* input, float* magnitude, float* phase, size_t length, SpectralAccuracy accuracy )
+    {
+        const float* floats = reinterpret_cast< const float* >( input );
+        switch( accuracy )
+        {
+            case SpectralAccuracy::medium:
+                simd::cart_to_polar< V, MediumAtan2< V > >( floats, magnitude, phase, length );
+                break;
+            case SpectralAccuracy::fast:
+                simd::cart_to_polar< V, FastAtan2< V > >( floats, magnitude, phase, length );
+                break;
+            case SpectralAccuracy::full:
+            default:
+                simd::cart_to_polar< V, FullAtan2< V > >( floats, magnitude, phase, length );
+                break;
+        }
+    }
+
+    static void spectral_mult( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* output, size_t length )
+    {
+        simd::map_complex_binary< V, ComplexMul< V >, false >( reinterpret_cast< const float* >( input1 ), reinterpret_cast< const float* >( input2 ),
+                                                              reinterpret_cast< float* >( output ), length );
+    }
+
+    static void spectral_mult_accumulate( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* accumulator, size_t length )
+    {
+        simd::map_complex_binary< V, ComplexMul< V >, true >( reinterpret_cast< const float* >( input1 ), reinterpret_cast< const float* >( input2 ),
+                                                             reinterpret_cast< float* >( accumulator ), length );
+    }
+
+    static void spectral_conj_mult( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* output, size_t length )
+    {
+        simd::map_complex_binary< V, ConjugateMul< V >, false >( reinterpret_cast< const float* >( input1 ), reinterpret_cast< const float* >( input2 ),
+                                                                reinterpret_cast< float* >( output ), length );
+    }
+
+    static void spectral_conj_mult_accumulate( const std::complex< float >* input1, const std::complex< float >* input2, std::complex< float >* accumulator, size_t length )
+    {
+        simd::map_complex_binary< V, ConjugateMul< V >, true >( reinterpret_cast< const float* >( input1 ), reinterpret_cast< const float* >( input2 ),
+                                                               reinterpret_cast< float* >( accumulator ), length );
+    }
+
+    static void spectral_power( const std::complex< float >* input, float* output, size_t length )
+    {
+        simd::spectral_power< V >( reinterpret_cast< const float* >( input ), output, length );
+    }
+
+    static void spectral_power_dB( const std::complex< float >* input, float* output, size_t length, float floor_power )
+    {
+        simd::spectral_power_dB< V >( reinterpret_cast< const float* >( input ), output, length, floor_power );
+    }
+
+    static void polar_to_cart( const float* magnitude, const float* phase, std::complex< float >* output, size_t length )
+    {
+        simd::polar_to_cart< V >( magnitude, phase, reinterpret_cast< float* >( output ), length );
+    }
+
+    static void spectral_magnitude_split( const float* real, const float* imag, float* output, size_t length )
+    {
+        simd::spectral_magnitude_split< V >( real, imag, output, length );
+    }
+
+    static void phase_spectra_split( const float* real, const float* imag, float* output, size_t length, SpectralAccuracy accuracy )
+    {
+        switch( accuracy )
+        {
+            case SpectralAccuracy::medium:
+                simd::phase_spectra_split< V, MediumAtan2< V > >( real, imag, output, length );
+                break;
+            case SpectralAccuracy::fast:
+                simd::phase_spectra_split< V, FastAtan2< V > >( real, imag, output, length );
+                break;
+            case SpectralAccuracy::full:
+            default:
+                simd::phase_spectra_split< V, FullAtan2< V > >( real, imag, output, length );
+                break;
+        }
+    }
+
+    static void cart_to_polar_split( const float* real, const float* imag, float* magnitude, float* phase, size_t length, SpectralAccuracy accuracy )
+    {
+        switch( accuracy )
+        {
+            case SpectralAccuracy::medium:
+                simd::cart_to_polar_split< V, MediumAtan2< V > >( real, imag, magnitude, phase, length );
+                break;
+            case SpectralAccuracy::fast:
+                simd::cart_to_polar_split< V, FastAtan2< V > >( real, imag, magnitude, phase, length );
+                break;
+            case SpectralAccuracy::full:
+            default:
+                simd::cart_to_polar_split< V, FullAtan2< V > >( real, imag, magnitude, phase, length );
+                break;
+        }
+    }
+
+    static void deinterleave_complex( const std::complex< float >* input, float* real, float* imag, size_t length )
+    {
+        simd::deinterleave_complex< V >( reinterpret_cast< const float* >( input ), real, imag, length );
+    }
+
+    static void interleave_complex( const float* real, const float* imag, std::complex< float >* output, size_t length )
+    {
+        simd::interleave_complex< V >( real, imag, reinterpret_cast< float* >( output ), length );
+    }
+
+    static void spectral_magnitude_double( const std::complex< double >* input, double* output, size_t length )
+    {
+        simd::spectral_magnitude< D >( reinterpret_cast< const double* >( input ), output, length );
+    }
+
+    static void phase_spectra_double( const std::complex< double >* input, double* output, size_t length )
+    {
+        simd::phase_spectra< D, DoubleAtan2< D > >( reinterpret_cast< const double* >( input ), output, length );
+    }
+
+    static void cart_to_polar_double( const std::complex< double >* input, double* magnitude, double* phase, size_t length )
+    {
+        simd::cart_to_polar< D, DoubleAtan2< D > >( reinterpret_cast< const double* >( input ), magnitude, phase, length );
+    }
+
+    static void fir_direct( const float* history, const float* reversed_taps, float* output, size_t length, size_t taps )
+    {
+        simd::fir_direct< V >( history, reversed_taps, output, length, taps );
+    }
+
+    static void convolve_partitions( const float* delay_line, const float* filters, const float* swapped_filters,
+                                     float* output, size_t bins, size_t partitions, size_t newest )
+    {
+        simd::convolve_partitions< V >( delay_line, filters, swapped_filters, output, bins, partitions, newest );
+    }
+
+    static void biquad_cascade( const float* input, float* output, size_t frames, size_t channels, size_t sections,
+                                size_t row_length, float* coefficients, const float* steps, float* state, float* scratch )
+    {
+        if( steps != NULL )
+        {
+            simd::biquad_cascade< V, true >( input, output, frames, channels, sections, row_length, coefficients, steps, state, scratch );
+        }
+        else
+        {
+            simd::biquad_cascade< V, false >( input, output, frames, channels, sections, row_length, coefficients, steps, state, scratch );
+        }
+    }
+
+    static void real_FFT_forward( size_t FFTSize, const float* table, const float* input, float* output, float* working_buffer )
+    {
+        simd::real_FFT_forward< V >( FFTSize, table, input, output, working_buffer );
+    }
+
+    static void real_FFT_inverse( size_t FFTSize, const float* table, const float* input, float* output, float* working_buffer )
+    {
+        simd::real_FFT_inverse< V >( FFTSize, table, input, output, working_buffer );
+    }
+
+    static void real_FFT_forward_split( size_t FFTSize, const float* table, const float* input, float* output_real,
+                                        float* output_imag, float* working_buffer )
+    {
+        simd::real_FFT_forward_split< V >( FFTSize, table, input, output_real, output_imag, working_buffer );
+    }
+
+    static void real_FFT_inverse_split( size_t FFTSize, const float* table, const float* input_real, const float* input_imag,
+                                        float* output, float* working_buffer )
+    {
+        simd::real_FFT_inverse_split< V >( FFTSize, table, input_real, input_imag, output, working_buffer );
+    }
+
+    static void cosine_oscillator( float* output, size_t length, double start_cycles, double start_frequency,
+                                   double chirp_rate, float magnitude, float offset )
+    {
+        simd::cosine_oscillator< V >( output, length, start_cycles, start_frequency, chirp_rate, magnitude, offset );
+    }
+
+    static void random_uniform( uint64_t key, uint64_t stream, uint64_t first_sample, float* output, size_t length,
+                                float minimum, float maximum )
+    {
+        simd::random_uniform< V >( key, stream, first_sample, output, length, minimum, maximum );
+    }
+
+    static void random_gaussian( uint64_t key, uint64_t stream, uint64_t first_sample, float* output, size_t length,
+                                 float mean, float deviation )
+    {
+        simd::random_gaussian< V >( key, stream, first_sample, output, length, mean, deviation );
+    }
+
+    static const KernelTable table;
+};
+
+template< class V >
+const KernelTable Kernels< V >::table =
+{
+    V::isa,
+    &Kernels< V >::vec_mult_const_in_place,
+    &Kernels< V >::vec_mult,
+    &Kernels< V >::vec_mult_in_place,
+    &Kernels< V >::vec_add_constant,
+    &Kernels< V >::vec_add_in_place,
+    &Kernels< V >::vec_sub_constant,
+    &Kernels< V >::vec_sub,
+    &Kernels< V >::vec_sub_in_place,
+    &Kernels< V >::vec_negative_halfwave_rectify,
+    &Kernels< V >::vec_zero_magnitudes_greater_than_abs,
+    &Kernels< V >::vec_zero_values_less_than,
+    &Kernels< V >::vec_fractional_part,
+    &Kernels< V >::vec_zero,
+    &Kernels< V >::vec_mult_const_in_place_double,
+    &Kernels< V >::vec_mult_double,
+    &Kernels< V >::vec_mult_in_place_double,
+    &Kernels< V >::vec_add_constant_double,
+    &Kernels< V >::vec_add_in_place_double,
+    &Kernels< V >::vec_sub_constant_double,
+    &Kernels< V >::vec_sub_double,
+    &Kernels< V >::vec_sub_in_place_double,
+    &Kernels< V >::vec_negative_halfwave_rectify_double,
+    &Kernels< V >::vec_zero_magnitudes_greater_than_abs_double,
+    &Kernels< V >::vec_zero_values_less_than_double,
+    &Kernels< V >::vec_fractional_part_double,
+    &Kernels< V >::vec_zero_double,
+    &Kernels< V >::vec_convert_from_s16,
+    &Kernels< V >::vec_convert_to_s16,
+    &Kernels< V >::vec_mult_s16,
+    &Kernels< V >::vec_add_in_place_s16,
+    &Kernels< V >::vec_sum,
+    &Kernels< V >::vec_dot,
+    &Kernels< V >::vec_norm_l1,
+    &Kernels< V >::vec_norm_l2,
+    &Kernels< V >::vec_min,
+    &Kernels< V >::vec_max,
+    &Kernels< V >::vec_mean_variance,
+    &Kernels< V >::vec_weighted_mean,
+    &Kernels< V >::vec_sum_double,
+    &Kernels< V >::vec_dot_double,
+    &Kernels< V >::vec_norm_l1_double,
+    &Kernels< V >::vec_norm_l2_double,
+    &Kernels< V >::vec_min_double,
+    &Kernels< V >::vec_max_double,
+    &Kernels< V >::vec_mean_variance_double,
+    &Kernels< V >::vec_weighted_mean_double,
+    &Kernels< V >::apply_window,
+    &Kernels< V >::spectral_magnitude,
+    &Kernels< V >::phase_spectra,
+    &Kernels< V >::cart_to_polar,
+    &Kernels< V >::spectral_mult,
+    &Kernels< V >::spectral_mult_accumulate,
+    &Kernels< V >::spectral_conj_mult,
+    &Kernels< V >::spectral_conj_mult_accumulate,
+    &Kernels< V >::spectral_power,
+    &Kernels< V >::spectral_power_dB,
+    &Kernels< V >::polar_to_cart,
+    &Kernels< V >::spectral_magnitude_split,
+    &Kernels< V >::phase_spectra_split,
+    &Kernels< V >::cart_to_polar_split,
+    &Kernels< V >::deinterleave_complex,
+    &Kernels< V >::interleave_complex,
+    &Kernels< V >::spectral_magnitude_double,
+    &Kernels< V >::phase_spectra_double,
+    &Kernels< V >::cart_to_polar_double,
+    &Kernels< V >::fir_direct,
+    &Kernels< V >::convolve_partitions,
+    &Kernels< V >::biquad_cascade,
+    &Kernels< V >::real_FFT_forward,
+    &Kernels< V >::real_FFT_inverse,
+    &Kernels< V >::real_FFT_forward_split,
+    &Kernels< V >::real_FFT_inverse_split,
+    &Kernels< V >::cosine_oscillator,
+    &Kernels< V >::random_uniform,
+    &Kernels< V >::random_gaussian,
+};
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_KERNEL_TABLE_IMPL_H
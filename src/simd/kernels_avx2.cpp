@@ -0,0 +1,76 @@
+//
+// AVX2 + FMA kernel table for the SIMD backend.
+//
+
+// In Module includes
+#include "kernel_table.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+
+// Everything from here on is compiled for the target ISA regardless of the command line flags.
+// Std Lib headers must be included above this point so none of their inline code is built for it.
+#if defined( __clang__ )
+#pragma clang attribute push( __attribute__(( target( "avx2,fma" ) )), apply_to = function )
+#elif defined( __GNUC__ )
+#pragma GCC push_options
+#pragma GCC target( "avx2,fma" )
+#endif
+
+#include "simd_avx2.h"
+#include "kernel_table_impl.h"
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+template struct Kernels< AVX2 >;
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#if defined( __clang__ )
+#pragma clang attribute pop
+#elif defined( __GNUC__ )
+#pragma GCC pop_options
+#endif
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+const KernelTable& avx2_kernel_table()
+{
+    return Kernels< AVX2 >::table;
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
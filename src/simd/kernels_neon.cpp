@@ -0,0 +1,41 @@
+//
+// NEON kernel table for the SIMD backend.
+//
+
+// In Module includes
+#include "kernel_table.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+// None.
+
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+
+#include "simd_neon.h"
+#include "kernel_table_impl.h"
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+template struct Kernels< NEON >;
+
+const KernelTable& neon_kernel_table()
+{
+    return Kernels< NEON >::table;
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // defined( __ARM_NEON ) || defined( __ARM_NEON__ )
@@ -0,0 +1,36 @@
+//
+// Scalar kernel table for the SIMD backend. Always built, so there is a table on every architecture.
+//
+
+// In Module includes
+#include "kernel_table.h"
+#include "simd_scalar.h"
+#include "kernel_table_impl.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+// None.
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+template struct Kernels< Scalar >;
+
+const KernelTable& scalar_kernel_table()
+{
+    return Kernels< Scalar >::table;
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
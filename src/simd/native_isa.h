@@ -0,0 +1,54 @@
+//
+// Picks the ISA traits matching the compiler's target flags, for code that is
+// compiled into the caller rather than dispatched at runtime.
+//
+
+#ifndef CUPCAKE_VEC_LIB_NATIVE_ISA_H
+#define CUPCAKE_VEC_LIB_NATIVE_ISA_H
+
+// In module includes
+#include "simd_scalar.h"
+#if defined( __AVX512F__ )
+#include "simd_avx512.h"
+#elif defined( __AVX2__ ) && defined( __FMA__ )
+#include "simd_avx2.h"
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include "simd_sse2.h"
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#include "simd_neon.h"
+#endif
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+// None.
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+#if defined( __AVX512F__ )
+typedef AVX512 NativeISA;
+#elif defined( __AVX2__ ) && defined( __FMA__ )
+typedef AVX2 NativeISA;
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+typedef SSE2 NativeISA;
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+typedef NEON NativeISA;
+#else
+typedef Scalar NativeISA;
+#endif
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_NATIVE_ISA_H
@@ -0,0 +1,172 @@
+//
+// SIMD kernels for generating sinusoids and linear chirps.
+//
+
+#ifndef CUPCAKE_VEC_LIB_OSCILLATOR_KERNELS_H
+#define CUPCAKE_VEC_LIB_OSCILLATOR_KERNELS_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <cmath>
+#include <stdlib.h>
+#include <string.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+//
+// Each lane of a vector holds the phasor exp( i 2 pi cycles( n ) ) of one of V::width
+// consecutive samples. Stepping a block forward is a complex multiply by each lane's step
+// phasor, which for a chirp is itself advanced by a constant phasor. Rounding errors in
+// that recursion would build up without bound, so every restart_vectors steps the phasors
+// are recomputed from the exact phase, evaluated in double precision. The phase error
+// therefore stays at the level of a few float roundings however long the signal runs.
+//
+
+template< class V >
+inline void sincos_cycles( typename V::vf x, typename V::vf& sin_out, typename V::vf& cos_out )
+///
+/// Computes sin( 2 pi x ) and cos( 2 pi x ) for x in [-0.5,0.5] cycles, to within a few
+/// ulps, using the Cephes sinf/cosf polynomials on [-pi/4,pi/4].
+///
+{
+    typedef typename V::vf vf;
+
+    const vf negative_zero = V::set1( -0.0f );
+
+    // Split x into quarter cycles q in { -2, ..., 2 } and a remainder in [-1/8,1/8] cycles.
+    vf y = V::mul( x, V::set1( 4.0f ) );
+    vf q = V::trunc( V::add( y, V::xor_bits( V::set1( 0.5f ), V::sign( y ) ) ) );
+    vf theta = V::mul( V::sub( y, q ), V::set1( 1.57079632679f ) );
+    vf z = V::mul( theta, theta );
+
+    vf s = V::fmadd( V::set1( -1.9515295891e-4f ), z, V::set1( 8.3321608736e-3f ) );
+    s = V::fmadd( s, z, V::set1( -1.6666654611e-1f ) );
+    s = V::fmadd( V::mul( s, z ), theta, theta );
+
+    vf c = V::fmadd( V::set1( 2.443315711809948e-5f ), z, V::set1( -1.388731625493765e-3f ) );
+    c = V::fmadd( c, z, V::set1( 4.166664568298827e-2f ) );
+    c = V::fmadd( V::mul( c, z ), z, V::fmadd( V::set1( -0.5f ), z, V::set1( 1.0f ) ) );
+
+    // Rotate by q quarter cycles.
+    vf abs_q = V::abs( q );
+    typename V::vm half_cycle = V::cmpgt( abs_q, V::set1( 1.5f ) );
+    typename V::vm quarter_cycle = V::cmplt( V::abs( V::sub( abs_q, V::set1( 1.0f ) ) ), V::set1( 0.5f ) );
+    vf even_sin = V::select( half_cycle, V::xor_bits( s, negative_zero ), s );
+    vf even_cos = V::select( half_cycle, V::xor_bits( c, negative_zero ), c );
+    vf odd_sin = V::xor_bits( c, V::sign( q ) );
+    vf odd_cos = V::xor_bits( V::xor_bits( s, negative_zero ), V::sign( q ) );
+    sin_out = V::select( quarter_cycle, odd_sin, even_sin );
+    cos_out = V::select( quarter_cycle, odd_cos, even_cos );
+}
+
+template< class V >
+inline double wrap_cycles( double cycles )
+///
+/// Returns the fractional part of cycles, in [-0.5,0.5). A template on V only so that each
+/// ISA's copy gets its own symbol.
+///
+{
+    return cycles - std::floor( cycles + 0.5 );
+}
+
+template< class V >
+void cosine_oscillator( float* output, size_t length, double start_cycles, double start_frequency,
+                        double chirp_rate, float magnitude, float offset )
+///
+/// Fills output with offset + magnitude*cos( 2 pi cycles( n ) ), where
+/// cycles( n ) = start_cycles + start_frequency*n + chirp_rate*n^2/2.
+///
+/// @param output
+///  A pointer to length floats to fill.
+///
+/// @param length
+///  The number of samples to generate.
+///
+/// @param start_cycles
+///  The phase of the first sample, in cycles.
+///
+/// @param start_frequency
+///  The frequency at the first sample, in cycles per sample.
+///
+/// @param chirp_rate
+///  The change in frequency per sample, in cycles per sample per sample. 0 for a sinusoid.
+///
+/// @param magnitude
+///  The amplitude of the cosine.
+///
+/// @param offset
+///  A constant added to every sample.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    const size_t restart_vectors = 16;
+    const double pi = 3.14159265358979323846;
+
+    const double step = static_cast< double >( W );
+    const double chirp_step_cycles = wrap_cycles< V >( chirp_rate*step*step );
+    const vf chirp_re = V::set1( static_cast< float >( std::cos( 2.0*pi*chirp_step_cycles ) ) );
+    const vf chirp_im = V::set1( static_cast< float >( std::sin( 2.0*pi*chirp_step_cycles ) ) );
+    const vf magnitude_v = V::set1( magnitude );
+    const vf offset_v = V::set1( offset );
+
+    float lane_phase[ W ];
+    float lane_step[ W ];
+    size_t n = 0;
+    while( n < length )
+    {
+        // Exact phasors for the lanes of this run of vectors, and each lane's step phasor.
+        for( size_t lane = 0; lane < W; ++lane )
+        {
+            const double sample = static_cast< double >( n + lane );
+            lane_phase[lane] = static_cast< float >( wrap_cycles< V >( start_cycles + sample*( start_frequency + 0.5*chirp_rate*sample ) ) );
+            lane_step[lane] = static_cast< float >( wrap_cycles< V >( step*( start_frequency + chirp_rate*( sample + 0.5*step ) ) ) );
+        }
+        vf z_re, z_im, d_re, d_im;
+        sincos_cycles< V >( V::loadu( lane_phase ), z_im, z_re );
+        sincos_cycles< V >( V::loadu( lane_step ), d_im, d_re );
+
+        for( size_t block = 0; block < restart_vectors && n < length; ++block, n += W )
+        {
+            const vf result = V::fmadd( magnitude_v, z_re, offset_v );
+            if( n + W <= length )
+            {
+                V::storeu( output + n, result );
+            }
+            else
+            {
+                float tail[ W ];
+                V::storeu( tail, result );
+                memcpy( output + n, tail, ( length - n )*sizeof( float ) );
+            }
+
+            const vf next_re = V::sub( V::mul( z_re, d_re ), V::mul( z_im, d_im ) );
+            z_im = V::fmadd( z_re, d_im, V::mul( z_im, d_re ) );
+            z_re = next_re;
+
+            const vf next_d_re = V::sub( V::mul( d_re, chirp_re ), V::mul( d_im, chirp_im ) );
+            d_im = V::fmadd( d_re, chirp_im, V::mul( d_im, chirp_re ) );
+            d_re = next_d_re;
+        }
+    }
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_OSCILLATOR_KERNELS_H
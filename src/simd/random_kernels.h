@@ -0,0 +1,271 @@
+//
+// SIMD kernels for counter-based random number generation.
+//
+
+#ifndef CUPCAKE_VEC_LIB_RANDOM_KERNELS_H
+#define CUPCAKE_VEC_LIB_RANDOM_KERNELS_H
+
+// In module includes
+#include "oscillator_kernels.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+//
+// Samples come from Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+// 1, 2, 3", SC 2011), which maps a 128 bit counter and a 64 bit key to four 32 bit words.
+// The counter is ( block counter, stream ) and the key is the seed, so any sample of any
+// stream can be computed directly from its index, without stepping through the ones before.
+//
+// Samples are produced in blocks of random_block_samples from random_block_counters
+// consecutive counters: sample 16*word + lane of a block is word `word` of counter `lane`.
+// The layout is the same for every ISA, so the integer sequence never depends on the vector
+// width. The float arithmetic applied afterwards may differ between ISAs by an ulp where
+// fused multiply-adds are available.
+//
+
+const size_t random_block_counters = 16;
+const size_t random_block_samples = 4*random_block_counters;
+
+template< class V >
+inline void philox( uint64_t key, uint64_t stream, uint64_t first_counter,
+                    typename V::vu& x0, typename V::vu& x1, typename V::vu& x2, typename V::vu& x3 )
+///
+/// Runs Philox4x32-10 on V::width consecutive counters, starting at first_counter, returning
+/// word i of each lane's output in xi.
+///
+{
+    typedef typename V::vu vu;
+    const size_t W = V::width;
+
+    uint32_t counter_low[ W ];
+    uint32_t counter_high[ W ];
+    for( size_t lane = 0; lane < W; ++lane )
+    {
+        const uint64_t counter = first_counter + lane;
+        counter_low[lane] = static_cast< uint32_t >( counter );
+        counter_high[lane] = static_cast< uint32_t >( counter >> 32 );
+    }
+    vu c0 = V::loadu_u32( counter_low );
+    vu c1 = V::loadu_u32( counter_high );
+    vu c2 = V::set1_u32( static_cast< uint32_t >( stream ) );
+    vu c3 = V::set1_u32( static_cast< uint32_t >( stream >> 32 ) );
+
+    uint32_t k0 = static_cast< uint32_t >( key );
+    uint32_t k1 = static_cast< uint32_t >( key >> 32 );
+    for( int round = 0; round < 10; ++round )
+    {
+        vu hi0, lo0, hi1, lo1;
+        V::mul_wide_u32( c0, 0xD2511F53u, hi0, lo0 );
+        V::mul_wide_u32( c2, 0xCD9E8D57u, hi1, lo1 );
+        c0 = V::xor_u32( V::xor_u32( hi1, c1 ), V::set1_u32( k0 ) );
+        c1 = lo1;
+        c2 = V::xor_u32( V::xor_u32( hi0, c3 ), V::set1_u32( k1 ) );
+        c3 = lo0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    x0 = c0;
+    x1 = c1;
+    x2 = c2;
+    x3 = c3;
+}
+
+template< class V >
+inline void uniform_block( uint64_t key, uint64_t stream, uint64_t block, float* output, float scale, float offset )
+///
+/// Writes random_block_samples values, offset + scale*u with u uniform in [0,1).
+///
+{
+    typedef typename V::vu vu;
+    const size_t W = V::width;
+    const size_t G = random_block_counters;
+
+    const typename V::vf scale_v = V::set1( scale );
+    const typename V::vf offset_v = V::set1( offset );
+    for( size_t lane = 0; lane < G; lane += W )
+    {
+        vu x0, x1, x2, x3;
+        philox< V >( key, stream, block*G + lane, x0, x1, x2, x3 );
+        V::storeu( output + lane, V::fmadd( V::u32_to_unit( x0 ), scale_v, offset_v ) );
+        V::storeu( output + G + lane, V::fmadd( V::u32_to_unit( x1 ), scale_v, offset_v ) );
+        V::storeu( output + 2*G + lane, V::fmadd( V::u32_to_unit( x2 ), scale_v, offset_v ) );
+        V::storeu( output + 3*G + lane, V::fmadd( V::u32_to_unit( x3 ), scale_v, offset_v ) );
+    }
+}
+
+template< class V >
+inline typename V::vf log_unit( typename V::vf x, typename V::vf exponent )
+///
+/// Returns log( ( 1 + x )*2^exponent ) for x in [sqrt( 0.5 ) - 1, sqrt( 2 ) - 1], using the
+/// Cephes logf polynomial. Accurate to a few ulps.
+///
+{
+    typedef typename V::vf vf;
+    const vf z = V::mul( x, x );
+    vf y = V::fmadd( V::set1( 7.0376836292e-2f ), x, V::set1( -1.1514610310e-1f ) );
+    y = V::fmadd( y, x, V::set1( 1.1676998740e-1f ) );
+    y = V::fmadd( y, x, V::set1( -1.2420140846e-1f ) );
+    y = V::fmadd( y, x, V::set1( 1.4249322787e-1f ) );
+    y = V::fmadd( y, x, V::set1( -1.6668057665e-1f ) );
+    y = V::fmadd( y, x, V::set1( 2.0000714765e-1f ) );
+    y = V::fmadd( y, x, V::set1( -2.4999993993e-1f ) );
+    y = V::fmadd( y, x, V::set1( 3.3333331174e-1f ) );
+    y = V::mul( V::mul( y, x ), z );
+    y = V::fmadd( exponent, V::set1( -2.12194440e-4f ), y );
+    y = V::fmadd( z, V::set1( -0.5f ), y );
+    return V::fmadd( exponent, V::set1( 0.693359375f ), V::add( x, y ) );
+}
+
+template< class V >
+inline void gaussian_block( uint64_t key, uint64_t stream, uint64_t block, float* output, float deviation, float mean )
+///
+/// Writes random_block_samples normally distributed values, by the Box-Muller transform of
+/// pairs of words. Words 0 and 1 of each counter give samples lane and 16 + lane, words 2 and
+/// 3 give samples 32 + lane and 48 + lane. The radius comes from 24 bits of a word, which
+/// limits values to within 5.9 standard deviations of the mean.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    const size_t G = random_block_counters;
+
+    const vf deviation_v = V::set1( deviation );
+    const vf mean_v = V::set1( mean );
+    for( size_t lane = 0; lane < G; lane += W )
+    {
+        typename V::vu x[ 4 ];
+        philox< V >( key, stream, block*G + lane, x[0], x[1], x[2], x[3] );
+        for( size_t pair = 0; pair < 2; ++pair )
+        {
+            // r = sqrt( -2 log( u ) ) with u in ( 0, 1 ), at an angle in [-0.5,0.5) cycles.
+            const vf u = V::add( V::u32_to_unit( x[ 2*pair ] ), V::set1( 0.5f/16777216.0f ) );
+            vf exponent;
+            const vf mantissa = V::frexp( u, exponent );
+            const typename V::vm low = V::cmplt( mantissa, V::set1( 0.707106781186547524f ) );
+            const vf log_u = log_unit< V >( V::select( low, V::sub( V::add( mantissa, mantissa ), V::set1( 1.0f ) ), V::sub( mantissa, V::set1( 1.0f ) ) ),
+                                            V::select( low, V::sub( exponent, V::set1( 1.0f ) ), exponent ) );
+            const vf radius = V::mul( deviation_v, V::sqrt( V::mul( V::set1( -2.0f ), log_u ) ) );
+
+            vf s, c;
+            sincos_cycles< V >( V::sub( V::u32_to_unit( x[ 2*pair + 1 ] ), V::set1( 0.5f ) ), s, c );
+            V::storeu( output + 2*pair*G + lane, V::fmadd( radius, c, mean_v ) );
+            V::storeu( output + ( 2*pair + 1 )*G + lane, V::fmadd( radius, s, mean_v ) );
+        }
+    }
+}
+
+template< class V, class Block >
+inline void random_fill( uint64_t key, uint64_t stream, uint64_t first_sample, float* output, size_t length,
+                         float scale, float offset, Block block_function )
+///
+/// Fills output with samples first_sample onwards, generating whole blocks directly into the
+/// output and only going through a temporary block at the ends.
+///
+{
+    float partial[ random_block_samples ];
+    uint64_t sample = first_sample;
+    while( length > 0 )
+    {
+        const uint64_t block = sample/random_block_samples;
+        const size_t skip = static_cast< size_t >( sample%random_block_samples );
+        const size_t count = std::min( length, random_block_samples - skip );
+        if( count == random_block_samples )
+        {
+            block_function( key, stream, block, output, scale, offset );
+        }
+        else
+        {
+            block_function( key, stream, block, partial, scale, offset );
+            memcpy( output, partial + skip, count*sizeof( float ) );
+        }
+        sample += count;
+        output += count;
+        length -= count;
+    }
+}
+
+template< class V >
+void random_uniform( uint64_t key, uint64_t stream, uint64_t first_sample, float* output, size_t length,
+                     float minimum, float maximum )
+///
+/// Fills output with samples uniformly distributed in [minimum,maximum).
+///
+/// @param key
+///  The seed.
+///
+/// @param stream
+///  The stream number.
+///
+/// @param first_sample
+///  The index within the stream of the sample written to output[0].
+///
+/// @param output
+///  A pointer to length floats to fill.
+///
+/// @param length
+///  The number of samples to generate.
+///
+/// @param minimum
+///  The lower limit of the range.
+///
+/// @param maximum
+///  The upper limit of the range.
+///
+{
+    random_fill< V >( key, stream, first_sample, output, length, maximum - minimum, minimum, &uniform_block< V > );
+}
+
+template< class V >
+void random_gaussian( uint64_t key, uint64_t stream, uint64_t first_sample, float* output, size_t length,
+                      float mean, float deviation )
+///
+/// Fills output with normally distributed samples.
+///
+/// @param key
+///  The seed.
+///
+/// @param stream
+///  The stream number.
+///
+/// @param first_sample
+///  The index within the stream of the sample written to output[0].
+///
+/// @param output
+///  A pointer to length floats to fill.
+///
+/// @param length
+///  The number of samples to generate.
+///
+/// @param mean
+///  The mean of the distribution.
+///
+/// @param deviation
+///  The standard deviation of the distribution.
+///
+{
+    random_fill< V >( key, stream, first_sample, output, length, deviation, mean, &gaussian_block< V > );
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_RANDOM_KERNELS_H
@@ -0,0 +1,521 @@
+//
+// SIMD kernels for reductions: sums, dot products, norms, extrema and moments.
+//
+
+#ifndef CUPCAKE_VEC_LIB_REDUCTION_KERNELS_H
+#define CUPCAKE_VEC_LIB_REDUCTION_KERNELS_H
+
+// In module includes
+#include "vector_functions.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <cmath>
+#include <stdlib.h>
+#include <string.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+//
+// As with vector_kernels.h, everything here is a template on the ISA traits, V, and runs
+// over V::scalar. A reduction is a Term, which turns a vector from each input into one or
+// two vectors of terms, accumulated by a Sum policy. Four sums are kept per term so that
+// consecutive adds don't wait on each other.
+//
+// CompensatedSum depends on the compiler keeping the order of floating point operations;
+// don't build these kernels with -ffast-math.
+//
+
+template< class V >
+inline typename V::scalar add_lanes( typename V::scalar* lanes, size_t count )
+///
+/// Adds count lanes pairwise, in place. count must be a power of 2. A template on V, though
+/// it only uses V::scalar, so that each ISA's copy gets its own symbol; a shared one would
+/// be compiled for whichever ISA the linker happened to keep.
+///
+{
+    for( size_t step = 1; step < count; step *= 2 )
+    {
+        for( size_t i = 0; i + step < count; i += 2*step )
+        {
+            lanes[i] += lanes[i + step];
+        }
+    }
+    return lanes[0];
+}
+
+template< class V >
+struct FastSum
+///
+/// A plain running sum in each lane.
+///
+{
+    FastSum() : total( V::zero() ) {}
+
+    void add( typename V::vf term ) { total = V::add( total, term ); }
+
+    void merge( const FastSum& other ) { total = V::add( total, other.total ); }
+
+    typename V::scalar result() const
+    {
+        typename V::scalar lanes[ V::width ];
+        V::storeu( lanes, total );
+        return add_lanes< V >( lanes, V::width );
+    }
+
+    typename V::vf total;
+};
+
+template< class V >
+struct CompensatedSum
+///
+/// A Kahan sum in each lane: compensation holds the low order bits lost by the last add,
+/// and is subtracted from the next term.
+///
+{
+    CompensatedSum() : total( V::zero() ), compensation( V::zero() ) {}
+
+    void add( typename V::vf term )
+    {
+        const typename V::vf corrected = V::sub( term, compensation );
+        const typename V::vf sum = V::add( total, corrected );
+        compensation = V::sub( V::sub( sum, total ), corrected );
+        total = sum;
+    }
+
+    void merge( const CompensatedSum& other )
+    {
+        add( other.total );
+        add( V::sub( V::zero(), other.compensation ) );
+    }
+
+    typename V::scalar result() const
+    {
+        typename V::scalar totals[ V::width ];
+        typename V::scalar compensations[ V::width ];
+        V::storeu( totals, total );
+        V::storeu( compensations, compensation );
+        typename V::scalar sum = 0;
+        typename V::scalar lost = 0;
+        for( size_t lane = 0; lane < V::width; ++lane )
+        {
+            const typename V::scalar terms[2] = { totals[lane], -compensations[lane] };
+            for( size_t k = 0; k < 2; ++k )
+            {
+                const typename V::scalar corrected = terms[k] - lost;
+                const typename V::scalar next = sum + corrected;
+                lost = ( next - sum ) - corrected;
+                sum = next;
+            }
+        }
+        return sum;
+    }
+
+    typename V::vf total;
+    typename V::vf compensation;
+};
+
+//
+// Terms. Each takes a vector from each of two inputs, a and b, and writes its terms.
+// Terms of one input ignore b. Tails are padded with padding() in a and zero in b, which
+// must contribute nothing.
+//
+
+template< class V >
+struct SumTerm
+{
+    static const size_t outputs = 1;
+    typename V::scalar padding() const { return 0; }
+    void operator()( typename V::vf a, typename V::vf, typename V::vf* terms ) const { terms[0] = a; }
+};
+
+template< class V >
+struct AbsTerm
+{
+    static const size_t outputs = 1;
+    typename V::scalar padding() const { return 0; }
+    void operator()( typename V::vf a, typename V::vf, typename V::vf* terms ) const { terms[0] = V::abs( a ); }
+};
+
+template< class V >
+struct SquareTerm
+{
+    static const size_t outputs = 1;
+    typename V::scalar padding() const { return 0; }
+    void operator()( typename V::vf a, typename V::vf, typename V::vf* terms ) const { terms[0] = V::mul( a, a ); }
+};
+
+template< class V >
+struct ProductTerm
+{
+    static const size_t outputs = 1;
+    typename V::scalar padding() const { return 0; }
+    void operator()( typename V::vf a, typename V::vf b, typename V::vf* terms ) const { terms[0] = V::mul( a, b ); }
+};
+
+template< class V >
+struct WeightedTerm
+///
+/// a*b and b, for the weighted mean of values a with weights b.
+///
+{
+    static const size_t outputs = 2;
+    typename V::scalar padding() const { return 0; }
+    void operator()( typename V::vf a, typename V::vf b, typename V::vf* terms ) const
+    {
+        terms[0] = V::mul( a, b );
+        terms[1] = b;
+    }
+};
+
+template< class V >
+struct ShiftedMomentsTerm
+///
+/// a - shift and ( a - shift )^2. Shifting by a value near the mean keeps the sum of squares
+/// from cancelling catastrophically when the variance is small next to the mean.
+///
+{
+    static const size_t outputs = 2;
+
+    explicit ShiftedMomentsTerm( typename V::scalar value ) : shift( value ), shift_vector( V::set1( value ) ) {}
+
+    typename V::scalar padding() const { return shift; }
+
+    void operator()( typename V::vf a, typename V::vf, typename V::vf* terms ) const
+    {
+        const typename V::vf deviation = V::sub( a, shift_vector );
+        terms[0] = deviation;
+        terms[1] = V::mul( deviation, deviation );
+    }
+
+    typename V::scalar shift;
+    typename V::vf shift_vector;
+};
+
+template< class V, class Sum, class Term >
+inline void accumulate_terms( const typename V::scalar* input1, const typename V::scalar* input2, const Term& term, Sum* sums )
+{
+    typename V::vf terms[ Term::outputs ];
+    term( V::loadu( input1 ), V::loadu( input2 ), terms );
+    for( size_t k = 0; k < Term::outputs; ++k )
+    {
+        sums[k].add( terms[k] );
+    }
+}
+
+template< class V, class Sum, class Term >
+inline void accumulate( const typename V::scalar* input1, const typename V::scalar* input2, size_t length, const Term& term,
+                        Sum* totals )
+///
+/// Adds the terms of input1 and input2 over length elements to totals, keeping them as
+/// vectors.
+///
+/// @param input1
+///  A pointer to the first element of the first input.
+///
+/// @param input2
+///  A pointer to the first element of the second input. Pass input1 for terms of one input.
+///
+/// @param length
+///  The number of elements in each input.
+///
+/// @param term
+///  The Term to sum.
+///
+/// @param totals
+///  The Term::outputs sums to add to.
+///
+{
+    typedef typename V::scalar scalar;
+    const size_t W = V::width;
+    Sum sums[4][ Term::outputs ];
+    size_t i = 0;
+    for( ; i + 4*W <= length; i += 4*W )
+    {
+        accumulate_terms< V >( input1 + i, input2 + i, term, sums[0] );
+        accumulate_terms< V >( input1 + i + W, input2 + i + W, term, sums[1] );
+        accumulate_terms< V >( input1 + i + 2*W, input2 + i + 2*W, term, sums[2] );
+        accumulate_terms< V >( input1 + i + 3*W, input2 + i + 3*W, term, sums[3] );
+    }
+    for( ; i + W <= length; i += W )
+    {
+        accumulate_terms< V >( input1 + i, input2 + i, term, sums[0] );
+    }
+    if( i < length )
+    {
+        scalar tail1[ W ];
+        scalar tail2[ W ] = {};
+        for( size_t lane = 0; lane < W; ++lane )
+        {
+            tail1[lane] = term.padding();
+        }
+        memcpy( tail1, input1 + i, ( length - i )*sizeof( scalar ) );
+        memcpy( tail2, input2 + i, ( length - i )*sizeof( scalar ) );
+        accumulate_terms< V >( tail1, tail2, term, sums[1] );
+    }
+    for( size_t k = 0; k < Term::outputs; ++k )
+    {
+        sums[0][k].merge( sums[1][k] );
+        sums[2][k].merge( sums[3][k] );
+        sums[0][k].merge( sums[2][k] );
+        totals[k].merge( sums[0][k] );
+    }
+}
+
+template< class V, class Term >
+inline void accumulate_pairwise( const typename V::scalar* input1, const typename V::scalar* input2, size_t length, const Term& term,
+                                 FastSum< V >* totals )
+///
+/// As accumulate, with blocks of at most 32 vectors summed directly and the block sums
+/// added in pairs. Each lane of a block sums at most 8 terms, so error grows with the depth
+/// of the recursion rather than with length. Splits fall on whole vectors, so only the
+/// last block has a tail.
+///
+{
+    const size_t leaf = 32*V::width;
+    if( length <= leaf )
+    {
+        accumulate< V >( input1, input2, length, term, totals );
+        return;
+    }
+    const size_t half = ( length/2 + V::width - 1 )/V::width*V::width;
+    FastSum< V > right[ Term::outputs ];
+    accumulate_pairwise< V >( input1, input2, half, term, totals );
+    accumulate_pairwise< V >( input1 + half, input2 + half, length - half, term, right );
+    for( size_t k = 0; k < Term::outputs; ++k )
+    {
+        totals[k].merge( right[k] );
+    }
+}
+
+template< class V, class Sum, class Term >
+inline void reduce( const typename V::scalar* input1, const typename V::scalar* input2, size_t length, const Term& term,
+                    typename V::scalar* results )
+///
+/// Sums the terms of input1 and input2 over length elements into the Term::outputs results.
+///
+{
+    Sum totals[ Term::outputs ];
+    accumulate< V >( input1, input2, length, term, totals );
+    for( size_t k = 0; k < Term::outputs; ++k )
+    {
+        results[k] = totals[k].result();
+    }
+}
+
+template< class V, class Term >
+inline void reduce( const typename V::scalar* input1, const typename V::scalar* input2, size_t length, const Term& term,
+                    typename V::scalar* results, SumAccuracy accuracy )
+///
+/// As reduce above, with the summation chosen by accuracy.
+///
+{
+    switch( accuracy )
+    {
+        case SumAccuracy::pairwise:
+        {
+            FastSum< V > totals[ Term::outputs ];
+            accumulate_pairwise< V >( input1, input2, length, term, totals );
+            for( size_t k = 0; k < Term::outputs; ++k )
+            {
+                results[k] = totals[k].result();
+            }
+            break;
+        }
+        case SumAccuracy::compensated:
+            reduce< V, CompensatedSum< V > >( input1, input2, length, term, results );
+            break;
+        case SumAccuracy::fast:
+        default:
+            reduce< V, FastSum< V > >( input1, input2, length, term, results );
+            break;
+    }
+}
+
+template< class V >
+inline typename V::scalar sum( const typename V::scalar* input, size_t length, SumAccuracy accuracy )
+{
+    typename V::scalar result;
+    reduce< V >( input, input, length, SumTerm< V >(), &result, accuracy );
+    return result;
+}
+
+template< class V >
+inline typename V::scalar dot( const typename V::scalar* input1, const typename V::scalar* input2, size_t length, SumAccuracy accuracy )
+{
+    typename V::scalar result;
+    reduce< V >( input1, input2, length, ProductTerm< V >(), &result, accuracy );
+    return result;
+}
+
+template< class V >
+inline typename V::scalar norm_l1( const typename V::scalar* input, size_t length, SumAccuracy accuracy )
+{
+    typename V::scalar result;
+    reduce< V >( input, input, length, AbsTerm< V >(), &result, accuracy );
+    return result;
+}
+
+template< class V >
+inline typename V::scalar norm_l2( const typename V::scalar* input, size_t length, SumAccuracy accuracy )
+{
+    typename V::scalar result;
+    reduce< V >( input, input, length, SquareTerm< V >(), &result, accuracy );
+    return std::sqrt( result );
+}
+
+template< class V >
+inline void mean_variance( const typename V::scalar* input, size_t length, typename V::scalar* mean, typename V::scalar* variance,
+                           SumAccuracy accuracy )
+///
+/// The mean and population variance of input, in one pass. length must be at least 1.
+///
+{
+    typedef typename V::scalar scalar;
+    const scalar shift = input[0];
+    scalar sums[2];
+    reduce< V >( input, input, length, ShiftedMomentsTerm< V >( shift ), sums, accuracy );
+    const scalar count = static_cast< scalar >( length );
+    const scalar offset = sums[0]/count;
+    const scalar spread = sums[1]/count - offset*offset;
+    *mean = shift + offset;
+    *variance = spread > 0 ? spread : 0;
+}
+
+template< class V >
+inline typename V::scalar weighted_mean( const typename V::scalar* values, const typename V::scalar* weights, size_t length,
+                                         SumAccuracy accuracy )
+///
+/// sum( values*weights )/sum( weights ) in one pass, or 0 if the weights sum to 0.
+///
+{
+    typename V::scalar sums[2];
+    reduce< V >( values, weights, length, WeightedTerm< V >(), sums, accuracy );
+    return sums[1] != 0 ? sums[0]/sums[1] : 0;
+}
+
+template< class V >
+struct Largest
+{
+    static typename V::vf pick( typename V::vf a, typename V::vf b ) { return V::max( a, b ); }
+    static typename V::vm improves( typename V::vf a, typename V::vf b ) { return V::cmpgt( a, b ); }
+    static bool better( typename V::scalar a, typename V::scalar b ) { return a > b; }
+};
+
+template< class V >
+struct Smallest
+{
+    static typename V::vf pick( typename V::vf a, typename V::vf b ) { return V::min( a, b ); }
+    static typename V::vm improves( typename V::vf a, typename V::vf b ) { return V::cmplt( a, b ); }
+    static bool better( typename V::scalar a, typename V::scalar b ) { return a < b; }
+};
+
+template< class V, class Order >
+inline size_t find_extreme( const typename V::scalar* input, size_t length, typename V::scalar* value )
+///
+/// Finds the first largest, or smallest, element of input. Input is read in blocks of 16
+/// vectors. Each lane keeps its extreme so far and the first block in which it was seen, so
+/// the loop has no horizontal operations; only the block holding the overall extreme is
+/// searched again for its index. The result is unspecified if input contains NaN.
+///
+/// @param input
+///  A pointer to the first element to search.
+///
+/// @param length
+///  The number of elements in input. Must be at least 1.
+///
+/// @param value
+///  Receives the extreme element.
+///
+/// @return
+///  The index of the first occurrence of the extreme element.
+///
+{
+    typedef typename V::scalar scalar;
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    const size_t block = 16*W;
+    // Block numbers are held as V::scalar, exact up to 2^24 for float.
+    const size_t max_blocks = size_t( 1 ) << 22;
+
+    scalar best = input[0];
+    size_t best_index = 0;
+    size_t start = 0;
+    while( length - start >= block )
+    {
+        const size_t remaining = ( length - start )/block;
+        const size_t blocks = remaining < max_blocks ? remaining : max_blocks;
+        vf extremes = V::loadu( input + start );
+        vf first_blocks = V::zero();
+        for( size_t b = 0; b < blocks; ++b )
+        {
+            const scalar* data = input + start + b*block;
+            vf extreme0 = V::loadu( data );
+            vf extreme1 = V::loadu( data + W );
+            vf extreme2 = V::loadu( data + 2*W );
+            vf extreme3 = V::loadu( data + 3*W );
+            for( size_t v = 4*W; v < block; v += 4*W )
+            {
+                extreme0 = Order::pick( extreme0, V::loadu( data + v ) );
+                extreme1 = Order::pick( extreme1, V::loadu( data + v + W ) );
+                extreme2 = Order::pick( extreme2, V::loadu( data + v + 2*W ) );
+                extreme3 = Order::pick( extreme3, V::loadu( data + v + 3*W ) );
+            }
+            const vf extreme = Order::pick( Order::pick( extreme0, extreme1 ), Order::pick( extreme2, extreme3 ) );
+            first_blocks = V::select( Order::improves( extreme, extremes ), V::set1( static_cast< scalar >( b ) ), first_blocks );
+            extremes = Order::pick( extremes, extreme );
+        }
+
+        scalar lanes[ W ];
+        scalar lane_blocks[ W ];
+        V::storeu( lanes, extremes );
+        V::storeu( lane_blocks, first_blocks );
+        scalar candidate = lanes[0];
+        scalar first_block = lane_blocks[0];
+        for( size_t lane = 1; lane < W; ++lane )
+        {
+            if( Order::better( lanes[lane], candidate ) || ( lanes[lane] == candidate && lane_blocks[lane] < first_block ) )
+            {
+                candidate = lanes[lane];
+                first_block = lane_blocks[lane];
+            }
+        }
+        if( Order::better( candidate, best ) )
+        {
+            best = candidate;
+            best_index = start + static_cast< size_t >( first_block )*block;
+            while( best_index + 1 < length && !( input[best_index] == best ) )
+            {
+                ++best_index;
+            }
+        }
+        start += blocks*block;
+    }
+    for( size_t i = start; i < length; ++i )
+    {
+        if( Order::better( input[i], best ) )
+        {
+            best = input[i];
+            best_index = i;
+        }
+    }
+    *value = best;
+    return best_index;
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_REDUCTION_KERNELS_H
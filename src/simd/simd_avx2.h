@@ -0,0 +1,165 @@
+//
+// AVX2 + FMA traits for the SIMD kernels - eight floats per vector.
+//
+
+#ifndef CUPCAKE_VEC_LIB_SIMD_AVX2_H
+#define CUPCAKE_VEC_LIB_SIMD_AVX2_H
+
+// In module includes
+#include "dispatch.h"
+
+// Thirdparty includes
+#include <immintrin.h>
+
+// Std Lib includes
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+///
+/// AVX2 traits over four doubles per vector, for the double precision kernels.
+///
+struct AVX2Double
+{
+    typedef __m256d vf;
+    typedef __m256d vm;
+    typedef double scalar;
+
+    static const size_t width = 4;
+
+    static inline vf zero() { return _mm256_setzero_pd(); }
+    static inline vf set1( double value ) { return _mm256_set1_pd( value ); }
+    static inline vf loadu( const double* ptr ) { return _mm256_loadu_pd( ptr ); }
+    static inline void storeu( double* ptr, vf value ) { _mm256_storeu_pd( ptr, value ); }
+
+    static inline vf add( vf a, vf b ) { return _mm256_add_pd( a, b ); }
+    static inline vf sub( vf a, vf b ) { return _mm256_sub_pd( a, b ); }
+    static inline vf mul( vf a, vf b ) { return _mm256_mul_pd( a, b ); }
+    static inline vf div( vf a, vf b ) { return _mm256_div_pd( a, b ); }
+    static inline vf fmadd( vf a, vf b, vf c ) { return _mm256_fmadd_pd( a, b, c ); }
+    static inline vf min( vf a, vf b ) { return _mm256_min_pd( a, b ); }
+    static inline vf max( vf a, vf b ) { return _mm256_max_pd( a, b ); }
+    static inline vf abs( vf a ) { return _mm256_andnot_pd( _mm256_set1_pd( -0.0 ), a ); }
+    static inline vf trunc( vf a ) { return _mm256_round_pd( a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ); }
+    static inline vf sqrt( vf a ) { return _mm256_sqrt_pd( a ); }
+    static inline vf sign( vf a ) { return _mm256_and_pd( _mm256_set1_pd( -0.0 ), a ); }
+    static inline vf xor_bits( vf a, vf b ) { return _mm256_xor_pd( a, b ); }
+
+    static inline vm cmplt( vf a, vf b ) { return _mm256_cmp_pd( a, b, _CMP_LT_OQ ); }
+    static inline vm cmpgt( vf a, vf b ) { return _mm256_cmp_pd( a, b, _CMP_GT_OQ ); }
+    static inline vf select( vm mask, vf if_true, vf if_false ) { return _mm256_blendv_pd( if_false, if_true, mask ); }
+
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd )
+    {
+        // As for floats, the in-lane unpack leaves the halves ordered lo0, hi0, lo1, hi1.
+        even = _mm256_permute4x64_pd( _mm256_unpacklo_pd( lo, hi ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        odd = _mm256_permute4x64_pd( _mm256_unpackhi_pd( lo, hi ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+    }
+};
+
+///
+/// ISA traits for AVX2 with FMA (Haswell and later).
+///
+struct AVX2
+{
+    typedef __m256 vf;
+    typedef __m256 vm;
+    typedef __m256i vu;
+    typedef float scalar;
+    typedef AVX2Double Double;
+
+    static const ISA isa = ISA::avx2;
+    static const size_t width = 8;
+
+    static inline vf zero() { return _mm256_setzero_ps(); }
+    static inline vf set1( float value ) { return _mm256_set1_ps( value ); }
+    static inline vf loadu( const float* ptr ) { return _mm256_loadu_ps( ptr ); }
+    static inline void storeu( float* ptr, vf value ) { _mm256_storeu_ps( ptr, value ); }
+
+    static inline vf add( vf a, vf b ) { return _mm256_add_ps( a, b ); }
+    static inline vf sub( vf a, vf b ) { return _mm256_sub_ps( a, b ); }
+    static inline vf mul( vf a, vf b ) { return _mm256_mul_ps( a, b ); }
+    static inline vf div( vf a, vf b ) { return _mm256_div_ps( a, b ); }
+    static inline vf fmadd( vf a, vf b, vf c ) { return _mm256_fmadd_ps( a, b, c ); }
+    static inline vf min( vf a, vf b ) { return _mm256_min_ps( a, b ); }
+    static inline vf max( vf a, vf b ) { return _mm256_max_ps( a, b ); }
+    static inline vf abs( vf a ) { return _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), a ); }
+    static inline vf trunc( vf a ) { return _mm256_round_ps( a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ); }
+    static inline vf sqrt( vf a ) { return _mm256_sqrt_ps( a ); }
+    static inline vf sign( vf a ) { return _mm256_and_ps( _mm256_set1_ps( -0.0f ), a ); }
+    static inline vf xor_bits( vf a, vf b ) { return _mm256_xor_ps( a, b ); }
+
+    static inline vm cmplt( vf a, vf b ) { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+    static inline vm cmpgt( vf a, vf b ) { return _mm256_cmp_ps( a, b, _CMP_GT_OQ ); }
+    static inline vf select( vm mask, vf if_true, vf if_false ) { return _mm256_blendv_ps( if_false, if_true, mask ); }
+
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd )
+    {
+        // In-lane shuffles leave the 64-bit quarters ordered lo0, hi0, lo1, hi1; the permute restores sequence.
+        even = _mm256_castpd_ps( _mm256_permute4x64_pd( _mm256_castps_pd( _mm256_shuffle_ps( lo, hi, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+        odd = _mm256_castpd_ps( _mm256_permute4x64_pd( _mm256_castps_pd( _mm256_shuffle_ps( lo, hi, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+    }
+
+    static inline void interleave( vf even, vf odd, vf& lo, vf& hi )
+    {
+        // Unpacking works within 128-bit lanes, so swap the middle lanes afterwards.
+        vf low_lanes = _mm256_unpacklo_ps( even, odd );
+        vf high_lanes = _mm256_unpackhi_ps( even, odd );
+        lo = _mm256_permute2f128_ps( low_lanes, high_lanes, 0x20 );
+        hi = _mm256_permute2f128_ps( low_lanes, high_lanes, 0x31 );
+    }
+
+    static inline vf reverse( vf a ) { return _mm256_permutevar8x32_ps( a, _mm256_setr_epi32( 7, 6, 5, 4, 3, 2, 1, 0 ) ); }
+
+    // 16-bit integer samples, one per lane. Stores round to nearest and saturate.
+    static inline vf load_s16( const int16_t* ptr )
+    {
+        return _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm_loadu_si128( reinterpret_cast< const __m128i* >( ptr ) ) ) );
+    }
+    static inline void store_s16( int16_t* ptr, vf value )
+    {
+        const vf clamped = _mm256_min_ps( _mm256_max_ps( value, _mm256_set1_ps( -32768.0f ) ), _mm256_set1_ps( 32767.0f ) );
+        const __m256i rounded = _mm256_cvtps_epi32( clamped );
+        const __m128i packed = _mm_packs_epi32( _mm256_castsi256_si128( rounded ), _mm256_extracti128_si256( rounded, 1 ) );
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( ptr ), packed );
+    }
+
+    // 32-bit unsigned integer lanes, for random number generation.
+    static inline vu set1_u32( uint32_t value ) { return _mm256_set1_epi32( static_cast< int >( value ) ); }
+    static inline vu loadu_u32( const uint32_t* ptr ) { return _mm256_loadu_si256( reinterpret_cast< const __m256i* >( ptr ) ); }
+    static inline void storeu_u32( uint32_t* ptr, vu value ) { _mm256_storeu_si256( reinterpret_cast< __m256i* >( ptr ), value ); }
+    static inline vu xor_u32( vu a, vu b ) { return _mm256_xor_si256( a, b ); }
+    static inline void mul_wide_u32( vu a, uint32_t b, vu& hi, vu& lo )
+    {
+        // Even and odd lanes multiply separately into 64-bit products, then the halves are blended back.
+        const vu factor = _mm256_set1_epi32( static_cast< int >( b ) );
+        const vu even = _mm256_mul_epu32( a, factor );
+        const vu odd = _mm256_mul_epu32( _mm256_srli_epi64( a, 32 ), factor );
+        lo = _mm256_blend_epi32( even, _mm256_slli_epi64( odd, 32 ), 0xAA );
+        hi = _mm256_blend_epi32( _mm256_srli_epi64( even, 32 ), odd, 0xAA );
+    }
+    static inline vf u32_to_unit( vu a ) { return _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_srli_epi32( a, 8 ) ), _mm256_set1_ps( 1.0f/16777216.0f ) ); }
+    static inline vf frexp( vf a, vf& exponent )
+    {
+        // Positive normal inputs only.
+        const vu bits = _mm256_castps_si256( a );
+        exponent = _mm256_cvtepi32_ps( _mm256_sub_epi32( _mm256_srli_epi32( bits, 23 ), _mm256_set1_epi32( 126 ) ) );
+        return _mm256_castsi256_ps( _mm256_or_si256( _mm256_and_si256( bits, _mm256_set1_epi32( 0x007FFFFF ) ), _mm256_set1_epi32( 0x3F000000 ) ) );
+    }
+};
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_SIMD_AVX2_H
@@ -0,0 +1,177 @@
+//
+// AVX-512F traits for the SIMD kernels - sixteen floats per vector.
+//
+
+#ifndef CUPCAKE_VEC_LIB_SIMD_AVX512_H
+#define CUPCAKE_VEC_LIB_SIMD_AVX512_H
+
+// In module includes
+#include "dispatch.h"
+
+// Thirdparty includes
+#include <immintrin.h>
+
+// Std Lib includes
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+///
+/// AVX-512F traits over eight doubles per vector, for the double precision kernels.
+///
+struct AVX512Double
+{
+    typedef __m512d vf;
+    typedef __mmask8 vm;
+    typedef double scalar;
+
+    static const size_t width = 8;
+
+    static inline vf zero() { return _mm512_setzero_pd(); }
+    static inline vf set1( double value ) { return _mm512_set1_pd( value ); }
+    static inline vf loadu( const double* ptr ) { return _mm512_loadu_pd( ptr ); }
+    static inline void storeu( double* ptr, vf value ) { _mm512_storeu_pd( ptr, value ); }
+
+    static inline vf add( vf a, vf b ) { return _mm512_add_pd( a, b ); }
+    static inline vf sub( vf a, vf b ) { return _mm512_sub_pd( a, b ); }
+    static inline vf mul( vf a, vf b ) { return _mm512_mul_pd( a, b ); }
+    static inline vf div( vf a, vf b ) { return _mm512_div_pd( a, b ); }
+    static inline vf fmadd( vf a, vf b, vf c ) { return _mm512_fmadd_pd( a, b, c ); }
+    static inline vf min( vf a, vf b ) { return _mm512_min_pd( a, b ); }
+    static inline vf max( vf a, vf b ) { return _mm512_max_pd( a, b ); }
+    static inline vf abs( vf a )
+    {
+        return _mm512_castsi512_pd( _mm512_and_si512( _mm512_castpd_si512( a ), _mm512_set1_epi64( 0x7fffffffffffffffLL ) ) );
+    }
+    static inline vf trunc( vf a ) { return _mm512_roundscale_pd( a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ); }
+    static inline vf sqrt( vf a ) { return _mm512_sqrt_pd( a ); }
+    static inline vf sign( vf a )
+    {
+        return _mm512_castsi512_pd( _mm512_and_si512( _mm512_castpd_si512( a ), _mm512_set1_epi64( static_cast< long long >( 0x8000000000000000ULL ) ) ) );
+    }
+    static inline vf xor_bits( vf a, vf b )
+    {
+        return _mm512_castsi512_pd( _mm512_xor_si512( _mm512_castpd_si512( a ), _mm512_castpd_si512( b ) ) );
+    }
+
+    static inline vm cmplt( vf a, vf b ) { return _mm512_cmp_pd_mask( a, b, _CMP_LT_OQ ); }
+    static inline vm cmpgt( vf a, vf b ) { return _mm512_cmp_pd_mask( a, b, _CMP_GT_OQ ); }
+    static inline vf select( vm mask, vf if_true, vf if_false ) { return _mm512_mask_blend_pd( mask, if_false, if_true ); }
+
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd )
+    {
+        even = _mm512_permutex2var_pd( lo, _mm512_setr_epi64( 0, 2, 4, 6, 8, 10, 12, 14 ), hi );
+        odd = _mm512_permutex2var_pd( lo, _mm512_setr_epi64( 1, 3, 5, 7, 9, 11, 13, 15 ), hi );
+    }
+};
+
+///
+/// ISA traits for AVX-512F (Skylake-SP and later). Comparisons produce
+/// mask registers rather than vectors.
+///
+struct AVX512
+{
+    typedef __m512 vf;
+    typedef __mmask16 vm;
+    typedef __m512i vu;
+    typedef float scalar;
+    typedef AVX512Double Double;
+
+    static const ISA isa = ISA::avx512;
+    static const size_t width = 16;
+
+    static inline vf zero() { return _mm512_setzero_ps(); }
+    static inline vf set1( float value ) { return _mm512_set1_ps( value ); }
+    static inline vf loadu( const float* ptr ) { return _mm512_loadu_ps( ptr ); }
+    static inline void storeu( float* ptr, vf value ) { _mm512_storeu_ps( ptr, value ); }
+
+    static inline vf add( vf a, vf b ) { return _mm512_add_ps( a, b ); }
+    static inline vf sub( vf a, vf b ) { return _mm512_sub_ps( a, b ); }
+    static inline vf mul( vf a, vf b ) { return _mm512_mul_ps( a, b ); }
+    static inline vf div( vf a, vf b ) { return _mm512_div_ps( a, b ); }
+    static inline vf fmadd( vf a, vf b, vf c ) { return _mm512_fmadd_ps( a, b, c ); }
+    static inline vf min( vf a, vf b ) { return _mm512_min_ps( a, b ); }
+    static inline vf max( vf a, vf b ) { return _mm512_max_ps( a, b ); }
+    static inline vf abs( vf a )
+    {
+        return _mm512_castsi512_ps( _mm512_and_si512( _mm512_castps_si512( a ), _mm512_set1_epi32( 0x7fffffff ) ) );
+    }
+    static inline vf trunc( vf a ) { return _mm512_roundscale_ps( a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ); }
+    static inline vf sqrt( vf a ) { return _mm512_sqrt_ps( a ); }
+    static inline vf sign( vf a )
+    {
+        return _mm512_castsi512_ps( _mm512_and_si512( _mm512_castps_si512( a ), _mm512_set1_epi32( static_cast< int >( 0x80000000u ) ) ) );
+    }
+    static inline vf xor_bits( vf a, vf b )
+    {
+        return _mm512_castsi512_ps( _mm512_xor_si512( _mm512_castps_si512( a ), _mm512_castps_si512( b ) ) );
+    }
+
+    static inline vm cmplt( vf a, vf b ) { return _mm512_cmp_ps_mask( a, b, _CMP_LT_OQ ); }
+    static inline vm cmpgt( vf a, vf b ) { return _mm512_cmp_ps_mask( a, b, _CMP_GT_OQ ); }
+    static inline vf select( vm mask, vf if_true, vf if_false ) { return _mm512_mask_blend_ps( mask, if_false, if_true ); }
+
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd )
+    {
+        even = _mm512_permutex2var_ps( lo, _mm512_setr_epi32( 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30 ), hi );
+        odd = _mm512_permutex2var_ps( lo, _mm512_setr_epi32( 1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31 ), hi );
+    }
+
+    static inline void interleave( vf even, vf odd, vf& lo, vf& hi )
+    {
+        lo = _mm512_permutex2var_ps( even, _mm512_setr_epi32( 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23 ), odd );
+        hi = _mm512_permutex2var_ps( even, _mm512_setr_epi32( 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31 ), odd );
+    }
+
+    static inline vf reverse( vf a ) { return _mm512_permutexvar_ps( _mm512_setr_epi32( 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 ), a ); }
+
+    // 16-bit integer samples, one per lane. Stores round to nearest and saturate.
+    static inline vf load_s16( const int16_t* ptr )
+    {
+        return _mm512_cvtepi32_ps( _mm512_cvtepi16_epi32( _mm256_loadu_si256( reinterpret_cast< const __m256i* >( ptr ) ) ) );
+    }
+    static inline void store_s16( int16_t* ptr, vf value )
+    {
+        const vf clamped = _mm512_min_ps( _mm512_max_ps( value, _mm512_set1_ps( -32768.0f ) ), _mm512_set1_ps( 32767.0f ) );
+        _mm256_storeu_si256( reinterpret_cast< __m256i* >( ptr ), _mm512_cvtsepi32_epi16( _mm512_cvtps_epi32( clamped ) ) );
+    }
+
+    // 32-bit unsigned integer lanes, for random number generation.
+    static inline vu set1_u32( uint32_t value ) { return _mm512_set1_epi32( static_cast< int >( value ) ); }
+    static inline vu loadu_u32( const uint32_t* ptr ) { return _mm512_loadu_si512( ptr ); }
+    static inline void storeu_u32( uint32_t* ptr, vu value ) { _mm512_storeu_si512( ptr, value ); }
+    static inline vu xor_u32( vu a, vu b ) { return _mm512_xor_si512( a, b ); }
+    static inline void mul_wide_u32( vu a, uint32_t b, vu& hi, vu& lo )
+    {
+        // Even and odd lanes multiply separately into 64-bit products, then the halves are blended back.
+        const vu factor = _mm512_set1_epi32( static_cast< int >( b ) );
+        const vu even = _mm512_mul_epu32( a, factor );
+        const vu odd = _mm512_mul_epu32( _mm512_srli_epi64( a, 32 ), factor );
+        lo = _mm512_mask_blend_epi32( 0xAAAA, even, _mm512_slli_epi64( odd, 32 ) );
+        hi = _mm512_mask_blend_epi32( 0xAAAA, _mm512_srli_epi64( even, 32 ), odd );
+    }
+    static inline vf u32_to_unit( vu a ) { return _mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_srli_epi32( a, 8 ) ), _mm512_set1_ps( 1.0f/16777216.0f ) ); }
+    static inline vf frexp( vf a, vf& exponent )
+    {
+        // Positive normal inputs only.
+        const vu bits = _mm512_castps_si512( a );
+        exponent = _mm512_cvtepi32_ps( _mm512_sub_epi32( _mm512_srli_epi32( bits, 23 ), _mm512_set1_epi32( 126 ) ) );
+        return _mm512_castsi512_ps( _mm512_or_si512( _mm512_and_si512( bits, _mm512_set1_epi32( 0x007FFFFF ) ), _mm512_set1_epi32( 0x3F000000 ) ) );
+    }
+};
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_SIMD_AVX512_H
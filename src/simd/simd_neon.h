@@ -0,0 +1,219 @@
+//
+// ARM NEON traits for the SIMD kernels - four floats per vector.
+//
+
+#ifndef CUPCAKE_VEC_LIB_SIMD_NEON_H
+#define CUPCAKE_VEC_LIB_SIMD_NEON_H
+
+// In module includes
+#include "dispatch.h"
+#include "simd_scalar.h"
+
+// Thirdparty includes
+#include <arm_neon.h>
+
+// Std Lib includes
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+#if defined( __aarch64__ )
+
+///
+/// NEON traits over two doubles per vector, for the double precision kernels. AArch64 only.
+///
+struct NEONDouble
+{
+    typedef float64x2_t vf;
+    typedef uint64x2_t vm;
+    typedef double scalar;
+
+    static const size_t width = 2;
+
+    static inline vf zero() { return vdupq_n_f64( 0.0 ); }
+    static inline vf set1( double value ) { return vdupq_n_f64( value ); }
+    static inline vf loadu( const double* ptr ) { return vld1q_f64( ptr ); }
+    static inline void storeu( double* ptr, vf value ) { vst1q_f64( ptr, value ); }
+
+    static inline vf add( vf a, vf b ) { return vaddq_f64( a, b ); }
+    static inline vf sub( vf a, vf b ) { return vsubq_f64( a, b ); }
+    static inline vf mul( vf a, vf b ) { return vmulq_f64( a, b ); }
+    static inline vf div( vf a, vf b ) { return vdivq_f64( a, b ); }
+    static inline vf fmadd( vf a, vf b, vf c ) { return vfmaq_f64( c, a, b ); }
+    static inline vf min( vf a, vf b ) { return vminq_f64( a, b ); }
+    static inline vf max( vf a, vf b ) { return vmaxq_f64( a, b ); }
+    static inline vf abs( vf a ) { return vabsq_f64( a ); }
+    static inline vf trunc( vf a ) { return vrndq_f64( a ); }
+    static inline vf sqrt( vf a ) { return vsqrtq_f64( a ); }
+    static inline vf sign( vf a ) { return vreinterpretq_f64_u64( vandq_u64( vreinterpretq_u64_f64( a ), vdupq_n_u64( 0x8000000000000000ULL ) ) ); }
+    static inline vf xor_bits( vf a, vf b ) { return vreinterpretq_f64_u64( veorq_u64( vreinterpretq_u64_f64( a ), vreinterpretq_u64_f64( b ) ) ); }
+
+    static inline vm cmplt( vf a, vf b ) { return vcltq_f64( a, b ); }
+    static inline vm cmpgt( vf a, vf b ) { return vcgtq_f64( a, b ); }
+    static inline vf select( vm mask, vf if_true, vf if_false ) { return vbslq_f64( mask, if_true, if_false ); }
+
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd )
+    {
+        even = vuzp1q_f64( lo, hi );
+        odd = vuzp2q_f64( lo, hi );
+    }
+};
+
+#endif
+
+///
+/// ISA traits for NEON. AArch64 gets fused multiply-add and a native truncation,
+/// 32-bit ARM falls back to the equivalent two-instruction sequences.
+///
+struct NEON
+{
+    typedef float32x4_t vf;
+    typedef uint32x4_t vm;
+    typedef uint32x4_t vu;
+    typedef float scalar;
+#if defined( __aarch64__ )
+    typedef NEONDouble Double;
+#else
+    typedef ScalarDouble Double;    // -> 32-bit NEON has no double precision vectors.
+#endif
+
+    static const ISA isa = ISA::neon;
+    static const size_t width = 4;
+
+    static inline vf zero() { return vdupq_n_f32( 0.0f ); }
+    static inline vf set1( float value ) { return vdupq_n_f32( value ); }
+    static inline vf loadu( const float* ptr ) { return vld1q_f32( ptr ); }
+    static inline void storeu( float* ptr, vf value ) { vst1q_f32( ptr, value ); }
+
+    static inline vf add( vf a, vf b ) { return vaddq_f32( a, b ); }
+    static inline vf sub( vf a, vf b ) { return vsubq_f32( a, b ); }
+    static inline vf mul( vf a, vf b ) { return vmulq_f32( a, b ); }
+    static inline vf min( vf a, vf b ) { return vminq_f32( a, b ); }
+    static inline vf max( vf a, vf b ) { return vmaxq_f32( a, b ); }
+    static inline vf abs( vf a ) { return vabsq_f32( a ); }
+    static inline vf sign( vf a ) { return vreinterpretq_f32_u32( vandq_u32( vreinterpretq_u32_f32( a ), vdupq_n_u32( 0x80000000u ) ) ); }
+    static inline vf xor_bits( vf a, vf b ) { return vreinterpretq_f32_u32( veorq_u32( vreinterpretq_u32_f32( a ), vreinterpretq_u32_f32( b ) ) ); }
+
+#if defined( __aarch64__ )
+    static inline vf fmadd( vf a, vf b, vf c ) { return vfmaq_f32( c, a, b ); }
+    static inline vf trunc( vf a ) { return vrndq_f32( a ); }
+    static inline vf div( vf a, vf b ) { return vdivq_f32( a, b ); }
+    static inline vf sqrt( vf a ) { return vsqrtq_f32( a ); }
+#else
+    static inline vf fmadd( vf a, vf b, vf c ) { return vmlaq_f32( c, a, b ); }
+    static inline vf trunc( vf a )
+    {
+        vf truncated = vcvtq_f32_s32( vcvtq_s32_f32( a ) );
+        return select( vcltq_f32( vabsq_f32( a ), vdupq_n_f32( 8388608.0f ) ), truncated, a );
+    }
+    static inline vf div( vf a, vf b )
+    {
+        // Two Newton-Raphson steps on the reciprocal estimate give full single precision.
+        vf reciprocal = vrecpeq_f32( b );
+        reciprocal = vmulq_f32( vrecpsq_f32( b, reciprocal ), reciprocal );
+        reciprocal = vmulq_f32( vrecpsq_f32( b, reciprocal ), reciprocal );
+        return vmulq_f32( a, reciprocal );
+    }
+    static inline vf sqrt( vf a )
+    {
+        vf estimate = vrsqrteq_f32( a );
+        estimate = vmulq_f32( vrsqrtsq_f32( vmulq_f32( a, estimate ), estimate ), estimate );
+        estimate = vmulq_f32( vrsqrtsq_f32( vmulq_f32( a, estimate ), estimate ), estimate );
+        return select( vcgtq_f32( a, vdupq_n_f32( 0.0f ) ), vmulq_f32( a, estimate ), vdupq_n_f32( 0.0f ) );
+    }
+#endif
+
+    static inline vm cmplt( vf a, vf b ) { return vcltq_f32( a, b ); }
+    static inline vm cmpgt( vf a, vf b ) { return vcgtq_f32( a, b ); }
+    static inline vf select( vm mask, vf if_true, vf if_false ) { return vbslq_f32( mask, if_true, if_false ); }
+
+#if defined( __aarch64__ )
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd )
+    {
+        even = vuzp1q_f32( lo, hi );
+        odd = vuzp2q_f32( lo, hi );
+    }
+#else
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd )
+    {
+        float32x4x2_t unzipped = vuzpq_f32( lo, hi );
+        even = unzipped.val[0];
+        odd = unzipped.val[1];
+    }
+#endif
+
+#if defined( __aarch64__ )
+    static inline void interleave( vf even, vf odd, vf& lo, vf& hi )
+    {
+        lo = vzip1q_f32( even, odd );
+        hi = vzip2q_f32( even, odd );
+    }
+#else
+    static inline void interleave( vf even, vf odd, vf& lo, vf& hi )
+    {
+        float32x4x2_t zipped = vzipq_f32( even, odd );
+        lo = zipped.val[0];
+        hi = zipped.val[1];
+    }
+#endif
+
+    static inline vf reverse( vf a )
+    {
+        vf pairs_swapped = vrev64q_f32( a );
+        return vcombine_f32( vget_high_f32( pairs_swapped ), vget_low_f32( pairs_swapped ) );
+    }
+
+    // 16-bit integer samples, one per lane. Stores round to nearest and saturate.
+    static inline vf load_s16( const int16_t* ptr ) { return vcvtq_f32_s32( vmovl_s16( vld1_s16( ptr ) ) ); }
+    static inline void store_s16( int16_t* ptr, vf value )
+    {
+        const vf clamped = vminq_f32( vmaxq_f32( value, vdupq_n_f32( -32768.0f ) ), vdupq_n_f32( 32767.0f ) );
+#if defined( __aarch64__ )
+        const int32x4_t rounded = vcvtnq_s32_f32( clamped );
+#else
+        // Conversion truncates here, so add a half away from zero first.
+        const vf half = vreinterpretq_f32_u32( vorrq_u32( vreinterpretq_u32_f32( sign( clamped ) ),
+                                                          vreinterpretq_u32_f32( vdupq_n_f32( 0.5f ) ) ) );
+        const int32x4_t rounded = vcvtq_s32_f32( vaddq_f32( clamped, half ) );
+#endif
+        vst1_s16( ptr, vqmovn_s32( rounded ) );
+    }
+
+    // 32-bit unsigned integer lanes, for random number generation.
+    static inline vu set1_u32( uint32_t value ) { return vdupq_n_u32( value ); }
+    static inline vu loadu_u32( const uint32_t* ptr ) { return vld1q_u32( ptr ); }
+    static inline void storeu_u32( uint32_t* ptr, vu value ) { vst1q_u32( ptr, value ); }
+    static inline vu xor_u32( vu a, vu b ) { return veorq_u32( a, b ); }
+    static inline void mul_wide_u32( vu a, uint32_t b, vu& hi, vu& lo )
+    {
+        const uint32x2_t factor = vdup_n_u32( b );
+        const uint64x2_t low_products = vmull_u32( vget_low_u32( a ), factor );
+        const uint64x2_t high_products = vmull_u32( vget_high_u32( a ), factor );
+        lo = vcombine_u32( vmovn_u64( low_products ), vmovn_u64( high_products ) );
+        hi = vcombine_u32( vshrn_n_u64( low_products, 32 ), vshrn_n_u64( high_products, 32 ) );
+    }
+    static inline vf u32_to_unit( vu a ) { return vmulq_f32( vcvtq_f32_u32( vshrq_n_u32( a, 8 ) ), vdupq_n_f32( 1.0f/16777216.0f ) ); }
+    static inline vf frexp( vf a, vf& exponent )
+    {
+        // Positive normal inputs only.
+        const vu bits = vreinterpretq_u32_f32( a );
+        exponent = vcvtq_f32_s32( vsubq_s32( vreinterpretq_s32_u32( vshrq_n_u32( bits, 23 ) ), vdupq_n_s32( 126 ) ) );
+        return vreinterpretq_f32_u32( vorrq_u32( vandq_u32( bits, vdupq_n_u32( 0x007FFFFFu ) ), vdupq_n_u32( 0x3F000000u ) ) );
+    }
+};
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_SIMD_NEON_H
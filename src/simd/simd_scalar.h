@@ -0,0 +1,158 @@
+//
+// Scalar fallback for the SIMD kernels - one float per "vector".
+//
+
+#ifndef CUPCAKE_VEC_LIB_SIMD_SCALAR_H
+#define CUPCAKE_VEC_LIB_SIMD_SCALAR_H
+
+// In module includes
+#include "dispatch.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+///
+/// Plain C++ traits over one double, for the double precision kernels. Also used by
+/// instruction sets without double precision vectors.
+///
+struct ScalarDouble
+{
+    typedef double vf;
+    typedef bool vm;
+    typedef double scalar;
+
+    static const size_t width = 1;
+
+    static inline vf zero() { return 0.0; }
+    static inline vf set1( double value ) { return value; }
+    static inline vf loadu( const double* ptr ) { return *ptr; }
+    static inline void storeu( double* ptr, vf value ) { *ptr = value; }
+
+    static inline vf add( vf a, vf b ) { return a + b; }
+    static inline vf sub( vf a, vf b ) { return a - b; }
+    static inline vf mul( vf a, vf b ) { return a*b; }
+    static inline vf div( vf a, vf b ) { return a/b; }
+    static inline vf fmadd( vf a, vf b, vf c ) { return a*b + c; }
+    static inline vf min( vf a, vf b ) { return a < b ? a : b; }
+    static inline vf max( vf a, vf b ) { return a > b ? a : b; }
+    static inline vf abs( vf a ) { return fabs( a ); }
+    static inline vf trunc( vf a ) { return ::trunc( a ); }
+    static inline vf sqrt( vf a ) { return ::sqrt( a ); }
+    static inline vf sign( vf a ) { return copysign( 0.0, a ); }
+    static inline vf xor_bits( vf a, vf b )
+    {
+        uint64_t ia, ib;
+        memcpy( &ia, &a, sizeof( ia ) );
+        memcpy( &ib, &b, sizeof( ib ) );
+        ia ^= ib;
+        memcpy( &a, &ia, sizeof( a ) );
+        return a;
+    }
+
+    static inline vm cmplt( vf a, vf b ) { return a < b; }
+    static inline vm cmpgt( vf a, vf b ) { return a > b; }
+    static inline vf select( vm mask, vf if_true, vf if_false ) { return mask ? if_true : if_false; }
+
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd ) { even = lo; odd = hi; }
+};
+
+///
+/// ISA traits for plain C++. Used where no vector instruction set is available,
+/// and as the reference that all other ISA traits must agree with.
+///
+struct Scalar
+{
+    typedef float vf;
+    typedef bool vm;
+    typedef uint32_t vu;
+    typedef float scalar;
+    typedef ScalarDouble Double;
+
+    static const ISA isa = ISA::scalar;
+    static const size_t width = 1;
+
+    static inline vf zero() { return 0.0f; }
+    static inline vf set1( float value ) { return value; }
+    static inline vf loadu( const float* ptr ) { return *ptr; }
+    static inline void storeu( float* ptr, vf value ) { *ptr = value; }
+
+    static inline vf add( vf a, vf b ) { return a + b; }
+    static inline vf sub( vf a, vf b ) { return a - b; }
+    static inline vf mul( vf a, vf b ) { return a*b; }
+    static inline vf div( vf a, vf b ) { return a/b; }
+    static inline vf fmadd( vf a, vf b, vf c ) { return a*b + c; }
+    static inline vf min( vf a, vf b ) { return a < b ? a : b; }
+    static inline vf max( vf a, vf b ) { return a > b ? a : b; }
+    static inline vf abs( vf a ) { return fabsf( a ); }
+    static inline vf trunc( vf a ) { return truncf( a ); }
+    static inline vf sqrt( vf a ) { return sqrtf( a ); }
+    static inline vf sign( vf a ) { return copysignf( 0.0f, a ); }
+    static inline vf xor_bits( vf a, vf b )
+    {
+        unsigned int ia, ib;
+        memcpy( &ia, &a, sizeof( ia ) );
+        memcpy( &ib, &b, sizeof( ib ) );
+        ia ^= ib;
+        memcpy( &a, &ia, sizeof( a ) );
+        return a;
+    }
+
+    static inline vm cmplt( vf a, vf b ) { return a < b; }
+    static inline vm cmpgt( vf a, vf b ) { return a > b; }
+    static inline vf select( vm mask, vf if_true, vf if_false ) { return mask ? if_true : if_false; }
+
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd ) { even = lo; odd = hi; }
+    static inline void interleave( vf even, vf odd, vf& lo, vf& hi ) { lo = even; hi = odd; }
+    static inline vf reverse( vf a ) { return a; }
+
+    // 16-bit integer samples, one per lane. Stores round to nearest and saturate.
+    static inline vf load_s16( const int16_t* ptr ) { return static_cast< float >( *ptr ); }
+    static inline void store_s16( int16_t* ptr, vf value )
+    {
+        const vf clamped = value > -32768.0f ? ( value < 32767.0f ? value : 32767.0f ) : -32768.0f;
+        *ptr = static_cast< int16_t >( lrintf( clamped ) );
+    }
+
+    // 32-bit unsigned integer lanes, for random number generation.
+    static inline vu set1_u32( uint32_t value ) { return value; }
+    static inline vu loadu_u32( const uint32_t* ptr ) { return *ptr; }
+    static inline void storeu_u32( uint32_t* ptr, vu value ) { *ptr = value; }
+    static inline vu xor_u32( vu a, vu b ) { return a ^ b; }
+    static inline void mul_wide_u32( vu a, uint32_t b, vu& hi, vu& lo )
+    {
+        const uint64_t product = static_cast< uint64_t >( a )*b;
+        hi = static_cast< uint32_t >( product >> 32 );
+        lo = static_cast< uint32_t >( product );
+    }
+    static inline vf u32_to_unit( vu a ) { return static_cast< float >( static_cast< int32_t >( a >> 8 ) )*( 1.0f/16777216.0f ); }
+    static inline vf frexp( vf a, vf& exponent )
+    {
+        int e;
+        const vf mantissa = frexpf( a, &e );
+        exponent = static_cast< float >( e );
+        return mantissa;
+    }
+};
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_SIMD_SCALAR_H
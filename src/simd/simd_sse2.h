@@ -0,0 +1,184 @@
+//
+// SSE2 traits for the SIMD kernels - four floats per vector.
+//
+
+#ifndef CUPCAKE_VEC_LIB_SIMD_SSE2_H
+#define CUPCAKE_VEC_LIB_SIMD_SSE2_H
+
+// In module includes
+#include "dispatch.h"
+
+// Thirdparty includes
+#include <emmintrin.h>
+
+// Std Lib includes
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+///
+/// SSE2 traits over two doubles per vector, for the double precision kernels. Only the
+/// operations the elementwise kernels use are provided.
+///
+struct SSE2Double
+{
+    typedef __m128d vf;
+    typedef __m128d vm;
+    typedef double scalar;
+
+    static const size_t width = 2;
+
+    static inline vf zero() { return _mm_setzero_pd(); }
+    static inline vf set1( double value ) { return _mm_set1_pd( value ); }
+    static inline vf loadu( const double* ptr ) { return _mm_loadu_pd( ptr ); }
+    static inline void storeu( double* ptr, vf value ) { _mm_storeu_pd( ptr, value ); }
+
+    static inline vf add( vf a, vf b ) { return _mm_add_pd( a, b ); }
+    static inline vf sub( vf a, vf b ) { return _mm_sub_pd( a, b ); }
+    static inline vf mul( vf a, vf b ) { return _mm_mul_pd( a, b ); }
+    static inline vf div( vf a, vf b ) { return _mm_div_pd( a, b ); }
+    static inline vf fmadd( vf a, vf b, vf c ) { return _mm_add_pd( _mm_mul_pd( a, b ), c ); }
+    static inline vf min( vf a, vf b ) { return _mm_min_pd( a, b ); }
+    static inline vf max( vf a, vf b ) { return _mm_max_pd( a, b ); }
+    static inline vf abs( vf a ) { return _mm_andnot_pd( _mm_set1_pd( -0.0 ), a ); }
+    static inline vf sqrt( vf a ) { return _mm_sqrt_pd( a ); }
+    static inline vf sign( vf a ) { return _mm_and_pd( _mm_set1_pd( -0.0 ), a ); }
+    static inline vf xor_bits( vf a, vf b ) { return _mm_xor_pd( a, b ); }
+
+    static inline vf trunc( vf a )
+    {
+        // No packed double to integer conversion before AVX-512. Adding and subtracting 2^52
+        // rounds the magnitude to nearest, then one is taken off wherever that rounded up.
+        const vf magnitude = abs( a );
+        const vf two_52 = _mm_set1_pd( 4503599627370496.0 );
+        vf rounded = _mm_sub_pd( _mm_add_pd( magnitude, two_52 ), two_52 );
+        rounded = _mm_sub_pd( rounded, _mm_and_pd( _mm_cmpgt_pd( rounded, magnitude ), _mm_set1_pd( 1.0 ) ) );
+        const vf truncated = _mm_or_pd( rounded, _mm_and_pd( _mm_set1_pd( -0.0 ), a ) );
+        return select( _mm_cmplt_pd( magnitude, two_52 ), truncated, a );
+    }
+
+    static inline vm cmplt( vf a, vf b ) { return _mm_cmplt_pd( a, b ); }
+    static inline vm cmpgt( vf a, vf b ) { return _mm_cmpgt_pd( a, b ); }
+    static inline vf select( vm mask, vf if_true, vf if_false )
+    {
+        return _mm_or_pd( _mm_and_pd( mask, if_true ), _mm_andnot_pd( mask, if_false ) );
+    }
+
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd )
+    {
+        even = _mm_unpacklo_pd( lo, hi );
+        odd = _mm_unpackhi_pd( lo, hi );
+    }
+};
+
+///
+/// ISA traits for SSE2, the x86-64 baseline.
+///
+struct SSE2
+{
+    typedef __m128 vf;
+    typedef __m128 vm;
+    typedef __m128i vu;
+    typedef float scalar;
+    typedef SSE2Double Double;
+
+    static const ISA isa = ISA::sse2;
+    static const size_t width = 4;
+
+    static inline vf zero() { return _mm_setzero_ps(); }
+    static inline vf set1( float value ) { return _mm_set1_ps( value ); }
+    static inline vf loadu( const float* ptr ) { return _mm_loadu_ps( ptr ); }
+    static inline void storeu( float* ptr, vf value ) { _mm_storeu_ps( ptr, value ); }
+
+    static inline vf add( vf a, vf b ) { return _mm_add_ps( a, b ); }
+    static inline vf sub( vf a, vf b ) { return _mm_sub_ps( a, b ); }
+    static inline vf mul( vf a, vf b ) { return _mm_mul_ps( a, b ); }
+    static inline vf div( vf a, vf b ) { return _mm_div_ps( a, b ); }
+    static inline vf fmadd( vf a, vf b, vf c ) { return _mm_add_ps( _mm_mul_ps( a, b ), c ); }
+    static inline vf min( vf a, vf b ) { return _mm_min_ps( a, b ); }
+    static inline vf max( vf a, vf b ) { return _mm_max_ps( a, b ); }
+    static inline vf abs( vf a ) { return _mm_andnot_ps( _mm_set1_ps( -0.0f ), a ); }
+    static inline vf sqrt( vf a ) { return _mm_sqrt_ps( a ); }
+    static inline vf sign( vf a ) { return _mm_and_ps( _mm_set1_ps( -0.0f ), a ); }
+    static inline vf xor_bits( vf a, vf b ) { return _mm_xor_ps( a, b ); }
+
+    static inline vf trunc( vf a )
+    {
+        // cvttps is only exact below 2^31, but anything at or above 2^23 is already integral.
+        vf truncated = _mm_cvtepi32_ps( _mm_cvttps_epi32( a ) );
+        return select( _mm_cmplt_ps( abs( a ), _mm_set1_ps( 8388608.0f ) ), truncated, a );
+    }
+
+    static inline vm cmplt( vf a, vf b ) { return _mm_cmplt_ps( a, b ); }
+    static inline vm cmpgt( vf a, vf b ) { return _mm_cmpgt_ps( a, b ); }
+    static inline vf select( vm mask, vf if_true, vf if_false )
+    {
+        return _mm_or_ps( _mm_and_ps( mask, if_true ), _mm_andnot_ps( mask, if_false ) );
+    }
+
+    static inline void deinterleave( vf lo, vf hi, vf& even, vf& odd )
+    {
+        even = _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+        odd = _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+    }
+
+    static inline void interleave( vf even, vf odd, vf& lo, vf& hi )
+    {
+        lo = _mm_unpacklo_ps( even, odd );
+        hi = _mm_unpackhi_ps( even, odd );
+    }
+
+    static inline vf reverse( vf a ) { return _mm_shuffle_ps( a, a, _MM_SHUFFLE( 0, 1, 2, 3 ) ); }
+
+    // 16-bit integer samples, one per lane. Stores round to nearest and saturate.
+    static inline vf load_s16( const int16_t* ptr )
+    {
+        const __m128i packed = _mm_loadl_epi64( reinterpret_cast< const __m128i* >( ptr ) );
+        return _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( packed, packed ), 16 ) );
+    }
+    static inline void store_s16( int16_t* ptr, vf value )
+    {
+        const vf clamped = _mm_min_ps( _mm_max_ps( value, _mm_set1_ps( -32768.0f ) ), _mm_set1_ps( 32767.0f ) );
+        const __m128i rounded = _mm_cvtps_epi32( clamped );
+        _mm_storel_epi64( reinterpret_cast< __m128i* >( ptr ), _mm_packs_epi32( rounded, rounded ) );
+    }
+
+    // 32-bit unsigned integer lanes, for random number generation.
+    static inline vu set1_u32( uint32_t value ) { return _mm_set1_epi32( static_cast< int >( value ) ); }
+    static inline vu loadu_u32( const uint32_t* ptr ) { return _mm_loadu_si128( reinterpret_cast< const __m128i* >( ptr ) ); }
+    static inline void storeu_u32( uint32_t* ptr, vu value ) { _mm_storeu_si128( reinterpret_cast< __m128i* >( ptr ), value ); }
+    static inline vu xor_u32( vu a, vu b ) { return _mm_xor_si128( a, b ); }
+    static inline void mul_wide_u32( vu a, uint32_t b, vu& hi, vu& lo )
+    {
+        // Even and odd lanes multiply separately into 64-bit products, then the halves are regathered.
+        const vu factor = _mm_set1_epi32( static_cast< int >( b ) );
+        const vu even = _mm_shuffle_epi32( _mm_mul_epu32( a, factor ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        const vu odd = _mm_shuffle_epi32( _mm_mul_epu32( _mm_srli_epi64( a, 32 ), factor ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        lo = _mm_unpacklo_epi32( even, odd );
+        hi = _mm_unpackhi_epi32( even, odd );
+    }
+    static inline vf u32_to_unit( vu a ) { return _mm_mul_ps( _mm_cvtepi32_ps( _mm_srli_epi32( a, 8 ) ), _mm_set1_ps( 1.0f/16777216.0f ) ); }
+    static inline vf frexp( vf a, vf& exponent )
+    {
+        // Positive normal inputs only.
+        const vu bits = _mm_castps_si128( a );
+        exponent = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 126 ) ) );
+        return _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32( 0x007FFFFF ) ), _mm_set1_epi32( 0x3F000000 ) ) );
+    }
+};
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_SIMD_SSE2_H
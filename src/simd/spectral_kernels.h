@@ -0,0 +1,688 @@
+//
+// SIMD kernels for operations on interleaved complex spectra.
+//
+
+#ifndef CUPCAKE_VEC_LIB_SPECTRAL_KERNELS_H
+#define CUPCAKE_VEC_LIB_SPECTRAL_KERNELS_H
+
+// In module includes
+#include "oscillator_kernels.h"
+#include "random_kernels.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+//
+// As with vector_kernels.h, everything here is a template on the ISA traits, V.
+// Complex input is interleaved (re, im) pairs, so each step loads 2*V::width floats
+// and splits them into a vector of real parts and a vector of imaginary parts.
+//
+
+template< class V >
+inline typename V::vf magnitude( typename V::vf re, typename V::vf im )
+///
+/// Returns sqrt( re^2 + im^2 ) for each lane.
+///
+{
+    return V::sqrt( V::fmadd( re, re, V::mul( im, im ) ) );
+}
+
+template< class V >
+inline typename V::vf unfold_octants( typename V::vf angle, typename V::vf y, typename V::vf x,
+                                      typename V::vf abs_y, typename V::vf abs_x )
+///
+/// Maps the arctangent of min( |x|,|y| )/max( |x|,|y| ), in [0,pi/4], to the four quadrant
+/// angle of ( x, y ).
+///
+{
+    angle = V::select( V::cmpgt( abs_y, abs_x ), V::sub( V::set1( 1.57079632679f ), angle ), angle );
+    angle = V::select( V::cmplt( x, V::zero() ), V::sub( V::set1( 3.14159265359f ), angle ), angle );
+    return V::xor_bits( angle, V::sign( y ) );
+}
+
+template< class V >
+inline typename V::vf folded_ratio( typename V::vf abs_y, typename V::vf abs_x )
+///
+/// Returns min( |x|,|y| )/max( |x|,|y| ), in [0,1], guarding 0/0 at the origin so that it
+/// maps to an angle of 0.
+///
+{
+    typename V::vf larger = V::max( abs_x, abs_y );
+    typename V::vf smaller = V::min( abs_x, abs_y );
+    return V::select( V::cmpgt( larger, V::zero() ), V::div( smaller, larger ), V::zero() );
+}
+
+template< class V >
+inline typename V::vf atan2( typename V::vf y, typename V::vf x )
+///
+/// Four quadrant arctangent of y/x for each lane, in the range [-pi,pi].
+///
+/// The ratio of the smaller to the larger magnitude is reduced to [0,tan(pi/8)] and
+/// evaluated with the Cephes atanf polynomial, giving a maximum error of about 3e-7 rad.
+///
+{
+    typedef typename V::vf vf;
+
+    vf abs_x = V::abs( x );
+    vf abs_y = V::abs( y );
+    vf a = folded_ratio< V >( abs_y, abs_x );
+
+    typename V::vm reduce = V::cmpgt( a, V::set1( 0.41421356237f ) );
+    a = V::select( reduce, V::div( V::sub( a, V::set1( 1.0f ) ), V::add( a, V::set1( 1.0f ) ) ), a );
+    vf offset = V::select( reduce, V::set1( 0.78539816340f ), V::zero() );
+
+    vf z = V::mul( a, a );
+    vf poly = V::set1( 8.05374449538e-2f );
+    poly = V::fmadd( poly, z, V::set1( -1.38776856032e-1f ) );
+    poly = V::fmadd( poly, z, V::set1( 1.99777106478e-1f ) );
+    poly = V::fmadd( poly, z, V::set1( -3.33329491539e-1f ) );
+    vf result = V::add( V::fmadd( V::mul( poly, z ), a, a ), offset );
+
+    return unfold_octants< V >( result, y, x, abs_y, abs_x );
+}
+
+template< class V >
+inline typename V::vf atan2_medium( typename V::vf y, typename V::vf x )
+///
+/// As atan2, but with a degree 11 minimax polynomial over the whole of [0,1] in place of
+/// the range reduction. Maximum error 2e-6 rad.
+///
+{
+    typedef typename V::vf vf;
+
+    vf abs_x = V::abs( x );
+    vf abs_y = V::abs( y );
+    vf a = folded_ratio< V >( abs_y, abs_x );
+
+    vf z = V::mul( a, a );
+    vf poly = V::set1( -1.171913573e-2f );
+    poly = V::fmadd( poly, z, V::set1( 5.264735147e-2f ) );
+    poly = V::fmadd( poly, z, V::set1( -1.164264820e-1f ) );
+    poly = V::fmadd( poly, z, V::set1( 1.935403761e-1f ) );
+    poly = V::fmadd( poly, z, V::set1( -3.326228279e-1f ) );
+    poly = V::fmadd( poly, z, V::set1( 9.999772191e-1f ) );
+
+    return unfold_octants< V >( V::mul( poly, a ), y, x, abs_y, abs_x );
+}
+
+template< class V >
+inline typename V::vf atan2_fast( typename V::vf y, typename V::vf x )
+///
+/// As atan2_medium, with a degree 7 polynomial. Maximum error 1e-4 rad.
+///
+{
+    typedef typename V::vf vf;
+
+    vf abs_x = V::abs( x );
+    vf abs_y = V::abs( y );
+    vf a = folded_ratio< V >( abs_y, abs_x );
+
+    vf z = V::mul( a, a );
+    vf poly = V::set1( -3.898651416e-2f );
+    poly = V::fmadd( poly, z, V::set1( 1.462644636e-1f ) );
+    poly = V::fmadd( poly, z, V::set1( -3.211749693e-1f ) );
+    poly = V::fmadd( poly, z, V::set1( 9.992138126e-1f ) );
+
+    return unfold_octants< V >( V::mul( poly, a ), y, x, abs_y, abs_x );
+}
+
+template< class D >
+inline typename D::vf atan2_double( typename D::vf y, typename D::vf x )
+///
+/// As atan2, over doubles, for D a V::Double. The ratio is reduced to [0,0.66] and
+/// evaluated with the Cephes atan rational function, giving a maximum error of a few ulps.
+///
+{
+    typedef typename D::vf vf;
+
+    vf abs_x = D::abs( x );
+    vf abs_y = D::abs( y );
+    vf a = folded_ratio< D >( abs_y, abs_x );
+
+    // The low bits of pi/4 are added back separately, after the rational function.
+    typename D::vm reduce = D::cmpgt( a, D::set1( 0.66 ) );
+    a = D::select( reduce, D::div( D::sub( a, D::set1( 1.0 ) ), D::add( a, D::set1( 1.0 ) ) ), a );
+    vf offset = D::select( reduce, D::set1( 7.85398163397448309616e-1 ), D::zero() );
+    vf offset_low = D::select( reduce, D::set1( 3.06161699786838294307e-17 ), D::zero() );
+
+    vf z = D::mul( a, a );
+    vf p = D::set1( -8.750608600031904122785e-1 );
+    p = D::fmadd( p, z, D::set1( -1.615753718733365076637e1 ) );
+    p = D::fmadd( p, z, D::set1( -7.500855792314704667340e1 ) );
+    p = D::fmadd( p, z, D::set1( -1.228866684490136173410e2 ) );
+    p = D::fmadd( p, z, D::set1( -6.485021904942025371773e1 ) );
+    vf q = D::add( z, D::set1( 2.485846490142306297962e1 ) );
+    q = D::fmadd( q, z, D::set1( 1.650270098316988542046e2 ) );
+    q = D::fmadd( q, z, D::set1( 4.328810604912902668951e2 ) );
+    q = D::fmadd( q, z, D::set1( 4.853903996359136964868e2 ) );
+    q = D::fmadd( q, z, D::set1( 1.945506571482613964425e2 ) );
+    vf angle = D::add( offset, D::add( D::fmadd( D::mul( a, z ), D::div( p, q ), a ), offset_low ) );
+
+    angle = D::select( D::cmpgt( abs_y, abs_x ), D::sub( D::set1( 1.57079632679489661923 ), angle ), angle );
+    angle = D::select( D::cmplt( x, D::zero() ), D::sub( D::set1( 3.14159265358979323846 ), angle ), angle );
+    return D::xor_bits( angle, D::sign( y ) );
+}
+
+//
+// Angle policies, so each accuracy level gets its own copy of the loops below.
+//
+
+template< class V >
+struct FullAtan2
+{
+    static inline typename V::vf apply( typename V::vf y, typename V::vf x ) { return atan2< V >( y, x ); }
+};
+
+template< class V >
+struct MediumAtan2
+{
+    static inline typename V::vf apply( typename V::vf y, typename V::vf x ) { return atan2_medium< V >( y, x ); }
+};
+
+template< class V >
+struct FastAtan2
+{
+    static inline typename V::vf apply( typename V::vf y, typename V::vf x ) { return atan2_fast< V >( y, x ); }
+};
+
+template< class D >
+struct DoubleAtan2
+{
+    static inline typename D::vf apply( typename D::vf y, typename D::vf x ) { return atan2_double< D >( y, x ); }
+};
+
+//
+// The _split kernels take the real and imaginary parts in separate arrays, which load
+// straight into vectors.
+//
+
+template< class V >
+inline void spectral_magnitude_split( const float* real, const float* imag, float* output, size_t length )
+///
+/// Computes the magnitude of length complex values held as separate real and imaginary
+/// arrays.
+///
+{
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        V::storeu( output + i, magnitude< V >( V::loadu( real + i ), V::loadu( imag + i ) ) );
+    }
+    if( i < length )
+    {
+        float tail_re[ W ] = {};
+        float tail_im[ W ] = {};
+        float tail_out[ W ];
+        memcpy( tail_re, real + i, ( length - i )*sizeof( float ) );
+        memcpy( tail_im, imag + i, ( length - i )*sizeof( float ) );
+        V::storeu( tail_out, magnitude< V >( V::loadu( tail_re ), V::loadu( tail_im ) ) );
+        memcpy( output + i, tail_out, ( length - i )*sizeof( float ) );
+    }
+}
+
+template< class V, class Angle >
+inline void phase_spectra_split( const float* real, const float* imag, float* output, size_t length )
+///
+/// Computes the argument of length complex values held as separate real and imaginary
+/// arrays, with Angle one of the atan2 policies above.
+///
+{
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        V::storeu( output + i, Angle::apply( V::loadu( imag + i ), V::loadu( real + i ) ) );
+    }
+    if( i < length )
+    {
+        float tail_re[ W ] = {};
+        float tail_im[ W ] = {};
+        float tail_out[ W ];
+        memcpy( tail_re, real + i, ( length - i )*sizeof( float ) );
+        memcpy( tail_im, imag + i, ( length - i )*sizeof( float ) );
+        V::storeu( tail_out, Angle::apply( V::loadu( tail_im ), V::loadu( tail_re ) ) );
+        memcpy( output + i, tail_out, ( length - i )*sizeof( float ) );
+    }
+}
+
+template< class V, class Angle >
+inline void cart_to_polar_split( const float* real, const float* imag, float* magnitude_out, float* phase_out, size_t length )
+///
+/// Computes the magnitude and argument of length complex values held as separate real and
+/// imaginary arrays in one pass, with Angle one of the atan2 policies above.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        const vf re = V::loadu( real + i );
+        const vf im = V::loadu( imag + i );
+        V::storeu( magnitude_out + i, magnitude< V >( re, im ) );
+        V::storeu( phase_out + i, Angle::apply( im, re ) );
+    }
+    if( i < length )
+    {
+        float tail_re[ W ] = {};
+        float tail_im[ W ] = {};
+        float tail_mag[ W ];
+        float tail_phase[ W ];
+        memcpy( tail_re, real + i, ( length - i )*sizeof( float ) );
+        memcpy( tail_im, imag + i, ( length - i )*sizeof( float ) );
+        const vf re = V::loadu( tail_re );
+        const vf im = V::loadu( tail_im );
+        V::storeu( tail_mag, magnitude< V >( re, im ) );
+        V::storeu( tail_phase, Angle::apply( im, re ) );
+        memcpy( magnitude_out + i, tail_mag, ( length - i )*sizeof( float ) );
+        memcpy( phase_out + i, tail_phase, ( length - i )*sizeof( float ) );
+    }
+}
+
+template< class V >
+inline void deinterleave_complex( const float* input, float* real, float* imag, size_t length )
+///
+/// Splits length interleaved complex values into separate real and imaginary arrays.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        vf re, im;
+        V::deinterleave( V::loadu( input + 2*i ), V::loadu( input + 2*i + W ), re, im );
+        V::storeu( real + i, re );
+        V::storeu( imag + i, im );
+    }
+    for( ; i < length; ++i )
+    {
+        real[i] = input[ 2*i ];
+        imag[i] = input[ 2*i + 1 ];
+    }
+}
+
+template< class V >
+inline void interleave_complex( const float* real, const float* imag, float* output, size_t length )
+///
+/// Merges separate real and imaginary arrays into length interleaved complex values.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        vf lo, hi;
+        V::interleave( V::loadu( real + i ), V::loadu( imag + i ), lo, hi );
+        V::storeu( output + 2*i, lo );
+        V::storeu( output + 2*i + W, hi );
+    }
+    for( ; i < length; ++i )
+    {
+        output[ 2*i ] = real[i];
+        output[ 2*i + 1 ] = imag[i];
+    }
+}
+
+template< class V >
+inline typename V::vf natural_log( typename V::vf x )
+///
+/// Returns log( x ) for positive normal x in each lane, accurate to a few ulps.
+///
+{
+    typename V::vf exponent;
+    const typename V::vf mantissa = V::frexp( x, exponent );
+    const typename V::vm low = V::cmplt( mantissa, V::set1( 0.707106781186547524f ) );
+    return log_unit< V >( V::select( low, V::sub( V::add( mantissa, mantissa ), V::set1( 1.0f ) ), V::sub( mantissa, V::set1( 1.0f ) ) ),
+                          V::select( low, V::sub( exponent, V::set1( 1.0f ) ), exponent ) );
+}
+
+//
+// Complex products, accumulated into re and im so that one loop serves both the plain
+// and the accumulating forms.
+//
+
+template< class V >
+struct ComplexMul
+{
+    static inline void apply( typename V::vf a_re, typename V::vf a_im, typename V::vf b_re, typename V::vf b_im,
+                              typename V::vf& re, typename V::vf& im )
+    {
+        re = V::sub( V::fmadd( a_re, b_re, re ), V::mul( a_im, b_im ) );
+        im = V::fmadd( a_re, b_im, V::fmadd( a_im, b_re, im ) );
+    }
+};
+
+template< class V >
+struct ConjugateMul
+{
+    static inline void apply( typename V::vf a_re, typename V::vf a_im, typename V::vf b_re, typename V::vf b_im,
+                              typename V::vf& re, typename V::vf& im )
+    {
+        re = V::fmadd( a_re, b_re, V::fmadd( a_im, b_im, re ) );
+        im = V::sub( V::fmadd( a_re, b_im, im ), V::mul( a_im, b_re ) );
+    }
+};
+
+template< class V, class Product, bool Accumulate >
+inline void map_complex_binary( const float* input1, const float* input2, float* output, size_t length )
+///
+/// Computes a product of two vectors of interleaved complex values, with Product one of
+/// ComplexMul or ConjugateMul, and either stores it or, with Accumulate, adds it to output.
+///
+/// @param input1
+///  A pointer to 2*length floats, alternating real and imaginary parts.
+///
+/// @param input2
+///  A pointer to 2*length floats, alternating real and imaginary parts.
+///
+/// @param output
+///  A pointer to 2*length floats in which to place, or to which to add, the products. May
+///  be equal to input1 or input2.
+///
+/// @param length
+///  The number of complex values in each vector.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        vf a_re, a_im, b_re, b_im;
+        V::deinterleave( V::loadu( input1 + 2*i ), V::loadu( input1 + 2*i + W ), a_re, a_im );
+        V::deinterleave( V::loadu( input2 + 2*i ), V::loadu( input2 + 2*i + W ), b_re, b_im );
+        vf re = V::zero();
+        vf im = V::zero();
+        if( Accumulate )
+        {
+            V::deinterleave( V::loadu( output + 2*i ), V::loadu( output + 2*i + W ), re, im );
+        }
+        Product::apply( a_re, a_im, b_re, b_im, re, im );
+        vf lo, hi;
+        V::interleave( re, im, lo, hi );
+        V::storeu( output + 2*i, lo );
+        V::storeu( output + 2*i + W, hi );
+    }
+    if( i < length )
+    {
+        float tail_a[ 2*W ] = {};
+        float tail_b[ 2*W ] = {};
+        float tail_out[ 2*W ] = {};
+        const size_t bytes = 2*( length - i )*sizeof( float );
+        memcpy( tail_a, input1 + 2*i, bytes );
+        memcpy( tail_b, input2 + 2*i, bytes );
+        if( Accumulate )
+        {
+            memcpy( tail_out, output + 2*i, bytes );
+        }
+        map_complex_binary< V, Product, Accumulate >( tail_a, tail_b, tail_out, W );
+        memcpy( output + 2*i, tail_out, bytes );
+    }
+}
+
+template< class V >
+inline void spectral_magnitude( const typename V::scalar* input, typename V::scalar* output, size_t length )
+///
+/// Computes the magnitude of length interleaved complex values. Also runs over doubles
+/// when given V::Double.
+///
+/// @param input
+///  A pointer to 2*length values, alternating real and imaginary parts.
+///
+/// @param output
+///  A pointer to length values in which to place the magnitudes.
+///
+/// @param length
+///  The number of complex values in input.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        vf re, im;
+        V::deinterleave( V::loadu( input + 2*i ), V::loadu( input + 2*i + W ), re, im );
+        V::storeu( output + i, magnitude< V >( re, im ) );
+    }
+    if( i < length )
+    {
+        typename V::scalar tail_in[ 2*W ] = {};
+        typename V::scalar tail_out[ W ];
+        memcpy( tail_in, input + 2*i, 2*( length - i )*sizeof( typename V::scalar ) );
+        vf re, im;
+        V::deinterleave( V::loadu( tail_in ), V::loadu( tail_in + W ), re, im );
+        V::storeu( tail_out, magnitude< V >( re, im ) );
+        memcpy( output + i, tail_out, ( length - i )*sizeof( typename V::scalar ) );
+    }
+}
+
+template< class V, class Angle >
+inline void phase_spectra( const typename V::scalar* input, typename V::scalar* output, size_t length )
+///
+/// Computes the argument of length interleaved complex values, with Angle one of the
+/// atan2 policies above. Also runs over doubles when given V::Double and DoubleAtan2.
+///
+/// @param input
+///  A pointer to 2*length values, alternating real and imaginary parts.
+///
+/// @param output
+///  A pointer to length values in which to place the arguments.
+///
+/// @param length
+///  The number of complex values in input.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        vf re, im;
+        V::deinterleave( V::loadu( input + 2*i ), V::loadu( input + 2*i + W ), re, im );
+        V::storeu( output + i, Angle::apply( im, re ) );
+    }
+    if( i < length )
+    {
+        typename V::scalar tail_in[ 2*W ] = {};
+        typename V::scalar tail_out[ W ];
+        memcpy( tail_in, input + 2*i, 2*( length - i )*sizeof( typename V::scalar ) );
+        vf re, im;
+        V::deinterleave( V::loadu( tail_in ), V::loadu( tail_in + W ), re, im );
+        V::storeu( tail_out, Angle::apply( im, re ) );
+        memcpy( output + i, tail_out, ( length - i )*sizeof( typename V::scalar ) );
+    }
+}
+
+template< class V, class Angle >
+inline void cart_to_polar( const typename V::scalar* input, typename V::scalar* magnitude_out, typename V::scalar* phase_out, size_t length )
+///
+/// Computes the magnitude and argument of length interleaved complex values in one pass,
+/// with Angle one of the atan2 policies above. Also runs over doubles when given V::Double
+/// and DoubleAtan2.
+///
+/// @param input
+///  A pointer to 2*length values, alternating real and imaginary parts.
+///
+/// @param magnitude_out
+///  A pointer to length values in which to place the magnitudes.
+///
+/// @param phase_out
+///  A pointer to length values in which to place the arguments.
+///
+/// @param length
+///  The number of complex values in input.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        vf re, im;
+        V::deinterleave( V::loadu( input + 2*i ), V::loadu( input + 2*i + W ), re, im );
+        V::storeu( magnitude_out + i, magnitude< V >( re, im ) );
+        V::storeu( phase_out + i, Angle::apply( im, re ) );
+    }
+    if( i < length )
+    {
+        typename V::scalar tail_in[ 2*W ] = {};
+        typename V::scalar tail_mag[ W ];
+        typename V::scalar tail_phase[ W ];
+        memcpy( tail_in, input + 2*i, 2*( length - i )*sizeof( typename V::scalar ) );
+        vf re, im;
+        V::deinterleave( V::loadu( tail_in ), V::loadu( tail_in + W ), re, im );
+        V::storeu( tail_mag, magnitude< V >( re, im ) );
+        V::storeu( tail_phase, Angle::apply( im, re ) );
+        memcpy( magnitude_out + i, tail_mag, ( length - i )*sizeof( typename V::scalar ) );
+        memcpy( phase_out + i, tail_phase, ( length - i )*sizeof( typename V::scalar ) );
+    }
+}
+
+template< class V >
+inline void spectral_power( const float* input, float* output, size_t length )
+///
+/// Computes the squared magnitude of length interleaved complex values.
+///
+/// @param input
+///  A pointer to 2*length floats, alternating real and imaginary parts.
+///
+/// @param output
+///  A pointer to length floats in which to place re^2 + im^2 of each value.
+///
+/// @param length
+///  The number of complex values in input.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        vf re, im;
+        V::deinterleave( V::loadu( input + 2*i ), V::loadu( input + 2*i + W ), re, im );
+        V::storeu( output + i, V::fmadd( re, re, V::mul( im, im ) ) );
+    }
+    if( i < length )
+    {
+        float tail_in[ 2*W ] = {};
+        float tail_out[ W ];
+        memcpy( tail_in, input + 2*i, 2*( length - i )*sizeof( float ) );
+        spectral_power< V >( tail_in, tail_out, W );
+        memcpy( output + i, tail_out, ( length - i )*sizeof( float ) );
+    }
+}
+
+template< class V >
+inline void spectral_power_dB( const float* input, float* output, size_t length, float floor_power )
+///
+/// Computes 10*log10( max( re^2 + im^2, floor_power ) ) of length interleaved complex values
+/// in one pass. Powers that overflow are clamped to FLT_MAX.
+///
+/// @param input
+///  A pointer to 2*length floats, alternating real and imaginary parts.
+///
+/// @param output
+///  A pointer to length floats in which to place the powers in decibels.
+///
+/// @param length
+///  The number of complex values in input.
+///
+/// @param floor_power
+///  The smallest power, as a positive normal float, so that the logarithm is always finite.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    const vf floor_v = V::set1( floor_power );
+    const vf largest = V::set1( FLT_MAX );
+    const vf dB_per_neper = V::set1( 4.34294481903251828f );
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        vf re, im;
+        V::deinterleave( V::loadu( input + 2*i ), V::loadu( input + 2*i + W ), re, im );
+        const vf power = V::min( V::max( V::fmadd( re, re, V::mul( im, im ) ), floor_v ), largest );
+        V::storeu( output + i, V::mul( dB_per_neper, natural_log< V >( power ) ) );
+    }
+    if( i < length )
+    {
+        float tail_in[ 2*W ] = {};
+        float tail_out[ W ];
+        memcpy( tail_in, input + 2*i, 2*( length - i )*sizeof( float ) );
+        spectral_power_dB< V >( tail_in, tail_out, W, floor_power );
+        memcpy( output + i, tail_out, ( length - i )*sizeof( float ) );
+    }
+}
+
+template< class V >
+inline void polar_to_cart( const float* magnitude, const float* phase, float* output, size_t length )
+///
+/// Forms length interleaved complex values from their magnitudes and arguments. Phases of
+/// any size are wrapped to [-pi,pi] before the sine and cosine are taken.
+///
+/// @param magnitude
+///  A pointer to length magnitudes.
+///
+/// @param phase
+///  A pointer to length arguments, in radians.
+///
+/// @param output
+///  A pointer to 2*length floats in which to place the complex values.
+///
+/// @param length
+///  The number of values.
+///
+{
+    typedef typename V::vf vf;
+    const size_t W = V::width;
+    const vf cycles_per_radian = V::set1( 0.159154943091895336f );
+    size_t i = 0;
+    for( ; i + W <= length; i += W )
+    {
+        const vf cycles = V::mul( V::loadu( phase + i ), cycles_per_radian );
+        const vf nearest = V::trunc( V::add( cycles, V::xor_bits( V::set1( 0.5f ), V::sign( cycles ) ) ) );
+        vf s, c;
+        sincos_cycles< V >( V::sub( cycles, nearest ), s, c );
+        const vf r = V::loadu( magnitude + i );
+        vf lo, hi;
+        V::interleave( V::mul( r, c ), V::mul( r, s ), lo, hi );
+        V::storeu( output + 2*i, lo );
+        V::storeu( output + 2*i + W, hi );
+    }
+    if( i < length )
+    {
+        float tail_magnitude[ W ] = {};
+        float tail_phase[ W ] = {};
+        float tail_out[ 2*W ];
+        memcpy( tail_magnitude, magnitude + i, ( length - i )*sizeof( float ) );
+        memcpy( tail_phase, phase + i, ( length - i )*sizeof( float ) );
+        polar_to_cart< V >( tail_magnitude, tail_phase, tail_out, W );
+        memcpy( output + 2*i, tail_out, 2*( length - i )*sizeof( float ) );
+    }
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_SPECTRAL_KERNELS_H
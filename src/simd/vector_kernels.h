@@ -0,0 +1,326 @@
+//
+// Elementwise SIMD kernels, written once against the ISA traits in simd_*.h.
+//
+
+#ifndef CUPCAKE_VEC_LIB_VECTOR_KERNELS_H
+#define CUPCAKE_VEC_LIB_VECTOR_KERNELS_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace simd
+{
+
+//
+// Everything in this file is a template on the ISA traits type, V, so that each
+// instantiation has a distinct symbol and kernels built for different instruction
+// sets can live in the same binary. The maps and operations work on V::scalar, so they
+// run over doubles when given V::Double.
+//
+
+template< class V, class Op >
+inline void map_unary( const typename V::scalar* input, typename V::scalar* output, size_t length, Op op )
+///
+/// Applies a vector operation to each element of input and writes the result to output.
+/// The main loop is unrolled four vectors deep, the tail is run through a zero-padded
+/// vector so that op is only ever defined once.
+///
+/// @param input
+///  A pointer to the first element of the input vector.
+///
+/// @param output
+///  A pointer to the first element of the output vector. May be equal to input.
+///
+/// @param length
+///  The number of elements in input and output.
+///
+/// @param op
+///  A functor taking and returning a V::vf.
+///
+{
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + 4*W <= length; i += 4*W )
+    {
+        typename V::vf a0 = V::loadu( input + i );
+        typename V::vf a1 = V::loadu( input + i + W );
+        typename V::vf a2 = V::loadu( input + i + 2*W );
+        typename V::vf a3 = V::loadu( input + i + 3*W );
+        V::storeu( output + i, op( a0 ) );
+        V::storeu( output + i + W, op( a1 ) );
+        V::storeu( output + i + 2*W, op( a2 ) );
+        V::storeu( output + i + 3*W, op( a3 ) );
+    }
+    for( ; i + W <= length; i += W )
+    {
+        V::storeu( output + i, op( V::loadu( input + i ) ) );
+    }
+    if( i < length )
+    {
+        typename V::scalar tail[ W ] = {};
+        memcpy( tail, input + i, ( length - i )*sizeof( tail[0] ) );
+        V::storeu( tail, op( V::loadu( tail ) ) );
+        memcpy( output + i, tail, ( length - i )*sizeof( tail[0] ) );
+    }
+}
+
+template< class V, class Op >
+inline void map_binary( const typename V::scalar* input1, const typename V::scalar* input2, typename V::scalar* output,
+                        size_t length, Op op )
+///
+/// Applies a vector operation to each pair of elements in input1 and input2 and writes the
+/// result to output.
+///
+/// @param input1
+///  A pointer to the first element of the first operand vector.
+///
+/// @param input2
+///  A pointer to the first element of the second operand vector.
+///
+/// @param output
+///  A pointer to the first element of the output vector. May be equal to either input.
+///
+/// @param length
+///  The number of elements in all vectors.
+///
+/// @param op
+///  A functor taking two V::vf and returning a V::vf.
+///
+{
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + 4*W <= length; i += 4*W )
+    {
+        typename V::vf a0 = V::loadu( input1 + i );
+        typename V::vf a1 = V::loadu( input1 + i + W );
+        typename V::vf a2 = V::loadu( input1 + i + 2*W );
+        typename V::vf a3 = V::loadu( input1 + i + 3*W );
+        typename V::vf b0 = V::loadu( input2 + i );
+        typename V::vf b1 = V::loadu( input2 + i + W );
+        typename V::vf b2 = V::loadu( input2 + i + 2*W );
+        typename V::vf b3 = V::loadu( input2 + i + 3*W );
+        V::storeu( output + i, op( a0, b0 ) );
+        V::storeu( output + i + W, op( a1, b1 ) );
+        V::storeu( output + i + 2*W, op( a2, b2 ) );
+        V::storeu( output + i + 3*W, op( a3, b3 ) );
+    }
+    for( ; i + W <= length; i += W )
+    {
+        V::storeu( output + i, op( V::loadu( input1 + i ), V::loadu( input2 + i ) ) );
+    }
+    if( i < length )
+    {
+        typename V::scalar tail1[ W ] = {};
+        typename V::scalar tail2[ W ] = {};
+        memcpy( tail1, input1 + i, ( length - i )*sizeof( tail1[0] ) );
+        memcpy( tail2, input2 + i, ( length - i )*sizeof( tail2[0] ) );
+        V::storeu( tail1, op( V::loadu( tail1 ), V::loadu( tail2 ) ) );
+        memcpy( output + i, tail1, ( length - i )*sizeof( tail1[0] ) );
+    }
+}
+
+template< class V >
+inline void fill( typename V::scalar* output, typename V::scalar value, size_t length )
+///
+/// Sets every element of output to value.
+///
+{
+    const size_t W = V::width;
+    const typename V::vf v = V::set1( value );
+    size_t i = 0;
+    for( ; i + 4*W <= length; i += 4*W )
+    {
+        V::storeu( output + i, v );
+        V::storeu( output + i + W, v );
+        V::storeu( output + i + 2*W, v );
+        V::storeu( output + i + 3*W, v );
+    }
+    for( ; i < length; ++i )
+    {
+        output[i] = value;
+    }
+}
+
+///
+/// Elementwise operations used by the vector_functions.h API.
+///
+template< class V > struct Add { typename V::vf operator()( typename V::vf a, typename V::vf b ) const { return V::add( a, b ); } };
+
+template< class V > struct Sub { typename V::vf operator()( typename V::vf a, typename V::vf b ) const { return V::sub( a, b ); } };
+
+template< class V > struct Mul { typename V::vf operator()( typename V::vf a, typename V::vf b ) const { return V::mul( a, b ); } };
+
+template< class V >
+struct AddConst
+{
+    explicit AddConst( typename V::scalar c ) : constant( V::set1( c ) ) {}
+    typename V::vf operator()( typename V::vf a ) const { return V::add( a, constant ); }
+    typename V::vf constant;
+};
+
+template< class V >
+struct MulConst
+{
+    explicit MulConst( typename V::scalar c ) : constant( V::set1( c ) ) {}
+    typename V::vf operator()( typename V::vf a ) const { return V::mul( a, constant ); }
+    typename V::vf constant;
+};
+
+template< class V >
+struct MulScaled
+{
+    explicit MulScaled( typename V::scalar g ) : gain( V::set1( g ) ) {}
+    typename V::vf operator()( typename V::vf a, typename V::vf b ) const { return V::mul( V::mul( a, b ), gain ); }
+    typename V::vf gain;
+};
+
+template< class V >
+struct MinConst
+{
+    explicit MinConst( typename V::scalar c ) : constant( V::set1( c ) ) {}
+    typename V::vf operator()( typename V::vf a ) const { return V::min( constant, a ); }
+    typename V::vf constant;
+};
+
+template< class V >
+struct ZeroAbsGreaterThan
+{
+    explicit ZeroAbsGreaterThan( typename V::scalar t ) : threshold( V::set1( t ) ) {}
+    typename V::vf operator()( typename V::vf a ) const { return V::select( V::cmpgt( V::abs( a ), threshold ), V::zero(), a ); }
+    typename V::vf threshold;
+};
+
+template< class V >
+struct ZeroLessThan
+{
+    explicit ZeroLessThan( typename V::scalar t ) : threshold( V::set1( t ) ) {}
+    typename V::vf operator()( typename V::vf a ) const { return V::select( V::cmplt( a, threshold ), V::zero(), a ); }
+    typename V::vf threshold;
+};
+
+template< class V > struct FractionalPart { typename V::vf operator()( typename V::vf a ) const { return V::sub( a, V::trunc( a ) ); } };
+
+template< class V >
+struct AddScaled
+{
+    explicit AddScaled( float s ) : scale( V::set1( s ) ) {}
+    typename V::vf operator()( typename V::vf a, typename V::vf b ) const { return V::fmadd( a, scale, b ); }
+    typename V::vf scale;
+};
+
+template< class V, class Op >
+inline void map_from_s16( const int16_t* input, float* output, size_t length, Op op )
+///
+/// As map_unary, for 16-bit integer input. Samples are converted to float in registers, so
+/// there is no intermediate float buffer.
+///
+{
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + 4*W <= length; i += 4*W )
+    {
+        typename V::vf a0 = V::load_s16( input + i );
+        typename V::vf a1 = V::load_s16( input + i + W );
+        typename V::vf a2 = V::load_s16( input + i + 2*W );
+        typename V::vf a3 = V::load_s16( input + i + 3*W );
+        V::storeu( output + i, op( a0 ) );
+        V::storeu( output + i + W, op( a1 ) );
+        V::storeu( output + i + 2*W, op( a2 ) );
+        V::storeu( output + i + 3*W, op( a3 ) );
+    }
+    for( ; i + W <= length; i += W )
+    {
+        V::storeu( output + i, op( V::load_s16( input + i ) ) );
+    }
+    if( i < length )
+    {
+        int16_t tail_in[ W ] = {};
+        float tail_out[ W ];
+        memcpy( tail_in, input + i, ( length - i )*sizeof( int16_t ) );
+        V::storeu( tail_out, op( V::load_s16( tail_in ) ) );
+        memcpy( output + i, tail_out, ( length - i )*sizeof( float ) );
+    }
+}
+
+template< class V, class Op >
+inline void map_binary_s16( const int16_t* input1, const float* input2, float* output, size_t length, Op op )
+///
+/// As map_binary, with the first operand read from 16-bit integers.
+///
+{
+    const size_t W = V::width;
+    size_t i = 0;
+    for( ; i + 2*W <= length; i += 2*W )
+    {
+        typename V::vf a0 = V::load_s16( input1 + i );
+        typename V::vf a1 = V::load_s16( input1 + i + W );
+        typename V::vf b0 = V::loadu( input2 + i );
+        typename V::vf b1 = V::loadu( input2 + i + W );
+        V::storeu( output + i, op( a0, b0 ) );
+        V::storeu( output + i + W, op( a1, b1 ) );
+    }
+    for( ; i + W <= length; i += W )
+    {
+        V::storeu( output + i, op( V::load_s16( input1 + i ), V::loadu( input2 + i ) ) );
+    }
+    if( i < length )
+    {
+        int16_t tail1[ W ] = {};
+        float tail2[ W ] = {};
+        memcpy( tail1, input1 + i, ( length - i )*sizeof( int16_t ) );
+        memcpy( tail2, input2 + i, ( length - i )*sizeof( float ) );
+        V::storeu( tail2, op( V::load_s16( tail1 ), V::loadu( tail2 ) ) );
+        memcpy( output + i, tail2, ( length - i )*sizeof( float ) );
+    }
+}
+
+template< class V >
+inline void convert_to_s16( const float* input, int16_t* output, float scale, size_t length )
+///
+/// Multiplies each element of input by scale and stores it as a 16-bit integer, rounded to
+/// nearest and saturated to [-32768,32767].
+///
+{
+    const size_t W = V::width;
+    const typename V::vf s = V::set1( scale );
+    size_t i = 0;
+    for( ; i + 2*W <= length; i += 2*W )
+    {
+        V::store_s16( output + i, V::mul( V::loadu( input + i ), s ) );
+        V::store_s16( output + i + W, V::mul( V::loadu( input + i + W ), s ) );
+    }
+    for( ; i + W <= length; i += W )
+    {
+        V::store_s16( output + i, V::mul( V::loadu( input + i ), s ) );
+    }
+    if( i < length )
+    {
+        float tail_in[ W ] = {};
+        int16_t tail_out[ W ];
+        memcpy( tail_in, input + i, ( length - i )*sizeof( float ) );
+        V::store_s16( tail_out, V::mul( V::loadu( tail_in ), s ) );
+        memcpy( output + i, tail_out, ( length - i )*sizeof( int16_t ) );
+    }
+}
+
+} // namespace simd
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_VECTOR_KERNELS_H
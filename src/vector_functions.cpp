@@ -7,13 +7,19 @@
 
 // In Module includes
 #include "vector_functions.h"
+#include "error_reporting.h"
+#include "instrumentation_probe.h"
+#include "simd/native_isa.h"
+#include "simd/reduction_kernels.h"
+#include "simd/vector_kernels.h"
 
 // Thirdparty includes
 #include "ipp/ipps.h"
 #include "ipp/ippvm.h"
 
 // Std Lib includes
-#include <assert.h>
+#include <cmath>
+#include <stdint.h>
 
 namespace cupcake
 {
@@ -35,12 +41,18 @@ void vec_mult_const_in_place( float* input1, float multiplier, size_t length )
 ///  The number of elements in the input vector.
 ///
 {
+    VECLIB_PROBE( vec_mult_const_in_place, length );
     
-    IppStatus err = ippsMulC_32f_I( static_cast< Ipp32f >( multiplier ),
-                                    static_cast< Ipp32f* >( input1 ),
-                                    static_cast< int >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error multiplying by constant
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMulC_32f_I( static_cast< Ipp32f >( multiplier ),
+                                        static_cast< Ipp32f* >( input1 + offset ),
+                                        ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_mult_const_in_place" ) )
+        {
+            return;
+        }
+    }
     
 }
 
@@ -61,13 +73,19 @@ void vec_mult( const float* input1, const float* input2, float* output, size_t l
 ///  The length of all vectors - input1, input2 and output.
 ///
 {
+    VECLIB_PROBE( vec_mult, length );
     
-    IppStatus err = ippsMul_32f( static_cast< const Ipp32f* >( input1 ),
-                                 static_cast< const Ipp32f* >( input2 ),
-                                 static_cast< Ipp32f* >( output ),
-                                 static_cast< Ipp32s >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error multiplying vectors.
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMul_32f( static_cast< const Ipp32f* >( input1 + offset ),
+                                     static_cast< const Ipp32f* >( input2 + offset ),
+                                     static_cast< Ipp32f* >( output + offset ),
+                                     ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_mult" ) )
+        {
+            return;
+        }
+    }
     
 }
     
@@ -87,12 +105,18 @@ void vec_mult_in_place( const float* input1, float* input2, size_t length )
 ///  The number of elements in both input1 and input2.
 ///
 {
+    VECLIB_PROBE( vec_mult_in_place, length );
  
-    IppStatus err = ippsMul_32f_I( static_cast< const Ipp32f* >( input1 ),
-                                   static_cast< Ipp32f* >( input2 ),
-                                   static_cast< Ipp32s >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error multiplying vectors.
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMul_32f_I( static_cast< const Ipp32f* >( input1 + offset ),
+                                       static_cast< Ipp32f* >( input2 + offset ),
+                                       ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_mult_in_place" ) )
+        {
+            return;
+        }
+    }
     
 }
     
@@ -111,12 +135,18 @@ void vec_add_constant( float* input1, float constant, size_t length )
 ///  The numebr of elements in the input vector.
 ///
 {
+    VECLIB_PROBE( vec_add_constant, length );
     
-    IppStatus err = ippsAddC_32f_I( static_cast< Ipp32f >( constant ),
-                                    static_cast< Ipp32f* >( input1 ),
-                                    static_cast< int >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error adding constant.
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsAddC_32f_I( static_cast< Ipp32f >( constant ),
+                                        static_cast< Ipp32f* >( input1 + offset ),
+                                        ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_add_constant" ) )
+        {
+            return;
+        }
+    }
     
 }
 
@@ -134,12 +164,18 @@ void vec_add_in_place( const float* input1, float* input2_output, size_t length
 ///  The number of elements in both input vectors
 ///
 {
+    VECLIB_PROBE( vec_add_in_place, length );
    
-    IppStatus err = ippsAdd_32f_I( static_cast< const Ipp32f* >( input1 ),
-                                   static_cast< Ipp32f* >( input2_output ),
-                                   static_cast< int >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error adding vectors.
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsAdd_32f_I( static_cast< const Ipp32f* >( input1 + offset ),
+                                       static_cast< Ipp32f* >( input2_output + offset ),
+                                       ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_add_in_place" ) )
+        {
+            return;
+        }
+    }
     
 }
     
@@ -158,11 +194,17 @@ void vec_sub_constant( float* input, float constant, size_t length )
 ///  The number of elements in the input vector.
 ///
 {
-    IppStatus err = ippsSubC_32f_I( static_cast< Ipp32f >( constant ),
-                                    static_cast< Ipp32f* >( input ),
-                                    static_cast< int >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error adding constant.
+    VECLIB_PROBE( vec_sub_constant, length );
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsSubC_32f_I( static_cast< Ipp32f >( constant ),
+                                        static_cast< Ipp32f* >( input + offset ),
+                                        ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_sub_constant" ) )
+        {
+            return;
+        }
+    }
 }
     
 void vec_sub( const float* input1, const float* input2, float* output, size_t length )
@@ -185,13 +227,19 @@ void vec_sub( const float* input1, const float* input2, float* output, size_t le
 ///  The number of elements in all inputs and in the output.
 ///
 {
+    VECLIB_PROBE( vec_sub, length );
     
-    IppStatus err = ippsSub_32f( static_cast< const Ipp32f* >( input2 ),
-                                 static_cast< const Ipp32f* >( input1 ),
-                                 static_cast< Ipp32f* >( output ),
-                                 static_cast< int >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error subtracting vectors.
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsSub_32f( static_cast< const Ipp32f* >( input2 + offset ),
+                                     static_cast< const Ipp32f* >( input1 + offset ),
+                                     static_cast< Ipp32f* >( output + offset ),
+                                     ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_sub" ) )
+        {
+            return;
+        }
+    }
     
 }
     
@@ -213,12 +261,18 @@ void vec_sub_in_place( float* input1, const float* input2, size_t length )
 ///  The number of elements in input1 and input2.
 ///
 {
+    VECLIB_PROBE( vec_sub_in_place, length );
     
-    IppStatus err = ippsSub_32f_I( static_cast< const Ipp32f* >( input2 ),
-                                   static_cast< Ipp32f* >( input1 ),
-                                   static_cast< int >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error subtracting vectors.
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsSub_32f_I( static_cast< const Ipp32f* >( input2 + offset ),
+                                       static_cast< Ipp32f* >( input1 + offset ),
+                                       ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_sub_in_place" ) )
+        {
+            return;
+        }
+    }
     
 }
     
@@ -233,12 +287,18 @@ void vec_negative_halfwave_rectify( float* input, size_t length )
 ///  The number of elements in input1.
 ///
 {
+    VECLIB_PROBE( vec_negative_halfwave_rectify, length );
     
-    IppStatus err = ippsThreshold_GT_32f_I( static_cast< Ipp32f* >( input ),
-                                            static_cast< int >( length ),
-                                            0.0 );
-    
-    assert( err==ippStsNoErr ); // Error limiting positive values
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsThreshold_GT_32f_I( static_cast< Ipp32f* >( input + offset ),
+                                                ipp_chunk_length( length, offset ),
+                                                0.0 );
+        if( !check_ipp_status( err, "vec_negative_halfwave_rectify" ) )
+        {
+            return;
+        }
+    }
     
 }
     
@@ -257,17 +317,27 @@ void vec_zero_magnitudes_greater_than_abs( float* input, float threshold, size_t
 ///  The number of elements in input1.
 ///
 {
+    VECLIB_PROBE( vec_zero_magnitudes_greater_than_abs, length );
     
-    assert( threshold>0.0 );
+    if( VECLIB_UNLIKELY( !( threshold>0.0 ) ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_zero_magnitudes_greater_than_abs", "Threshold must be positive." );
+        return;
+    }
     
-    IppStatus err = ippsThreshold_LTValGTVal_32f_I( static_cast< Ipp32f* >( input ),
-                                                    static_cast< int >( length ),
-                                                    static_cast< Ipp32f >( -threshold ),
-                                                    0.0,
-                                                    static_cast< Ipp32f >( threshold ),
-                                                    0.0 );
-    
-    assert( err==ippStsNoErr ); // Error zeroing values
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsThreshold_LTValGTVal_32f_I( static_cast< Ipp32f* >( input + offset ),
+                                                        ipp_chunk_length( length, offset ),
+                                                        static_cast< Ipp32f >( -threshold ),
+                                                        0.0,
+                                                        static_cast< Ipp32f >( threshold ),
+                                                        0.0 );
+        if( !check_ipp_status( err, "vec_zero_magnitudes_greater_than_abs" ) )
+        {
+            return;
+        }
+    }
     
 }
     
@@ -276,13 +346,19 @@ void vec_zero_values_less_than( float* input, float threshold, size_t length )
 ///
 ///
 {
+    VECLIB_PROBE( vec_zero_values_less_than, length );
     
-    IppStatus err = ippsThreshold_LTVal_32f_I( static_cast< Ipp32f* >( input ),
-                                               static_cast< int >( length ),
-                                               static_cast< Ipp32f >( threshold ),
-                                               0.0 );
-    
-    assert( err==ippStsNoErr ); // Error zeroing values
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsThreshold_LTVal_32f_I( static_cast< Ipp32f* >( input + offset ),
+                                                   ipp_chunk_length( length, offset ),
+                                                   static_cast< Ipp32f >( threshold ),
+                                                   0.0 );
+        if( !check_ipp_status( err, "vec_zero_values_less_than" ) )
+        {
+            return;
+        }
+    }
     
 }
     
@@ -302,12 +378,18 @@ void vec_fractional_part( const float* input, float* output, size_t length )
 ///  The number of elements in the input/output vectors.
 ///
 {
+    VECLIB_PROBE( vec_fractional_part, length );
     
-    IppStatus err = ippsFrac_32f( static_cast< const Ipp32f* >( input ),
-                                  static_cast< Ipp32f* >( output ),
-                                  static_cast< Ipp32s >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error finding fractional part.
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsFrac_32f( static_cast< const Ipp32f* >( input + offset ),
+                                      static_cast< Ipp32f* >( output + offset ),
+                                      ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_fractional_part" ) )
+        {
+            return;
+        }
+    }
     
 }
     
@@ -322,10 +404,16 @@ void vec_zero( float* vec, size_t length )
 ///  The number of elements in the input vector ot be zeroed.
 ///
 {
+    VECLIB_PROBE( vec_zero, length );
     
-    IppStatus err = ippsZero_32f( static_cast< Ipp32f* >( vec ), static_cast< int >( length ) );
-    
-    assert( err==ippStsNoErr ); // Error zeroing vector.
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsZero_32f( static_cast< Ipp32f* >( vec + offset ), ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_zero" ) )
+        {
+            return;
+        }
+    }
     
 }
     
@@ -344,12 +432,1018 @@ void vec_copy( const float* vec_source, float* vec_dest, size_t length )
 ///  The number of elements to be copied from one vector to another.
 ///
 {
+    VECLIB_PROBE( vec_copy, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsCopy_32f( static_cast< const Ipp32f* >( vec_source + offset ),
+                                      static_cast< Ipp32f* >( vec_dest + offset ),
+                                      ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_copy" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+//
+// Double precision versions, with the same arguments as the float functions above.
+//
+
+void vec_mult_const_in_place( double* input1, double multiplier, size_t length )
+///
+/// As vec_mult_const_in_place above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_mult_const_in_place, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMulC_64f_I( static_cast< Ipp64f >( multiplier ),
+                                        static_cast< Ipp64f* >( input1 + offset ),
+                                        ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_mult_const_in_place" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_mult( const double* input1, const double* input2, double* output, size_t length )
+///
+/// As vec_mult above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_mult, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMul_64f( static_cast< const Ipp64f* >( input1 + offset ),
+                                     static_cast< const Ipp64f* >( input2 + offset ),
+                                     static_cast< Ipp64f* >( output + offset ),
+                                     ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_mult" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_mult_in_place( const double* input1, double* input2, size_t length )
+///
+/// As vec_mult_in_place above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_mult_in_place, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsMul_64f_I( static_cast< const Ipp64f* >( input1 + offset ),
+                                       static_cast< Ipp64f* >( input2 + offset ),
+                                       ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_mult_in_place" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_add_constant( double* input1, double constant, size_t length )
+///
+/// As vec_add_constant above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_add_constant, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsAddC_64f_I( static_cast< Ipp64f >( constant ),
+                                        static_cast< Ipp64f* >( input1 + offset ),
+                                        ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_add_constant" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_add_in_place( const double* input1, double* input2_output, size_t length )
+///
+/// As vec_add_in_place above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_add_in_place, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsAdd_64f_I( static_cast< const Ipp64f* >( input1 + offset ),
+                                       static_cast< Ipp64f* >( input2_output + offset ),
+                                       ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_add_in_place" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_sub_constant( double* input, double constant, size_t length )
+///
+/// As vec_sub_constant above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_sub_constant, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsSubC_64f_I( static_cast< Ipp64f >( constant ),
+                                        static_cast< Ipp64f* >( input + offset ),
+                                        ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_sub_constant" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_sub( const double* input1, const double* input2, double* output, size_t length )
+///
+/// As vec_sub above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_sub, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsSub_64f( static_cast< const Ipp64f* >( input2 + offset ),
+                                     static_cast< const Ipp64f* >( input1 + offset ),
+                                     static_cast< Ipp64f* >( output + offset ),
+                                     ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_sub" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_sub_in_place( double* input1, const double* input2, size_t length )
+///
+/// As vec_sub_in_place above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_sub_in_place, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsSub_64f_I( static_cast< const Ipp64f* >( input2 + offset ),
+                                       static_cast< Ipp64f* >( input1 + offset ),
+                                       ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_sub_in_place" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_negative_halfwave_rectify( double* input, size_t length )
+///
+/// As vec_negative_halfwave_rectify above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_negative_halfwave_rectify, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsThreshold_GT_64f_I( static_cast< Ipp64f* >( input + offset ),
+                                                ipp_chunk_length( length, offset ),
+                                                0.0 );
+        if( !check_ipp_status( err, "vec_negative_halfwave_rectify" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_zero_magnitudes_greater_than_abs( double* input, double threshold, size_t length )
+///
+/// As vec_zero_magnitudes_greater_than_abs above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_zero_magnitudes_greater_than_abs, length );
+    
+    if( VECLIB_UNLIKELY( !( threshold>0.0 ) ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_zero_magnitudes_greater_than_abs", "Threshold must be positive." );
+        return;
+    }
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsThreshold_LTValGTVal_64f_I( static_cast< Ipp64f* >( input + offset ),
+                                                        ipp_chunk_length( length, offset ),
+                                                        static_cast< Ipp64f >( -threshold ),
+                                                        0.0,
+                                                        static_cast< Ipp64f >( threshold ),
+                                                        0.0 );
+        if( !check_ipp_status( err, "vec_zero_magnitudes_greater_than_abs" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_zero_values_less_than( double* input, double threshold, size_t length )
+///
+/// As vec_zero_values_less_than above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_zero_values_less_than, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsThreshold_LTVal_64f_I( static_cast< Ipp64f* >( input + offset ),
+                                                   ipp_chunk_length( length, offset ),
+                                                   static_cast< Ipp64f >( threshold ),
+                                                   0.0 );
+        if( !check_ipp_status( err, "vec_zero_values_less_than" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_fractional_part( const double* input, double* output, size_t length )
+///
+/// As vec_fractional_part above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_fractional_part, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsFrac_64f( static_cast< const Ipp64f* >( input + offset ),
+                                      static_cast< Ipp64f* >( output + offset ),
+                                      ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_fractional_part" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_zero( double* vec, size_t length )
+///
+/// As vec_zero above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_zero, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsZero_64f( static_cast< Ipp64f* >( vec + offset ), ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_zero" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_copy( const double* vec_source, double* vec_dest, size_t length )
+///
+/// As vec_copy above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_copy, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsCopy_64f( static_cast< const Ipp64f* >( vec_source + offset ),
+                                      static_cast< Ipp64f* >( vec_dest + offset ),
+                                      ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_copy" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_convert( const int16_t* input, float* output, float scale, size_t length )
+///
+/// Converts 16-bit integer samples to float.
+///
+/// @param input
+///  A pointer to the first of length 16-bit samples.
+///
+/// @param output
+///  A pointer to length floats for the converted samples.
+///
+/// @param scale
+///  Each sample is multiplied by this, e.g. 1.0f/32768.0f for full scale at 1.0.
+///
+/// @param length
+///  The number of samples.
+///
+{
+    VECLIB_PROBE( vec_convert, length );
+    
+    simd::map_from_s16< simd::NativeISA >( input, output, length, simd::MulConst< simd::NativeISA >( scale ) );
+    
+}
+
+void vec_convert( const float* input, int16_t* output, float scale, size_t length )
+///
+/// Converts float samples to 16-bit integers, rounding to nearest and saturating.
+///
+/// @param input
+///  A pointer to the first of length float samples.
+///
+/// @param output
+///  A pointer to length 16-bit integers for the converted samples.
+///
+/// @param scale
+///  Each sample is multiplied by this before rounding, e.g. 32767.0f for full scale at 1.0.
+///
+/// @param length
+///  The number of samples.
+///
+{
+    VECLIB_PROBE( vec_convert, length );
+    
+    simd::convert_to_s16< simd::NativeISA >( input, output, scale, length );
+    
+}
+
+void vec_convert( const float* input, double* output, size_t length )
+///
+/// Widens float samples to double.
+///
+/// @param input
+///  A pointer to the first of length float samples.
+///
+/// @param output
+///  A pointer to length doubles for the converted samples.
+///
+/// @param length
+///  The number of samples.
+///
+{
+    VECLIB_PROBE( vec_convert, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsConvert_32f64f( static_cast< const Ipp32f* >( input + offset ),
+                                            static_cast< Ipp64f* >( output + offset ),
+                                            ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_convert" ) )
+        {
+            return;
+        }
+    }
+    
+}
+
+void vec_convert( const double* input, float* output, size_t length )
+///
+/// Narrows double samples to float, rounding to nearest.
+///
+/// @param input
+///  A pointer to the first of length double samples.
+///
+/// @param output
+///  A pointer to length floats for the converted samples.
+///
+/// @param length
+///  The number of samples.
+///
+{
+    VECLIB_PROBE( vec_convert, length );
+    
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        IppStatus err = ippsConvert_64f32f( static_cast< const Ipp64f* >( input + offset ),
+                                            static_cast< Ipp32f* >( output + offset ),
+                                            ipp_chunk_length( length, offset ) );
+        if( !check_ipp_status( err, "vec_convert" ) )
+        {
+            return;
+        }
+    }
     
-    IppStatus err = ippsCopy_32f( static_cast< const Ipp32f* >( vec_source ),
-                                  static_cast< Ipp32f* >( vec_dest ),
-                                  static_cast< int >( length ) );
+}
+
+void vec_mult( const int16_t* input1, float scale, const float* input2, float* output, size_t length )
+///
+/// Converts 16-bit integer samples to float and multiplies them element-wise by a second
+/// vector, in a single pass.
+///
+/// @param input1
+///  A pointer to the first of length 16-bit samples.
+///
+/// @param scale
+///  Each sample of input1 is multiplied by this, e.g. 1.0f/32768.0f for full scale at 1.0.
+///
+/// @param input2
+///  The second factor in multiplication.
+///
+/// @param output
+///  A pointer to length floats for the product. May be equal to input2.
+///
+/// @param length
+///  The number of elements in all vectors.
+///
+{
+    VECLIB_PROBE( vec_mult, length );
+    
+    simd::map_binary_s16< simd::NativeISA >( input1, input2, output, length, simd::MulScaled< simd::NativeISA >( scale ) );
+    
+}
+
+void vec_add_in_place( const int16_t* input1, float scale, float* input2_output, size_t length )
+///
+/// Converts 16-bit integer samples to float and adds them element-wise to a second vector,
+/// e.g. to mix PCM into an accumulator.
+///
+/// @param input1
+///  A pointer to the first of length 16-bit samples.
+///
+/// @param scale
+///  Each sample of input1 is multiplied by this, e.g. 1.0f/32768.0f for full scale at 1.0.
+///
+/// @param input2_output
+///  On input: the vector to add to. On output: the sum.
+///
+/// @param length
+///  The number of elements in both vectors.
+///
+{
+    VECLIB_PROBE( vec_add_in_place, length );
+    
+    simd::map_binary_s16< simd::NativeISA >( input1, input2_output, input2_output, length, simd::AddScaled< simd::NativeISA >( scale ) );
+    
+}
+
+//
+// Reductions. Fast sums use IPP; IPP has no pairwise or compensated summation, so the
+// other accuracies, and the moments, use the SIMD kernels.
+//
+
+float vec_sum( const float* input, size_t length, SumAccuracy accuracy )
+///
+/// Returns the sum of the elements of a vector.
+///
+/// @param input
+///  A pointer to the first element of the vector to sum.
+///
+/// @param length
+///  The number of elements in input. The sum of no elements is 0.
+///
+/// @param accuracy
+///  How the sum is taken. See SumAccuracy.
+///
+{
+    VECLIB_PROBE( vec_sum, length );
+    
+    if( accuracy != SumAccuracy::fast )
+    {
+        return simd::sum< simd::NativeISA >( input, length, accuracy );
+    }
+    
+    float total = 0.0f;
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp32f partial = 0.0f;
+        IppStatus err = ippsSum_32f( static_cast< const Ipp32f* >( input + offset ),
+                                     ipp_chunk_length( length, offset ),
+                                     &partial,
+                                     ippAlgHintFast );
+        if( !check_ipp_status( err, "vec_sum" ) )
+        {
+            break;
+        }
+        total += partial;
+    }
+    return total;
+    
+}
+
+float vec_dot( const float* input1, const float* input2, size_t length, SumAccuracy accuracy )
+///
+/// Returns the dot product of two vectors, the sum of their element-wise product.
+///
+/// @param input1
+///  A pointer to the first element of the first vector.
+///
+/// @param input2
+///  A pointer to the first element of the second vector.
+///
+/// @param length
+///  The number of elements in both vectors.
+///
+/// @param accuracy
+///  How the sum is taken. See SumAccuracy.
+///
+{
+    VECLIB_PROBE( vec_dot, length );
+    
+    if( accuracy != SumAccuracy::fast )
+    {
+        return simd::dot< simd::NativeISA >( input1, input2, length, accuracy );
+    }
+    
+    float total = 0.0f;
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp32f partial = 0.0f;
+        IppStatus err = ippsDotProd_32f( static_cast< const Ipp32f* >( input1 + offset ),
+                                         static_cast< const Ipp32f* >( input2 + offset ),
+                                         ipp_chunk_length( length, offset ),
+                                         &partial );
+        if( !check_ipp_status( err, "vec_dot" ) )
+        {
+            break;
+        }
+        total += partial;
+    }
+    return total;
+    
+}
+
+float vec_norm_l1( const float* input, size_t length, SumAccuracy accuracy )
+///
+/// Returns the L1 norm of a vector, the sum of the magnitudes of its elements.
+///
+/// @param input
+///  A pointer to the first element of the vector.
+///
+/// @param length
+///  The number of elements in input.
+///
+/// @param accuracy
+///  How the sum is taken. See SumAccuracy.
+///
+{
+    VECLIB_PROBE( vec_norm_l1, length );
+    
+    if( accuracy != SumAccuracy::fast )
+    {
+        return simd::norm_l1< simd::NativeISA >( input, length, accuracy );
+    }
+    
+    float total = 0.0f;
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp32f partial = 0.0f;
+        IppStatus err = ippsNorm_L1_32f( static_cast< const Ipp32f* >( input + offset ),
+                                         ipp_chunk_length( length, offset ),
+                                         &partial );
+        if( !check_ipp_status( err, "vec_norm_l1" ) )
+        {
+            break;
+        }
+        total += partial;
+    }
+    return total;
+    
+}
+
+float vec_norm_l2( const float* input, size_t length, SumAccuracy accuracy )
+///
+/// Returns the L2 norm of a vector, the square root of the sum of its squared elements,
+/// e.g. for the energy of a frame.
+///
+/// @param input
+///  A pointer to the first element of the vector.
+///
+/// @param length
+///  The number of elements in input.
+///
+/// @param accuracy
+///  How the sum of squares is taken. See SumAccuracy.
+///
+{
+    VECLIB_PROBE( vec_norm_l2, length );
+    
+    if( accuracy != SumAccuracy::fast )
+    {
+        return simd::norm_l2< simd::NativeISA >( input, length, accuracy );
+    }
+    
+    // Norms of each IPP call are combined as a sum of squares; a single call is returned as is.
+    float norm = 0.0f;
+    float squares = 0.0f;
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp32f partial = 0.0f;
+        IppStatus err = ippsNorm_L2_32f( static_cast< const Ipp32f* >( input + offset ),
+                                         ipp_chunk_length( length, offset ),
+                                         &partial );
+        if( !check_ipp_status( err, "vec_norm_l2" ) )
+        {
+            break;
+        }
+        norm = partial;
+        squares += partial*partial;
+    }
+    return ( length > max_ipp_length ) ? std::sqrt( squares ) : norm;
+    
+}
+
+float vec_min( const float* input, size_t length, size_t* index )
+///
+/// Returns the smallest element of a vector, and optionally its index.
+///
+/// @param input
+///  A pointer to the first element of the vector to search.
+///
+/// @param length
+///  The number of elements in input. Must be at least 1.
+///
+/// @param index
+///  If not NULL, receives the index of the first occurrence of the smallest element.
+///
+{
+    VECLIB_PROBE( vec_min, length );
+    
+    float best = 0.0f;
+    size_t best_index = 0;
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_min", "Input must not be empty." );
+    }
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp32f value = 0.0f;
+        int position = 0;
+        IppStatus err = ippsMinIndx_32f( static_cast< const Ipp32f* >( input + offset ),
+                                         ipp_chunk_length( length, offset ),
+                                         &value,
+                                         &position );
+        if( !check_ipp_status( err, "vec_min" ) )
+        {
+            break;
+        }
+        if( offset == 0 || value < best )
+        {
+            best = value;
+            best_index = offset + static_cast< size_t >( position );
+        }
+    }
+    if( index )
+    {
+        *index = best_index;
+    }
+    return best;
+    
+}
+
+float vec_max( const float* input, size_t length, size_t* index )
+///
+/// Returns the largest element of a vector, and optionally its index, e.g. for peak picking.
+///
+/// @param input
+///  A pointer to the first element of the vector to search.
+///
+/// @param length
+///  The number of elements in input. Must be at least 1.
+///
+/// @param index
+///  If not NULL, receives the index of the first occurrence of the largest element.
+///
+{
+    VECLIB_PROBE( vec_max, length );
+    
+    float best = 0.0f;
+    size_t best_index = 0;
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_max", "Input must not be empty." );
+    }
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp32f value = 0.0f;
+        int position = 0;
+        IppStatus err = ippsMaxIndx_32f( static_cast< const Ipp32f* >( input + offset ),
+                                         ipp_chunk_length( length, offset ),
+                                         &value,
+                                         &position );
+        if( !check_ipp_status( err, "vec_max" ) )
+        {
+            break;
+        }
+        if( offset == 0 || value > best )
+        {
+            best = value;
+            best_index = offset + static_cast< size_t >( position );
+        }
+    }
+    if( index )
+    {
+        *index = best_index;
+    }
+    return best;
+    
+}
+
+void vec_mean_variance( const float* input, size_t length, float* mean, float* variance, SumAccuracy accuracy )
+///
+/// Computes the mean and population variance of a vector in a single pass. Elements are
+/// summed relative to the first, so the variance stays accurate when it is small next to
+/// the square of the mean.
+///
+/// @param input
+///  A pointer to the first element of the vector.
+///
+/// @param length
+///  The number of elements in input. Must be at least 1.
+///
+/// @param mean
+///  Receives the mean of the elements.
+///
+/// @param variance
+///  Receives the mean squared deviation from the mean, i.e. divided by length rather than
+///  length - 1.
+///
+/// @param accuracy
+///  How the sums are taken. See SumAccuracy.
+///
+{
+    VECLIB_PROBE( vec_mean_variance, length );
+    
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_mean_variance", "Input must not be empty." );
+        *mean = 0.0f;
+        *variance = 0.0f;
+        return;
+    }
+    simd::mean_variance< simd::NativeISA >( input, length, mean, variance, accuracy );
+    
+}
+
+float vec_weighted_mean( const float* values, const float* weights, size_t length, SumAccuracy accuracy )
+///
+/// Returns sum( values*weights )/sum( weights ), in a single pass. With bin frequencies as
+/// values and a magnitude spectrum as weights, this is the spectral centroid.
+///
+/// @param values
+///  A pointer to the first of the values to average.
+///
+/// @param weights
+///  A pointer to the first of the weights, one per value.
+///
+/// @param length
+///  The number of elements in values and weights.
+///
+/// @param accuracy
+///  How the sums are taken. See SumAccuracy.
+///
+/// @return
+///  The weighted mean, or 0 if the weights sum to 0.
+///
+{
+    VECLIB_PROBE( vec_weighted_mean, length );
+    
+    return simd::weighted_mean< simd::NativeISA >( values, weights, length, accuracy );
+    
+}
+
+double vec_sum( const double* input, size_t length, SumAccuracy accuracy )
+///
+/// As vec_sum above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_sum, length );
+    
+    if( accuracy != SumAccuracy::fast )
+    {
+        return simd::sum< simd::NativeISA::Double >( input, length, accuracy );
+    }
+    
+    double total = 0.0;
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp64f partial = 0.0;
+        IppStatus err = ippsSum_64f( static_cast< const Ipp64f* >( input + offset ),
+                                     ipp_chunk_length( length, offset ),
+                                     &partial );
+        if( !check_ipp_status( err, "vec_sum" ) )
+        {
+            break;
+        }
+        total += partial;
+    }
+    return total;
+    
+}
+
+double vec_dot( const double* input1, const double* input2, size_t length, SumAccuracy accuracy )
+///
+/// As vec_dot above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_dot, length );
+    
+    if( accuracy != SumAccuracy::fast )
+    {
+        return simd::dot< simd::NativeISA::Double >( input1, input2, length, accuracy );
+    }
+    
+    double total = 0.0;
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp64f partial = 0.0;
+        IppStatus err = ippsDotProd_64f( static_cast< const Ipp64f* >( input1 + offset ),
+                                         static_cast< const Ipp64f* >( input2 + offset ),
+                                         ipp_chunk_length( length, offset ),
+                                         &partial );
+        if( !check_ipp_status( err, "vec_dot" ) )
+        {
+            break;
+        }
+        total += partial;
+    }
+    return total;
+    
+}
+
+double vec_norm_l1( const double* input, size_t length, SumAccuracy accuracy )
+///
+/// As vec_norm_l1 above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_norm_l1, length );
+    
+    if( accuracy != SumAccuracy::fast )
+    {
+        return simd::norm_l1< simd::NativeISA::Double >( input, length, accuracy );
+    }
+    
+    double total = 0.0;
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp64f partial = 0.0;
+        IppStatus err = ippsNorm_L1_64f( static_cast< const Ipp64f* >( input + offset ),
+                                         ipp_chunk_length( length, offset ),
+                                         &partial );
+        if( !check_ipp_status( err, "vec_norm_l1" ) )
+        {
+            break;
+        }
+        total += partial;
+    }
+    return total;
+    
+}
+
+double vec_norm_l2( const double* input, size_t length, SumAccuracy accuracy )
+///
+/// As vec_norm_l2 above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_norm_l2, length );
+    
+    if( accuracy != SumAccuracy::fast )
+    {
+        return simd::norm_l2< simd::NativeISA::Double >( input, length, accuracy );
+    }
+    
+    double norm = 0.0;
+    double squares = 0.0;
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp64f partial = 0.0;
+        IppStatus err = ippsNorm_L2_64f( static_cast< const Ipp64f* >( input + offset ),
+                                         ipp_chunk_length( length, offset ),
+                                         &partial );
+        if( !check_ipp_status( err, "vec_norm_l2" ) )
+        {
+            break;
+        }
+        norm = partial;
+        squares += partial*partial;
+    }
+    return ( length > max_ipp_length ) ? std::sqrt( squares ) : norm;
+    
+}
+
+double vec_min( const double* input, size_t length, size_t* index )
+///
+/// As vec_min above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_min, length );
+    
+    double best = 0.0;
+    size_t best_index = 0;
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_min", "Input must not be empty." );
+    }
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp64f value = 0.0;
+        int position = 0;
+        IppStatus err = ippsMinIndx_64f( static_cast< const Ipp64f* >( input + offset ),
+                                         ipp_chunk_length( length, offset ),
+                                         &value,
+                                         &position );
+        if( !check_ipp_status( err, "vec_min" ) )
+        {
+            break;
+        }
+        if( offset == 0 || value < best )
+        {
+            best = value;
+            best_index = offset + static_cast< size_t >( position );
+        }
+    }
+    if( index )
+    {
+        *index = best_index;
+    }
+    return best;
+    
+}
+
+double vec_max( const double* input, size_t length, size_t* index )
+///
+/// As vec_max above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_max, length );
+    
+    double best = 0.0;
+    size_t best_index = 0;
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_max", "Input must not be empty." );
+    }
+    for( size_t offset = 0; offset < length; offset += max_ipp_length )
+    {
+        Ipp64f value = 0.0;
+        int position = 0;
+        IppStatus err = ippsMaxIndx_64f( static_cast< const Ipp64f* >( input + offset ),
+                                         ipp_chunk_length( length, offset ),
+                                         &value,
+                                         &position );
+        if( !check_ipp_status( err, "vec_max" ) )
+        {
+            break;
+        }
+        if( offset == 0 || value > best )
+        {
+            best = value;
+            best_index = offset + static_cast< size_t >( position );
+        }
+    }
+    if( index )
+    {
+        *index = best_index;
+    }
+    return best;
+    
+}
+
+void vec_mean_variance( const double* input, size_t length, double* mean, double* variance, SumAccuracy accuracy )
+///
+/// As vec_mean_variance above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_mean_variance, length );
+    
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_mean_variance", "Input must not be empty." );
+        *mean = 0.0;
+        *variance = 0.0;
+        return;
+    }
+    simd::mean_variance< simd::NativeISA::Double >( input, length, mean, variance, accuracy );
+    
+}
+
+double vec_weighted_mean( const double* values, const double* weights, size_t length, SumAccuracy accuracy )
+///
+/// As vec_weighted_mean above, in double precision.
+///
+{
+    VECLIB_PROBE( vec_weighted_mean, length );
     
-    assert( err==ippStsNoErr ); // Error copying vector.
+    return simd::weighted_mean< simd::NativeISA::Double >( values, weights, length, accuracy );
     
 }
     
@@ -0,0 +1,402 @@
+//
+// Utility functions for vectorised operations in C++ - hand written SIMD implementation.
+//
+// This is a drop in replacement for vector_functions.cpp on hosts without IPP. Each call
+// goes through the kernel table for the instruction set picked at runtime, see dispatch.h.
+//
+
+// In Module includes
+#include "vector_functions.h"
+#include "error_reporting.h"
+#include "instrumentation_probe.h"
+#include "simd/kernel_table.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <stdint.h>
+#include <string.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+//
+// The API documentation for each of these functions lives with the IPP implementation
+// in vector_functions.cpp. Behaviour here matches it.
+//
+
+void vec_mult_const_in_place( float* input1, float multiplier, size_t length )
+{
+    VECLIB_PROBE( vec_mult_const_in_place, length );
+    simd::kernels().vec_mult_const_in_place( input1, multiplier, length );
+}
+
+void vec_mult( const float* input1, const float* input2, float* output, size_t length )
+{
+    VECLIB_PROBE( vec_mult, length );
+    simd::kernels().vec_mult( input1, input2, output, length );
+}
+
+void vec_mult_in_place( const float* input1, float* input2, size_t length )
+{
+    VECLIB_PROBE( vec_mult_in_place, length );
+    simd::kernels().vec_mult_in_place( input1, input2, length );
+}
+
+void vec_add_constant( float* input1, float constant, size_t length )
+{
+    VECLIB_PROBE( vec_add_constant, length );
+    simd::kernels().vec_add_constant( input1, constant, length );
+}
+
+void vec_add_in_place( const float* input1, float* input2_output, size_t length )
+{
+    VECLIB_PROBE( vec_add_in_place, length );
+    simd::kernels().vec_add_in_place( input1, input2_output, length );
+}
+
+void vec_sub_constant( float* input, float constant, size_t length )
+{
+    VECLIB_PROBE( vec_sub_constant, length );
+    simd::kernels().vec_sub_constant( input, constant, length );
+}
+
+void vec_sub( const float* input1, const float* input2, float* output, size_t length )
+{
+    VECLIB_PROBE( vec_sub, length );
+    simd::kernels().vec_sub( input1, input2, output, length );
+}
+
+void vec_sub_in_place( float* input1, const float* input2, size_t length )
+{
+    VECLIB_PROBE( vec_sub_in_place, length );
+    simd::kernels().vec_sub_in_place( input1, input2, length );
+}
+
+void vec_negative_halfwave_rectify( float* input, size_t length )
+{
+    VECLIB_PROBE( vec_negative_halfwave_rectify, length );
+    simd::kernels().vec_negative_halfwave_rectify( input, length );
+}
+
+void vec_zero_magnitudes_greater_than_abs( float* input, float threshold, size_t length )
+{
+    VECLIB_PROBE( vec_zero_magnitudes_greater_than_abs, length );
+    if( VECLIB_UNLIKELY( !( threshold>0.0 ) ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_zero_magnitudes_greater_than_abs", "Threshold must be positive." );
+        return;
+    }
+    simd::kernels().vec_zero_magnitudes_greater_than_abs( input, threshold, length );
+}
+
+void vec_zero_values_less_than( float* input, float threshold, size_t length )
+{
+    VECLIB_PROBE( vec_zero_values_less_than, length );
+    simd::kernels().vec_zero_values_less_than( input, threshold, length );
+}
+
+void vec_fractional_part( const float* input, float* output, size_t length )
+{
+    VECLIB_PROBE( vec_fractional_part, length );
+    simd::kernels().vec_fractional_part( input, output, length );
+}
+
+void vec_zero( float* vec, size_t length )
+{
+    VECLIB_PROBE( vec_zero, length );
+    simd::kernels().vec_zero( vec, length );
+}
+
+void vec_copy( const float* vec_source, float* vec_dest, size_t length )
+{
+    VECLIB_PROBE( vec_copy, length );
+    // The C library copy is already vectorised and tuned for the host; there is nothing to gain here.
+    memcpy( vec_dest, vec_source, length*sizeof( float ) );
+}
+
+void vec_mult_const_in_place( double* input1, double multiplier, size_t length )
+{
+    VECLIB_PROBE( vec_mult_const_in_place, length );
+    simd::kernels().vec_mult_const_in_place_double( input1, multiplier, length );
+}
+
+void vec_mult( const double* input1, const double* input2, double* output, size_t length )
+{
+    VECLIB_PROBE( vec_mult, length );
+    simd::kernels().vec_mult_double( input1, input2, output, length );
+}
+
+void vec_mult_in_place( const double* input1, double* input2, size_t length )
+{
+    VECLIB_PROBE( vec_mult_in_place, length );
+    simd::kernels().vec_mult_in_place_double( input1, input2, length );
+}
+
+void vec_add_constant( double* input1, double constant, size_t length )
+{
+    VECLIB_PROBE( vec_add_constant, length );
+    simd::kernels().vec_add_constant_double( input1, constant, length );
+}
+
+void vec_add_in_place( const double* input1, double* input2_output, size_t length )
+{
+    VECLIB_PROBE( vec_add_in_place, length );
+    simd::kernels().vec_add_in_place_double( input1, input2_output, length );
+}
+
+void vec_sub_constant( double* input, double constant, size_t length )
+{
+    VECLIB_PROBE( vec_sub_constant, length );
+    simd::kernels().vec_sub_constant_double( input, constant, length );
+}
+
+void vec_sub( const double* input1, const double* input2, double* output, size_t length )
+{
+    VECLIB_PROBE( vec_sub, length );
+    simd::kernels().vec_sub_double( input1, input2, output, length );
+}
+
+void vec_sub_in_place( double* input1, const double* input2, size_t length )
+{
+    VECLIB_PROBE( vec_sub_in_place, length );
+    simd::kernels().vec_sub_in_place_double( input1, input2, length );
+}
+
+void vec_negative_halfwave_rectify( double* input, size_t length )
+{
+    VECLIB_PROBE( vec_negative_halfwave_rectify, length );
+    simd::kernels().vec_negative_halfwave_rectify_double( input, length );
+}
+
+void vec_zero_magnitudes_greater_than_abs( double* input, double threshold, size_t length )
+{
+    VECLIB_PROBE( vec_zero_magnitudes_greater_than_abs, length );
+    if( VECLIB_UNLIKELY( !( threshold>0.0 ) ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_zero_magnitudes_greater_than_abs", "Threshold must be positive." );
+        return;
+    }
+    simd::kernels().vec_zero_magnitudes_greater_than_abs_double( input, threshold, length );
+}
+
+void vec_zero_values_less_than( double* input, double threshold, size_t length )
+{
+    VECLIB_PROBE( vec_zero_values_less_than, length );
+    simd::kernels().vec_zero_values_less_than_double( input, threshold, length );
+}
+
+void vec_fractional_part( const double* input, double* output, size_t length )
+{
+    VECLIB_PROBE( vec_fractional_part, length );
+    simd::kernels().vec_fractional_part_double( input, output, length );
+}
+
+void vec_zero( double* vec, size_t length )
+{
+    VECLIB_PROBE( vec_zero, length );
+    simd::kernels().vec_zero_double( vec, length );
+}
+
+void vec_copy( const double* vec_source, double* vec_dest, size_t length )
+{
+    VECLIB_PROBE( vec_copy, length );
+    memcpy( vec_dest, vec_source, length*sizeof( double ) );
+}
+
+void vec_convert( const int16_t* input, float* output, float scale, size_t length )
+{
+    VECLIB_PROBE( vec_convert, length );
+    simd::kernels().vec_convert_from_s16( input, output, scale, length );
+}
+
+void vec_convert( const float* input, int16_t* output, float scale, size_t length )
+{
+    VECLIB_PROBE( vec_convert, length );
+    simd::kernels().vec_convert_to_s16( input, output, scale, length );
+}
+
+void vec_convert( const float* input, double* output, size_t length )
+{
+    VECLIB_PROBE( vec_convert, length );
+    // A plain loop; compilers vectorise this for the baseline instruction set.
+    for( size_t i = 0; i < length; ++i )
+    {
+        output[i] = static_cast< double >( input[i] );
+    }
+}
+
+void vec_convert( const double* input, float* output, size_t length )
+{
+    VECLIB_PROBE( vec_convert, length );
+    for( size_t i = 0; i < length; ++i )
+    {
+        output[i] = static_cast< float >( input[i] );
+    }
+}
+
+void vec_mult( const int16_t* input1, float scale, const float* input2, float* output, size_t length )
+{
+    VECLIB_PROBE( vec_mult, length );
+    simd::kernels().vec_mult_s16( input1, scale, input2, output, length );
+}
+
+void vec_add_in_place( const int16_t* input1, float scale, float* input2_output, size_t length )
+{
+    VECLIB_PROBE( vec_add_in_place, length );
+    simd::kernels().vec_add_in_place_s16( input1, scale, input2_output, length );
+}
+
+float vec_sum( const float* input, size_t length, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_sum, length );
+    return simd::kernels().vec_sum( input, length, accuracy );
+}
+
+float vec_dot( const float* input1, const float* input2, size_t length, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_dot, length );
+    return simd::kernels().vec_dot( input1, input2, length, accuracy );
+}
+
+float vec_norm_l1( const float* input, size_t length, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_norm_l1, length );
+    return simd::kernels().vec_norm_l1( input, length, accuracy );
+}
+
+float vec_norm_l2( const float* input, size_t length, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_norm_l2, length );
+    return simd::kernels().vec_norm_l2( input, length, accuracy );
+}
+
+float vec_min( const float* input, size_t length, size_t* index )
+{
+    VECLIB_PROBE( vec_min, length );
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_min", "Input must not be empty." );
+        if( index )
+        {
+            *index = 0;
+        }
+        return 0;
+    }
+    return simd::kernels().vec_min( input, length, index );
+}
+
+float vec_max( const float* input, size_t length, size_t* index )
+{
+    VECLIB_PROBE( vec_max, length );
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_max", "Input must not be empty." );
+        if( index )
+        {
+            *index = 0;
+        }
+        return 0;
+    }
+    return simd::kernels().vec_max( input, length, index );
+}
+
+void vec_mean_variance( const float* input, size_t length, float* mean, float* variance, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_mean_variance, length );
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_mean_variance", "Input must not be empty." );
+        *mean = 0;
+        *variance = 0;
+        return;
+    }
+    simd::kernels().vec_mean_variance( input, length, mean, variance, accuracy );
+}
+
+float vec_weighted_mean( const float* values, const float* weights, size_t length, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_weighted_mean, length );
+    return simd::kernels().vec_weighted_mean( values, weights, length, accuracy );
+}
+
+double vec_sum( const double* input, size_t length, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_sum, length );
+    return simd::kernels().vec_sum_double( input, length, accuracy );
+}
+
+double vec_dot( const double* input1, const double* input2, size_t length, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_dot, length );
+    return simd::kernels().vec_dot_double( input1, input2, length, accuracy );
+}
+
+double vec_norm_l1( const double* input, size_t length, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_norm_l1, length );
+    return simd::kernels().vec_norm_l1_double( input, length, accuracy );
+}
+
+double vec_norm_l2( const double* input, size_t length, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_norm_l2, length );
+    return simd::kernels().vec_norm_l2_double( input, length, accuracy );
+}
+
+double vec_min( const double* input, size_t length, size_t* index )
+{
+    VECLIB_PROBE( vec_min, length );
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_min", "Input must not be empty." );
+        if( index )
+        {
+            *index = 0;
+        }
+        return 0;
+    }
+    return simd::kernels().vec_min_double( input, length, index );
+}
+
+double vec_max( const double* input, size_t length, size_t* index )
+{
+    VECLIB_PROBE( vec_max, length );
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_max", "Input must not be empty." );
+        if( index )
+        {
+            *index = 0;
+        }
+        return 0;
+    }
+    return simd::kernels().vec_max_double( input, length, index );
+}
+
+void vec_mean_variance( const double* input, size_t length, double* mean, double* variance, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_mean_variance, length );
+    if( VECLIB_UNLIKELY( length == 0 ) )
+    {
+        report_error( ErrorCode::invalid_argument, 0, "vec_mean_variance", "Input must not be empty." );
+        *mean = 0;
+        *variance = 0;
+        return;
+    }
+    simd::kernels().vec_mean_variance_double( input, length, mean, variance, accuracy );
+}
+
+double vec_weighted_mean( const double* values, const double* weights, size_t length, SumAccuracy accuracy )
+{
+    VECLIB_PROBE( vec_weighted_mean, length );
+    return simd::kernels().vec_weighted_mean_double( values, weights, length, accuracy );
+}
+
+} // namespace veclib
+
+} // namespace cupcake
@@ -0,0 +1,409 @@
+//
+// Window functions, served from a process wide cache of precomputed tables - implementation.
+//
+
+// In Module includes
+#include "window_functions.h"
+#include "aligned_memory.h"
+#include "instrumentation_probe.h"
+#if defined( VECLIB_BACKEND_SIMD )
+#include "simd/kernel_table.h"
+#else
+#include "simd/native_isa.h"
+#include "simd/vector_kernels.h"
+#endif
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <string.h>
+#include <tuple>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+class WindowTable
+///
+/// A window's coefficients, in 64 byte aligned memory. Never modified after construction,
+/// so one instance can be shared by any number of Windows and threads.
+///
+{
+public:
+
+    explicit WindowTable( size_t length ) : coefficients( length ) {}
+
+    AlignedBuffer< float > coefficients;
+
+private:
+
+    WindowTable( const WindowTable& );
+
+    WindowTable& operator=( const WindowTable& );
+
+};
+
+namespace
+{
+
+const double pi = 3.14159265358979323846;
+
+double bessel_i0( double x )
+///
+/// The modified Bessel function of the first kind, order 0, by its power series.
+///
+{
+    const double quarter_x2 = 0.25*x*x;
+    double term = 1.0;
+    double sum = 1.0;
+    for( int k = 1; term > 1e-17*sum; ++k )
+    {
+        term *= quarter_x2/( static_cast< double >( k )*k );
+        sum += term;
+    }
+    return sum;
+}
+
+double cosine_sum( const double* a, size_t terms, double x )
+///
+/// Returns a[0] - a[1] cos( 2 pi x ) + a[2] cos( 4 pi x ) - ..., for x in cycles.
+///
+{
+    double value = 0.0;
+    double sign = 1.0;
+    for( size_t k = 0; k < terms; ++k )
+    {
+        value += sign*a[k]*std::cos( 2.0*pi*static_cast< double >( k )*x );
+        sign = -sign;
+    }
+    return value;
+}
+
+double window_value( WindowType type, const WindowOptions& options, double x )
+///
+/// Evaluates a window at position x, running from 0 at the first sample to 1 one period later.
+///
+{
+    static const double hann[] = { 0.5, 0.5 };
+    static const double hamming[] = { 0.54, 0.46 };
+    static const double blackman[] = { 0.42, 0.5, 0.08 };
+    static const double blackman_harris[] = { 0.35875, 0.48829, 0.14128, 0.01168 };
+    static const double flat_top[] = { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 };
+
+    switch( type )
+    {
+        case WindowType::hann:
+            return cosine_sum( hann, 2, x );
+        case WindowType::hamming:
+            return cosine_sum( hamming, 2, x );
+        case WindowType::blackman:
+            return cosine_sum( blackman, 3, x );
+        case WindowType::blackman_harris:
+            return cosine_sum( blackman_harris, 4, x );
+        case WindowType::flat_top:
+            return cosine_sum( flat_top, 5, x );
+        case WindowType::kaiser:
+        {
+            const double beta = options.kaiser_beta;
+            const double r = 2.0*x - 1.0;
+            return bessel_i0( beta*std::sqrt( std::max( 0.0, 1.0 - r*r ) ) )/bessel_i0( beta );
+        }
+        case WindowType::tukey:
+        {
+            const double taper = 0.5*options.tukey_alpha;
+            const double edge = std::min( x, 1.0 - x );
+            return ( edge < taper ) ? 0.5 - 0.5*std::cos( pi*edge/taper ) : 1.0;
+        }
+        case WindowType::rectangular:
+        default:
+            return 1.0;
+    }
+}
+
+void compute_window( WindowType type, const WindowOptions& options, float* output, size_t length )
+///
+/// Fills output with a window, evaluated in double precision.
+///
+{
+    const double period = static_cast< double >( options.symmetry==WindowSymmetry::symmetric ? length - 1 : length );
+    for( size_t n = 0; n < length; ++n )
+    {
+        // A single sample window is 1, as in Matlab and SciPy.
+        double value = ( length > 1 ) ? window_value( type, options, static_cast< double >( n )/period ) : 1.0;
+        if( options.square_root )
+        {
+            // Flat-top dips below zero; keep the sign so that the window squares back to itself.
+            value = ( value < 0.0 ) ? -std::sqrt( -value ) : std::sqrt( value );
+        }
+        output[n] = static_cast< float >( value );
+    }
+}
+
+///
+/// Process wide cache of window tables, keyed by type, length, symmetry, square root and
+/// the type's shape parameter.
+///
+/// Tables are kept until clear_window_cache() is called; Windows hold their own reference,
+/// so clearing never invalidates a live Window.
+///
+struct WindowCache
+{
+    typedef std::tuple< WindowType, size_t, WindowSymmetry, bool, float > Key;
+
+    WindowCache() : hits( 0 ), misses( 0 ) {}
+
+    std::mutex lock;
+    std::map< Key, std::shared_ptr< const WindowTable > > tables;
+    std::atomic< size_t > hits;
+    std::atomic< size_t > misses;
+};
+
+WindowCache& window_cache()
+{
+    static WindowCache cache;
+    return cache;
+}
+
+std::shared_ptr< const WindowTable > acquire_window_table( WindowType type, size_t length, const WindowOptions& options )
+///
+/// Returns the cached table for a window, computing it on first use.
+///
+{
+    assert( length > 0 ); // Windows must have at least one coefficient.
+    assert( type!=WindowType::tukey || ( options.tukey_alpha >= 0.0f && options.tukey_alpha <= 1.0f ) ); // Tukey alpha must be in [0,1].
+
+    float parameter = 0.0f;
+    if( type==WindowType::kaiser )
+    {
+        parameter = options.kaiser_beta;
+    }
+    else if( type==WindowType::tukey )
+    {
+        parameter = options.tukey_alpha;
+    }
+
+    WindowCache& cache = window_cache();
+    const WindowCache::Key key( type, length, options.symmetry, options.square_root, parameter );
+    {
+        std::lock_guard< std::mutex > guard( cache.lock );
+        auto found = cache.tables.find( key );
+        if( found != cache.tables.end() )
+        {
+            ++cache.hits;
+            return found->second;
+        }
+    }
+
+    // Compute outside the lock so that a miss doesn't stall lookups of other windows.
+    // If another thread beat us to it, keep theirs and drop ours.
+    std::shared_ptr< WindowTable > table = std::make_shared< WindowTable >( length );
+    compute_window( type, options, table->coefficients.data(), length );
+    std::lock_guard< std::mutex > guard( cache.lock );
+    auto inserted = cache.tables.insert( std::make_pair( key, std::shared_ptr< const WindowTable >( table ) ) );
+    if( inserted.second )
+    {
+        ++cache.misses;
+    }
+    else
+    {
+        ++cache.hits;
+    }
+    return inserted.first->second;
+}
+
+} // namespace
+
+Window::Window( WindowType type, size_t length, const WindowOptions& options ) :
+    table( acquire_window_table( type, length, options ) )
+///
+/// Gets a window from the cache, computing it if this is the first request for it.
+///
+/// @param type
+///  The window function.
+///
+/// @param length
+///  The number of coefficients. Must be non-zero.
+///
+/// @param options
+///  Symmetry, square root and shape parameters. Defaults to a periodic window.
+///
+{
+}
+
+Window::Window( const float* coefficients, size_t length )
+///
+/// Creates a window from caller supplied coefficients, which are copied into an aligned
+/// table of its own. Custom windows are not cached.
+///
+/// @param coefficients
+///  A pointer to length window coefficients.
+///
+/// @param length
+///  The number of coefficients. Must be non-zero.
+///
+{
+    assert( length > 0 ); // Windows must have at least one coefficient.
+    std::shared_ptr< WindowTable > custom = std::make_shared< WindowTable >( length );
+    memcpy( custom->coefficients.data(), coefficients, length*sizeof( float ) );
+    table = custom;
+}
+
+const float* Window::data() const
+///
+/// Returns the window's coefficients, aligned to 64 bytes.
+///
+{
+    return table->coefficients.data();
+}
+
+size_t Window::size() const
+///
+/// Returns the number of coefficients in the window.
+///
+{
+    return table->coefficients.size();
+}
+
+void apply_window( const float* input, const Window& window, float* output, float gain )
+///
+/// Multiplies a frame by a window, and optionally a gain, in a single pass.
+///
+/// @param input
+///  A pointer to window.size() samples.
+///
+/// @param window
+///  The window to apply.
+///
+/// @param output
+///  A pointer to window.size() floats for the windowed frame. May be equal to input.
+///
+/// @param gain
+///  A constant applied along with the window, e.g. to normalise for the window's sum.
+///
+{
+    apply_window( input, window.data(), output, window.size(), gain );
+}
+
+void apply_window( const float* input, const float* window, float* output, size_t length, float gain )
+///
+/// Multiplies a frame by a window, and optionally a gain, in a single pass. This form takes
+/// any part of a window, e.g. to window a ring buffer in two pieces.
+///
+/// @param input
+///  A pointer to length samples.
+///
+/// @param window
+///  A pointer to length window coefficients.
+///
+/// @param output
+///  A pointer to length floats for the windowed frame. May be equal to input.
+///
+/// @param length
+///  The number of samples to window.
+///
+/// @param gain
+///  A constant applied along with the window.
+///
+{
+    VECLIB_PROBE( apply_window, length );
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().apply_window( input, window, output, length, gain );
+#else
+    simd::map_binary< simd::NativeISA >( input, window, output, length, simd::MulScaled< simd::NativeISA >( gain ) );
+#endif
+}
+
+void apply_window( const int16_t* input, const Window& window, float* output, float gain )
+///
+/// Converts a frame of 16-bit integer samples to float and windows it in a single pass.
+///
+/// @param input
+///  A pointer to window.size() 16-bit samples.
+///
+/// @param window
+///  The window to apply.
+///
+/// @param output
+///  A pointer to window.size() floats for the windowed frame.
+///
+/// @param gain
+///  A constant applied along with the window, including any scaling of the samples.
+///
+{
+    apply_window( input, window.data(), output, window.size(), gain );
+}
+
+void apply_window( const int16_t* input, const float* window, float* output, size_t length, float gain )
+///
+/// As above, for any part of a window.
+///
+/// @param input
+///  A pointer to length 16-bit samples.
+///
+/// @param window
+///  A pointer to length window coefficients.
+///
+/// @param output
+///  A pointer to length floats for the windowed frame.
+///
+/// @param length
+///  The number of samples to window.
+///
+/// @param gain
+///  A constant applied along with the window, including any scaling of the samples.
+///
+{
+    VECLIB_PROBE( apply_window, length );
+#if defined( VECLIB_BACKEND_SIMD )
+    simd::kernels().vec_mult_s16( input, gain, window, output, length );
+#else
+    simd::map_binary_s16< simd::NativeISA >( input, window, output, length, simd::MulScaled< simd::NativeISA >( gain ) );
+#endif
+}
+
+WindowCacheStats get_window_cache_stats()
+///
+/// Returns the window cache hit and miss counts.
+///
+{
+    WindowCache& cache = window_cache();
+    WindowCacheStats stats;
+    stats.hits = cache.hits.load();
+    stats.misses = cache.misses.load();
+    std::lock_guard< std::mutex > guard( cache.lock );
+    stats.entries = cache.tables.size();
+    return stats;
+}
+
+void reset_window_cache_stats()
+///
+/// Zeroes the window cache hit and miss counts.
+///
+{
+    window_cache().hits = 0;
+    window_cache().misses = 0;
+}
+
+void clear_window_cache()
+///
+/// Releases the cache's references to all window tables. Tables still used by a live
+/// Window are freed when the last such Window is destroyed.
+///
+{
+    WindowCache& cache = window_cache();
+    std::lock_guard< std::mutex > guard( cache.lock );
+    cache.tables.clear();
+}
+
+} // namespace veclib
+
+} // namespace cupcake
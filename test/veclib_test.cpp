@@ -0,0 +1,315 @@
+//
+// Accuracy tests for the documented error bounds of VecLib functions.
+//
+// With the SIMD backend every test runs once per instruction set the host supports.
+// Exits non-zero if any bound is exceeded. --filter=<substring> runs only matching tests.
+//
+
+// In Module includes
+#include "FFT.h"
+#include "oscillators.h"
+#include "sig_gen.h"
+#if defined( VECLIB_BACKEND_SIMD )
+#include "dispatch.h"
+#endif
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace cupcake::veclib;
+
+namespace
+{
+
+size_t failures = 0;
+
+void expect_at_most( const char* test, const char* quantity, double value, double bound )
+///
+/// Prints a test result, counting it as a failure if value exceeds bound.
+///
+{
+    const bool passed = value <= bound;
+    printf( "  %-4s %s: %s %.3g (bound %.3g)\n", passed ? "ok" : "FAIL", test, quantity, value, bound );
+    if( !passed )
+    {
+        ++failures;
+    }
+}
+
+double angle_error( float angle, double reference )
+///
+/// Returns the distance between two angles in radians, allowing for the wrap at +-pi.
+///
+{
+    const double difference = std::fabs( angle - reference );
+    return std::min( difference, 2.0*M_PI - difference );
+}
+
+void test_phase_accuracy()
+///
+/// Sweeps phase_spectra and cart_to_polar around the unit circle, and circles of other
+/// radii, at each SpectralAccuracy, for both spectrum layouts.
+///
+{
+    const size_t points = 1 << 20;
+    const float radii[] = { 1.0f, 1e-30f, 1e30f };
+    const size_t count = points*( sizeof( radii )/sizeof( radii[0] ) );
+    std::vector< std::complex< float > > input( count );
+    std::vector< float > real( count );
+    std::vector< float > imag( count );
+    std::vector< double > reference( count );
+    for( size_t r = 0; r < sizeof( radii )/sizeof( radii[0] ); ++r )
+    {
+        for( size_t i = 0; i < points; ++i )
+        {
+            const double angle = -M_PI + 2.0*M_PI*( i + 0.5 )/points;
+            const size_t k = r*points + i;
+            input[k] = std::complex< float >( static_cast< float >( radii[r]*std::cos( angle ) ),
+                                              static_cast< float >( radii[r]*std::sin( angle ) ) );
+            real[k] = input[k].real();
+            imag[k] = input[k].imag();
+            reference[k] = std::atan2( static_cast< double >( imag[k] ), static_cast< double >( real[k] ) );
+        }
+    }
+
+    const SpectralAccuracy levels[] = { SpectralAccuracy::full, SpectralAccuracy::medium, SpectralAccuracy::fast };
+    const char* names[] = { "full", "medium", "fast" };
+    const double bounds[] = { 3e-7, 2e-6, 1e-4 };
+    std::vector< float > phase( count );
+    std::vector< float > polar_phase( count );
+    std::vector< float > split_phase( count );
+    std::vector< float > magnitude( count );
+    for( size_t level = 0; level < 3; ++level )
+    {
+        phase_spectra( input.data(), phase.data(), count, levels[level] );
+        cart_to_polar( input.data(), magnitude.data(), polar_phase.data(), count, levels[level] );
+        phase_spectra( real.data(), imag.data(), split_phase.data(), count, levels[level] );
+
+        double worst = 0.0;
+        for( size_t k = 0; k < count; ++k )
+        {
+            worst = std::max( worst, angle_error( phase[k], reference[k] ) );
+            worst = std::max( worst, angle_error( polar_phase[k], reference[k] ) );
+            worst = std::max( worst, angle_error( split_phase[k], reference[k] ) );
+        }
+        expect_at_most( names[level], "max error (rad)", worst, bounds[level] );
+    }
+}
+
+void test_oscillator_drift()
+///
+/// Runs a SineOscillator for 10^8 samples, in blocks long enough to exercise the kernel's
+/// recurrence between exact restarts, and bounds its deviation from the ideal cosine. The
+/// frequency has few enough significant bits that n*frequency is exact in double, so the
+/// reference phase is exact.
+///
+{
+    const size_t total = 100000000;
+    const size_t block = 1 << 20;
+    const float frequency = 0.0123456789f;
+    SineOscillator oscillator( frequency );
+    std::vector< float > output( block );
+
+    double worst = 0.0;
+    double worst_last_block = 0.0;
+    for( size_t start = 0; start < total; start += block )
+    {
+        const size_t length = std::min( block, total - start );
+        oscillator.process( output.data(), length );
+        for( size_t i = 0; i < length; ++i )
+        {
+            const double cycles = static_cast< double >( start + i )*frequency;
+            const double error = std::fabs( output[i] - std::cos( 2.0*M_PI*( cycles - std::floor( cycles ) ) ) );
+            worst = std::max( worst, error );
+            if( start + block >= total )
+            {
+                worst_last_block = std::max( worst_last_block, error );
+            }
+        }
+    }
+    expect_at_most( "SineOscillator", "max sample error", worst, 2e-6 );
+    expect_at_most( "SineOscillator", "max sample error in the last block", worst_last_block, 2e-6 );
+
+    // The oscillator's own phase, after 10^8 samples, against the exact value.
+    const double cycles = static_cast< double >( total )*frequency;
+    double expected = 2.0*M_PI*( cycles - std::floor( cycles ) );
+    expected = expected >= M_PI ? expected - 2.0*M_PI : expected;
+    expect_at_most( "SineOscillator", "phase error after 10^8 samples (rad)", angle_error( oscillator.phase(), expected ), 1e-6 );
+}
+
+double signal_error( const std::vector< float >& signal, double start_cycles, double frequency, double chirp_rate,
+                     double& worst_last_block )
+///
+/// Returns the largest deviation of signal from cos( 2 pi cycles(n) ), where
+/// cycles(n) = start_cycles + frequency*n + chirp_rate*n*n/2, and sets worst_last_block to
+/// the largest over the final 2^20 samples. The whole cycles are dropped before the start
+/// phase is added, so the reference keeps its precision however long the signal is.
+///
+{
+    const size_t last_block = signal.size() > ( 1 << 20 ) ? signal.size() - ( 1 << 20 ) : 0;
+    double worst = 0.0;
+    worst_last_block = 0.0;
+    for( size_t i = 0; i < signal.size(); ++i )
+    {
+        const double n = static_cast< double >( i );
+        const double cycles = n*( frequency + 0.5*chirp_rate*n );
+        const double error = std::fabs( signal[i] - std::cos( 2.0*M_PI*( cycles - std::floor( cycles ) + start_cycles ) ) );
+        worst = std::max( worst, error );
+        if( i >= last_block )
+        {
+            worst_last_block = std::max( worst_last_block, error );
+        }
+    }
+    return worst;
+}
+
+double ending_frequency( const std::vector< float >& signal, size_t window )
+///
+/// Estimates the frequency, in cycles per sample, of the last window samples of a sinusoid,
+/// from x[n-1] + x[n+1] = 2 cos( 2 pi f ) x[n] fitted by least squares. For a chirp this is
+/// the frequency at the middle of the window.
+///
+{
+    double correlation = 0.0;
+    double energy = 0.0;
+    for( size_t i = signal.size() - window + 1; i + 1 < signal.size(); ++i )
+    {
+        correlation += static_cast< double >( signal[i] )*( signal[i - 1] + signal[i + 1] );
+        energy += static_cast< double >( signal[i] )*signal[i];
+    }
+    return std::acos( correlation/( 2.0*energy ) )/( 2.0*M_PI );
+}
+
+void test_generator_drift()
+///
+/// Fills 10^8 samples with fill_vector_sine and fill_vector_chirp, through both the pointer
+/// and the std::vector overloads, and bounds their deviation from the ideal signal over the
+/// whole run and at its end, along with the frequency they finish on. The chirp must end
+/// at end_freq on its last sample.
+///
+{
+    const size_t total = 100000000;
+    const size_t window = 1 << 16;
+    std::vector< float > signal( total );
+    double worst_last_block = 0.0;
+
+    const float frequency = 0.0123456789f;
+    const float phase = 0.5f;
+    const char* sine_names[] = { "fill_vector_sine", "fill_vector_sine (vector)" };
+    for( size_t overload = 0; overload < 2; ++overload )
+    {
+        if( overload==0 )
+        {
+            fill_vector_sine( signal.data(), total, frequency, phase, 1.0f );
+        }
+        else
+        {
+            fill_vector_sine( signal, frequency, phase, 1.0f );
+        }
+        const double worst = signal_error( signal, phase/( 2.0*M_PI ), frequency, 0.0, worst_last_block );
+        expect_at_most( sine_names[overload], "max sample error", worst, 2e-6 );
+        expect_at_most( sine_names[overload], "max sample error in the last 2^20 samples", worst_last_block, 2e-6 );
+        expect_at_most( sine_names[overload], "ending frequency error (cycles/sample)",
+                        std::fabs( ending_frequency( signal, window ) - frequency ), 1e-7 );
+    }
+
+    const float start_freq = 0.001f;
+    const float end_freq = 0.2f;
+    const float start_phase = -1.0f;
+    const double chirp_rate = ( static_cast< double >( end_freq ) - start_freq )/static_cast< double >( total - 1 );
+    const char* chirp_names[] = { "fill_vector_chirp", "fill_vector_chirp (vector)" };
+    for( size_t overload = 0; overload < 2; ++overload )
+    {
+        if( overload==0 )
+        {
+            fill_vector_chirp( signal.data(), total, start_freq, end_freq, start_phase, 1.0f );
+        }
+        else
+        {
+            fill_vector_chirp( signal, start_freq, end_freq, start_phase, 1.0f );
+        }
+        const double worst = signal_error( signal, start_phase/( 2.0*M_PI ), start_freq, chirp_rate, worst_last_block );
+        // The chirp also advances its step phasor between restarts, which roughly triples
+        // the sine's rounding, but like the sine's it doesn't grow over the run.
+        expect_at_most( chirp_names[overload], "max sample error", worst, 1e-5 );
+        expect_at_most( chirp_names[overload], "max sample error in the last 2^20 samples", worst_last_block, 1e-5 );
+
+        // The estimate is for the middle of the window, half a window before the end.
+        const double expected = end_freq - chirp_rate*0.5*static_cast< double >( window - 1 );
+        expect_at_most( chirp_names[overload], "ending frequency error (cycles/sample)",
+                        std::fabs( ending_frequency( signal, window ) - expected ), 1e-7 );
+    }
+}
+
+struct Test
+{
+    const char* name;
+    void ( *run )();
+};
+
+const Test tests[] =
+{
+    { "phase_accuracy", test_phase_accuracy },
+    { "oscillator_drift", test_oscillator_drift },
+    { "generator_drift", test_generator_drift },
+};
+
+void run_tests( const char* filter )
+///
+/// Runs every test whose name contains filter.
+///
+{
+    for( size_t t = 0; t < sizeof( tests )/sizeof( tests[0] ); ++t )
+    {
+        if( strstr( tests[t].name, filter ) )
+        {
+            printf( " %s\n", tests[t].name );
+            tests[t].run();
+        }
+    }
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+    const char* filter = "";
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strncmp( argv[i], "--filter=", 9 )==0 )
+        {
+            filter = argv[i] + 9;
+        }
+        else
+        {
+            fprintf( stderr, "Usage: %s [--filter=<substring>]\n", argv[0] );
+            return 1;
+        }
+    }
+
+#if defined( VECLIB_BACKEND_SIMD )
+    const ISA candidates[] = { ISA::scalar, ISA::sse2, ISA::avx2, ISA::avx512, ISA::neon };
+    for( size_t c = 0; c < 5; ++c )
+    {
+        if( force_isa( candidates[c] ) )
+        {
+            printf( "isa %s\n", isa_name( candidates[c] ) );
+            run_tests( filter );
+        }
+    }
+#else
+    printf( "backend ipp\n" );
+    run_tests( filter );
+#endif
+
+    printf( "%s: %zu failure%s\n", failures ? "FAILED" : "PASSED", failures, failures==1 ? "" : "s" );
+    return failures ? 1 : 0;
+}
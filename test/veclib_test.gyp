@@ -0,0 +1,30 @@
+  {
+
+    'includes':
+    [
+      '../VecLib.gypi',
+    ],
+
+    'targets':
+    [
+      {
+        # Accuracy tests, run against every instruction set the host supports. Exits non-zero
+        # on failure, e.g.
+        #   gyp test/veclib_test.gyp --depth=. -Dveclib_backend=simd
+        'target_name': 'veclib_test',
+        'type': 'executable',
+        'cflags':
+        [
+          '-O2',
+        ],
+        'xcode_settings':
+        {
+          'GCC_OPTIMIZATION_LEVEL': '2',
+        },
+        'sources':
+        [
+          'veclib_test.cpp',
+        ],
+      },
+    ],
+  }
@@ -0,0 +1,252 @@
+//
+// Lazily evaluated, fused elementwise vector expressions.
+//
+// Chaining vector_functions.h calls makes one pass over memory per call. Here an
+// expression such as
+//
+//     view( out, n ) = max( view( a, n )*view( b, n ) + view( c, n ), threshold );
+//
+// builds a tree of lightweight nodes that is only evaluated on assignment, in a single
+// SIMD loop with no temporary buffers. a*b + c contracts to a fused multiply-add.
+//
+// This layer is header only, so the instruction set follows the compiler flags of the
+// including file (e.g. -mavx2 -mfma) rather than the runtime dispatch in dispatch.h.
+//
+
+#ifndef CUPCAKE_VEC_LIB_VECTOR_EXPRESSIONS_H
+#define CUPCAKE_VEC_LIB_VECTOR_EXPRESSIONS_H
+
+// In module includes
+#include "src/simd/native_isa.h"
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <assert.h>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+namespace expr
+{
+
+///
+/// Base of all expression nodes (CRTP). Every node provides:
+///
+///     template< class V > typename V::vf eval( size_t i ) const;  -> V::width results starting at element i.
+///     bool conforms( size_t length ) const;                       -> true if every operand has length elements.
+///
+template< class E >
+struct Expression
+{
+    const E& derived() const { return static_cast< const E& >( *this ); }
+};
+
+template< class E >
+inline void evaluate( float* output, size_t length, const Expression< E >& expression )
+///
+/// Evaluates an expression into output in a single pass.
+///
+/// @param output
+///  A pointer to the first of length elements to be written. This may be the same memory as
+///  any of the operands, but not an offset into it.
+///
+/// @param length
+///  The number of elements to evaluate.
+///
+/// @param expression
+///  The expression to evaluate. All vector operands must have length elements.
+///
+{
+    typedef simd::NativeISA V;
+    const size_t W = V::width;
+    const E& e = expression.derived();
+    assert( e.conforms( length ) ); // Operand lengths differ from the output.
+
+    size_t i = 0;
+    for( ; i + 2*W <= length; i += 2*W )
+    {
+        typename V::vf r0 = e.template eval< V >( i );
+        typename V::vf r1 = e.template eval< V >( i + W );
+        V::storeu( output + i, r0 );
+        V::storeu( output + i + W, r1 );
+    }
+    for( ; i < length; ++i )
+    {
+        output[i] = e.template eval< simd::Scalar >( i );
+    }
+}
+
+///
+/// Leaf nodes.
+///
+struct ConstView : Expression< ConstView >
+{
+    ConstView( const float* data_, size_t length_ ) : data( data_ ), length( length_ ) {}
+    template< class V > typename V::vf eval( size_t i ) const { return V::loadu( data + i ); }
+    bool conforms( size_t n ) const { return n==length; }
+
+    const float* data;
+    size_t length;
+};
+
+struct View : Expression< View >
+///
+/// A writable vector. Assigning an expression to a View evaluates it into the View's memory.
+///
+{
+    View( float* data_, size_t length_ ) : data( data_ ), length( length_ ) {}
+    View( const View& other ) : data( other.data ), length( other.length ) {}
+    template< class V > typename V::vf eval( size_t i ) const { return V::loadu( data + i ); }
+    bool conforms( size_t n ) const { return n==length; }
+
+    template< class E >
+    View& operator=( const Expression< E >& expression ) { evaluate( data, length, expression ); return *this; }
+
+    // Copies elements, not the pointer - a View has reference semantics.
+    View& operator=( const View& other ) { evaluate( data, length, other ); return *this; }
+
+    float* data;
+    size_t length;
+};
+
+struct Constant : Expression< Constant >
+{
+    explicit Constant( float value_ ) : value( value_ ) {}
+    template< class V > typename V::vf eval( size_t ) const { return V::set1( value ); }
+    bool conforms( size_t ) const { return true; }
+
+    float value;
+};
+
+inline ConstView view( const float* data, size_t length ) { return ConstView( data, length ); }
+
+inline View view( float* data, size_t length ) { return View( data, length ); }
+
+///
+/// Elementwise operations.
+///
+struct AddOp { template< class V > static typename V::vf apply( typename V::vf a, typename V::vf b ) { return V::add( a, b ); } };
+struct SubOp { template< class V > static typename V::vf apply( typename V::vf a, typename V::vf b ) { return V::sub( a, b ); } };
+struct MulOp { template< class V > static typename V::vf apply( typename V::vf a, typename V::vf b ) { return V::mul( a, b ); } };
+struct DivOp { template< class V > static typename V::vf apply( typename V::vf a, typename V::vf b ) { return V::div( a, b ); } };
+struct MinOp { template< class V > static typename V::vf apply( typename V::vf a, typename V::vf b ) { return V::min( a, b ); } };
+struct MaxOp { template< class V > static typename V::vf apply( typename V::vf a, typename V::vf b ) { return V::max( a, b ); } };
+struct ZeroLessThanOp
+{
+    template< class V > static typename V::vf apply( typename V::vf a, typename V::vf b ) { return V::select( V::cmplt( a, b ), V::zero(), a ); }
+};
+
+struct AbsOp { template< class V > static typename V::vf apply( typename V::vf a ) { return V::abs( a ); } };
+struct SqrtOp { template< class V > static typename V::vf apply( typename V::vf a ) { return V::sqrt( a ); } };
+struct NegateOp { template< class V > static typename V::vf apply( typename V::vf a ) { return V::sub( V::zero(), a ); } };
+struct FracOp { template< class V > static typename V::vf apply( typename V::vf a ) { return V::sub( a, V::trunc( a ) ); } };
+
+template< class Op, class L, class R > struct Binary;
+
+template< class Op, class L, class R >
+struct BinaryEval
+///
+/// How a Binary node is evaluated. Specialised below to contract multiply-add.
+///
+{
+    template< class V >
+    static typename V::vf eval( const L& lhs, const R& rhs, size_t i )
+    {
+        return Op::template apply< V >( lhs.template eval< V >( i ), rhs.template eval< V >( i ) );
+    }
+};
+
+template< class A, class B, class R >
+struct BinaryEval< AddOp, Binary< MulOp, A, B >, R >
+{
+    template< class V >
+    static typename V::vf eval( const Binary< MulOp, A, B >& lhs, const R& rhs, size_t i )
+    {
+        return V::fmadd( lhs.lhs.template eval< V >( i ), lhs.rhs.template eval< V >( i ), rhs.template eval< V >( i ) );
+    }
+};
+
+template< class L, class A, class B >
+struct BinaryEval< AddOp, L, Binary< MulOp, A, B > >
+{
+    template< class V >
+    static typename V::vf eval( const L& lhs, const Binary< MulOp, A, B >& rhs, size_t i )
+    {
+        return V::fmadd( rhs.lhs.template eval< V >( i ), rhs.rhs.template eval< V >( i ), lhs.template eval< V >( i ) );
+    }
+};
+
+template< class A, class B, class C, class D >
+struct BinaryEval< AddOp, Binary< MulOp, A, B >, Binary< MulOp, C, D > >
+{
+    template< class V >
+    static typename V::vf eval( const Binary< MulOp, A, B >& lhs, const Binary< MulOp, C, D >& rhs, size_t i )
+    {
+        return V::fmadd( lhs.lhs.template eval< V >( i ), lhs.rhs.template eval< V >( i ), rhs.template eval< V >( i ) );
+    }
+};
+
+template< class Op, class L, class R >
+struct Binary : Expression< Binary< Op, L, R > >
+{
+    Binary( const L& lhs_, const R& rhs_ ) : lhs( lhs_ ), rhs( rhs_ ) {}
+    template< class V > typename V::vf eval( size_t i ) const { return BinaryEval< Op, L, R >::template eval< V >( lhs, rhs, i ); }
+    bool conforms( size_t n ) const { return lhs.conforms( n ) && rhs.conforms( n ); }
+
+    // Operands are held by value; nodes are small and this keeps temporaries alive.
+    L lhs;
+    R rhs;
+};
+
+template< class Op, class A >
+struct Unary : Expression< Unary< Op, A > >
+{
+    explicit Unary( const A& operand_ ) : operand( operand_ ) {}
+    template< class V > typename V::vf eval( size_t i ) const { return Op::template apply< V >( operand.template eval< V >( i ) ); }
+    bool conforms( size_t n ) const { return operand.conforms( n ); }
+
+    A operand;
+};
+
+//
+// Each binary operation accepts expression/expression, expression/float and float/expression.
+//
+#define VECLIB_EXPR_BINARY( NAME, OP )                                                                          \
+template< class L, class R >                                                                                    \
+inline Binary< OP, L, R > NAME( const Expression< L >& lhs, const Expression< R >& rhs )                       \
+{ return Binary< OP, L, R >( lhs.derived(), rhs.derived() ); }                                                  \
+template< class L >                                                                                             \
+inline Binary< OP, L, Constant > NAME( const Expression< L >& lhs, float rhs )                                 \
+{ return Binary< OP, L, Constant >( lhs.derived(), Constant( rhs ) ); }                                         \
+template< class R >                                                                                             \
+inline Binary< OP, Constant, R > NAME( float lhs, const Expression< R >& rhs )                                 \
+{ return Binary< OP, Constant, R >( Constant( lhs ), rhs.derived() ); }
+
+VECLIB_EXPR_BINARY( operator+, AddOp )
+VECLIB_EXPR_BINARY( operator-, SubOp )
+VECLIB_EXPR_BINARY( operator*, MulOp )
+VECLIB_EXPR_BINARY( operator/, DivOp )
+VECLIB_EXPR_BINARY( min, MinOp )
+VECLIB_EXPR_BINARY( max, MaxOp )
+VECLIB_EXPR_BINARY( zero_less_than, ZeroLessThanOp )
+
+#undef VECLIB_EXPR_BINARY
+
+template< class A > inline Unary< NegateOp, A > operator-( const Expression< A >& a ) { return Unary< NegateOp, A >( a.derived() ); }
+template< class A > inline Unary< AbsOp, A > abs( const Expression< A >& a ) { return Unary< AbsOp, A >( a.derived() ); }
+template< class A > inline Unary< SqrtOp, A > sqrt( const Expression< A >& a ) { return Unary< SqrtOp, A >( a.derived() ); }
+template< class A > inline Unary< FracOp, A > frac( const Expression< A >& a ) { return Unary< FracOp, A >( a.derived() ); }
+
+} // namespace expr
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_VECTOR_EXPRESSIONS_H
@@ -9,12 +9,14 @@
 #define CUPCAKE_VEC_LIB_VECTOR_FUNCTIONS_H
 
 // In module includes
-// None.
+#include "aligned_memory.h"
 
 // Thirdparty includes
 // None.
 
 // Std Lib includes
+#include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 namespace cupcake
@@ -57,6 +59,251 @@ void vec_zero( float* vec, size_t length );
     
 void vec_copy( const float* vec_source, float* vec_dest, size_t length );
 
+///
+/// Double precision versions of the above, for high dynamic range analysis.
+///
+void vec_mult_const_in_place( double* input1, double multiplier, size_t length );
+
+void vec_mult( const double* input1, const double* input2, double* output, size_t length );
+
+void vec_mult_in_place( const double* input1, double* input2, size_t length );
+
+void vec_add_constant( double* input1, double constant, size_t length );
+
+void vec_add_in_place( const double* input1, double* input2_output, size_t length );
+
+void vec_sub_constant( double* input1, double constant, size_t length );
+
+void vec_sub( const double* input1, const double* input2, double* output, size_t length );
+
+void vec_sub_in_place( double* input1, const double* input2, size_t length );
+
+void vec_negative_halfwave_rectify( double* input, size_t length );
+
+void vec_zero_magnitudes_greater_than_abs( double* input, double threshold, size_t length );
+
+void vec_zero_values_less_than( double* input, double threshold, size_t length );
+
+void vec_fractional_part( const double* input, double* output, size_t length );
+
+void vec_zero( double* vec, size_t length );
+
+void vec_copy( const double* vec_source, double* vec_dest, size_t length );
+
+///
+/// Conversions between sample types. Conversions to int16_t round to nearest and saturate.
+///
+void vec_convert( const int16_t* input, float* output, float scale, size_t length );
+
+void vec_convert( const float* input, int16_t* output, float scale, size_t length );
+
+void vec_convert( const float* input, double* output, size_t length );
+
+void vec_convert( const double* input, float* output, size_t length );
+
+///
+/// Fused convert-and-process operations on 16-bit integer samples, e.g. PCM. Samples are
+/// multiplied by scale as they are read, e.g. 1.0f/32768.0f for full scale at 1.0, so no
+/// converted copy of the input is made.
+///
+void vec_mult( const int16_t* input1, float scale, const float* input2, float* output, size_t length );
+
+void vec_add_in_place( const int16_t* input1, float scale, float* input2_output, size_t length );
+
+///
+/// Accuracy of the sums taken by the reductions below. The error bounds are relative to the
+/// sum of the magnitudes of the terms, for n terms and machine epsilon e.
+///
+enum class SumAccuracy
+{
+    fast,               // -> IPP, or several independent sums per SIMD lane with the SIMD backend. Error O( n*e ).
+    pairwise,           // -> Short blocks summed directly, then added in pairs. Error O( log2( n )*e ), for little extra cost.
+    compensated,        // -> Kahan summation in each lane. Error O( e ), independent of n, at a third to a quarter of the speed of fast.
+};
+
+///
+/// Reductions. Each has a double overload taking and returning double.
+///
+float vec_sum( const float* input, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+float vec_dot( const float* input1, const float* input2, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+float vec_norm_l1( const float* input, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+float vec_norm_l2( const float* input, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+float vec_min( const float* input, size_t length, size_t* index = NULL );
+
+float vec_max( const float* input, size_t length, size_t* index = NULL );
+
+void vec_mean_variance( const float* input, size_t length, float* mean, float* variance, SumAccuracy accuracy = SumAccuracy::fast );
+
+float vec_weighted_mean( const float* values, const float* weights, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+double vec_sum( const double* input, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+double vec_dot( const double* input1, const double* input2, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+double vec_norm_l1( const double* input, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+double vec_norm_l2( const double* input, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+double vec_min( const double* input, size_t length, size_t* index = NULL );
+
+double vec_max( const double* input, size_t length, size_t* index = NULL );
+
+void vec_mean_variance( const double* input, size_t length, double* mean, double* variance, SumAccuracy accuracy = SumAccuracy::fast );
+
+double vec_weighted_mean( const double* values, const double* weights, size_t length, SumAccuracy accuracy = SumAccuracy::fast );
+
+///
+/// Overloads of the above for AlignedBuffer< float > and AlignedBuffer< double >, taking the
+/// length from the buffers. Buffers used together must be the same size. Constants take the
+/// buffer's sample type, so generic code can call these for either precision.
+///
+template< class T >
+inline void vec_mult_const_in_place( AlignedBuffer< T >& input1, typename AlignedBuffer< T >::value_type multiplier )
+{
+    vec_mult_const_in_place( input1.data(), multiplier, input1.size() );
+}
+
+template< class T >
+inline void vec_mult( const AlignedBuffer< T >& input1, const AlignedBuffer< T >& input2, AlignedBuffer< T >& output )
+{
+    assert( input1.size() == input2.size() ); // Input buffers must be the same size.
+    assert( input1.size() == output.size() ); // Output buffer must match the inputs.
+    vec_mult( input1.data(), input2.data(), output.data(), output.size() );
+}
+
+template< class T >
+inline void vec_mult_in_place( const AlignedBuffer< T >& input1, AlignedBuffer< T >& input2 )
+{
+    assert( input1.size() == input2.size() ); // Buffers must be the same size.
+    vec_mult_in_place( input1.data(), input2.data(), input2.size() );
+}
+
+template< class T >
+inline void vec_add_constant( AlignedBuffer< T >& input1, typename AlignedBuffer< T >::value_type constant )
+{
+    vec_add_constant( input1.data(), constant, input1.size() );
+}
+
+template< class T >
+inline void vec_add_in_place( const AlignedBuffer< T >& input1, AlignedBuffer< T >& input2_output )
+{
+    assert( input1.size() == input2_output.size() ); // Buffers must be the same size.
+    vec_add_in_place( input1.data(), input2_output.data(), input2_output.size() );
+}
+
+template< class T >
+inline void vec_sub_constant( AlignedBuffer< T >& input1, typename AlignedBuffer< T >::value_type constant )
+{
+    vec_sub_constant( input1.data(), constant, input1.size() );
+}
+
+template< class T >
+inline void vec_sub( const AlignedBuffer< T >& input1, const AlignedBuffer< T >& input2, AlignedBuffer< T >& output )
+{
+    assert( input1.size() == input2.size() ); // Input buffers must be the same size.
+    assert( input1.size() == output.size() ); // Output buffer must match the inputs.
+    vec_sub( input1.data(), input2.data(), output.data(), output.size() );
+}
+
+template< class T >
+inline void vec_sub_in_place( AlignedBuffer< T >& input1, const AlignedBuffer< T >& input2 )
+{
+    assert( input1.size() == input2.size() ); // Buffers must be the same size.
+    vec_sub_in_place( input1.data(), input2.data(), input1.size() );
+}
+
+template< class T >
+inline void vec_negative_halfwave_rectify( AlignedBuffer< T >& input )
+{
+    vec_negative_halfwave_rectify( input.data(), input.size() );
+}
+
+template< class T >
+inline void vec_zero_magnitudes_greater_than_abs( AlignedBuffer< T >& input, typename AlignedBuffer< T >::value_type threshold )
+{
+    vec_zero_magnitudes_greater_than_abs( input.data(), threshold, input.size() );
+}
+
+template< class T >
+inline void vec_zero_values_less_than( AlignedBuffer< T >& input, typename AlignedBuffer< T >::value_type threshold )
+{
+    vec_zero_values_less_than( input.data(), threshold, input.size() );
+}
+
+template< class T >
+inline void vec_fractional_part( const AlignedBuffer< T >& input, AlignedBuffer< T >& output )
+{
+    assert( input.size() == output.size() ); // Buffers must be the same size.
+    vec_fractional_part( input.data(), output.data(), output.size() );
+}
+
+template< class T >
+inline void vec_zero( AlignedBuffer< T >& vec )
+{
+    vec_zero( vec.data(), vec.size() );
+}
+
+template< class T >
+inline void vec_copy( const AlignedBuffer< T >& vec_source, AlignedBuffer< T >& vec_dest )
+{
+    assert( vec_source.size() == vec_dest.size() ); // Buffers must be the same size.
+    vec_copy( vec_source.data(), vec_dest.data(), vec_dest.size() );
+}
+
+template< class T >
+inline T vec_sum( const AlignedBuffer< T >& input, SumAccuracy accuracy = SumAccuracy::fast )
+{
+    return vec_sum( input.data(), input.size(), accuracy );
+}
+
+template< class T >
+inline T vec_dot( const AlignedBuffer< T >& input1, const AlignedBuffer< T >& input2, SumAccuracy accuracy = SumAccuracy::fast )
+{
+    assert( input1.size() == input2.size() ); // Buffers must be the same size.
+    return vec_dot( input1.data(), input2.data(), input1.size(), accuracy );
+}
+
+template< class T >
+inline T vec_norm_l1( const AlignedBuffer< T >& input, SumAccuracy accuracy = SumAccuracy::fast )
+{
+    return vec_norm_l1( input.data(), input.size(), accuracy );
+}
+
+template< class T >
+inline T vec_norm_l2( const AlignedBuffer< T >& input, SumAccuracy accuracy = SumAccuracy::fast )
+{
+    return vec_norm_l2( input.data(), input.size(), accuracy );
+}
+
+template< class T >
+inline T vec_min( const AlignedBuffer< T >& input, size_t* index = NULL )
+{
+    return vec_min( input.data(), input.size(), index );
+}
+
+template< class T >
+inline T vec_max( const AlignedBuffer< T >& input, size_t* index = NULL )
+{
+    return vec_max( input.data(), input.size(), index );
+}
+
+template< class T >
+inline void vec_mean_variance( const AlignedBuffer< T >& input, T* mean, T* variance, SumAccuracy accuracy = SumAccuracy::fast )
+{
+    vec_mean_variance( input.data(), input.size(), mean, variance, accuracy );
+}
+
+template< class T >
+inline T vec_weighted_mean( const AlignedBuffer< T >& values, const AlignedBuffer< T >& weights, SumAccuracy accuracy = SumAccuracy::fast )
+{
+    assert( values.size() == weights.size() ); // Buffers must be the same size.
+    return vec_weighted_mean( values.data(), weights.data(), values.size(), accuracy );
+}
+
 } // namespace veclib
 
 } // namespace cupcake
@@ -0,0 +1,126 @@
+//
+// Window functions, served from a process wide cache of precomputed tables.
+//
+
+#ifndef CUPCAKE_VEC_LIB_WINDOW_FUNCTIONS_H
+#define CUPCAKE_VEC_LIB_WINDOW_FUNCTIONS_H
+
+// In module includes
+// None.
+
+// Thirdparty includes
+// None.
+
+// Std Lib includes
+#include <memory>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace cupcake
+{
+
+namespace veclib
+{
+
+enum class WindowType
+{
+    rectangular,
+    hann,
+    hamming,
+    blackman,
+    blackman_harris,    // -> 4 term, -92 dB sidelobes.
+    flat_top,           // -> 5 term, as Matlab's flattopwin. Takes negative values near the ends.
+    kaiser,             // -> Shape set by WindowOptions::kaiser_beta.
+    tukey,              // -> Cosine tapered, shape set by WindowOptions::tukey_alpha.
+};
+
+enum class WindowSymmetry
+{
+    periodic,           // -> Period equal to the length, for spectral analysis and overlap-add. Default.
+    symmetric,          // -> First and last values equal, for filter design.
+};
+
+///
+/// Optional window settings. The Kaiser and Tukey parameters are ignored by other types.
+///
+struct WindowOptions
+{
+    WindowOptions() :
+        symmetry( WindowSymmetry::periodic ),
+        square_root( false ),
+        kaiser_beta( 8.6f ),
+        tukey_alpha( 0.5f )
+    {}
+
+    WindowSymmetry symmetry;
+    bool square_root;           // -> Take the square root of each value, for matched analysis and synthesis windows in WOLA.
+    float kaiser_beta;          // -> Sidelobe level falls as beta rises; 8.6 gives about -90 dB.
+    float tukey_alpha;          // -> Fraction of the window inside the tapers, from 0 (rectangular) to 1 (Hann).
+};
+
+///
+/// Immutable window table, shared between Windows through the window cache.
+///
+class WindowTable;
+
+///
+/// A window of a fixed length and shape.
+///
+/// Tables come from a process wide cache keyed by type, length and options, so the
+/// coefficients are only computed the first time a window is asked for. Tables are
+/// aligned for SIMD loads and never modified, so Windows are cheap to copy and safe to
+/// read from any number of threads.
+///
+class Window
+{
+public:
+
+    Window( WindowType type, size_t length, const WindowOptions& options = WindowOptions() );
+
+    Window( const float* coefficients, size_t length );
+
+    const float* data() const;
+
+    size_t size() const;
+
+    float operator[]( size_t index ) const { return data()[index]; }
+
+private:
+
+    std::shared_ptr< const WindowTable > table;
+
+};
+
+void apply_window( const float* input, const Window& window, float* output, float gain = 1.0f );
+
+void apply_window( const float* input, const float* window, float* output, size_t length, float gain = 1.0f );
+
+///
+/// Windowing straight from 16-bit integer samples, e.g. PCM, without a separate conversion
+/// pass. Fold the sample scaling into gain, e.g. 1.0f/32768.0f for full scale at 1.0.
+///
+void apply_window( const int16_t* input, const Window& window, float* output, float gain = 1.0f );
+
+void apply_window( const int16_t* input, const float* window, float* output, size_t length, float gain = 1.0f );
+
+///
+/// Window cache statistics, counted since startup or the last reset_window_cache_stats().
+///
+struct WindowCacheStats
+{
+    size_t hits;                // -> Windows created from an existing table.
+    size_t misses;              // -> Windows that had to compute a new table.
+    size_t entries;             // -> Tables currently held by the cache.
+};
+
+WindowCacheStats get_window_cache_stats();
+
+void reset_window_cache_stats();
+
+void clear_window_cache();
+
+} // namespace veclib
+
+} // namespace cupcake
+
+#endif // CUPCAKE_VEC_LIB_WINDOW_FUNCTIONS_H